@@ -21,7 +21,8 @@
 # Options:
 #   SUFFIX       - Target name suffix (e.g., "rocm" or "triton")
 #   LLVM_DIR     - LLVM installation or build directory (must contain bin/llvm-config)
-#   LINK_LLVM_LIBS - If set, link against LLVMCore, LLVMIRReader, LLVMLinker
+#   LINK_LLVM_LIBS - If set, link against LLVMCore, LLVMIRReader, LLVMLinker,
+#                    LLVMAnalysis, LLVMTransformUtils
 
 function(add_instrumentation_plugins)
     cmake_parse_arguments(AIP "LINK_LLVM_LIBS" "SUFFIX;LLVM_DIR" "" ${ARGN})
@@ -79,7 +80,7 @@ function(add_instrumentation_plugins)
     if(AIP_LINK_LLVM_LIBS)
         execute_process(COMMAND "${_llvm_config}" --libdir
             OUTPUT_VARIABLE _llvm_libdir OUTPUT_STRIP_TRAILING_WHITESPACE)
-        list(APPEND _link_flags_list "-L${_llvm_libdir}" -lLLVMCore -lLLVMIRReader -lLLVMLinker)
+        list(APPEND _link_flags_list "-L${_llvm_libdir}" -lLLVMCore -lLLVMIRReader -lLLVMLinker -lLLVMAnalysis -lLLVMTransformUtils)
         message(STATUS "[instrumentation-${AIP_SUFFIX}] LLVM libdir: ${_llvm_libdir}")
     endif()
 
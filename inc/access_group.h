@@ -0,0 +1,81 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Host side of the access groups emitted by the address instrumentation plugin when
+ * INSTRUMENTATION_GROUP_ACCESSES is set at compile time. Loads or stores in one basic block that
+ * share a base pointer, source file, line and column, access kind, address space and size, and that
+ * sit at constant offsets of a multiple of the access size from each other, are submitted as a
+ * single address message. Its data items are the addresses of the lowest member (slot 0), and its DWARF
+ * column packs:
+ *
+ *   bits  0..11  source column
+ *   bits 12..27  slot mask: slot i is the access at base + i * access size
+ *   bits 28..29  repeat count - 1: every slot in the mask was accessed this many times
+ *   bit  30      ACCESS_GROUP_COLUMN_FLAG
+ *
+ * Handlers expand a group into one access per slot and repeat, so their results are the same as
+ * with one message per access. With a site manifest (see site_manifest.h), the members only share
+ * file and line; each has a site with its own column. The layout must match src/instrumentation/AMDGCNSubmitAddressMessages.cpp. */
+
+const uint32_t ACCESS_GROUP_COLUMN_FLAG = 0x40000000u;
+const uint32_t ACCESS_GROUP_COLUMN_MASK = 0xfffu;
+const uint32_t ACCESS_GROUP_SLOT_SHIFT = 12;
+const uint32_t ACCESS_GROUP_SLOTS = 16;
+const uint32_t ACCESS_GROUP_REPEAT_SHIFT = 28;
+
+inline bool isAccessGroup(uint32_t dwarf_column)
+{
+    return (dwarf_column & ACCESS_GROUP_COLUMN_FLAG) != 0;
+}
+
+// The source column of an address message, group or not
+inline uint32_t accessGroupColumn(uint32_t dwarf_column)
+{
+    return isAccessGroup(dwarf_column) ? dwarf_column & ACCESS_GROUP_COLUMN_MASK : dwarf_column;
+}
+
+const uint32_t ACCESS_GROUP_MAX_REPEAT = 4;
+const size_t ACCESS_GROUP_MAX_ACCESSES = ACCESS_GROUP_SLOTS * ACCESS_GROUP_MAX_REPEAT;
+
+/* Fills offsets with the byte offsets, from the message's addresses, of all accesses the message
+ * stands for and returns how many there are: just {0} for an ordinary address message. */
+inline size_t accessGroupOffsets(uint32_t dwarf_column, uint16_t access_size,
+                                 uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES])
+{
+    if (!isAccessGroup(dwarf_column))
+    {
+        offsets[0] = 0;
+        return 1;
+    }
+    size_t count = 0;
+    uint32_t slots = (dwarf_column >> ACCESS_GROUP_SLOT_SHIFT) & ((1u << ACCESS_GROUP_SLOTS) - 1);
+    uint32_t repeat = ((dwarf_column >> ACCESS_GROUP_REPEAT_SHIFT) & (ACCESS_GROUP_MAX_REPEAT - 1)) + 1;
+    for (uint32_t slot = 0; slot < ACCESS_GROUP_SLOTS; slot++)
+        if (slots & (1u << slot))
+            for (uint32_t i = 0; i < repeat; i++)
+                offsets[count++] = static_cast<uint64_t>(slot) * access_size;
+    return count;
+}
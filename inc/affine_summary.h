@@ -0,0 +1,101 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Host side of the affine access summaries emitted by the address instrumentation plugin when
+ * INSTRUMENTATION_AFFINE_SUMMARY is set at compile time. For a load or store at base + i * stride in
+ * a loop, a wave submits, once per loop entry and before the loop runs:
+ *
+ * 1. a summary: an address message with AFFINE_SUMMARY_COLUMN_FLAG set in its DWARF column, where
+ *    each active lane's data item holds that lane's trip count (high 32 bits) and the stride in
+ *    bytes (low 32 bits, signed);
+ * 2. an ordinary address message with the addresses of the first iteration.
+ *
+ * Handlers stash the summary per wave and, when the matching address message arrives, process
+ * iterations 1 .. trip count - 1 as if the wave had submitted them. The flag value must match
+ * AffineSummaryColumnFlag in src/instrumentation/AMDGCNSubmitAddressMessages.cpp. */
+
+const uint32_t AFFINE_SUMMARY_COLUMN_FLAG = 0x80000000u;
+
+inline bool isAffineSummary(uint32_t dwarf_column)
+{
+    return (dwarf_column & AFFINE_SUMMARY_COLUMN_FLAG) != 0;
+}
+
+// A summary waiting for its first-iteration address message
+typedef struct {
+    uint64_t dwarf_fname_hash_;
+    uint32_t dwarf_line_;
+    uint32_t dwarf_column_;      // with AFFINE_SUMMARY_COLUMN_FLAG cleared
+    std::vector<uint64_t> items_; // one packed trip count/stride per active lane
+}affineSummary_t;
+
+inline uint32_t affineTripCount(uint64_t item)
+{
+    return static_cast<uint32_t>(item >> 32);
+}
+
+inline int32_t affineStride(uint64_t item)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(item));
+}
+
+// Returns true if the address message with this source location and lane count is the first
+// iteration of summary
+inline bool affineSummaryMatches(const affineSummary_t& summary, uint64_t dwarf_fname_hash, uint32_t dwarf_line,
+                                 uint32_t dwarf_column, size_t lanes)
+{
+    return summary.dwarf_fname_hash_ == dwarf_fname_hash && summary.dwarf_line_ == dwarf_line &&
+           summary.dwarf_column_ == dwarf_column && summary.items_.size() == lanes;
+}
+
+// Number of iterations of the longest running lane
+inline uint32_t affineIterations(const affineSummary_t& summary)
+{
+    uint32_t iterations = 0;
+    for (auto item : summary.items_)
+        if (affineTripCount(item) > iterations)
+            iterations = affineTripCount(item);
+    return iterations;
+}
+
+/* Computes the addresses of iteration (>= 1) from the first-iteration addresses in base. Lanes
+ * whose trip count is exhausted drop out, so addresses and lanes (indices into base, i.e. into the
+ * active lanes of the first iteration) only hold the lanes still running. */
+inline void expandAffineIteration(const affineSummary_t& summary, const std::vector<uint64_t>& base,
+                                  uint32_t iteration, std::vector<uint64_t>& addresses, std::vector<size_t>& lanes)
+{
+    addresses.clear();
+    lanes.clear();
+    for (size_t i = 0; i < base.size() && i < summary.items_.size(); i++)
+    {
+        uint64_t item = summary.items_[i];
+        if (iteration >= affineTripCount(item))
+            continue;
+        addresses.push_back(base[i] + static_cast<uint64_t>(static_cast<int64_t>(affineStride(item)) * iteration));
+        lanes.push_back(i);
+    }
+}
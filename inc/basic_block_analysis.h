@@ -23,7 +23,11 @@ THE SOFTWARE.
 #pragma once
 #include "dh_comms.h"
 #include "message_handlers.h"
+#include "inc/json_helpers.h"
 #include "inc/kdb_message_handler_base.h"
+#include "inc/quantile_sketch.h"
+#include "inc/timing_region.h"
+#include "inc/wave_state_table.h"
 #include <set>
 #include <atomic>
 
@@ -34,13 +38,6 @@ typedef struct {
     uint32_t dwarf_line_;
 }blockInfo_t;
 
-typedef struct {
-    uint32_t block_x_;
-    uint32_t block_y_;
-    uint32_t block_z_;
-    uint8_t wave_id_;
-}waveIdentifier_t;
-
 typedef struct {
     uint16_t x;
     uint16_t y;
@@ -56,64 +53,15 @@ struct wave_cmp
     }
 };
 
-template <typename T>
-void renderJSON(std::map<std::string, T>& fields, std::iostream& out, bool omitFinalComma)
-{
-    if constexpr (std::is_same_v<T, std::string>) {
-        auto it = fields.begin();
-        while (it != fields.end())
-        {
-            out << "\"" << it->first << "\": \"" << it->second << "\"";
-            it++;
-            if (it != fields.end() || !omitFinalComma)
-                out << ",";
-        }
-    }
-    else
-    {
-        auto it = fields.begin();
-        while (it != fields.end())
-        {
-            out << "\"" << it->first << "\": " << it->second;
-            it++;
-            if (it != fields.end() || !omitFinalComma)
-                out << ",";
-        }
-    }
-}
-
-template <typename T>
-void renderJSON(std::vector<std::pair<std::string, T>>& fields, std::iostream& out, bool omitFinalComma, bool valueAsString)
-{
-    if (valueAsString) {
-        auto it = fields.begin();
-        while (it != fields.end())
-        {
-            out << "\"" << it->first << "\": \"" << it->second << "\"";
-            it++;
-            if (it != fields.end() || !omitFinalComma)
-                out << ",";
-        }
-    }
-    else
-    {
-        auto it = fields.begin();
-        while (it != fields.end())
-        {
-            out << "\"" << it->first << "\": " << it->second;
-            it++;
-            if (it != fields.end() || !omitFinalComma)
-                out << ",";
-        }
-    }
-}
-
 typedef struct {
-    kernelDB::basicBlock *current_block_;
+    uint32_t current_block_;    // Index into the kernel's basic blocks
     uint64_t start_time_;
     uint64_t count_;
 }wave_state_t;
 
+#define BLOCK_HAS_INSTRUCTIONS 0x1
+#define BLOCK_ENDS_PROGRAM 0x2
+
 
 class basic_block_analysis : public kdb_message_handler_base
 {
@@ -129,6 +77,8 @@ public:
     void printComputeResources(std::ostream& out, const std::string& format);
     void renderComputeResources(std::ostream& out, const std::string& format);
 private:
+    void loadBlocks();
+    void reportRegions(bool bFormatCsv);
     uint64_t first_start_;
     uint64_t last_stop_;
     uint64_t total_time_;
@@ -139,10 +89,15 @@ private:
     uint64_t dispatch_id_;
     kernelDB::basicBlock *current_block_;
     uint64_t start_time_;
-    std::map<waveIdentifier_t,wave_state_t, wave_cmp<waveIdentifier_t>> wave_states_;
-    std::map<kernelDB::basicBlock *, blockInfo_t> block_info_;
-    std::map<kernelDB::basicBlock *, uint64_t> block_timings_;
-    std::set<kernelDB::basicBlock *> blocks_seen_;
+    waveStateTable<wave_state_t> wave_states_;
+    // Per basic block state, indexed by the block's index in the kernel (see loadBlocks)
+    bool blocks_loaded_;
+    std::vector<kernelDB::basicBlock *> blocks_;
+    std::vector<uint8_t> block_flags_;
+    std::vector<blockInfo_t> block_info_;
+    std::vector<quantileSketch> block_durations_;
+    // Kernel and loop regions, for kernels built with INSTRUMENTATION_TIMING_REGIONS
+    timingRegionTable regions_;
     // key is xcc,                se               key is cu                                    wave                  
     std::map<uint16_t, std::map<uint16_t, std::map<uint16_t, std::map<workgroup_id_t, std::set<uint16_t>, wave_cmp<workgroup_id_t>>>>> compute_resources_;
     std::string location_;
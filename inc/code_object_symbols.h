@@ -0,0 +1,45 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+/* The instrumentation plugins describe a clone to the runtime with constant globals named
+ * <clone symbol> <suffix> (see site_manifest.h and device_heatmap.h). forEachCloneSymbol calls visit
+ * with the clone name and the bytes of every defined object symbol of the code object image (a 64-bit
+ * ELF file) whose name ends in suffix, and returns the number of such symbols. */
+typedef std::function<void(const std::string& clone, const uint8_t *data, size_t size)> cloneSymbolVisitor_t;
+
+size_t forEachCloneSymbol(const void *image, size_t length, const char *suffix, const cloneSymbolVisitor_t& visit);
+
+// The plugins write these globals little endian, whatever the alignment of the image
+template<typename T>
+T readLE(const uint8_t *p)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); i++)
+        value |= static_cast<T>(p[i]) << (8 * i);
+    return value;
+}
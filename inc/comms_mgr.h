@@ -42,6 +42,9 @@ THE SOFTWARE.
 #include "memory_heatmap.h"
 #include "kernelDB.h"
 #include "inc/kdb_message_handler_base.h"
+#include "inc/message_loss.h"
+#include "inc/message_replay.h"
+#include "inc/telemetry.h"
 
 
 typedef struct pool_specs
@@ -56,7 +59,10 @@ class comms_mgr
 public: 
     comms_mgr(HsaApiTable *pTable);
     ~comms_mgr();
-    dh_comms::dh_comms * checkoutCommsObject(hsa_agent_t agent, std::string& strKernelName, uint64_t dispatch_id, kernelDB::kernelDB *kdb);
+    dh_comms::dh_comms * checkoutCommsObject(hsa_agent_t agent, kernel_name_id_t kernel, uint64_t dispatch_id, kernelDB::kernelDB *kdb, std::shared_ptr<const siteManifest> sites = nullptr, const deviceHeatmapConfig_t& heatmap = deviceHeatmapConfig_t{});
+    // What the instrumented clone gets as its extra pointer argument: the device heatmap if it was built
+    // with INSTRUMENTATION_HEATMAP, the dh_comms descriptor otherwise
+    void * getInstrumentationBuffer(dh_comms::dh_comms *object);
     bool checkinCommsObject(hsa_agent_t agent, dh_comms::dh_comms *object);
     bool addAgent(hsa_agent_t agent);
     void setConfig(const std::map<std::string, std::string>& config);
@@ -68,8 +74,22 @@ private:
     std::map<hsa_agent_t, dh_comms::dh_comms_mem_mgr *, hsa_cmp<hsa_agent_t>> mem_mgrs_;
     std::map<hsa_agent_t, std::vector<dh_comms::dh_comms *>, hsa_cmp<hsa_agent_t>> comms_pool_;
     std::map<hsa_agent_t, std::vector<dh_comms::dh_comms *>, hsa_cmp<hsa_agent_t>> pending_comms_;
+    struct device_heatmap_t {
+        void *histogram_;
+        size_t length_;
+        std::vector<dh_comms::memory_heatmap_t *> handlers_;
+    };
+    std::map<dh_comms::dh_comms *, device_heatmap_t> device_heatmaps_;
+    // The delivered messages of each dispatch with kdb handlers, handed to them before they report
+    struct message_loss_t {
+        std::shared_ptr<messageLoss> loss_;
+        std::vector<kdb_message_handler_base *> handlers_;
+    };
+    std::map<dh_comms::dh_comms *, message_loss_t> message_losses_;
     HsaApiTable *pTable_;
     handlerManager handler_mgr_;
+    // Set when LOGDUR_RECORD_MESSAGES names a file to record messages to (see message_replay.h)
+    std::shared_ptr<messageRecordWriter> recorder_;
 };
 
 
@@ -88,3 +108,36 @@ private:
     std::string strKernelName_;
     uint64_t dispatch_id_;
 };
+
+/* Times the handler it wraps into the TELEMETRY_HANDLER_NS histogram of the telemetry segment. comms_mgr wraps
+ * every handler of a dispatch this way when telemetry is on; the one at the front of the chain also counts the
+ * messages. */
+/* Counts the messages of a dispatch that reach the handlers, per site of the clone's site manifest, for the
+ * lossy mode accounting in message_loss.h. comms_mgr puts it at the front of the chain when the dispatch has
+ * kdb handlers. */
+class loss_counter_handler_t : public dh_comms::message_handler_base
+{
+public:
+    explicit loss_counter_handler_t(std::shared_ptr<messageLoss> loss);
+    virtual ~loss_counter_handler_t() = default;
+    virtual bool handle(const dh_comms::message_t &message) override;
+    virtual void report() override {}
+    virtual void clear() override {}
+
+private:
+    std::shared_ptr<messageLoss> loss_;
+};
+
+class telemetry_handler_t : public dh_comms::message_handler_base
+{
+public:
+    telemetry_handler_t(std::unique_ptr<dh_comms::message_handler_base> handler, bool count_messages);
+    virtual ~telemetry_handler_t() = default;
+    virtual bool handle(const dh_comms::message_t &message) override;
+    virtual void report() override;
+    virtual void clear() override;
+
+private:
+    std::unique_ptr<dh_comms::message_handler_base> handler_;
+    bool count_messages_;
+};
@@ -0,0 +1,96 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+/* Host side of the device heatmaps emitted by the address message plugin when INSTRUMENTATION_HEATMAP
+ * is set at compile time. Such a clone sends no address messages: the pointer argument that normally
+ * points to the dh_comms descriptor points to a histogram in device memory instead, and every active
+ * lane of every load and store adds one to the count of its page there. The histogram is an open
+ * addressing hash table,
+ *
+ *   header  deviceHeatmapHeader_t
+ *   slots   slot count x deviceHeatmapSlot_t, all zero while empty
+ *
+ * A lane hashes the index of its page to a slot and probes at most DEVICE_HEATMAP_MAX_PROBES slots
+ * from there, counting the access in dropped_ if none of them is empty or holds its page. The clone is
+ * marked with a constant global named <clone symbol> DEVICE_HEATMAP_SUFFIX, laid out as
+ *
+ *   "OPHM", u16 version, u16 reserved, u32 page shift, u32 slot count
+ *
+ * all little endian. The layouts must match src/instrumentation/AMDGCNSubmitAddressMessages.cpp. */
+
+#define DEVICE_HEATMAP_SUFFIX ".heatmap"
+#define DEVICE_HEATMAP_MAGIC "OPHM"
+const uint16_t DEVICE_HEATMAP_VERSION = 1;
+const uint32_t DEVICE_HEATMAP_MAX_PROBES = 16;
+// A lane starts probing at slot (page index + 1) * DEVICE_HEATMAP_HASH_MULTIPLIER >> (64 - log2(slot count))
+const uint64_t DEVICE_HEATMAP_HASH_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+
+typedef struct {
+    uint32_t page_shift_;  // log2 of the page size the device counts
+    uint32_t slot_count_;  // A power of two
+    uint64_t dropped_;     // Accesses that found no slot
+    uint64_t reserved_[2];
+} deviceHeatmapHeader_t;
+
+typedef struct {
+    uint64_t page_;        // Page index + 1, 0 for an empty slot
+    uint64_t count_;
+} deviceHeatmapSlot_t;
+
+static_assert(sizeof(deviceHeatmapHeader_t) == 32, "deviceHeatmapHeader_t must match the plugin");
+static_assert(sizeof(deviceHeatmapSlot_t) == 16, "deviceHeatmapSlot_t must match the plugin");
+
+// What a clone's marker says; a zero page_shift_ means the clone sends address messages as usual
+typedef struct {
+    uint32_t page_shift_;
+    uint32_t slot_count_;
+} deviceHeatmapConfig_t;
+
+typedef std::map<std::string, deviceHeatmapConfig_t> deviceHeatmapMap_t;
+
+// Returns false if data isn't a well-formed marker
+bool parseDeviceHeatmapMarker(const void *data, size_t length, deviceHeatmapConfig_t& config);
+
+/* Adds the device heatmap markers found in the symbol tables of the code object image to heatmaps, keyed
+ * by the name of the clone they mark. Returns the number of markers found. */
+size_t findDeviceHeatmaps(const void *image, size_t length, deviceHeatmapMap_t& heatmaps);
+
+inline size_t deviceHeatmapBytes(const deviceHeatmapConfig_t& config)
+{
+    return sizeof(deviceHeatmapHeader_t) + config.slot_count_ * sizeof(deviceHeatmapSlot_t);
+}
+
+// Writes an empty histogram of deviceHeatmapBytes(config) bytes, to be copied to the device before the dispatch
+void deviceHeatmapInit(const deviceHeatmapConfig_t& config, void *histogram);
+
+/* Adds the counts of a histogram copied back from the device to page_counts, which maps the lowest address
+ * of each page_size page to its number of accesses, as memory_heatmap_t does. Device pages smaller than
+ * page_size are folded into the page that holds them; the counts of larger device pages go to the page_size
+ * page at their start. Returns false, leaving page_counts alone, if the histogram is malformed. */
+bool deviceHeatmapMerge(const void *histogram, size_t length, uint64_t page_size,
+                        std::map<uint64_t, size_t>& page_counts, uint64_t& dropped);
@@ -0,0 +1,70 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <utility>
+
+/* Per (agent, kernel_object) cache of what the interceptor decided to do with a dispatch. The first
+ * dispatch of a kernel object calls the resolver, which does the name lookups and fills in the
+ * decision; later dispatches get the cached decision back. The cache belongs to a generation of the
+ * loaded code objects: when resolve() is called with a newer generation, everything cached is
+ * dropped, since new code objects can change what a kernel object resolves to.
+ *
+ * Not thread safe; the interceptor calls it under its mutex_. Pointers returned by resolve() stay
+ * valid until the next clear() or generation change. */
+template<typename Decision>
+class dispatchDecisionCache {
+public:
+    dispatchDecisionCache() : generation_(0) {}
+
+    /* Returns the cached decision for (agent, kernel_object) or, on a miss, calls
+     * resolver(Decision&) on a value-initialized decision and caches it if the resolver returns
+     * true. Returns nullptr if the resolver declines, and nothing is cached in that case. */
+    template<typename Resolver>
+    Decision *resolve(uint64_t agent, uint64_t kernel_object, uint64_t generation, Resolver&& resolver)
+    {
+        if (generation != generation_)
+        {
+            decisions_.clear();
+            generation_ = generation;
+        }
+        auto key = std::make_pair(agent, kernel_object);
+        auto it = decisions_.find(key);
+        if (it != decisions_.end())
+            return &it->second;
+        Decision decision = {};
+        if (!resolver(decision))
+            return nullptr;
+        return &(decisions_[key] = decision);
+    }
+
+    // For changes the generation doesn't cover, such as a kernel registered with the interceptor
+    void clear() { decisions_.clear(); }
+    size_t size() const { return decisions_.size(); }
+
+private:
+    std::map<std::pair<uint64_t, uint64_t>, Decision> decisions_;
+    uint64_t generation_;
+};
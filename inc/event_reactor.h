@@ -0,0 +1,88 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/* One thread that sleeps in epoll_wait until something it owns becomes ready, and runs that thing's handler:
+ *   - watched fds (e.g. an inotify fd): the handler is called when the fd is readable and must drain it
+ *   - events: eventfds any thread can raise with notify(); the handler runs once per wakeup, however many
+ *     notifications were coalesced into it
+ *   - timers: periodic timerfds; the handler runs once per expiry batch
+ * With nothing ready the thread doesn't wake up at all, so an idle process costs nothing.
+ *
+ * Handlers run on the reactor thread, one at a time, and may register or remove other sources. They must not
+ * call stop(). Sources can be added before or after start(); fds handed to watchFd() stay owned by the caller,
+ * event and timer fds are owned by the reactor and closed by its destructor. */
+class eventReactor {
+public:
+    typedef std::function<void()> handler_t;
+
+    eventReactor();
+    ~eventReactor();
+
+    bool start();
+    // Wakes the thread and joins it; safe to call more than once and from any thread except the reactor's
+    void stop();
+    bool running() const { return thread_.joinable(); }
+
+    bool watchFd(int fd, handler_t handler);
+    void unwatchFd(int fd);
+    // Returns the eventfd to pass to notify(), or -1 on failure
+    int addEvent(handler_t handler);
+    // Returns the timerfd, or -1 on failure. The first expiry is interval_ms after the call.
+    int addTimer(uint64_t interval_ms, handler_t handler);
+
+    // Async-signal and thread safe: a single write to the eventfd
+    static void notify(int event_fd);
+
+    // Times epoll_wait returned, for measuring idle behavior
+    uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+private:
+    typedef enum {
+        SOURCE_FD,
+        SOURCE_EVENT,
+        SOURCE_TIMER,
+        SOURCE_STOP
+    } source_kind_t;
+
+    typedef struct {
+        source_kind_t kind_;
+        handler_t handler_;
+    } source_t;
+
+    bool addSource(int fd, source_kind_t kind, handler_t handler);
+    void run();
+
+    int epoll_fd_;
+    int stop_fd_;
+    std::mutex mutex_;
+    std::map<int, source_t> sources_;
+    std::thread thread_;
+    std::atomic<uint64_t> wakeups_;
+};
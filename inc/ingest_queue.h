@@ -0,0 +1,84 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define INGEST_DEBOUNCE_MS 50
+#define INGEST_MAX_THREADS 4
+
+/* Hands files that appear in a watched directory to an ingest callback on a small pool of worker threads.
+ *   - debounced: a path is ingested once it has gone debounce_ms without being enqueued again, so a compiler that
+ *     rewrites or renames the same file several times in a row costs one ingest
+ *   - deduplicated by path: enqueueing a path that is already waiting just pushes its deadline back; enqueueing
+ *     one that is being ingested runs it once more afterwards, so the last version of the file is always seen
+ *   - parallel: different paths are ingested concurrently, the same path never is
+ * Workers sleep on a condition variable until the earliest deadline, so an idle queue costs nothing. enqueue()
+ * only takes the queue's own lock and never waits for an ingest to finish. */
+class ingestQueue {
+public:
+    typedef std::function<void(const std::string& path)> ingest_t;
+
+    typedef struct {
+        uint64_t enqueued_;     // enqueue() calls
+        uint64_t coalesced_;    // ...that merged into a path already waiting or being ingested
+        uint64_t ingested_;     // Callback invocations that have returned
+    } ingest_stats_t;
+
+    // threads == 0 picks half the hardware threads, between 1 and INGEST_MAX_THREADS
+    ingestQueue(ingest_t ingest, uint64_t debounce_ms = INGEST_DEBOUNCE_MS, size_t threads = 0);
+    ~ingestQueue();
+
+    void enqueue(const std::string& path);
+    // Waits until nothing is waiting or being ingested; false on timeout
+    bool drain(uint64_t timeout_ms);
+    // Drops waiting paths, lets running ingests finish and joins the workers. Safe to call more than once.
+    void stop();
+    ingest_stats_t stats();
+
+private:
+    typedef struct {
+        std::chrono::steady_clock::time_point due_;
+        bool running_;
+        bool again_;    // Enqueued while running
+    } entry_t;
+
+    void worker();
+
+    ingest_t ingest_;
+    std::chrono::milliseconds debounce_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::map<std::string, entry_t> entries_;
+    std::vector<std::thread> workers_;
+    bool stopping_;
+    ingest_stats_t stats_;
+};
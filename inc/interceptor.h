@@ -43,11 +43,13 @@ THE SOFTWARE.
 #include "comms_mgr.h"
 #include "kernelDB.h"
 #include "library_filter.h"
+#include "kernarg_repack.h"
+#include "event_reactor.h"
+#include "ingest_queue.h"
+#include "dispatch_decision_cache.h"
+#include "telemetry.h"
 
 class hsaInterceptor;
-void signal_runner();
-void cache_watcher();
-void comms_runner(comms_mgr& mgr);
 
 #define PUBLIC_API __attribute__((visibility("default")))
 #define CONSTRUCTOR_API __attribute__((constructor))
@@ -78,7 +80,7 @@ static const int CHECKSUM_PAGE_SIZE = 1 << 20;
 
 typedef struct kernel_info{
     hsa_signal_t signal_;
-    std::string name_;
+    kernel_name_id_t name_id_;
     hsa_agent_t agent_;
     dh_comms::dh_comms *comms_obj_;
     timeHelper th_;
@@ -86,11 +88,24 @@ typedef struct kernel_info{
 
 typedef struct ld_kernel_descriptor {
     std::string name_;
+    kernel_name_id_t name_id_;          // name_, interned
     hsa_executable_symbol_t symbol_;
     hsa_agent_t agent_;
     uint32_t kernarg_size_;
 }ld_kernel_descriptor_t;
 
+// Per (agent, kernel_object) result of resolving what to do with a dispatch, cached so that
+// repeat dispatches of the same kernel skip the name lookups done on the first one.
+typedef struct dispatch_decision {
+    ld_kernel_descriptor_t *kernel_;    // Points into kernel_objects_, entries there are never removed
+    uint64_t alt_kernel_object_;        // 0 if there is no alternative
+    bool has_args_;                     // args_ is valid
+    arg_descriptor_t args_;
+    kernargRepackPlan repack_;          // Built from args_ when has_args_
+    kernelDB::kernelDB *kdb_;
+    bool kdb_scanned_;                  // kdb_ has already been scanned on demand for this kernel
+}dispatch_decision_t;
+
 class hsaInterceptor {
 private:
     hsaInterceptor(HsaApiTable* table, uint64_t runtime_version, uint64_t failed_tool_count, const char* const* failed_tool_names);
@@ -101,15 +116,20 @@ private:
     void addQueue(hsa_queue_t *queue, hsa_agent_t agent);
     void removeQueue(hsa_queue_t *queue);
     void addKernel(uint64_t kernelObject, std::string& name, hsa_executable_symbol_t symbol, hsa_agent_t agent, uint32_t kernarg_size);
-    bool getPendingSignals(std::vector<hsa_signal_t>& outSigs);
     void signalCompleted(const hsa_signal_t sig);
-    bool signalWait(hsa_signal_t sig, uint64_t timeout);
+    static bool signalReady(hsa_signal_value_t value, void *arg);
+    void queueCompletion(hsa_signal_t sig);
+    void processCompletions();
+    void watchKernelCache();
+    void onCacheEvents();
     static void OnSubmitPackets(const void* in_packets, uint64_t count, uint64_t user_que_idx, void* data,
                          hsa_amd_queue_intercept_packet_writer writer);
     static hsa_status_t hsa_queue_create(hsa_agent_t agent, uint32_t size, hsa_queue_type32_t type, void(*callback)(hsa_status_t status, hsa_queue_t *source, void *data), void *data, uint32_t private_segment_size, uint32_t group_segment_size, hsa_queue_t **queue);
     static hsa_status_t hsa_queue_destroy(hsa_queue_t *queue);
     static hsa_status_t hsa_executable_symbol_get_info(hsa_executable_symbol_t symbol, hsa_executable_symbol_info_t attribute, void *data);
-    void fixupKernArgs(void *dst, void *src, void *comms, arg_descriptor_t desc);
+    void fixupKernArgs(void *dst, void *src, void *comms, const kernargRepackPlan& plan);
+    dispatch_decision_t *resolveDispatch(uint64_t kernel_object, hsa_agent_t agent);
+    bool resolveDecision(uint64_t kernel_object, hsa_agent_t agent, dispatch_decision_t& decision);
     hsa_kernel_dispatch_packet_t *fixupPacket(const hsa_kernel_dispatch_packet_t *packet, hsa_queue_t *queue, uint64_t dispatch_id);
     virtual void doPackets(hsa_queue_t *queue, const packet_t *packet, uint64_t count, hsa_amd_queue_intercept_packet_writer writer);
     bool growBufferPool(hsa_agent_t agent, size_t count);
@@ -136,11 +156,8 @@ public:
         const packet_word_t* header = reinterpret_cast<const packet_word_t*>(packet);
         return static_cast<hsa_packet_type_t>((*header >> HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) & header_scacquire_scope_mask);
     }
-    friend void signal_runner();
-    friend void cache_watcher();
-    friend void comms_runner(comms_mgr& mgr);
-
     bool hasPendingSignals();
+    bool hasUnsignaledDispatches() { return unsignaled_dispatches_.load() != 0; }
     void shutdown();
 protected:
     bool shuttingdown();
@@ -148,6 +165,8 @@ protected:
     bool addCodeObject(const std::string& name);
 private:
     HsaApiTable *apiTable_;
+    // Created when LOGDUR_TELEMETRY is set; declared early so it outlives everything that updates it
+    telemetrySegment telemetry_;
     std::map<hsa_queue_t *, std::pair<unsigned int, uint64_t>> queue_ids_;
     std::map<std::string, hsa_agent_t> agents_;
     std::map<hsa_queue_t *, hsa_agent_t> queues_;
@@ -155,13 +174,29 @@ private:
     std::map<hsa_signal_t, kernel_info_t, hsa_cmp<hsa_signal_t>> pending_signals_;
     std::vector<hsa_signal_t> sig_pool_;
     std::map<uint64_t, ld_kernel_descriptor_t> kernel_objects_;
+    dispatchDecisionCache<dispatch_decision_t> dispatch_decisions_;
     std::map<hsa_signal_t, hsa_signal_t, hsa_cmp<hsa_signal_t>> app_sigs_;
     std::vector<dh_comms::dh_comms *> buffers_;
     std::map<std::string, std::string> config_;
     std::map<hsa_signal_t, void *, hsa_cmp<hsa_signal_t>> kernargs_;
     std::atomic<bool> shutting_down_;
-    std::thread signal_runner_;
-    std::thread cache_watcher_;
+    /* Completion, kernel cache watching and log flushing all happen on the reactor thread. The runtime's async
+     * signal handler thread only queues completed pool signals in completed_signals_ and raises
+     * completion_event_ when the queue goes from empty to non-empty. */
+    eventReactor reactor_;
+    int completion_event_;
+    std::mutex completed_mutex_;
+    std::vector<hsa_signal_t> completed_signals_;
+    uint64_t completed_since_;      // telemetryNow() when completed_signals_ last became non-empty
+    // Dispatches whose async handler is registered but hasn't queued their completion yet
+    std::atomic<uint64_t> unsignaled_dispatches_;
+    int cache_fd_;
+    std::map<int, std::string> cache_watches_;
+    /* Code objects that land in the kernel cache are loaded by co_ingest_'s workers, never on the reactor or a
+     * dispatching thread, and without mutex_. Each published file bumps co_generation_; dispatch_decisions_
+     * drops its cached decisions when resolveDispatch passes it a newer generation. */
+    std::unique_ptr<ingestQueue> co_ingest_;
+    std::atomic<uint64_t> co_generation_;
     std::mutex mutex_;
     logDuration log_;
     coCache kernel_cache_;
@@ -172,7 +207,6 @@ private:
     std::map<hsa_agent_t, std::vector<void *>, hsa_cmp<hsa_agent_t>> device_buffer_pool_;
     std::map<hsa_agent_t, std::vector<dh_comms::dh_comms_descriptor>, hsa_cmp<hsa_agent_t>> descriptor_pool_;
     comms_mgr comms_mgr_;
-    std::thread comms_runner_;
     std::vector<dh_comms::message_handler_base *> mh_pool_;
     std::atomic<uint64_t> dispatch_count_;
     dispatchController dispatcher_;
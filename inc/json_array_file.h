@@ -0,0 +1,77 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/* A JSON array written one record at a time, for handlers that report each dispatch as an element of one
+ * array in their output file (MemoryAnalysis with LOGDUR_LOG_FORMAT=json). Every record is followed by the
+ * closing bracket, which the next record overwrites, all in one write. The file is therefore a complete JSON
+ * array after every dispatch, and nothing is left to do at exit, or after a crash.
+ *
+ * Records are added at the file's real end under an exclusive flock(), so processes that share the output
+ * path (ranks started by one launcher, forked workers) add to the same array instead of overwriting each
+ * other, and an array already in the file is extended rather than truncated. A "%p" in the path is replaced
+ * by the process id, for one file per process. A non-empty file that doesn't end in an array's closing
+ * bracket is left alone and nothing is written to it.
+ *
+ * Next to the file, <path>.idx lists where each record is, one line per record after a '#' header line:
+ *
+ *   offset length dispatch_id kernel
+ *
+ * so a reader can seek straight to a dispatch without parsing the ones before it. */
+
+#define JSON_ARRAY_INDEX_SUFFIX ".idx"
+#define JSON_ARRAY_INDEX_HEADER "# omniprobe json array index 1: offset length dispatch_id kernel\n"
+
+class jsonArrayFile {
+public:
+    // The writer of path, shared by all handlers of the process that write to it; nullptr, after a
+    // message, if the file can't be opened
+    static jsonArrayFile *open(const std::string& path);
+    // path with each "%p" replaced by the process id
+    static std::string processPath(const std::string& path);
+
+    // Appends record, one JSON value; false if it couldn't be written
+    bool append(std::string_view record, const std::string& kernel, uint64_t dispatch_id);
+    uint64_t records();
+
+    ~jsonArrayFile();
+
+private:
+    jsonArrayFile(const std::string& path, int fd, int index_fd);
+    bool writeRecord(std::string_view record, uint64_t& offset);
+    jsonArrayFile(const jsonArrayFile&) = delete;
+    jsonArrayFile& operator=(const jsonArrayFile&) = delete;
+
+    std::mutex mutex_;
+    std::string path_;
+    int fd_;
+    int index_fd_;
+    pid_t pid_;             // the process that opened fd_; a forked child opens the file again
+    uint64_t records_;      // written by this process
+    bool refused_;          // the file isn't an array; said so once
+};
@@ -0,0 +1,141 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/* A small JSON reader for the handlers' own output, used by the host tools that post-process it
+ * (omniprobe-merge, omniprobe-analyze). Values are read into a jsonValue tree, one top-level record at a
+ * time, straight from a mapped file.
+ *
+ * The reader is strict JSON with one exception: MemoryAnalysis wrote source lines into "code_context"
+ * without escaping them, so a quote inside a string only ends it if what follows could continue the
+ * document (a ',', ':', '}' or ']', and after a ',' the start of another value). Valid JSON reads the
+ * same either way. */
+
+class jsonValue {
+public:
+    typedef enum {
+        JSON_NULL,
+        JSON_BOOL,
+        JSON_NUMBER,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT
+    } type_t;
+    typedef std::pair<std::string, jsonValue> member_t;
+
+    jsonValue() : type_(JSON_NULL), bool_(false), uint_(0), double_(0), integral_(false) {}
+
+    type_t type() const { return type_; }
+    bool isNull() const { return type_ == JSON_NULL; }
+    bool isNumber() const { return type_ == JSON_NUMBER; }
+    bool isString() const { return type_ == JSON_STRING; }
+    bool isArray() const { return type_ == JSON_ARRAY; }
+    bool isObject() const { return type_ == JSON_OBJECT; }
+
+    // The member named key of an object, or nullptr
+    const jsonValue *find(std::string_view key) const;
+    // Typed accessors return dflt when the value has another type
+    bool asBool(bool dflt = false) const { return type_ == JSON_BOOL ? bool_ : dflt; }
+    // Non-negative integers are exact up to UINT64_MAX; other numbers are rounded
+    uint64_t asUint(uint64_t dflt = 0) const;
+    double asDouble(double dflt = 0) const;
+    const std::string& asString() const { return string_; }
+    // Members of a find() result, with a default for a missing member
+    uint64_t uintAt(std::string_view key, uint64_t dflt = 0) const;
+    double doubleAt(std::string_view key, double dflt = 0) const;
+    std::string stringAt(std::string_view key) const;
+
+    const std::vector<jsonValue>& items() const { return items_; }
+    const std::vector<member_t>& members() const { return members_; }
+
+private:
+    friend class jsonReader;
+
+    type_t type_;
+    bool bool_;
+    uint64_t uint_;
+    double double_;
+    bool integral_;
+    std::string string_;
+    std::vector<jsonValue> items_;
+    std::vector<member_t> members_;
+};
+
+// Reads values from [begin, end); the text need not be NUL terminated
+class jsonReader {
+public:
+    jsonReader(const char *begin, const char *end) : pos_(begin), end_(end), error_(nullptr) {}
+
+    // Reads the value at the current position, after any whitespace, reusing the storage of whatever value
+    // held before. On failure the position is where the error was found and error() says what it was.
+    bool read(jsonValue& value);
+    void skipWhitespace();
+    const char *position() const { return pos_; }
+    void seek(const char *pos) { pos_ = pos; }
+    bool atEnd() const { return pos_ == end_; }
+    const char *error() const { return error_; }
+
+private:
+    bool fail(const char *error);
+    bool readValue(jsonValue& value, int depth);
+    bool readString(std::string& out);
+    bool readNumber(jsonValue& value);
+    bool readLiteral(const char *literal, size_t length);
+    bool stringEnds(const char *quote) const;
+
+    const char *pos_;
+    const char *end_;
+    const char *error_;
+};
+
+// Writes text as a quoted, escaped JSON string
+void writeJsonString(std::ostream& out, std::string_view text);
+
+// Writes an indented JSON document member by member, for the host tools' reports
+class jsonWriter {
+public:
+    explicit jsonWriter(std::ostream& out) : out_(out), depth_(0), first_(true) {}
+
+    void open(char bracket);
+    void close(char bracket);
+    // Starts the next member of an object, or with no name the next item of an array
+    void next(const char *name = nullptr);
+    void field(const char *name, uint64_t value);
+    void field(const char *name, double value);
+    void field(const char *name, const std::string& value);
+    void field(const char *name, bool value);
+
+private:
+    void indent();
+
+    std::ostream& out_;
+    int depth_;
+    bool first_;
+};
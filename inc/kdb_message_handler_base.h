@@ -23,25 +23,45 @@ THE SOFTWARE.
 
 #include "message_handlers.h"
 #include "kernelDB.h"
+#include "inc/message_loss.h"
+#include "inc/site_manifest.h"
+#include <memory>
 #include <string>
 
 /// Base class for Omniprobe message handlers that need access to KernelDB.
 ///
 /// After construction, call set_context() before processing begins to provide
 /// the KernelDB instance and kernel name. Handlers use the stored kdb_p_ and
-/// kernel_name_ in their handle(msg) and report() implementations.
+/// kernel_name_ in their handle(msg) and report() implementations. sites_ is
+/// the site manifest of the instrumented clone, if it was built with one.
+/// loss_ is set with set_loss() before report(), by comms_mgr, which counts
+/// the messages delivered to the handlers; when the dispatch dropped messages,
+/// scaled() turns a count summed over delivered messages into an estimate of
+/// the lossless count (see message_loss.h).
 class kdb_message_handler_base : public dh_comms::message_handler_base {
 public:
   kdb_message_handler_base() = default;
   kdb_message_handler_base(const kdb_message_handler_base &) = default;
   virtual ~kdb_message_handler_base() = default;
 
-  void set_context(kernelDB::kernelDB *kdb, const std::string &kernel_name) {
+  void set_context(kernelDB::kernelDB *kdb, const std::string &kernel_name,
+                   std::shared_ptr<const siteManifest> sites = nullptr) {
     kdb_p_ = kdb;
     kernel_name_ = kernel_name;
+    sites_ = std::move(sites);
+  }
+
+  void set_loss(std::shared_ptr<const messageLoss> loss) { loss_ = std::move(loss); }
+
+  /// Whether counts of site are scaled, i.e. its messages were dropped and enough of them delivered
+  bool scales(size_t site) const { return loss_ and loss_->scalable(site); }
+  uint64_t scaled(size_t site, uint64_t count) const {
+    return loss_ ? loss_->scaleCount(site, count) : count;
   }
 
 protected:
   kernelDB::kernelDB *kdb_p_ = nullptr;
   std::string kernel_name_;
+  std::shared_ptr<const siteManifest> sites_;
+  std::shared_ptr<const messageLoss> loss_;
 };
@@ -0,0 +1,72 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A precompiled recipe for turning the kernarg segment of an uninstrumented kernel into the kernarg
+ * segment of its instrumented clone. The clone has one extra void * (the dh_comms descriptor) as its
+ * last explicit argument, so the original explicit args are copied as-is, the dh_comms pointer goes in
+ * the last explicit slot, and the original hidden args (if any) are shifted up by sizeof(void *).
+ * Anything in the destination not covered by a copy or by the dh_comms pointer is zero-filled.
+ *
+ * The plan is built once per kernel from its arg descriptor so each dispatch is just a handful of
+ * memcpy/memset calls over precomputed ranges rather than a memset of the whole segment followed by
+ * copies over it. */
+class kernargRepackPlan {
+public:
+    typedef struct range {
+        uint32_t dst_offset_;
+        uint32_t src_offset_;
+        uint32_t length_;
+    }range_t;
+
+    static const size_t MAX_RANGES = 2;
+
+    kernargRepackPlan() = default;
+    // explicit_args_length and kernarg_length describe the instrumented clone; clone_hidden_args_length
+    // is the length of the hidden args of the uninstrumented kernel (0 for e.g. some Triton kernels)
+    kernargRepackPlan(size_t explicit_args_length, size_t clone_hidden_args_length, size_t kernarg_length);
+
+    void apply(void *dst, const void *src, void *comms) const;
+
+    bool valid() const { return valid_; }
+    size_t kernargLength() const { return kernarg_length_; }
+    size_t commsOffset() const { return comms_offset_; }
+    size_t copyCount() const { return copy_count_; }
+    size_t zeroCount() const { return zero_count_; }
+    const range_t& copy(size_t idx) const { return copies_[idx]; }
+    const range_t& zero(size_t idx) const { return zeros_[idx]; }
+
+private:
+    void addCopy(size_t dst_offset, size_t src_offset, size_t length);
+    void addZero(size_t dst_offset, size_t length);
+
+    bool valid_ = false;
+    size_t kernarg_length_ = 0;
+    size_t comms_offset_ = 0;
+    size_t copy_count_ = 0;
+    size_t zero_count_ = 0;
+    range_t copies_[MAX_RANGES] = {};
+    range_t zeros_[MAX_RANGES] = {};
+};
@@ -0,0 +1,76 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+typedef uint32_t kernel_name_id_t;
+
+// The empty name, and what find() returns for a name that was never interned
+#define KERNEL_NAME_EMPTY 0
+#define KERNEL_NAME_INVALID UINT32_MAX
+
+/* Process-wide table of interned kernel names. Each distinct name gets a dense 32-bit id the first time it is
+ * interned and keeps it for the life of the process, so dispatch and completion bookkeeping can carry and compare
+ * ids instead of copying and comparing strings. The text is only looked up again when something is written out.
+ *   - intern() takes a shared lock for names already in the table and an exclusive one to add a new name
+ *   - name() is lock free and the string_view it returns stays valid until exit
+ * Names are never removed. The table is deliberately leaked so that it outlives every static destructor. */
+class kernelNameTable {
+public:
+    static kernelNameTable& instance();
+
+    kernel_name_id_t intern(std::string_view name);
+    // Never adds name to the table
+    kernel_name_id_t find(std::string_view name) const;
+    // id must have come from intern() or find()
+    std::string_view name(kernel_name_id_t id) const;
+    size_t size() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    // name() reads a fixed array of chunks that are never moved, so growing the table doesn't disturb readers
+    static const uint32_t CHUNK_BITS = 12;
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const uint32_t MAX_CHUNKS = 1024;
+
+    kernelNameTable();
+    kernelNameTable(const kernelNameTable&) = delete;
+    kernelNameTable& operator=(const kernelNameTable&) = delete;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> storage_;   // deque: push_back never moves the strings ids_ and chunks_ point into
+    std::unordered_map<std::string_view, kernel_name_id_t> ids_;
+    std::atomic<std::string_view *> chunks_[MAX_CHUNKS];
+    std::atomic<uint32_t> count_;
+};
+
+// Shorthand for kernelNameTable::instance()
+inline kernelNameTable& kernelNames()
+{
+    return kernelNameTable::instance();
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "inc/kernel_names.h"
+#include "inc/quantile_sketch.h"
+
+/* How logDuration reports completed dispatches (LOGDUR_DURATION_MODE)
+ *   lines     - one CSV line per dispatch, written as the dispatch completes (default)
+ *   aggregate - per-kernel count/sum/min/max/p50/p90/p99, written once at shutdown
+ *   raw       - every dispatch as a fixed size binary record (see logDuration::log), buffered
+ *               and written out periodically
+ * aggregate and raw never write from log(): raw records go out when the owner calls flush(), every
+ * LOGDUR_FLUSH_INTERVAL_MS, and the aggregate summary is written by close() or the destructor. */
+typedef enum {
+    LOGDUR_MODE_LINES,
+    LOGDUR_MODE_AGGREGATE,
+    LOGDUR_MODE_RAW
+} logdur_mode_t;
+
+#define LOGDUR_RAW_MAGIC "OPDURRAW"
+#define LOGDUR_RAW_VERSION 1
+#define LOGDUR_FLUSH_INTERVAL_MS 250
+#define LOGDUR_RAW_UNNAMED UINT32_MAX
+
+class logDuration{
+public:
+    logDuration();
+    logDuration(std::string& location);
+    ~logDuration();
+    // The name behind kernel is only looked up when it's first written out
+    void log(kernel_name_id_t kernel, uint64_t dispatchTime, uint64_t startNs, uint64_t endNs);
+    bool setLocation(const std::string& strLocation);
+    bool setMode(const std::string& strMode);
+    logdur_mode_t getMode() { return mode_; }
+    void logHeaders();
+    // Writes out buffered raw records
+    void flush();
+    /* Writes out what is otherwise left to the destructor: the last raw records, or the aggregate summary.
+     * For an owner that may never be destroyed; raw records and durations logged afterwards aren't written. */
+    void close();
+private:
+    concurrentQuantileSketch *getStats(kernel_name_id_t kernel);
+    concurrentQuantileSketch *addStats(kernel_name_id_t kernel);
+    void flushRaw();
+    void writeSummary();
+    std::ostream *log_file_;
+    std::string location_;
+    logdur_mode_t mode_;
+    // Serializes flushRaw, writeSummary and close; closed_ is guarded by it
+    std::mutex file_mutex_;
+    bool closed_;
+    /* aggregate mode: per-kernel statistics, indexed by kernel name id. As in kernelNameTable, the ids are
+     * split into fixed chunks that are never moved, so record() finds a kernel seen before with two acquire
+     * loads and no lock. stats_mutex_ is only taken to add a kernel and to write the summary. */
+    static const uint32_t STATS_CHUNK_BITS = 12;
+    static const uint32_t STATS_CHUNK_SIZE = 1u << STATS_CHUNK_BITS;
+    static const uint32_t STATS_MAX_CHUNKS = 1024;
+    std::mutex stats_mutex_;
+    std::atomic<std::atomic<concurrentQuantileSketch *> *> stats_[STATS_MAX_CHUNKS];
+    // raw mode: records are appended to raw_buffer_ and swapped out by flush(). raw_ids_ maps a kernel name id
+    // to the id used in the log (ids there stay dense and in first-seen order), or LOGDUR_RAW_UNNAMED.
+    std::mutex raw_mutex_;
+    std::vector<char> raw_buffer_;
+    std::vector<uint32_t> raw_ids_;
+    uint32_t raw_count_;
+};
@@ -23,8 +23,13 @@ THE SOFTWARE.
 #pragma once
 #include "message_handlers.h"
 #include "inc/kdb_message_handler_base.h"
+#include "inc/access_group.h"
+#include "inc/affine_summary.h"
+#include "inc/wave_encoding.h"
+#include "inc/wave_state_table.h"
 
 #include <map>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -90,11 +95,15 @@ public:
   virtual void clear() override;
 
 private:
-  bool handle_bank_conflict_analysis(const message_t &message);
-  bool handle_cache_line_count_analysis(const message_t &message);
+  //! An address message with any wave encoding undone (see wave_encoding.h)
+  typedef waveAddressView<message_t> address_message_t;
+  bool take_affine_summary(const address_message_t &message, affineSummary_t &summary);
+  bool handle_bank_conflict_analysis(const address_message_t &message);
+  bool handle_cache_line_count_analysis(const address_message_t &message);
   void report_cache_line_use();
   void report_bank_conflicts();
   void report_json();
+  void report_loss();
 
 private:
   //! Maps each of the supported memory access sizes to the conflict sets for that size
@@ -106,6 +115,8 @@ private:
     uint16_t isa_access_size = 0;
     uint8_t rw_kind = 0;
     std::string isa_instruction;
+    //! Site of the manifest the messages came from, MESSAGE_LOSS_NO_SITE without one or if they came from several
+    size_t site = MESSAGE_LOSS_NO_SITE;
   };
 
   struct lds_accesses_t : memory_accesses_t {
@@ -140,8 +151,21 @@ public:
     uint8_t access_type;
   };
 
+  //! ISA-level information for an instrumented source location, see get_dwarf_info
+  struct dwarf_info_t {
+    std::string fname;
+    std::string isa_instruction;
+    uint16_t access_size = 0;
+  };
+
 private:
+  const dwarf_info_t &site_dwarf_info(uint64_t site_id, const siteRecord_t &site);
+
   const std::map<std::string, access_size_and_type> instr_size_map;
   std::map<uint64_t, std::string> fname_hash_to_fname;
+  //! With a site manifest, each site is looked up in kernelDB once, on its first message
+  std::vector<std::optional<dwarf_info_t>> site_dwarf_info_;
+  //! Affine summaries (see affine_summary.h) waiting for their first-iteration address message
+  waveStateTable<affineSummary_t> pending_summaries_{64};
 };
 } // namespace dh_comms
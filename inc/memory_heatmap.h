@@ -23,6 +23,9 @@
 #pragma once
 
 #include "message_handlers.h"
+#include "inc/access_group.h"
+#include "inc/affine_summary.h"
+#include "inc/wave_state_table.h"
 
 #include <map>
 namespace dh_comms {
@@ -39,6 +42,9 @@ public:
   virtual bool handle(const message_t &message) override;
   virtual void report() override;
   virtual void clear() override;
+  //! Adds the page counts of a device heatmap (see device_heatmap.h) copied back after the dispatch;
+  //! returns false if the histogram is malformed
+  bool add_device_histogram(const void *histogram, size_t length);
 
 private:
   bool verbose_;
@@ -50,6 +56,8 @@ private:
   //! Maps the lowest address on each page to the number of accesses to the page.
   std::map<uint64_t, size_t> page_counts_;
   std::string format_;
+  //! Affine summaries (see affine_summary.h) waiting for their first-iteration address message
+  waveStateTable<affineSummary_t> pending_summaries_{64};
 };
 
 } // namespace dh_comms
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include <fstream>
 #include "message_handlers.h"
 #include "json_helpers.h"
+#include "wave_encoding.h"
 
 class message_logger_t : public dh_comms::message_handler_base
 {
@@ -37,9 +38,10 @@ public:
     virtual bool handle(const dh_comms::message_t &message) override;
     virtual void report() override;
     virtual void clear() override;
-    bool handle_address_message(const dh_comms::message_t& message, JSONHelper& json);
+    // Address messages are logged with any wave encoding undone (see wave_encoding.h)
+    bool handle_address_message(const waveAddressView<dh_comms::message_t>& message, JSONHelper& json);
     bool handle_timeinterval_message(const dh_comms::message_t& message, JSONHelper& json);
-    void handle_header(const dh_comms::message_t& message, JSONHelper& json);
+    void handle_header(const dh_comms::wave_header_t& hdr, JSONHelper& json);
 
 private:
     std::string strKernel_;
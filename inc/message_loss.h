@@ -0,0 +1,116 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class siteManifest;
+
+/* Host side accounting for lossy mode. In lossy mode a wave that finds no free sub-buffer drops its message
+ * and moves on instead of waiting for the host, which keeps the kernel's timing close to that of an
+ * uninstrumented run. The device counts what it drops in a loss block,
+ *
+ *   header  messageLossHeader_t
+ *   sites   site count x uint64_t, messages dropped per site of the clone's site manifest
+ *
+ * all little endian. Messages without a site (a clone built without INSTRUMENTATION_SITE_MANIFEST) only count
+ * in the header's total, and a block with a site count of zero has just the total.
+ *
+ * Drops are decided by buffer pressure, not by what a message says, so within a site the delivered messages
+ * are a random sample of the ones sent. A count that is a sum over the messages of a site can then be scaled
+ * up by sent / delivered to estimate what a lossless run would have counted. Counts over a whole dispatch
+ * scale the same way, using the dispatch totals, when the clone has no site manifest. Ratios of two such
+ * counts need no scaling, and minima, maxima, distinct values and per-wave orderings can't be recovered. */
+
+#define MESSAGE_LOSS_MAGIC "OPLS"
+const uint16_t MESSAGE_LOSS_VERSION = 1;
+// Messages without a site of the manifest
+const size_t MESSAGE_LOSS_NO_SITE = SIZE_MAX;
+// A site needs this many delivered messages before its counts are scaled; fewer give too noisy an estimate
+const uint64_t MESSAGE_LOSS_MIN_DELIVERED = 32;
+
+typedef struct {
+    char magic_[4];
+    uint16_t version_;
+    uint16_t reserved_;
+    uint32_t site_count_;
+    uint32_t reserved2_;
+    uint64_t dropped_;     // All dropped messages, with or without a site
+} messageLossHeader_t;
+
+static_assert(sizeof(messageLossHeader_t) == 24, "messageLossHeader_t must match the device side");
+
+inline size_t messageLossBytes(uint32_t site_count)
+{
+    return sizeof(messageLossHeader_t) + site_count * sizeof(uint64_t);
+}
+
+// Writes an empty loss block of messageLossBytes(site_count) bytes
+void messageLossInit(uint32_t site_count, void *block);
+
+/* The messages of one dispatch that reached the handlers, per site, and the ones the device dropped. Not
+ * thread safe: addDelivered() is called on the thread that runs the handlers, and the rest after it has
+ * stopped. */
+class messageLoss {
+public:
+    explicit messageLoss(size_t site_count = 0);
+
+    void addDelivered(size_t site = MESSAGE_LOSS_NO_SITE, uint64_t count = 1);
+    // Counts a delivered message by the dwarf_fname_hash and dwarf_line of its header, which name its site
+    // when the clone has a site manifest (see site_manifest.h)
+    void addDeliveredMessage(uint64_t fname_hash, uint32_t line);
+    // Adds the counts of a loss block copied back from the device. Returns false, changing nothing, if the
+    // block is malformed or describes a different number of sites.
+    bool merge(const void *block, size_t length);
+
+    uint64_t delivered() const { return delivered_total_; }
+    uint64_t dropped() const { return dropped_total_; }
+    uint64_t delivered(size_t site) const;
+    uint64_t dropped(size_t site) const;
+    // Fraction of the messages sent that were dropped, 0 when nothing was sent
+    double lossRate() const;
+    double lossRate(size_t site) const;
+
+    /* What a count summed over the messages of site should be multiplied by to estimate the lossless count,
+     * or 1 when that isn't a valid estimate: the site has too few delivered messages, or its drops weren't
+     * counted separately. MESSAGE_LOSS_NO_SITE, or a clone without sites, uses the dispatch totals. */
+    double scale(size_t site) const;
+    bool scalable(size_t site) const { return scale(site) != 1.0; }
+    uint64_t scaleCount(size_t site, uint64_t count) const;
+
+    // One line for the dispatch and one per site that lost messages
+    void report(std::ostream& out, const std::string& kernel, uint64_t dispatch_id,
+                const siteManifest *sites = nullptr) const;
+
+private:
+    double scale(uint64_t delivered, uint64_t dropped) const;
+
+    std::vector<uint64_t> delivered_;
+    std::vector<uint64_t> dropped_;
+    uint64_t delivered_total_;
+    uint64_t dropped_total_;
+    bool site_drops_;      // dropped_ came from a loss block with per-site counts
+};
@@ -0,0 +1,44 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <memory>
+#include <string>
+#include "message_handlers.h"
+#include "inc/message_replay.h"
+
+/* Writes every message of a dispatch to a recording shared by all dispatches (see message_replay.h),
+ * then lets the message go on to the other handlers. comms_mgr puts it first in the handler chain
+ * when LOGDUR_RECORD_MESSAGES is set. */
+class message_recorder_t : public dh_comms::message_handler_base
+{
+public:
+    message_recorder_t(std::shared_ptr<messageRecordWriter> writer, const std::string& strKernel, uint64_t dispatch_id);
+    virtual ~message_recorder_t() = default;
+    virtual bool handle(const dh_comms::message_t &message) override;
+    virtual void report() override;
+    virtual void clear() override;
+
+private:
+    std::shared_ptr<messageRecordWriter> writer_;
+    uint32_t dispatch_;
+};
@@ -0,0 +1,101 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Recordings of the messages dh_comms hands to the message handlers, so that handlers can be replayed
+ * and benchmarked on the host without a GPU (see tests/bench/handler_replay_bench.cc). A recording is
+ * written when LOGDUR_RECORD_MESSAGES names a file. It is a binary stream: the MESSAGE_RECORD_MAGIC
+ * bytes, a uint32_t MESSAGE_RECORD_VERSION and the uint32_t size of a wave header, followed by
+ * little-endian, unpadded records each starting with a one byte tag:
+ *
+ *   'K' uint32_t dispatch, uint64_t dispatch id, uint32_t length, length bytes of kernel name
+ *       - one per dispatch, before its first message
+ *   'M' uint32_t dispatch, uint32_t item size, uint32_t item count, the wave header bytes,
+ *       item size * item count bytes of data items - one per message
+ *
+ * The wave header is stored as dh_comms lays it out, so a recording only replays against the
+ * dh_comms it was recorded with; the header size is checked when it is loaded. */
+
+#define MESSAGE_RECORD_MAGIC "OPMSGREC"
+#define MESSAGE_RECORD_VERSION 1
+// Buffered records are written out once there are this many bytes of them
+#define MESSAGE_RECORD_FLUSH_BYTES (4 * 1024 * 1024)
+
+class messageRecordWriter
+{
+public:
+    messageRecordWriter();
+    ~messageRecordWriter();
+    bool open(const std::string& path, uint32_t header_size);
+    bool isOpen() const { return file_.is_open(); }
+    // Returns the index that append() takes for messages of this dispatch
+    uint32_t beginDispatch(const std::string& kernel, uint64_t dispatch_id);
+    void append(uint32_t dispatch, const void *header, uint32_t item_size, uint32_t item_count, const void *items);
+    void flush();
+    void close();
+private:
+    void flushLocked();
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::vector<char> buffer_;
+    uint32_t header_size_;
+    uint32_t dispatches_;
+};
+
+// Points into the recording it came from; items_ need not be aligned
+typedef struct {
+    const char *header_;
+    const char *items_;
+    uint32_t item_size_;
+    uint32_t item_count_;
+} recordedMessage_t;
+
+typedef struct {
+    std::string kernel_;
+    uint64_t dispatch_id_;
+    std::vector<recordedMessage_t> messages_;
+} recordedDispatch_t;
+
+class messageRecording
+{
+public:
+    messageRecording() : header_size_(0) {}
+    messageRecording(const messageRecording&) = delete;
+    messageRecording& operator=(const messageRecording&) = delete;
+    // Both return false and describe the problem in error if the data isn't a valid recording
+    bool load(const std::string& path, std::string& error);
+    bool parse(std::vector<char>&& data, std::string& error);
+    uint32_t headerSize() const { return header_size_; }
+    const std::vector<recordedDispatch_t>& dispatches() const { return dispatches_; }
+    size_t messageCount() const;
+private:
+    std::vector<char> data_;
+    uint32_t header_size_;
+    std::vector<recordedDispatch_t> dispatches_;
+};
@@ -22,9 +22,22 @@ THE SOFTWARE.
 #pragma once
 
 #include <Python.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Message handlers written in Python. The interpreter is started by the first handler and kept until exit;
+ * handlers take the GIL only while they call into Python, so they can be used from any thread.
+ *
+ * pythonMessageHandler calls the module once per address or time with a dict. pythonBatchHandler collects
+ * messages into columns and calls the module once per batch; that is the one to use for real kernels. */
 
 class pythonMessageHandler {
 public:
@@ -40,3 +53,90 @@ private:
     static std::mutex global_mutex_;
 };
 
+// Messages per batch unless the module or LOGDUR_PYTHON_BATCH asks for another size
+#define PYTHON_BATCH_MESSAGES 1024
+
+// The wave header fields of an address message that are passed on
+typedef struct {
+    uint64_t dispatch_id_;
+    uint64_t timestamp_;
+    uint64_t exec_;
+    uint32_t line_;
+    uint32_t column_;
+    uint32_t user_data_;
+} pythonMessageHeader_t;
+
+// One column per field; the address columns have an entry per lane, the others one per message or interval
+typedef struct {
+    std::vector<uint64_t> dispatch_id_;
+    std::vector<uint64_t> timestamp_;
+    std::vector<uint64_t> exec_;
+    std::vector<uint32_t> line_;
+    std::vector<uint32_t> column_;
+    std::vector<uint32_t> user_data_;
+    std::vector<uint64_t> address_;
+    std::vector<uint32_t> message_;          // index of the address's message in this batch
+    std::vector<uint64_t> interval_dispatch_id_;
+    std::vector<uint64_t> start_;
+    std::vector<uint64_t> stop_;
+} pythonBatch_t;
+
+/* Hands messages to a Python module in batches. The module defines
+ *
+ *   handleAddressBatch(batch)     batch maps column names to memoryviews: "dispatch_id", "timestamp",
+ *                                 "exec", "line", "column" and "user_data" with one entry per message,
+ *                                 "address" and "message" (index into the others) with one per lane
+ *   handleTimeBatch(batch)        "dispatch_id", "start" and "stop", one entry per time interval
+ *   handleDispatchEnd(kernel, dispatch_id)    optional, after the last batch with that dispatch's messages
+ *
+ * and may set BATCH_MESSAGES. The memoryviews are typed ('Q' or 'I') and point straight at the handler's
+ * columns, so numpy.frombuffer() wraps them without a copy; they are released when the call returns, so a
+ * module that keeps data must copy it.
+ *
+ * Producers append under a mutex. A full batch is swapped with the one a dedicated thread hands to Python,
+ * which holds the GIL only for that call; producers that fill the next batch before Python is done wait, so
+ * nothing is dropped and a batch never holds much more than the batch size. */
+class pythonBatchHandler {
+public:
+    explicit pythonBatchHandler(const std::string& module_name, size_t batch_messages = 0);
+    ~pythonBatchHandler();
+
+    // One handler per module and process, created on first use; nullptr if the module can't be loaded
+    static pythonBatchHandler *get(const std::string& module_name);
+
+    void addressMessage(const pythonMessageHeader_t& header, const uint64_t *addresses, size_t count);
+    // count {start, stop} pairs
+    void timeIntervals(uint64_t dispatch_id, const uint64_t *intervals, size_t count);
+    // Hands over what has been collected and waits until Python has seen it
+    void flush();
+    void dispatchEnd(const std::string& kernel, uint64_t dispatch_id);
+
+    uint64_t batches() const { return batches_.load(std::memory_order_relaxed); }
+    uint64_t failedCalls() const { return failed_calls_.load(std::memory_order_relaxed); }
+
+private:
+    pythonBatchHandler(const pythonBatchHandler&) = delete;
+    pythonBatchHandler& operator=(const pythonBatchHandler&) = delete;
+    size_t pendingMessages(const pythonBatch_t& batch) const;
+    void waitForRoom(std::unique_lock<std::mutex>& lock);
+    void handOff(std::unique_lock<std::mutex>& lock);
+    void deliver(pythonBatch_t& batch);
+    void work();
+
+    std::string module_name_;
+    PyObject *module_;
+    PyObject *address_func_;
+    PyObject *time_func_;
+    PyObject *dispatch_end_func_;
+    size_t batch_messages_;
+    std::mutex mutex_;
+    std::condition_variable ready_;          // pending_ has a batch, or stop_
+    std::condition_variable done_;           // Python is done with pending_, or filling_ was handed off
+    pythonBatch_t filling_;
+    pythonBatch_t pending_;
+    bool pending_ready_;
+    bool stop_;
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> failed_calls_;
+    std::thread worker_;
+};
@@ -0,0 +1,47 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include "message_handlers.h"
+#include "inc/pyHandler.h"
+
+#include <string>
+#include <vector>
+
+/* A dispatch's message handler that passes its address and time interval messages to a pythonBatchHandler
+ * (see pyHandler.h), shared by all dispatches that use the same module. report() waits until Python has
+ * seen every message of the dispatch and then calls the module's handleDispatchEnd(). */
+class python_batch_handler_t : public dh_comms::message_handler_base
+{
+public:
+    python_batch_handler_t(const std::string& strKernel, uint64_t dispatch_id, pythonBatchHandler *handler);
+    virtual ~python_batch_handler_t() = default;
+    virtual bool handle(const dh_comms::message_t &message) override;
+    virtual void report() override;
+    virtual void clear() override;
+
+private:
+    std::string strKernel_;
+    uint64_t dispatch_id_;
+    pythonBatchHandler *handler_;
+    std::vector<uint64_t> scratch_;          // a message's addresses or intervals
+};
@@ -0,0 +1,278 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Log-bucketed quantile sketch in the style of DDSketch. Every positive sample is counted in the
+ * bucket i for which gamma^(i-1) < sample <= gamma^i, where gamma = (1 + a) / (1 - a). Reporting the
+ * bucket midpoint 2 * gamma^i / (gamma + 1) for a quantile gives an answer within a relative error a of
+ * the true sample at that rank, with a fixed number of buckets regardless of how many samples arrive.
+ * Samples below 1 (e.g. zero-length intervals) are counted separately and reported as 0. */
+class sketchMapping {
+public:
+    static constexpr double RELATIVE_ACCURACY = 0.01;
+    // Enough buckets to cover [1, 2^64) at RELATIVE_ACCURACY
+    static constexpr size_t BUCKET_COUNT = 2240;
+
+    static size_t index(double value)
+    {
+        double idx = std::ceil(std::log(value) * invLogGamma());
+        if (idx <= 0)
+            return 0;
+        if (idx >= BUCKET_COUNT)
+            return BUCKET_COUNT - 1;
+        return static_cast<size_t>(idx);
+    }
+
+    static double value(size_t index)
+    {
+        return 2.0 * std::pow(gamma(), static_cast<double>(index)) / (gamma() + 1.0);
+    }
+
+private:
+    static double gamma()
+    {
+        static const double g = (1.0 + RELATIVE_ACCURACY) / (1.0 - RELATIVE_ACCURACY);
+        return g;
+    }
+    static double invLogGamma()
+    {
+        static const double inv = 1.0 / std::log(gamma());
+        return inv;
+    }
+};
+
+/* A quantile sketch plus count/sum/min/max for a single writer. Sketches are mergeable: merging the
+ * sketches of several shards (threads, dispatches, processes) gives exactly the sketch that recording
+ * every sample into one sketch would have, so per-shard sketches can be combined at report time.
+ * Only the range of buckets actually hit is stored, which for timing data is typically a few hundred
+ * counters at most, no matter how many samples are recorded. */
+class quantileSketch {
+public:
+    void record(double value, uint64_t weight = 1)
+    {
+        if (!weight)
+            return;
+        if (!count_ || value < min_)
+            min_ = value;
+        if (!count_ || value > max_)
+            max_ = value;
+        count_ += weight;
+        sum_ += value * weight;
+        if (value >= 1.0)
+            bucket(sketchMapping::index(value)) += weight;
+        else
+            zero_count_ += weight;
+    }
+
+    void merge(const quantileSketch& other)
+    {
+        if (!other.count_)
+            return;
+        if (!count_ || other.min_ < min_)
+            min_ = other.min_;
+        if (!count_ || other.max_ > max_)
+            max_ = other.max_;
+        count_ += other.count_;
+        sum_ += other.sum_;
+        zero_count_ += other.zero_count_;
+        for (size_t i = 0; i < other.counts_.size(); i++)
+            if (other.counts_[i])
+                bucket(other.offset_ + i) += other.counts_[i];
+    }
+
+    void clear()
+    {
+        count_ = 0;
+        zero_count_ = 0;
+        sum_ = 0.0;
+        min_ = 0.0;
+        max_ = 0.0;
+        offset_ = 0;
+        counts_.clear();
+    }
+
+    uint64_t count() const { return count_; }
+    double sum() const { return sum_; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    double mean() const { return count_ ? sum_ / count_ : 0.0; }
+    size_t bucketCount() const { return counts_.size(); }
+
+    // q in [0, 1]. Returns 0 if nothing has been recorded.
+    double quantile(double q) const
+    {
+        if (!count_)
+            return 0.0;
+        if (q < 0.0)
+            q = 0.0;
+        if (q > 1.0)
+            q = 1.0;
+        uint64_t rank = static_cast<uint64_t>(q * (count_ - 1));
+        uint64_t seen = zero_count_;
+        if (rank < seen)
+            return min_ < 0.0 ? min_ : 0.0;
+        for (size_t i = 0; i < counts_.size(); i++)
+        {
+            seen += counts_[i];
+            if (rank < seen)
+            {
+                double value = sketchMapping::value(offset_ + i);
+                return value < min_ ? min_ : (value > max_ ? max_ : value);
+            }
+        }
+        return max_;
+    }
+
+private:
+    friend class concurrentQuantileSketch;
+
+    uint64_t& bucket(size_t index)
+    {
+        if (counts_.empty())
+        {
+            offset_ = index;
+            counts_.resize(1, 0);
+        }
+        else if (index < offset_)
+        {
+            counts_.insert(counts_.begin(), offset_ - index, 0);
+            offset_ = index;
+        }
+        else if (index >= offset_ + counts_.size())
+            counts_.resize(index - offset_ + 1, 0);
+        return counts_[index - offset_];
+    }
+
+    uint64_t count_ = 0;
+    uint64_t zero_count_ = 0;
+    double sum_ = 0.0;
+    double min_ = 0.0;
+    double max_ = 0.0;
+    size_t offset_ = 0;
+    std::vector<uint64_t> counts_;
+};
+
+/* A quantile sketch plus count/sum/min/max that any number of threads can record into concurrently
+ * without taking a lock. Readers (e.g. a background reporting thread) see a consistent-enough view for
+ * reporting; they don't stop writers. */
+class concurrentQuantileSketch {
+public:
+    concurrentQuantileSketch()
+    {
+        for (auto& bucket : buckets_)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t value)
+    {
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t cur = min_.load(std::memory_order_relaxed);
+        while (value < cur && !min_.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+            ;
+        cur = max_.load(std::memory_order_relaxed);
+        while (value > cur && !max_.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+            ;
+        if (value)
+            buckets_[sketchMapping::index(static_cast<double>(value))].fetch_add(1, std::memory_order_relaxed);
+        else
+            zero_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t min() const { return count() ? min_.load(std::memory_order_relaxed) : 0; }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const
+    {
+        uint64_t n = count();
+        return n ? static_cast<double>(sum()) / n : 0.0;
+    }
+
+    // Copy of the current state, e.g. to merge with other shards' sketches
+    quantileSketch snapshot() const
+    {
+        quantileSketch result;
+        result.count_ = count();
+        if (!result.count_)
+            return result;
+        result.sum_ = static_cast<double>(sum());
+        result.min_ = static_cast<double>(min());
+        result.max_ = static_cast<double>(max());
+        result.zero_count_ = zero_count_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < sketchMapping::BUCKET_COUNT; i++)
+        {
+            uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+            if (n)
+                result.bucket(i) += n;
+        }
+        return result;
+    }
+
+    // q in [0, 1]. Returns 0 if nothing has been recorded.
+    double quantile(double q) const
+    {
+        uint64_t total = zero_count_.load(std::memory_order_relaxed);
+        for (auto& bucket : buckets_)
+            total += bucket.load(std::memory_order_relaxed);
+        if (!total)
+            return 0.0;
+        if (q < 0.0)
+            q = 0.0;
+        if (q > 1.0)
+            q = 1.0;
+        uint64_t rank = static_cast<uint64_t>(q * (total - 1));
+        uint64_t seen = zero_count_.load(std::memory_order_relaxed);
+        if (rank < seen)
+            return 0.0;
+        for (size_t i = 0; i < sketchMapping::BUCKET_COUNT; i++)
+        {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (rank < seen)
+                return clamp(sketchMapping::value(i));
+        }
+        return static_cast<double>(max());
+    }
+
+private:
+    // The bucket midpoint can fall just outside the observed range; never report beyond it
+    double clamp(double value) const
+    {
+        double lo = static_cast<double>(min());
+        double hi = static_cast<double>(max());
+        return value < lo ? lo : (value > hi ? hi : value);
+    }
+
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{0};
+    std::atomic<uint64_t> zero_count_{0};
+    std::atomic<uint64_t> buckets_[sketchMapping::BUCKET_COUNT];
+};
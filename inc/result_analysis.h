@@ -0,0 +1,92 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include "inc/result_merge.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Cross-dispatch summaries of the handlers' JSON outputs (omniprobe analyze). The inputs are read by
+ * resultMerger, so they are parsed by parallel workers in chunks and every dispatch of a kernel, in every
+ * process, adds to the same source location before anything is ranked. From the merged table:
+ *
+ *   - kernels: per kernel totals over all its dispatches
+ *   - uncoalesced: global accesses ranked by the cache lines they used beyond the minimum they needed
+ *   - bank conflicts: LDS accesses ranked by their bank conflicts
+ *   - hottest blocks: basic blocks ranked by their summed duration
+ *
+ * Ties are broken by the table's own order, so the report is the same for any thread count and chunk size. */
+
+typedef struct {
+    size_t top_ = 10;                        // entries per ranking; 0 for all
+} analysisOptions_t;
+
+typedef struct {
+    std::string name_;
+    uint64_t processes_ = 0;
+    uint64_t dispatches_ = 0;
+    uint64_t global_sites_ = 0;
+    uint64_t lds_sites_ = 0;
+    uint64_t execution_count_ = 0;           // global and LDS accesses
+    uint64_t cache_lines_needed_ = 0;
+    uint64_t cache_lines_used_ = 0;
+    uint64_t bank_conflicts_ = 0;
+    uint64_t blocks_ = 0;
+    uint64_t block_duration_ = 0;
+    uint64_t messages_dropped_ = 0;
+    bool estimated_ = false;                 // some counts were scaled up for dropped messages
+} kernelSummary_t;
+
+typedef std::pair<const mergedAccessKey_t, mergedAccess_t> analyzedAccess_t;
+typedef std::pair<const mergedBlockKey_t, mergedBlock_t> analyzedBlock_t;
+
+class resultAnalysis {
+public:
+    // The table must outlive the analysis, which points into it
+    explicit resultAnalysis(const mergeTable& table, const analysisOptions_t& options = analysisOptions_t());
+
+    const std::vector<kernelSummary_t>& kernels() const { return kernels_; }
+    const std::vector<const analyzedAccess_t *>& uncoalesced() const { return uncoalesced_; }
+    const std::vector<const analyzedAccess_t *>& bankConflicts() const { return bank_conflicts_; }
+    const std::vector<const analyzedBlock_t *>& hottestBlocks() const { return hottest_blocks_; }
+
+    void writeText(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+
+    static uint64_t excessCacheLines(const mergedAccess_t& access)
+    {
+        return access.cache_lines_used_ > access.cache_lines_needed_
+                   ? access.cache_lines_used_ - access.cache_lines_needed_ : 0;
+    }
+
+private:
+    const mergeTable& table_;
+    std::vector<kernelSummary_t> kernels_;
+    std::vector<const analyzedAccess_t *> uncoalesced_;
+    std::vector<const analyzedAccess_t *> bank_conflicts_;
+    std::vector<const analyzedBlock_t *> hottest_blocks_;
+};
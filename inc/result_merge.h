@@ -0,0 +1,154 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+class jsonValue;
+
+/* Merges the JSON outputs of several processes, e.g. the ranks of a multi-rank job each writing to their
+ * own LOGDUR_LOG_LOCATION, into one report aggregated by kernel and source location (omniprobe merge).
+ *
+ * Inputs are mapped and cut into chunks of about chunk_bytes, each starting at a line that begins with '{'.
+ * The handlers write their top-level records (MemoryAnalysis array elements, basic block and region JSON
+ * lines) starting in column 0 and never put a raw newline inside a string, so any such line starts a
+ * record. Worker threads parse chunks in parallel into their own tables, which are added together at
+ * the end; memory use is bounded by the number of distinct kernels, sites and dispatches, not by the
+ * size of the inputs, since a chunk's pages are dropped once it has been read.
+ *
+ * Records merged:
+ *   - MemoryAnalysis ("kernel_analysis"): execution counts, cache lines and bank conflicts summed per
+ *     kernel, source location and access kind
+ *   - basic blocks ("block_start_line"): durations, visits and active lanes summed per block
+ *   - timing regions ("region"): the same per region
+ * Duration percentiles can't be combined exactly, so the merged report keeps the largest of each. Other
+ * records (compute resources, heatmaps, time intervals) are counted and left out. */
+
+typedef struct {
+    size_t threads_ = 0;                     // 0 for one per hardware thread
+    size_t chunk_bytes_ = 64 * 1024 * 1024;
+} mergeOptions_t;
+
+typedef enum {
+    MERGED_CACHE_LINES = 0,
+    MERGED_BANK_CONFLICTS = 1
+} mergedAccessKind_t;
+
+typedef struct {
+    std::string kernel_;
+    mergedAccessKind_t kind_;
+    std::string file_;
+    uint64_t line_;
+    uint64_t column_;
+    std::string type_;
+    uint64_t ir_bytes_;
+    uint64_t isa_bytes_;
+    std::string isa_instruction_;
+} mergedAccessKey_t;
+
+typedef struct {
+    uint64_t execution_count_ = 0;
+    uint64_t cache_lines_needed_ = 0;
+    uint64_t cache_lines_used_ = 0;
+    uint64_t bank_conflicts_ = 0;
+    uint64_t dispatches_ = 0;                // records the site appeared in
+    bool estimated_ = false;                 // some of the counts were scaled up for dropped messages
+    std::string code_context_;
+} mergedAccess_t;
+
+typedef struct {
+    std::string kernel_;
+    bool region_;                            // a timing region rather than a basic block
+    std::string file_;
+    uint64_t index_;                         // region index; 0 for blocks
+    uint64_t start_line_;
+    uint64_t end_line_;
+    std::string region_kind_;
+} mergedBlockKey_t;
+
+typedef struct {
+    uint64_t duration_ = 0;
+    uint64_t self_duration_ = 0;
+    uint64_t count_ = 0;
+    uint64_t thread_count_ = 0;              // active lanes over all visits, recovered from branchiness
+    uint64_t duration_p50_max_ = 0;
+    uint64_t duration_p90_max_ = 0;
+    uint64_t duration_p99_max_ = 0;
+    uint64_t dispatches_ = 0;
+} mergedBlock_t;
+
+typedef struct {
+    std::unordered_set<uint64_t> dispatches_;  // input index << 40 | dispatch id
+    std::vector<bool> inputs_;
+    uint64_t messages_dropped_ = 0;
+} mergedKernel_t;
+
+bool operator<(const mergedAccessKey_t& a, const mergedAccessKey_t& b);
+bool operator<(const mergedBlockKey_t& a, const mergedBlockKey_t& b);
+
+// Everything read so far; one per worker, then added together
+class mergeTable {
+public:
+    // A top-level record of input number input
+    void add(const jsonValue& record, uint32_t input);
+    void add(const mergeTable& other);
+
+    std::map<mergedAccessKey_t, mergedAccess_t> accesses_;
+    std::map<mergedBlockKey_t, mergedBlock_t> blocks_;
+    std::map<std::string, mergedKernel_t> kernels_;
+    uint64_t records_ = 0;                   // records merged
+    uint64_t skipped_records_ = 0;           // well formed but of a kind that isn't merged
+    uint64_t malformed_records_ = 0;         // couldn't be parsed, e.g. cut short by a crash
+
+private:
+    void addMemoryAnalysis(const jsonValue& analysis, uint32_t input);
+    void addBlock(const jsonValue& record, uint32_t input, bool region);
+    mergedKernel_t& kernel(const std::string& name, uint64_t dispatch_id, uint32_t input);
+};
+
+class resultMerger {
+public:
+    explicit resultMerger(const mergeOptions_t& options = mergeOptions_t());
+
+    // Reads all inputs; false if one of them can't be opened
+    bool merge(const std::vector<std::string>& inputs);
+    const mergeTable& table() const { return table_; }
+    // The combined report, one JSON object
+    void write(std::ostream& out) const;
+
+    // Where the chunks of a buffer start, see above; exposed for testing
+    static std::vector<size_t> chunkStarts(const char *data, size_t size, size_t chunk_bytes);
+    // Parses the records in [begin, end) into table
+    static void mergeChunk(const char *begin, const char *end, uint32_t input, mergeTable& table);
+
+private:
+    mergeOptions_t options_;
+    std::vector<std::string> inputs_;
+    mergeTable table_;
+};
@@ -0,0 +1,101 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Host side of the site manifests written by the address message plugin when
+ * INSTRUMENTATION_SITE_MANIFEST=1 is set at compile time. Each instrumented clone gets a constant
+ * global named <clone symbol> SITE_MANIFEST_SUFFIX that describes every instrumented access of the
+ * clone, and the clone's address messages carry the index of their site in dwarf_fname_hash, with
+ * SITE_MANIFEST_LINE_FLAG in dwarf_line. dwarf_column keeps the source column together with the
+ * access group and affine summary bits. From version 2 on, every member of an access group has a
+ * site of its own, so members can differ in column; see memberSite(). The manifest is laid out as
+ *
+ *   header   "OPSM", u16 version, u16 record size, u32 site count, u32 file count
+ *   records  one siteRecord_t per site
+ *   files    NUL-terminated source file names, in file index order
+ *
+ * all little endian. The layout must match InstrumentationSiteManifest in
+ * src/instrumentation/InstrumentationCommon.cpp. */
+
+#define SITE_MANIFEST_SUFFIX ".sites"
+#define SITE_MANIFEST_MAGIC "OPSM"
+const uint16_t SITE_MANIFEST_VERSION = 2;
+const uint16_t SITE_MANIFEST_MIN_VERSION = 1;
+const uint32_t SITE_MANIFEST_LINE_FLAG = 0x80000000u;
+
+typedef struct siteRecord {
+    uint32_t file_;        // Index into the file names of the manifest
+    uint32_t line_;
+    uint32_t column_;
+    uint8_t addr_space_;
+    uint8_t access_kind_;  // 0b01 load, 0b10 store, as in the message's user_data
+    uint16_t size_;        // Access size in the IR, in bytes
+}siteRecord_t;
+
+static_assert(sizeof(siteRecord_t) == 16, "siteRecord_t must match the manifest record size");
+
+class siteManifest {
+public:
+    // Returns false, leaving the manifest empty, if data isn't a well-formed manifest
+    bool parse(const void *data, size_t length);
+
+    size_t size() const { return sites_.size(); }
+    const siteRecord_t& operator[](size_t idx) const { return sites_[idx]; }
+    const std::string& fileName(const siteRecord_t& site) const { return files_[site.file_]; }
+
+    // The site of a message, given its dwarf_fname_hash and dwarf_line, or nullptr if the message
+    // doesn't refer to a site of this manifest
+    const siteRecord_t *find(uint64_t fname_hash, uint32_t line) const
+    {
+        if (line != SITE_MANIFEST_LINE_FLAG || fname_hash >= sites_.size())
+            return nullptr;
+        return &sites_[fname_hash];
+    }
+
+    // The site id of member idx of the access group whose message refers to site group_id, with
+    // members numbered as accessGroupOffsets() lists them. Version 1 manifests have one site for
+    // the whole group.
+    uint64_t memberSite(uint64_t group_id, size_t idx) const
+    {
+        return version_ >= 2 ? group_id + idx : group_id;
+    }
+
+    uint16_t version() const { return version_; }
+
+private:
+    uint16_t version_ = 0;
+    std::vector<siteRecord_t> sites_;
+    std::vector<std::string> files_;
+};
+
+typedef std::map<std::string, std::shared_ptr<const siteManifest>> siteManifestMap_t;
+
+/* Adds the site manifests found in the symbol tables of the code object image (an ELF file) to
+ * manifests, keyed by the name of the clone they describe. Returns the number of manifests found. */
+size_t findSiteManifests(const void *image, size_t length, siteManifestMap_t& manifests);
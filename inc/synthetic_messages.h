@@ -0,0 +1,88 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* Synthetic wave messages for benchmarking the message handlers without a GPU or a recording (see
+ * tests/bench/handler_replay_bench.cc). Messages are described field by field, independently of the
+ * dh_comms wave header layout; the caller builds the dh_comms messages from them. Address messages
+ * carry one 8 byte address per active lane and pack user_data the way the address plugin does:
+ *
+ *   bits  0..1   memory access kind, 1 read, 2 write
+ *   bits  2..5   address space, 1 global, 3 LDS
+ *   bits  6..21  access size in bytes
+ *
+ * Time interval messages carry one 16 byte {start, stop} item. */
+
+const uint32_t SYNTHETIC_ADDRESS_MESSAGE = 0;
+const uint32_t SYNTHETIC_TIME_INTERVAL_MESSAGE = 1;
+const uint32_t SYNTHETIC_GLOBAL_SPACE = 1;
+const uint32_t SYNTHETIC_LDS_SPACE = 3;
+
+typedef enum {
+    SYNTHETIC_COALESCED,      // Global loads and stores, consecutive lanes access consecutive elements
+    SYNTHETIC_STRIDED,        // Global loads, lanes a cache line or more apart
+    SYNTHETIC_GATHER,         // Global loads from random addresses in a large buffer
+    SYNTHETIC_LDS_CONFLICT,   // LDS stores where lanes collide on banks
+    SYNTHETIC_TIME_INTERVALS, // Per-block time intervals
+    SYNTHETIC_TIMING_REGIONS, // Kernel and loop timing regions (see timing_region.h)
+    SYNTHETIC_PATTERN_COUNT
+} syntheticPattern_t;
+
+typedef struct {
+    size_t waves_ = 1024;        // Waves in the simulated dispatch
+    size_t messages_per_wave_ = 32;
+    uint32_t wave_size_ = 64;
+    uint32_t active_lanes_ = 64; // Lanes active in each message, the low ones
+    uint32_t element_size_ = 4;  // Bytes per access
+    uint32_t sites_ = 8;         // Distinct source lines the messages are spread over
+    uint64_t seed_ = 1;
+} syntheticConfig_t;
+
+typedef struct {
+    uint32_t kind_;
+    uint64_t exec_;
+    uint32_t block_idx_x_;
+    uint32_t block_idx_y_;
+    uint32_t block_idx_z_;
+    uint32_t wave_num_;
+    uint64_t timestamp_;
+    uint64_t dwarf_fname_hash_;
+    uint32_t dwarf_line_;
+    uint32_t dwarf_column_;
+    uint32_t user_data_;
+    uint32_t item_size_;
+    // item_size_ * count bytes of items, as 64-bit words
+    std::vector<uint64_t> items_;
+} syntheticMessage_t;
+
+const char *syntheticPatternName(syntheticPattern_t pattern);
+bool parseSyntheticPattern(const std::string& name, syntheticPattern_t& pattern);
+
+// Calls emit once per message, in wave order. The message is reused between calls.
+void generateSyntheticMessages(syntheticPattern_t pattern, const syntheticConfig_t& config,
+                               const std::function<void(const syntheticMessage_t&)>& emit);
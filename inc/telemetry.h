@@ -0,0 +1,211 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/* Counters and histograms describing what omniprobe itself costs while it runs, kept in a named POSIX shared
+ * memory segment (/dev/shm/omniprobe.<pid>) so that `omniprobe stats` can attach from another process and show
+ * live rates. The segment is only created when LOGDUR_TELEMETRY is set; until then every update is a load and a
+ * branch.
+ *
+ * Layout, all little endian, described by the header so readers don't hardcode it:
+ *   - telemetry_header_t, followed by padding up to header_size_
+ *   - shard_count_ shards of shard_size_ bytes each. A shard is counter_count_ int64 counters, then for each
+ *     histogram an int64 count, an int64 sum and bucket_count_ int64 buckets
+ * Writers pick a shard per thread and update it with relaxed atomic adds; a reader sums the shards. Bucket 0
+ * counts zeros and bucket b counts values in [2^(b-1), 2^b), with the last bucket open ended. */
+
+#define TELEMETRY_MAGIC "OPTELEM1"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_SHARDS 16
+#define TELEMETRY_BUCKETS 32
+#define TELEMETRY_NAME_LENGTH 48
+
+typedef enum {
+    TELEMETRY_DISPATCHES = 0,             // dispatch packets seen by fixupPacket
+    TELEMETRY_INSTRUMENTED_DISPATCHES,    // of those, redirected to an instrumented clone with a dh_comms object
+    TELEMETRY_COMPLETIONS,                // dispatches whose completion signal was processed
+    TELEMETRY_PENDING_SIGNALS,            // gauge: dispatches in flight
+    TELEMETRY_COMMS_IN_USE,               // gauge: dh_comms objects checked out
+    TELEMETRY_MESSAGES,                   // messages handed to the handler chain
+    TELEMETRY_HANDLER_CALLS,              // handle() calls across all handlers
+    TELEMETRY_CODE_OBJECTS,               // code objects ingested from the kernel cache
+    TELEMETRY_COUNTER_COUNT
+} telemetry_counter_t;
+
+typedef enum {
+    TELEMETRY_FIXUP_NS = 0,               // time in fixupPacket per dispatch
+    TELEMETRY_COMPLETION_LAG_NS,          // signal handler queueing a completion to the reactor processing it
+    TELEMETRY_COMMS_DRAIN_NS,             // dh_comms::stop() at checkin: draining the last sub-buffers
+    TELEMETRY_HANDLER_NS,                 // one handle() call
+    TELEMETRY_HISTOGRAM_COUNT
+} telemetry_histogram_t;
+
+typedef enum {
+    TELEMETRY_KIND_COUNTER = 0,
+    TELEMETRY_KIND_GAUGE = 1,
+    TELEMETRY_KIND_HISTOGRAM = 2
+} telemetry_kind_t;
+
+typedef struct {
+    char name_[TELEMETRY_NAME_LENGTH];
+    uint32_t kind_;
+    uint32_t reserved_;
+} telemetry_descriptor_t;
+
+typedef struct {
+    char magic_[8];
+    uint32_t version_;
+    uint32_t header_size_;
+    uint32_t shard_count_;
+    uint32_t shard_size_;
+    uint32_t counter_count_;
+    uint32_t histogram_count_;
+    uint32_t bucket_count_;
+    uint32_t pid_;
+    uint64_t start_time_ns_;              // CLOCK_MONOTONIC, the clock behind telemetryNow()
+    telemetry_descriptor_t counters_[TELEMETRY_COUNTER_COUNT];
+    telemetry_descriptor_t histograms_[TELEMETRY_HISTOGRAM_COUNT];
+} telemetry_header_t;
+
+typedef struct {
+    std::atomic<int64_t> count_;
+    std::atomic<int64_t> sum_;
+    std::atomic<int64_t> buckets_[TELEMETRY_BUCKETS];
+} telemetry_histogram_slot_t;
+
+// Aligned so that two threads on different shards never share a cache line
+typedef struct alignas(64) {
+    std::atomic<int64_t> counters_[TELEMETRY_COUNTER_COUNT];
+    telemetry_histogram_slot_t histograms_[TELEMETRY_HISTOGRAM_COUNT];
+} telemetry_shard_t;
+
+static_assert(std::atomic<int64_t>::is_always_lock_free, "telemetry counters must be plain int64 in shared memory");
+static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t), "telemetry counters must be plain int64 in shared memory");
+
+// Shards summed up
+typedef struct {
+    int64_t counters_[TELEMETRY_COUNTER_COUNT];
+    struct {
+        int64_t count_;
+        int64_t sum_;
+        int64_t buckets_[TELEMETRY_BUCKETS];
+    } histograms_[TELEMETRY_HISTOGRAM_COUNT];
+} telemetry_snapshot_t;
+
+/* Owns one mapping of a telemetry segment. create() makes and initializes a new segment; attach() maps an
+ * existing one read only. At most one created segment is active at a time: it is the one telemetryCount() and
+ * telemetryRecord() update. The creator unlinks the name when it is destroyed. */
+class telemetrySegment {
+public:
+    telemetrySegment();
+    ~telemetrySegment();
+
+    // "/omniprobe.<pid>"
+    static std::string defaultName();
+    bool create(const std::string& name);
+    bool attach(const std::string& name);
+    // Makes this segment the one updates go to, or stops updates if it was
+    void activate();
+    void deactivate();
+    bool snapshot(telemetry_snapshot_t& snapshot) const;
+    const std::string& name() const { return name_; }
+
+    // The active segment's shard for the calling thread, or NULL when telemetry is off
+    static telemetry_shard_t *shard()
+    {
+        telemetry_shard_t *shards = active_.load(std::memory_order_acquire);
+        return shards ? shards + threadShard() : nullptr;
+    }
+    static uint32_t bucket(uint64_t value)
+    {
+        uint32_t bucket = value ? 64 - __builtin_clzll(value) : 0;
+        return bucket < TELEMETRY_BUCKETS ? bucket : TELEMETRY_BUCKETS - 1;
+    }
+
+private:
+    telemetrySegment(const telemetrySegment&) = delete;
+    telemetrySegment& operator=(const telemetrySegment&) = delete;
+    static uint32_t threadShard()
+    {
+        static thread_local uint32_t shard = next_shard_.fetch_add(1, std::memory_order_relaxed) % TELEMETRY_SHARDS;
+        return shard;
+    }
+    void unmap();
+
+    static std::atomic<telemetry_shard_t *> active_;
+    static std::atomic<uint32_t> next_shard_;
+    std::string name_;
+    void *base_;
+    size_t size_;
+    bool owner_;
+    bool activated_;
+};
+
+inline uint64_t telemetryNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline bool telemetryEnabled()
+{
+    return telemetrySegment::shard() != nullptr;
+}
+
+inline void telemetryCount(telemetry_counter_t counter, int64_t value = 1)
+{
+    telemetry_shard_t *shard = telemetrySegment::shard();
+    if (shard)
+        shard->counters_[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+inline void telemetryRecord(telemetry_histogram_t histogram, uint64_t value)
+{
+    telemetry_shard_t *shard = telemetrySegment::shard();
+    if (!shard)
+        return;
+    telemetry_histogram_slot_t& slot = shard->histograms_[histogram];
+    slot.count_.fetch_add(1, std::memory_order_relaxed);
+    slot.sum_.fetch_add(value, std::memory_order_relaxed);
+    slot.buckets_[telemetrySegment::bucket(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+/* Records the time from construction to destruction in a histogram, if telemetry was on when it was
+ * constructed. */
+class telemetryTimer {
+public:
+    explicit telemetryTimer(telemetry_histogram_t histogram)
+        : histogram_(histogram), start_(telemetryEnabled() ? telemetryNow() : 0) {}
+    ~telemetryTimer()
+    {
+        if (start_)
+            telemetryRecord(histogram_, telemetryNow() - start_);
+    }
+private:
+    telemetry_histogram_t histogram_;
+    uint64_t start_;
+};
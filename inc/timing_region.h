@@ -0,0 +1,130 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "inc/quantile_sketch.h"
+
+/* Host side of the timing regions emitted by the basic block interval plugin when
+ * INSTRUMENTATION_TIMING_REGIONS=loops is set at compile time. Instead of one time interval per basic
+ * block, the plugin times the whole kernel (region 0) and selected loops, from the loop preheader to
+ * each loop exit. A region's time interval message has its first source line in dwarf_line, its last
+ * source line in dwarf_column, and packs in user_data:
+ *
+ *   bits  0..11  region index within the kernel, 0 is the kernel itself
+ *   bits 12..23  index of the enclosing timed region
+ *   bits 24..27  loop depth, 0 for the kernel region
+ *   bit  31      TIMING_REGION_FLAG
+ *
+ * The layout must match src/instrumentation/AMDGCNSubmitBBInterval.cpp. */
+
+const uint32_t TIMING_REGION_FLAG = 0x80000000u;
+const uint32_t TIMING_REGION_INDEX_MASK = 0xfffu;
+const uint32_t TIMING_REGION_PARENT_SHIFT = 12;
+const uint32_t TIMING_REGION_DEPTH_SHIFT = 24;
+const uint32_t TIMING_REGION_DEPTH_MASK = 0xfu;
+const uint32_t TIMING_REGION_MAX_REGIONS = TIMING_REGION_INDEX_MASK + 1;
+
+inline bool isTimingRegion(uint32_t user_data)
+{
+    return (user_data & TIMING_REGION_FLAG) != 0;
+}
+
+inline uint32_t timingRegionIndex(uint32_t user_data)
+{
+    return user_data & TIMING_REGION_INDEX_MASK;
+}
+
+inline uint32_t timingRegionParent(uint32_t user_data)
+{
+    return (user_data >> TIMING_REGION_PARENT_SHIFT) & TIMING_REGION_INDEX_MASK;
+}
+
+inline uint32_t timingRegionDepth(uint32_t user_data)
+{
+    return (user_data >> TIMING_REGION_DEPTH_SHIFT) & TIMING_REGION_DEPTH_MASK;
+}
+
+typedef struct {
+    uint64_t count_;        // Wave-level executions of the region
+    uint64_t thread_count_; // Active lanes summed over those executions
+    uint64_t duration_;     // Cycles summed over those executions, nested regions included
+    uint64_t fname_hash_;
+    uint32_t start_line_;
+    uint32_t end_line_;
+    uint32_t parent_;
+    uint32_t depth_;
+} timingRegionInfo_t;
+
+/* Per-dispatch totals for the timing regions of one kernel, indexed by region index. Regions nest
+ * (every loop lies in the kernel region, inner timed loops in outer ones), so a region's duration
+ * includes that of its timed children; selfDuration() takes them out again to attribute each cycle
+ * to exactly one region. */
+class timingRegionTable {
+public:
+    void record(uint32_t user_data, uint64_t fname_hash, uint32_t start_line, uint32_t end_line,
+                uint32_t active_lanes, uint64_t duration)
+    {
+        uint32_t idx = timingRegionIndex(user_data);
+        if (idx >= regions_.size())
+        {
+            regions_.resize(idx + 1, timingRegionInfo_t{});
+            durations_.resize(idx + 1);
+        }
+        timingRegionInfo_t& info = regions_[idx];
+        if (!info.count_)
+            info = {0, 0, 0, fname_hash, start_line, end_line, timingRegionParent(user_data),
+                    timingRegionDepth(user_data)};
+        info.count_++;
+        info.thread_count_ += active_lanes;
+        info.duration_ += duration;
+        durations_[idx].record(static_cast<double>(duration));
+    }
+
+    size_t size() const { return regions_.size(); }
+    bool empty() const { return regions_.empty(); }
+    // Regions that never ran have a zero count
+    const timingRegionInfo_t& operator[](size_t idx) const { return regions_[idx]; }
+    const quantileSketch& durations(size_t idx) const { return durations_[idx]; }
+
+    uint64_t selfDuration(size_t idx) const
+    {
+        uint64_t children = 0;
+        for (size_t i = 0; i < regions_.size(); i++)
+            if (i != idx && regions_[i].count_ && regions_[i].parent_ == idx)
+                children += regions_[i].duration_;
+        return children < regions_[idx].duration_ ? regions_[idx].duration_ - children : 0;
+    }
+
+    void clear()
+    {
+        regions_.clear();
+        durations_.clear();
+    }
+
+private:
+    std::vector<timingRegionInfo_t> regions_;
+    std::vector<quantileSketch> durations_;
+};
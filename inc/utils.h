@@ -44,12 +44,15 @@ THE SOFTWARE.
 #include <fstream>
 #include <list>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <memory>
 #include <utility>
 #include <shared_mutex>
 #include <filesystem>
@@ -71,10 +74,17 @@ THE SOFTWARE.
 #define AMD_INTERNAL_BUILD
 #include <hsa_api_trace.h>
 #include "plugins/plugin.h"
+#include "inc/log_duration.h"
+#include "inc/site_manifest.h"
+#include "inc/device_heatmap.h"
+#include "inc/kernel_names.h"
 
 
 #define INSTRUMENTATION_BUFFER void *
 #define OMNIPROBE_PREFIX "__amd_crk_"
+// Clones built with INSTRUMENTATION_DUAL_PATH=1 run their uninstrumented body when passed a null
+// dh_comms pointer. The plugins mark them with a symbol named <clone symbol> DUAL_PATH_MARKER_SUFFIX.
+#define DUAL_PATH_MARKER_SUFFIX ".dual_path"
 
 
 #define RH_PAGE_SIZE 0x1000
@@ -143,6 +153,11 @@ typedef struct arg_descriptor {
     uint32_t private_segment_size;
     uint32_t group_segment_size;
     size_t clone_hidden_args_length;
+    bool dual_path;
+    // Set when the clone was built with INSTRUMENTATION_SITE_MANIFEST=1
+    std::shared_ptr<const siteManifest> sites;
+    // Set when the clone was built with INSTRUMENTATION_HEATMAP; its pointer argument takes a device heatmap
+    deviceHeatmapConfig_t heatmap;
 }arg_descriptor_t;
 
 
@@ -158,6 +173,18 @@ struct CodeObjectRef {
     std::string mangled_name;    // Mangled symbol name from HSA
 };
 
+/* What coCache::loadFile learns about one file on one agent. It is built without holding the cache lock, so
+ * several files can be parsed at once, and coCache::publish makes all of it visible to lookups in one step. */
+typedef struct {
+    hsa_agent_t agent_;
+    std::string source_;
+    std::vector<hsa_executable_t> executables_;
+    std::vector<hsa_executable_symbol_t> kernels_;
+    std::map<kernel_name_id_t, hsa_executable_symbol_t> symbols_;
+    std::map<kernel_name_id_t, arg_descriptor_t> args_;
+    std::map<kernel_name_id_t, CodeObjectRef> refs_;
+} coCacheBatch_t;
+
 class coCache{
 public:
     coCache(HsaApiTable *apiTable);
@@ -167,6 +194,7 @@ public:
     uint64_t findInstrumentedAlternative(hsa_executable_symbol_t, const std::string& name, hsa_agent_t queue_agent = {0});
     bool hasKernels(hsa_agent_t agent);
     uint32_t getArgSize(uint64_t kernel_object);
+    // Safe to call from several threads at once: files are loaded without the cache lock and published atomically
     bool addFile(const std::string& name, hsa_agent_t agent, const std::string& strFilter);
     bool getArgDescriptor(hsa_agent_t agent, std::string& name, arg_descriptor_t& desc, bool instrumented);
     bool getCodeObjectRef(hsa_agent_t agent, const std::string& name, CodeObjectRef& ref);
@@ -176,21 +204,24 @@ public:
                                uint64_t kernel_object, hsa_agent_t agent, uint32_t kernarg_size);
     bool isKernelFromExcludedFile(uint64_t kernel_object, const class LibraryFilter& filter);
 private:
+    bool loadFile(const std::string& name, hsa_agent_t agent, const std::string& strFilter, coCacheBatch_t& batch);
+    void publish(coCacheBatch_t& batch);
     bool resolveRuntimeArgDescriptors(hsa_agent_t agent);
     HsaApiTable *apiTable_;
     hsa_ven_amd_loader_1_01_pfn_t loader_api_;
     std::map<hsa_agent_t, std::vector<hsa_executable_symbol_t>, hsa_cmp<hsa_agent_t>> kernels_;
     std::vector<std::string> filelist_;
-    std::map<hsa_agent_t, std::map<std::string, hsa_executable_symbol_t>, hsa_cmp<hsa_agent_t>> lookup_map_;
-    std::map<hsa_agent_t, std::map<std::string, arg_descriptor_t>, hsa_cmp<hsa_agent_t>> arg_map_;
+    // Per-kernel maps are keyed by interned demangled name (see kernel_names.h)
+    std::map<hsa_agent_t, std::map<kernel_name_id_t, hsa_executable_symbol_t>, hsa_cmp<hsa_agent_t>> lookup_map_;
+    std::map<hsa_agent_t, std::map<kernel_name_id_t, arg_descriptor_t>, hsa_cmp<hsa_agent_t>> arg_map_;
     std::mutex mutex_;
     std::string location_;
     std::map<hsa_agent_t, cache_object_t, hsa_cmp<hsa_agent_t>> cache_objects_;
     std::map<hsa_agent_t, std::map<hsa_executable_symbol_t, uint64_t, hsa_cmp<hsa_executable_symbol_t>>, hsa_cmp<hsa_agent_t>> alternatives_;
     std::map<uint64_t, uint32_t> kernarg_sizes_;
-    std::map<hsa_agent_t, std::map<std::string, CodeObjectRef>, hsa_cmp<hsa_agent_t>> kernel_co_map_;
+    std::map<hsa_agent_t, std::map<kernel_name_id_t, CodeObjectRef>, hsa_cmp<hsa_agent_t>> kernel_co_map_;
     // Runtime kernel objects: agent -> (name -> kernel_object address) for resolveRuntimeArgDescriptors
-    std::map<hsa_agent_t, std::map<std::string, uint64_t>, hsa_cmp<hsa_agent_t>> runtime_kernel_objects_;
+    std::map<hsa_agent_t, std::map<kernel_name_id_t, uint64_t>, hsa_cmp<hsa_agent_t>> runtime_kernel_objects_;
     // Cache: executable.handle -> whether it comes from an excluded file
     std::map<uint64_t, bool> excluded_executable_cache_;
 };
@@ -205,23 +236,14 @@ public:
 private:
     std::string get_metadata_string(amd_comgr_metadata_node_t node);
     void computeKernargData(amd_comgr_metadata_node_t exec_map);
+    void findDualPathMarkers(amd_comgr_data_t executable);
     std::map<std::string, arg_descriptor_t> kernels_;
+    std::set<std::string> dual_path_kernels_;
+    siteManifestMap_t site_manifests_;
+    deviceHeatmapMap_t device_heatmaps_;
 
 };
 
-class logDuration{
-public:
-    logDuration();
-    logDuration(std::string& location);
-    ~logDuration();
-    void log(std::string& kernelName, uint64_t dispatchTime, uint64_t startNs, uint64_t endNs);
-    bool setLocation(const std::string& strLocation);
-    void logHeaders();
-private:
-    std::ostream *log_file_;
-    std::string location_;
-};
-
 class handlerManager{
 public:
     handlerManager();
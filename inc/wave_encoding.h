@@ -0,0 +1,138 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* Host side of the wave-compressed address messages emitted by the address instrumentation plugin when
+ * INSTRUMENTATION_WAVE_ENCODING is set at compile time. Before submitting the addresses of a load or
+ * store, each wave picks one of these encodings:
+ *
+ *   affine      every active lane accesses base + stride * (lane - first active lane)
+ *               items: exec mask, base, stride
+ *   dictionary  at most WAVE_DICTIONARY_SIZE distinct addresses
+ *               items: exec mask, bit 0 and bit 1 of every lane's index (one 64-bit mask each), then
+ *               the distinct addresses in index order
+ *   raw         one address per active lane, as without the option
+ *
+ * An encoded message is only sent when it has fewer items than the wave has active lanes, by as many
+ * lanes as it has items, so the wave header's exec mask is not that of the access. Its DWARF column
+ * packs:
+ *
+ *   bits  0..25  source column
+ *   bits 26..28  encoding
+ *   bit  29      WAVE_ENCODING_COLUMN_FLAG
+ *
+ * Affine summaries and access groups are never encoded. The layout must match
+ * src/instrumentation/AMDGCNSubmitAddressMessages.cpp. */
+
+const uint32_t WAVE_ENCODING_COLUMN_FLAG = 0x20000000u;
+const uint32_t WAVE_ENCODING_COLUMN_MASK = 0x3ffffffu;
+const uint32_t WAVE_ENCODING_SHIFT = 26;
+const uint32_t WAVE_ENCODING_MASK = 0x7u;
+const uint32_t WAVE_ENCODING_RAW = 0;
+const uint32_t WAVE_ENCODING_AFFINE = 1;
+const uint32_t WAVE_ENCODING_DICTIONARY = 2;
+const size_t WAVE_DICTIONARY_SIZE = 4;
+// Exec mask and the two index bit planes
+const size_t WAVE_DICTIONARY_HEADER_ITEMS = 3;
+const size_t WAVE_AFFINE_ITEMS = 3;
+
+inline bool isWaveEncoded(uint32_t dwarf_column)
+{
+    // Bits 30 and 31 flag access groups and affine summaries, which have their own column layouts
+    return (dwarf_column & 0xe0000000u) == WAVE_ENCODING_COLUMN_FLAG;
+}
+
+inline uint32_t waveEncoding(uint32_t dwarf_column)
+{
+    return isWaveEncoded(dwarf_column) ? (dwarf_column >> WAVE_ENCODING_SHIFT) & WAVE_ENCODING_MASK
+                                       : WAVE_ENCODING_RAW;
+}
+
+// The DWARF column of an address message, encoded or not
+inline uint32_t waveEncodingColumn(uint32_t dwarf_column)
+{
+    return isWaveEncoded(dwarf_column) ? dwarf_column & WAVE_ENCODING_COLUMN_MASK : dwarf_column;
+}
+
+/* Decodes the items of an encoded address message into exec, the exec mask of the access, and addresses,
+ * one per lane set in exec, in lane order. Returns false if the items don't make up a message of the
+ * encoding in dwarf_column. */
+bool decodeWaveAddresses(uint32_t dwarf_column, const uint64_t *items, size_t count, uint64_t& exec,
+                         std::vector<uint64_t>& addresses);
+
+/* The encoding the device picks for the addresses of the active lanes of exec, in lane order: fills items
+ * and returns the DWARF column to send with them. A model of the plugin's device code, for tests and
+ * benchmarks. */
+uint32_t encodeWaveAddresses(uint32_t dwarf_column, uint64_t exec, const std::vector<uint64_t>& addresses,
+                             std::vector<uint64_t>& items);
+
+/* An address message as handlers expect it: the exec mask, DWARF column and active lane count of its wave
+ * header and its data items are those of the access, whether the message was encoded or not. Unencoded
+ * messages are passed through without copying their data items. Message is dh_comms::message_t, or
+ * anything with the same wave_header(), no_data_items(), data_item_size() and data_item(). */
+template<typename Message>
+class waveAddressView {
+public:
+    typedef std::decay_t<decltype(std::declval<const Message&>().wave_header())> header_t;
+
+    explicit waveAddressView(const Message& message) : message_(message), header_(message.wave_header())
+    {
+        if (!isWaveEncoded(header_.dwarf_column))
+            return;
+        encoded_ = true;
+        uint64_t items[WAVE_DICTIONARY_HEADER_ITEMS + WAVE_DICTIONARY_SIZE];
+        size_t count = message.no_data_items();
+        uint64_t exec = 0;
+        if (count <= sizeof(items) / sizeof(items[0]))
+        {
+            for (size_t i = 0; i != count; ++i)
+                items[i] = *static_cast<const uint64_t *>(message.data_item(i));
+            valid_ = decodeWaveAddresses(header_.dwarf_column, items, count, exec, addresses_);
+        }
+        else
+            valid_ = false;
+        header_.exec = exec;
+        header_.active_lane_count = addresses_.size();
+        header_.dwarf_column = waveEncodingColumn(header_.dwarf_column);
+    }
+
+    // False if the message was encoded but couldn't be decoded; it then has no data items
+    bool valid() const { return valid_; }
+    bool encoded() const { return encoded_; }
+    const header_t& wave_header() const { return header_; }
+    size_t data_item_size() const { return encoded_ ? sizeof(uint64_t) : message_.data_item_size(); }
+    size_t no_data_items() const { return encoded_ ? addresses_.size() : message_.no_data_items(); }
+    const void *data_item(size_t i) const { return encoded_ ? &addresses_[i] : message_.data_item(i); }
+
+private:
+    const Message& message_;
+    header_t header_;
+    bool encoded_ = false;
+    bool valid_ = true;
+    std::vector<uint64_t> addresses_;
+};
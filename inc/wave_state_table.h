@@ -0,0 +1,164 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Identifies a wave by its workgroup and its index within the workgroup. All fields are the same
+// width so the struct has no padding.
+typedef struct {
+    uint32_t block_x_;
+    uint32_t block_y_;
+    uint32_t block_z_;
+    uint32_t wave_id_;
+}waveIdentifier_t;
+
+/* Open addressing (linear probing) hash table from waveIdentifier_t to per-wave state. Handlers
+ * look up the state of the wave that sent every single message, so this replaces a std::map with a
+ * memcmp comparator: one multiply-shift hash and, typically, one probe into a flat array instead of
+ * ~log2(waves) pointer-chasing comparisons. Erase uses backward shift deletion, so there are no
+ * tombstones and lookups stay short however many waves come and go over a dispatch.
+ *
+ * Pointers returned by find()/insert() are invalidated by any subsequent insert() or erase(). */
+template<typename T>
+class waveStateTable {
+public:
+    explicit waveStateTable(size_t initial_capacity = 1024)
+    {
+        size_t capacity = 16;
+        while (capacity < initial_capacity)
+            capacity <<= 1;
+        slots_.resize(capacity);
+    }
+
+    T *find(const waveIdentifier_t& wave)
+    {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash(wave) & mask; slots_[i].used_; i = (i + 1) & mask)
+            if (equal(slots_[i].key_, wave))
+                return &slots_[i].value_;
+        return nullptr;
+    }
+
+    // Inserts or overwrites the state for wave
+    T *insert(const waveIdentifier_t& wave, const T& value)
+    {
+        if ((size_ + 1) * 2 > slots_.size())
+            grow();
+        size_t mask = slots_.size() - 1;
+        size_t i = hash(wave) & mask;
+        for (; slots_[i].used_; i = (i + 1) & mask)
+        {
+            if (equal(slots_[i].key_, wave))
+            {
+                slots_[i].value_ = value;
+                return &slots_[i].value_;
+            }
+        }
+        slots_[i].used_ = true;
+        slots_[i].key_ = wave;
+        slots_[i].value_ = value;
+        size_++;
+        return &slots_[i].value_;
+    }
+
+    bool erase(const waveIdentifier_t& wave)
+    {
+        size_t mask = slots_.size() - 1;
+        size_t i = hash(wave) & mask;
+        for (; slots_[i].used_; i = (i + 1) & mask)
+            if (equal(slots_[i].key_, wave))
+                break;
+        if (!slots_[i].used_)
+            return false;
+        // Shift back any entries in the probe run that would otherwise become unreachable
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask; slots_[j].used_; j = (j + 1) & mask)
+        {
+            size_t home = hash(slots_[j].key_) & mask;
+            // Move j into the hole unless its home lies cyclically in (hole, j]
+            bool reachable = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+            if (!reachable)
+            {
+                slots_[hole] = slots_[j];
+                hole = j;
+            }
+        }
+        slots_[hole].used_ = false;
+        size_--;
+        return true;
+    }
+
+    void clear()
+    {
+        for (auto& slot : slots_)
+            slot.used_ = false;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    template<typename F>
+    void forEach(F fn)
+    {
+        for (auto& slot : slots_)
+            if (slot.used_)
+                fn(slot.key_, slot.value_);
+    }
+
+private:
+    typedef struct {
+        waveIdentifier_t key_;
+        bool used_;
+        T value_;
+    }slot_t;
+
+    static bool equal(const waveIdentifier_t& a, const waveIdentifier_t& b)
+    {
+        return a.block_x_ == b.block_x_ && a.block_y_ == b.block_y_ &&
+               a.block_z_ == b.block_z_ && a.wave_id_ == b.wave_id_;
+    }
+
+    static size_t hash(const waveIdentifier_t& wave)
+    {
+        uint64_t h = (static_cast<uint64_t>(wave.block_x_) << 32) | wave.block_y_;
+        h ^= ((static_cast<uint64_t>(wave.block_z_) << 32) | wave.wave_id_) * 0x9e3779b97f4a7c15ull;
+        h *= 0xff51afd7ed558ccdull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    void grow()
+    {
+        std::vector<slot_t> old;
+        old.swap(slots_);
+        slots_.resize(old.size() * 2);
+        size_ = 0;
+        for (auto& slot : old)
+            if (slot.used_)
+                insert(slot.key_, slot.value_);
+    }
+
+    std::vector<slot_t> slots_;
+    size_t size_ = 0;
+};
@@ -25,5 +25,10 @@
         "description": "Analyze memory access efficiency",
         "lib_name": "libBasicBlocks64.so",
         "llvm_plugin": "libAMDGCNSubmitBBStart-triton.so" 
+    },
+    {
+        "name": "Python",
+        "description": "Hand address and time messages to a Python module (--python-module)",
+        "lib_name": "libPythonHandler64.so"
     }
 ]
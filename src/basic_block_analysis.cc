@@ -33,27 +33,6 @@ THE SOFTWARE.
 
 std::atomic<bool> basic_block_analysis::banner_displayed_ = false;
 
-double calculatePercentile(std::vector<double>& data, double percentile) {
-    if (data.empty()) return 0.0;
-    size_t n = data.size();
-
-    // Sort the vector
-    std::sort(data.begin(), data.end());
-
-    // Calculate index for the percentile
-    double index = percentile * (n - 1);
-    size_t lower = static_cast<size_t>(index);
-    double fraction = index - lower;
-
-    // If index is exact, return the value
-    if (fraction == 0.0) {
-        return data[lower];
-    }
-
-    // Linear interpolation between lower and upper elements
-    return data[lower] + fraction * (data[lower + 1] - data[lower]);
-}
-
 std::vector<std::string> readFileLines(const std::string& filename, uint32_t startLine, uint32_t endLine) {
     std::vector<std::string> lines;
 
@@ -137,6 +116,7 @@ basic_block_analysis::basic_block_analysis(const std::string& strKernel, uint64_
       dispatch_id_(dispatch_id),
       current_block_(nullptr),
       start_time_(0),
+      blocks_loaded_(false),
       location_(strLocation)
 {
     message_count_ = 0;
@@ -255,75 +235,85 @@ void basic_block_analysis::renderComputeResources(std::ostream& out, const std::
 
 bool basic_block_analysis::handle(const dh_comms::message_t &message)
 {
+    auto hdr = message.wave_header();
+    if (hdr.user_type == dh_comms::message_type::time_interval && isTimingRegion(hdr.user_data))
+    {
+        // Regions carry their own source range, so unlike blocks they don't need kernelDB
+        message_count_++;
+        updateComputeResources(hdr);
+        dh_comms::time_interval ti = *(const dh_comms::time_interval *)message.data_item(0);
+        regions_.record(hdr.user_data, hdr.dwarf_fname_hash, hdr.dwarf_line, hdr.dwarf_column, countSetBits(hdr.exec),
+                        ti.stop > ti.start ? ti.stop - ti.start : 0);
+        return true;
+    }
+
     if (!kdb_p_)
         return true;
 
     bool bReturn = true;
     message_count_++;
-    auto hdr = message.wave_header();
     waveIdentifier_t wave = {hdr.block_idx_x, hdr.block_idx_y, hdr.block_idx_z, hdr.wave_num};
     updateComputeResources(hdr);
 
     try
     {
+        if (!blocks_loaded_)
+            loadBlocks();
         uint32_t block_idx = hdr.user_data;
-        auto& thisKernel = kdb_p_->getKernel(kernel_name_);
-        const auto& blocks = thisKernel.getBasicBlocks();
-        assert(block_idx < blocks.size());
-        kernelDB::basicBlock *thisBlock = blocks[block_idx].get();
-        auto& instructions = thisBlock->getInstructions();
-        if (instructions.size())
+        assert(block_idx < blocks_.size());
+        if (block_idx >= blocks_.size())
+            return false;
+        if (block_flags_[block_idx] & BLOCK_HAS_INSTRUCTIONS)
         {
-            std::set<kernelDB::basicBlock *> blocks;
-            for (auto& in : instructions)
-                blocks_seen_.insert(in.block_);
-            auto biit = block_info_.find(thisBlock);
             if (hdr.user_type == dh_comms::message_type::time_interval)
             {
                 assert(false); // Should not be getting here
                 dh_comms::time_interval ti = *(const dh_comms::time_interval *)message.data_item(0);
-                if (biit != block_info_.end())
+                blockInfo_t& info = block_info_[block_idx];
+                if (info.count_)
                 {
-                    biit->second.count_++;
-                    biit->second.thread_count_ += countSetBits(hdr.exec);
-                    biit->second.duration_ += ti.stop - ti.start;
+                    info.count_++;
+                    info.thread_count_ += countSetBits(hdr.exec);
+                    info.duration_ += ti.stop - ti.start;
                 }
                 else
                 {
-                    block_info_[thisBlock] = {countSetBits(hdr.exec), 1, ti.stop - ti.start, hdr.dwarf_line};
+                    info = {countSetBits(hdr.exec), 1, ti.stop - ti.start, hdr.dwarf_line};
                 }
             }
             else
             {
-                auto wsit = wave_states_.find(wave);
-                if (wsit != wave_states_.end())
+                wave_state_t *state = wave_states_.find(wave);
+                if (state)
                 {
-                    biit = block_info_.find(wsit->second.current_block_);
-                    if (biit != block_info_.end())
+                    uint64_t elapsed = hdr.timestamp - state->start_time_;
+                    blockInfo_t& info = block_info_[state->current_block_];
+                    block_durations_[state->current_block_].record(elapsed);
+                    if (info.count_)
                     {
-                        biit->second.count_+= wsit->second.count_;
-                        biit->second.thread_count_ += countSetBits(hdr.exec);
-                        biit->second.duration_ += hdr.timestamp - wsit->second.start_time_;
+                        info.count_+= state->count_;
+                        info.thread_count_ += countSetBits(hdr.exec);
+                        info.duration_ += elapsed;
                     }
                     else
                     {
-                        block_info_[wsit->second.current_block_] = {countSetBits(hdr.exec), 1, hdr.timestamp - wsit->second.start_time_};
+                        info = {countSetBits(hdr.exec), 1, elapsed, 0};
                     }
 
-                    if (instructions[instructions.size() - 1].inst_ == "s_endpgm")
+                    if (block_flags_[block_idx] & BLOCK_ENDS_PROGRAM)
                     {
-                        wave_states_.erase(wsit);
+                        wave_states_.erase(wave);
                     }
                     else
                     {
-                        wsit->second.current_block_ = thisBlock;
-                        wsit->second.start_time_ = hdr.timestamp;
-                        wsit->second.count_ = 1;
+                        state->current_block_ = block_idx;
+                        state->start_time_ = hdr.timestamp;
+                        state->count_ = 1;
                     }
                 }
                 else
                 {
-                    wave_states_[wave] = {thisBlock, hdr.timestamp, 1};
+                    wave_states_.insert(wave, {block_idx, hdr.timestamp, 1});
                 }
             }
         }
@@ -336,6 +326,31 @@ bool basic_block_analysis::handle(const dh_comms::message_t &message)
     return bReturn;
 }
 
+// Basic blocks are numbered densely by their index in the kernel's block list, which is also what the
+// instrumentation sends in user_data. Everything we need per block on the message path is pulled out of
+// kernelDB once here so that handle() only indexes flat arrays.
+void basic_block_analysis::loadBlocks()
+{
+    auto& thisKernel = kdb_p_->getKernel(kernel_name_);
+    const auto& blocks = thisKernel.getBasicBlocks();
+    blocks_.resize(blocks.size());
+    block_flags_.assign(blocks.size(), 0);
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        blocks_[i] = blocks[i].get();
+        auto& instructions = blocks_[i]->getInstructions();
+        if (instructions.size())
+        {
+            block_flags_[i] |= BLOCK_HAS_INSTRUCTIONS;
+            if (instructions[instructions.size() - 1].inst_ == "s_endpgm")
+                block_flags_[i] |= BLOCK_ENDS_PROGRAM;
+        }
+    }
+    block_info_.assign(blocks.size(), blockInfo_t{});
+    block_durations_.assign(blocks.size(), quantileSketch());
+    blocks_loaded_ = true;
+}
+
 void basic_block_analysis::setupLogger()
 {
     if (location_ == "console")
@@ -346,6 +361,12 @@ void basic_block_analysis::setupLogger()
 
 void basic_block_analysis::report()
 {
+    if (!regions_.empty())
+    {
+        const char* logDurLogFormat = std::getenv("LOGDUR_LOG_FORMAT");
+        reportRegions(!logDurLogFormat || std::string(logDurLogFormat) != "json");
+        return;
+    }
     if (!kdb_p_) {
         std::cerr << "omniprobe basic block analysis for kernel " << strKernel_ << " dispatch[" << std::dec << dispatch_id_ << "]\n";
         return;
@@ -365,16 +386,14 @@ void basic_block_analysis::report()
     renderComputeResources(*log_file_, "json");
     if (banner_displayed_.compare_exchange_strong(first_time, initialized))
         std::cerr << "omniprobe basic block analysis for kernel\n";
-    auto it = block_info_.begin();
     uint64_t duration = 0;
     uint64_t block_exec_count = 0;
     uint64_t thread_exec_count = 0;
-    while (it != block_info_.end())
+    for (const auto& info : block_info_)
     {
-        duration += it->second.duration_;
-        block_exec_count += it->second.count_;
-        thread_exec_count += it->second.thread_count_;
-        it++;
+        duration += info.duration_;
+        block_exec_count += info.count_;
+        thread_exec_count += info.thread_count_;
     }
     std::map<std::string, std::string> strings;
     std::map<std::string, uint64_t> bigints;
@@ -388,13 +407,17 @@ void basic_block_analysis::report()
         *log_file_ << "Kernel: " << strKernel_ << std::endl;
         *log_file_ << "Dispatch: " << dispatch_id_ << std::endl;
         *log_file_ << "Branchiness: " << 1.0 - ( (double) ((double)thread_exec_count / ((double)block_exec_count * 64.0))) << std::endl;
-        *log_file_  << "Start Line, End Line, Duration, FileName, Branchiness, Overhead, Count\n";
+        *log_file_  << "Start Line, End Line, Duration, FileName, Branchiness, Overhead, Count, P50 Duration, P90 Duration, P99 Duration\n";
     }
-    it = block_info_.begin();
-    while (it != block_info_.end())
+    for (size_t idx = 0; idx < block_info_.size(); idx++)
     {
+        // Blocks that were never timed have a zero count
+        const blockInfo_t& info = block_info_[idx];
+        if (!info.count_)
+            continue;
+        kernelDB::basicBlock *block = blocks_[idx];
         std::vector<std::string> isa, files;
-        auto instructions = it->first->getInstructions();
+        auto instructions = block->getInstructions();
         for (auto inst : instructions)
         {
             isa.push_back(inst.disassembly_);
@@ -403,16 +426,16 @@ void basic_block_analysis::report()
             if (ic != inst_counts.end())
             {
                 if (inst.inst_.starts_with("v_"))
-                    inst_counts[inst.inst_] += it->second.thread_count_;
+                    inst_counts[inst.inst_] += info.thread_count_;
                 else
-                    ic->second += it->second.count_;
+                    ic->second += info.count_;
             }
             else
             {
                 if (inst.inst_.starts_with("v_"))
-                    inst_counts[inst.inst_] = it->second.thread_count_;
+                    inst_counts[inst.inst_] = info.thread_count_;
                 else
-                    inst_counts[inst.inst_] = it->second.count_;
+                    inst_counts[inst.inst_] = info.count_;
             }
         }
         std::vector<std::pair<std::string, uint64_t>> inst_results(inst_counts.begin(), inst_counts.end());
@@ -431,17 +454,25 @@ void basic_block_analysis::report()
             doubles["kernel_branchiness"] = 1.0 - ( (double) ((double)thread_exec_count / ((double)block_exec_count * 64.0)));
             bigints["block_start_line"] = instructions[0].line_;
             bigints["block_end_line"] = instructions[instructions.size() - 1].line_;
-            bigints["block_duration"] = it->second.duration_;
+            bigints["block_duration"] = info.duration_;
             strings["kernel_file_name"] = kdb_p_->getFileName(kernel_name_, instructions[0].path_id_);
-            doubles["block_branchiness"] = 1.0 - ((double) ((double)it->second.thread_count_  / ((double) it->second.count_ * 64.0)));
-            doubles["block_overhead"] = (double)((double) it->second.duration_ / (double) duration);
-            doubles["block_count"] = it->second.count_;
+            doubles["block_branchiness"] = 1.0 - ((double) ((double)info.thread_count_  / ((double) info.count_ * 64.0)));
+            doubles["block_overhead"] = (double)((double) info.duration_ / (double) duration);
+            doubles["block_count"] = info.count_;
+            // Per-visit duration distribution for the block
+            const quantileSketch& visits = block_durations_[idx];
+            uint64_t p50 = static_cast<uint64_t>(visits.quantile(0.5));
+            uint64_t p90 = static_cast<uint64_t>(visits.quantile(0.9));
+            uint64_t p99 = static_cast<uint64_t>(visits.quantile(0.99));
+            bigints["block_duration_p50"] = p50;
+            bigints["block_duration_p90"] = p90;
+            bigints["block_duration_p99"] = p99;
             if (bFormatCsv)
             {
-                *log_file_ << instructions[0].line_ << "," << instructions[instructions.size() - 1].line_ << "," << it->second.duration_ << "," <<
-                    kdb_p_->getFileName(kernel_name_, instructions[0].path_id_) << "," <<  1.0 - ((double) ((double)it->second.thread_count_  / ((double) it->second.count_ * 64.0))) << "," <<
-                        (double)((double) it->second.duration_ / (double) duration)
-                            << "," << it->second.count_ << std::endl;
+                *log_file_ << instructions[0].line_ << "," << instructions[instructions.size() - 1].line_ << "," << info.duration_ << "," <<
+                    kdb_p_->getFileName(kernel_name_, instructions[0].path_id_) << "," <<  1.0 - ((double) ((double)info.thread_count_  / ((double) info.count_ * 64.0))) << "," <<
+                        (double)((double) info.duration_ / (double) duration)
+                            << "," << info.count_ << "," << p50 << "," << p90 << "," << p99 << std::endl;
             }
             else
             {
@@ -463,7 +494,111 @@ void basic_block_analysis::report()
             std::cerr << e.what() << std::endl;
         }
 
-        it++;
+    }
+    if (location_ != "console")
+    {
+        delete log_file_;
+        log_file_ = nullptr;
+    }
+}
+
+// Time per kernel and loop region. Each region's duration includes the regions nested in it; its self duration
+// doesn't, so the self durations of all regions add up to the kernel's and the overhead column says where the
+// kernel's time went.
+void basic_block_analysis::reportRegions(bool bFormatCsv)
+{
+    bool first_time = false, initialized = true;
+    setupLogger();
+    renderComputeResources(*log_file_, "json");
+    if (banner_displayed_.compare_exchange_strong(first_time, initialized))
+        std::cerr << "omniprobe basic block analysis for kernel\n";
+
+    // The messages only carry a hash of the file name; kernelDB knows the names of the kernel's source files
+    std::map<uint64_t, std::string> file_names;
+    if (kdb_p_)
+    {
+        try
+        {
+            auto& thisKernel = kdb_p_->getKernel(kernel_name_);
+            for (const auto& block : thisKernel.getBasicBlocks())
+                for (const auto& inst : block->getInstructions())
+                {
+                    std::string name = kdb_p_->getFileName(kernel_name_, inst.path_id_);
+                    file_names[std::hash<std::string>{}(name)] = name;
+                }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    uint64_t kernel_duration = regions_[0].duration_;
+    if (!kernel_duration)
+        for (size_t idx = 0; idx < regions_.size(); idx++)
+            kernel_duration += regions_.selfDuration(idx);
+
+    if (bFormatCsv)
+    {
+        *log_file_ << "Kernel: " << strKernel_ << std::endl;
+        *log_file_ << "Dispatch: " << dispatch_id_ << std::endl;
+        *log_file_ << "Region, Parent, Depth, Start Line, End Line, FileName, Duration, Self Duration, Overhead, Count, "
+                      "Branchiness, P50 Duration, P90 Duration, P99 Duration\n";
+    }
+    std::map<std::string, std::string> strings;
+    std::map<std::string, uint64_t> bigints;
+    std::map<std::string, double> doubles;
+    for (size_t idx = 0; idx < regions_.size(); idx++)
+    {
+        const timingRegionInfo_t& info = regions_[idx];
+        if (!info.count_)
+            continue;
+        auto name = file_names.find(info.fname_hash_);
+        std::string file_name = name != file_names.end() ? name->second : "unknown";
+        uint64_t self_duration = regions_.selfDuration(idx);
+        double overhead = kernel_duration ? (double)self_duration / (double)kernel_duration : 0.0;
+        double branchiness = 1.0 - ((double)info.thread_count_ / ((double)info.count_ * 64.0));
+        const quantileSketch& visits = regions_.durations(idx);
+        uint64_t p50 = static_cast<uint64_t>(visits.quantile(0.5));
+        uint64_t p90 = static_cast<uint64_t>(visits.quantile(0.9));
+        uint64_t p99 = static_cast<uint64_t>(visits.quantile(0.99));
+        if (bFormatCsv)
+        {
+            *log_file_ << idx << "," << info.parent_ << "," << info.depth_ << "," << info.start_line_ << "," <<
+                info.end_line_ << "," << file_name << "," << info.duration_ << "," << self_duration << "," <<
+                    overhead << "," << info.count_ << "," << branchiness << "," << p50 << "," << p90 << "," << p99 <<
+                        std::endl;
+        }
+        else
+        {
+            std::stringstream ss;
+            strings.clear();
+            bigints.clear();
+            doubles.clear();
+            strings["kernel"] = strKernel_;
+            strings["kernel_file_name"] = file_name;
+            strings["region_kind"] = info.depth_ ? "loop" : "kernel";
+            bigints["dispatch_id"] = dispatch_id_;
+            bigints["region"] = idx;
+            bigints["region_parent"] = info.parent_;
+            bigints["region_depth"] = info.depth_;
+            bigints["region_start_line"] = info.start_line_;
+            bigints["region_end_line"] = info.end_line_;
+            bigints["region_duration"] = info.duration_;
+            bigints["region_self_duration"] = self_duration;
+            bigints["region_count"] = info.count_;
+            bigints["region_duration_p50"] = p50;
+            bigints["region_duration_p90"] = p90;
+            bigints["region_duration_p99"] = p99;
+            doubles["region_overhead"] = overhead;
+            doubles["region_branchiness"] = branchiness;
+            ss << "{";
+            renderJSON(strings, ss, false);
+            renderJSON(bigints, ss, false);
+            renderJSON(doubles, ss, true);
+            ss << "}\n";
+            *log_file_ << ss.str();
+        }
     }
     if (location_ != "console")
     {
@@ -476,4 +611,5 @@ void basic_block_analysis::clear()
 {
     strKernel_ = "";
     dispatch_id_ = 0;
+    regions_.clear();
 }
@@ -0,0 +1,95 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/code_object_symbols.h"
+
+#include <elf.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+// The image need not be aligned, so ELF structures are copied out rather than accessed in place
+template<typename T>
+T readStruct(const uint8_t *p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+size_t forEachCloneSymbol(const void *image, size_t length, const char *suffix, const cloneSymbolVisitor_t& visit)
+{
+    // AMDGPU code objects are 64-bit little endian ELF files
+    const uint8_t *bytes = static_cast<const uint8_t *>(image);
+    if (length < sizeof(Elf64_Ehdr) || memcmp(bytes, ELFMAG, SELFMAG) != 0 || bytes[EI_CLASS] != ELFCLASS64)
+        return 0;
+    Elf64_Ehdr ehdr = readStruct<Elf64_Ehdr>(bytes);
+    if (ehdr.e_shentsize != sizeof(Elf64_Shdr) || ehdr.e_shoff > length ||
+        ehdr.e_shnum > (length - ehdr.e_shoff) / sizeof(Elf64_Shdr))
+        return 0;
+    std::vector<Elf64_Shdr> sections(ehdr.e_shnum);
+    for (uint16_t i = 0; i < ehdr.e_shnum; i++)
+        sections[i] = readStruct<Elf64_Shdr>(bytes + ehdr.e_shoff + i * sizeof(Elf64_Shdr));
+    auto inImage = [length](uint64_t offset, uint64_t size) {
+        return offset <= length && size <= length - offset;
+    };
+
+    size_t found = 0;
+    const size_t suffix_length = strlen(suffix);
+    for (uint16_t i = 0; i < ehdr.e_shnum; i++)
+    {
+        const Elf64_Shdr& symtab = sections[i];
+        if ((symtab.sh_type != SHT_SYMTAB && symtab.sh_type != SHT_DYNSYM) || symtab.sh_link >= ehdr.e_shnum ||
+            symtab.sh_entsize != sizeof(Elf64_Sym) || !inImage(symtab.sh_offset, symtab.sh_size))
+            continue;
+        const Elf64_Shdr& strtab = sections[symtab.sh_link];
+        if (!inImage(strtab.sh_offset, strtab.sh_size))
+            continue;
+        const char *names = reinterpret_cast<const char *>(bytes + strtab.sh_offset);
+        size_t symbol_count = symtab.sh_size / sizeof(Elf64_Sym);
+        for (size_t j = 0; j < symbol_count; j++)
+        {
+            Elf64_Sym sym = readStruct<Elf64_Sym>(bytes + symtab.sh_offset + j * sizeof(Elf64_Sym));
+            if (ELF64_ST_TYPE(sym.st_info) != STT_OBJECT || sym.st_shndx == SHN_UNDEF ||
+                sym.st_shndx >= ehdr.e_shnum || sym.st_name >= strtab.sh_size)
+                continue;
+            const char *name = names + sym.st_name;
+            size_t name_length = strnlen(name, strtab.sh_size - sym.st_name);
+            if (name_length <= suffix_length ||
+                memcmp(name + name_length - suffix_length, suffix, suffix_length) != 0)
+                continue;
+            // The symbol value is an address within its section
+            const Elf64_Shdr& section = sections[sym.st_shndx];
+            if (section.sh_type == SHT_NOBITS || sym.st_value < section.sh_addr ||
+                sym.st_value - section.sh_addr > section.sh_size)
+                continue;
+            uint64_t offset = section.sh_offset + (sym.st_value - section.sh_addr);
+            if (!inImage(offset, sym.st_size))
+                continue;
+            visit(std::string(name, name_length - suffix_length), bytes + offset, sym.st_size);
+            found++;
+        }
+    }
+    return found;
+}
@@ -22,6 +22,7 @@ THE SOFTWARE.
 #include "inc/comms_mgr.h"
 #include "inc/hsa_mem_mgr.h"
 #include "inc/memory_heatmap.h"
+#include "inc/message_recorder.h"
 #include "inc/time_interval_handler.h"
 
 comms_mgr::comms_mgr(HsaApiTable *pTable) : kern_arg_allocator_(pTable, std::cerr), pTable_(pTable)
@@ -49,9 +50,18 @@ void comms_mgr::setConfig(const std::map<std::string, std::string>& config)
             std::cerr << "HANDLER: " << h << std::endl;
         handler_mgr_.setHandlers(libs) ;
     }
+    it = config.find("LOGDUR_RECORD_MESSAGES");
+    if (it != config.end() && it->second.size())
+    {
+        auto writer = std::make_shared<messageRecordWriter>();
+        if (writer->open(it->second, sizeof(dh_comms::wave_header_t)))
+            recorder_ = writer;
+        else
+            std::cerr << "comms_mgr: unable to open " << it->second << " for LOGDUR_RECORD_MESSAGES" << std::endl;
+    }
 }
 
-dh_comms::dh_comms * comms_mgr::checkoutCommsObject(hsa_agent_t agent, std::string& strKernelName, uint64_t dispatch_id, kernelDB::kernelDB *kdb)
+dh_comms::dh_comms * comms_mgr::checkoutCommsObject(hsa_agent_t agent, kernel_name_id_t kernel, uint64_t dispatch_id, kernelDB::kernelDB *kdb, std::shared_ptr<const siteManifest> sites, const deviceHeatmapConfig_t& heatmap)
 {
     std::lock_guard<std::mutex> lock(mutex_);
     dh_comms::dh_comms_mem_mgr *mem_mgr = NULL;
@@ -59,38 +69,116 @@ dh_comms::dh_comms * comms_mgr::checkoutCommsObject(hsa_agent_t agent, std::stri
     if (it != mem_mgrs_.end())
     {
         mem_mgr = it->second;
+        // Handler plugins take the kernel name as a std::string, so this is where it gets materialized
+        std::string strKernelName(kernelNames().name(kernel));
         dh_comms::dh_comms *obj = new dh_comms::dh_comms(DH_SUB_BUFFER_COUNT, DH_SUB_BUFFER_CAPACITY, false, false, mem_mgr);
         std::vector<dh_comms::message_handler_base *> handlers;
+        std::vector<dh_comms::memory_heatmap_t *> heatmap_handlers;
+        // With telemetry on, every handler is timed and the first one in the chain counts the messages
+        bool timed = telemetryEnabled();
+        bool first = true;
+        auto append = [&](std::unique_ptr<dh_comms::message_handler_base> handler) {
+            if (timed)
+                handler = std::make_unique<telemetry_handler_t>(std::move(handler), first);
+            first = false;
+            obj->append_handler(std::move(handler));
+        };
         handler_mgr_.getMessageHandlers(strKernelName, dispatch_id, handlers);
+        message_loss_t loss;
+        for (auto it : handlers)
+        {
+            auto *kdb_handler = dynamic_cast<kdb_message_handler_base *>(it);
+            if (kdb_handler)
+                loss.handlers_.push_back(kdb_handler);
+        }
+        // The loss counter and the recorder go first so that they see every message before a handler claims it
+        if (loss.handlers_.size())
+        {
+            loss.loss_ = std::make_shared<messageLoss>(sites ? sites->size() : 0);
+            append(std::make_unique<loss_counter_handler_t>(loss.loss_));
+            message_losses_[obj] = loss;
+        }
+        if (recorder_)
+            append(std::make_unique<message_recorder_t>(recorder_, strKernelName, dispatch_id));
         if (handlers.size())
         {
             for(auto it : handlers)
             {
                 auto *kdb_handler = dynamic_cast<kdb_message_handler_base *>(it);
                 if (kdb_handler)
-                    kdb_handler->set_context(kdb, strKernelName);
-                auto tmp = std::unique_ptr<dh_comms::message_handler_base>(it);
-                obj->append_handler(std::move(tmp));
+                    kdb_handler->set_context(kdb, strKernelName, sites);
+                auto *heatmap_handler = dynamic_cast<dh_comms::memory_heatmap_t *>(it);
+                if (heatmap_handler)
+                    heatmap_handlers.push_back(heatmap_handler);
+                append(std::unique_ptr<dh_comms::message_handler_base>(it));
             }
         }
         else
         {
-            obj->append_handler(std::make_unique<dh_comms::memory_heatmap_t>(strKernelName, dispatch_id, "console"));
-            obj->append_handler(std::make_unique<dh_comms::time_interval_handler_t>(strKernelName, dispatch_id, "console", false));
+            auto heatmap_handler = std::make_unique<dh_comms::memory_heatmap_t>(strKernelName, dispatch_id, "console");
+            heatmap_handlers.push_back(heatmap_handler.get());
+            append(std::move(heatmap_handler));
+            append(std::make_unique<dh_comms::time_interval_handler_t>(strKernelName, dispatch_id, "console", false));
+        }
+        if (heatmap.page_shift_)
+        {
+            // The clone counts pages in a histogram of its own rather than sending address messages
+            if (heatmap_handlers.empty())
+                std::cerr << "comms_mgr: " << strKernelName << " was built with INSTRUMENTATION_HEATMAP, but no heatmap handler is loaded" << std::endl;
+            size_t length = deviceHeatmapBytes(heatmap);
+            std::vector<uint8_t> empty(length);
+            deviceHeatmapInit(heatmap, empty.data());
+            void *histogram = mem_mgr->calloc_device_memory(length);
+            mem_mgr->copy_to_device(histogram, empty.data(), length);
+            device_heatmaps_[obj] = {histogram, length, heatmap_handlers};
         }
         obj->start(strKernelName);
+        telemetryCount(TELEMETRY_COMMS_IN_USE);
         return obj;
 
     }
     return NULL;
 }
 
+void * comms_mgr::getInstrumentationBuffer(dh_comms::dh_comms *object)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = device_heatmaps_.find(object);
+    return it != device_heatmaps_.end() ? it->second.histogram_ : object->get_dev_rsrc_ptr();
+}
+
 bool comms_mgr::checkinCommsObject(hsa_agent_t agent, dh_comms::dh_comms *object)
 {
     std::lock_guard<std::mutex> lock(mutex_);
+    telemetryCount(TELEMETRY_COMMS_IN_USE, -1);
     try
     {
-        object->stop();
+        {
+            // stop() waits for the handler threads to get through the sub-buffers still in flight
+            telemetryTimer timer(TELEMETRY_COMMS_DRAIN_NS);
+            object->stop();
+        }
+        auto heatmap = device_heatmaps_.find(object);
+        if (heatmap != device_heatmaps_.end())
+        {
+            std::vector<uint8_t> histogram(heatmap->second.length_);
+            if (hsa_memory_copy(histogram.data(), heatmap->second.histogram_, histogram.size()) == HSA_STATUS_SUCCESS)
+            {
+                for (auto handler : heatmap->second.handlers_)
+                    handler->add_device_histogram(histogram.data(), histogram.size());
+            }
+            else
+                std::cerr << "comms_mgr: unable to copy back a device heatmap" << std::endl;
+            mem_mgrs_[agent]->free_device_memory(heatmap->second.histogram_);
+            device_heatmaps_.erase(heatmap);
+        }
+        auto loss = message_losses_.find(object);
+        if (loss != message_losses_.end())
+        {
+            for (auto handler : loss->second.handlers_)
+                handler->set_loss(loss->second.loss_);
+            message_losses_.erase(loss);
+        }
         object->report();
         object->delete_handlers();
         delete object;
@@ -171,6 +259,42 @@ default_message_handler::~default_message_handler()
     std::cerr << "Message Handler is cleaned up";
 }
 
+telemetry_handler_t::telemetry_handler_t(std::unique_ptr<dh_comms::message_handler_base> handler, bool count_messages)
+    : handler_(std::move(handler)), count_messages_(count_messages)
+{
+}
+
+loss_counter_handler_t::loss_counter_handler_t(std::shared_ptr<messageLoss> loss) : loss_(std::move(loss))
+{
+}
+
+bool loss_counter_handler_t::handle(const dh_comms::message_t& message)
+{
+    const dh_comms::wave_header_t& hdr = message.wave_header();
+    loss_->addDeliveredMessage(hdr.dwarf_fname_hash, hdr.dwarf_line);
+    // Not handled, so that the message still reaches the analysis handlers
+    return false;
+}
+
+bool telemetry_handler_t::handle(const dh_comms::message_t& message)
+{
+    if (count_messages_)
+        telemetryCount(TELEMETRY_MESSAGES);
+    telemetryCount(TELEMETRY_HANDLER_CALLS);
+    telemetryTimer timer(TELEMETRY_HANDLER_NS);
+    return handler_->handle(message);
+}
+
+void telemetry_handler_t::report()
+{
+    handler_->report();
+}
+
+void telemetry_handler_t::clear()
+{
+    handler_->clear();
+}
+
 bool default_message_handler::handle(const dh_comms::message_t& message)
 {
     std::cerr << "Message from " << strKernelName_ << " for dispatch id " << std::dec << dispatch_id_ << std::endl;
@@ -0,0 +1,88 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/device_heatmap.h"
+#include "inc/code_object_symbols.h"
+
+#include <string.h>
+
+bool parseDeviceHeatmapMarker(const void *data, size_t length, deviceHeatmapConfig_t& config)
+{
+    const size_t marker_size = 16;
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    if (length < marker_size || memcmp(bytes, DEVICE_HEATMAP_MAGIC, 4) != 0 ||
+        readLE<uint16_t>(bytes + 4) != DEVICE_HEATMAP_VERSION)
+        return false;
+    uint32_t page_shift = readLE<uint32_t>(bytes + 8);
+    uint32_t slot_count = readLE<uint32_t>(bytes + 12);
+    if (page_shift == 0 || page_shift >= 64 || slot_count == 0 || (slot_count & (slot_count - 1)) != 0)
+        return false;
+    config = {page_shift, slot_count};
+    return true;
+}
+
+size_t findDeviceHeatmaps(const void *image, size_t length, deviceHeatmapMap_t& heatmaps)
+{
+    size_t found = 0;
+    forEachCloneSymbol(image, length, DEVICE_HEATMAP_SUFFIX,
+                       [&](const std::string& clone, const uint8_t *data, size_t size) {
+        deviceHeatmapConfig_t config;
+        if (heatmaps.count(clone) || !parseDeviceHeatmapMarker(data, size, config))
+            return;
+        heatmaps[clone] = config;
+        found++;
+    });
+    return found;
+}
+
+void deviceHeatmapInit(const deviceHeatmapConfig_t& config, void *histogram)
+{
+    memset(histogram, 0, deviceHeatmapBytes(config));
+    deviceHeatmapHeader_t header = {};
+    header.page_shift_ = config.page_shift_;
+    header.slot_count_ = config.slot_count_;
+    memcpy(histogram, &header, sizeof(header));
+}
+
+bool deviceHeatmapMerge(const void *histogram, size_t length, uint64_t page_size,
+                        std::map<uint64_t, size_t>& page_counts, uint64_t& dropped)
+{
+    if (length < sizeof(deviceHeatmapHeader_t) || page_size == 0)
+        return false;
+    deviceHeatmapHeader_t header;
+    memcpy(&header, histogram, sizeof(header));
+    if (header.page_shift_ == 0 || header.page_shift_ >= 64 ||
+        header.slot_count_ > (length - sizeof(header)) / sizeof(deviceHeatmapSlot_t))
+        return false;
+
+    const uint8_t *slots = static_cast<const uint8_t *>(histogram) + sizeof(header);
+    for (uint32_t i = 0; i < header.slot_count_; i++)
+    {
+        deviceHeatmapSlot_t slot;
+        memcpy(&slot, slots + i * sizeof(slot), sizeof(slot));
+        if (slot.page_ == 0 || slot.count_ == 0)
+            continue;
+        uint64_t address = (slot.page_ - 1) << header.page_shift_;
+        page_counts[address / page_size * page_size] += slot.count_;
+    }
+    dropped = header.dropped_;
+    return true;
+}
@@ -0,0 +1,197 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/event_reactor.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <iostream>
+
+#define REACTOR_MAX_EVENTS 16
+
+eventReactor::eventReactor() : wakeups_(0)
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        perror("epoll_create1");
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0)
+        perror("eventfd");
+    else if (!addSource(stop_fd_, SOURCE_STOP, handler_t()))
+    {
+        close(stop_fd_);
+        stop_fd_ = -1;
+    }
+}
+
+eventReactor::~eventReactor()
+{
+    stop();
+    for (auto& it : sources_)
+    {
+        if (it.second.kind_ != SOURCE_FD)
+            close(it.first);
+    }
+    if (epoll_fd_ >= 0)
+        close(epoll_fd_);
+}
+
+bool eventReactor::start()
+{
+    if (epoll_fd_ < 0 || stop_fd_ < 0)
+        return false;
+    if (!thread_.joinable())
+        thread_ = std::thread(&eventReactor::run, this);
+    return true;
+}
+
+void eventReactor::stop()
+{
+    if (!thread_.joinable())
+        return;
+    notify(stop_fd_);
+    thread_.join();
+}
+
+bool eventReactor::addSource(int fd, source_kind_t kind, handler_t handler)
+{
+    if (epoll_fd_ < 0 || fd < 0)
+        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        std::cerr << "eventReactor: cannot watch fd " << fd << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    sources_[fd] = {kind, std::move(handler)};
+    return true;
+}
+
+bool eventReactor::watchFd(int fd, handler_t handler)
+{
+    return addSource(fd, SOURCE_FD, std::move(handler));
+}
+
+void eventReactor::unwatchFd(int fd)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sources_.find(fd);
+    if (it == sources_.end() || it->second.kind_ != SOURCE_FD)
+        return;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, NULL);
+    sources_.erase(it);
+}
+
+int eventReactor::addEvent(handler_t handler)
+{
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0)
+    {
+        perror("eventfd");
+        return -1;
+    }
+    if (!addSource(fd, SOURCE_EVENT, std::move(handler)))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int eventReactor::addTimer(uint64_t interval_ms, handler_t handler)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0)
+    {
+        perror("timerfd_create");
+        return -1;
+    }
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    if (interval_ms == 0 || timerfd_settime(fd, 0, &spec, NULL) != 0 || !addSource(fd, SOURCE_TIMER, std::move(handler)))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void eventReactor::notify(int event_fd)
+{
+    uint64_t one = 1;
+    // Only fails if the counter would overflow, in which case a wakeup is already pending
+    if (write(event_fd, &one, sizeof(one)) < 0)
+        return;
+}
+
+void eventReactor::run()
+{
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    bool stopping = false;
+    while (!stopping)
+    {
+        int count = epoll_wait(epoll_fd_, events, REACTOR_MAX_EVENTS, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            break;
+        }
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < count; i++)
+        {
+            int fd = events[i].data.fd;
+            source_t source;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = sources_.find(fd);
+                // Removed by an earlier handler in this batch
+                if (it == sources_.end())
+                    continue;
+                source = it->second;
+            }
+            if (source.kind_ != SOURCE_FD)
+            {
+                // Both eventfd and timerfd reset to zero on read
+                uint64_t counter;
+                if (read(fd, &counter, sizeof(counter)) != sizeof(counter))
+                    continue;
+            }
+            if (source.kind_ == SOURCE_STOP)
+                stopping = true;
+            else if (source.handler_)
+                source.handler_();
+        }
+    }
+}
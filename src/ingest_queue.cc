@@ -0,0 +1,146 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/ingest_queue.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+ingestQueue::ingestQueue(ingest_t ingest, uint64_t debounce_ms, size_t threads)
+    : ingest_(std::move(ingest)), debounce_(debounce_ms), stopping_(false), stats_({0, 0, 0})
+{
+    if (!threads)
+        threads = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, INGEST_MAX_THREADS);
+    for (size_t i = 0; i < threads; i++)
+        workers_.emplace_back(&ingestQueue::worker, this);
+}
+
+ingestQueue::~ingestQueue()
+{
+    stop();
+}
+
+void ingestQueue::enqueue(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+        return;
+    stats_.enqueued_++;
+    auto due = std::chrono::steady_clock::now() + debounce_;
+    auto it = entries_.find(path);
+    if (it == entries_.end())
+        entries_[path] = {due, false, false};
+    else
+    {
+        stats_.coalesced_++;
+        if (it->second.running_)
+            it->second.again_ = true;
+        else
+            it->second.due_ = due;
+    }
+    work_cv_.notify_one();
+}
+
+bool ingestQueue::drain(uint64_t timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return idle_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return entries_.empty(); });
+}
+
+void ingestQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto it = entries_.begin(); it != entries_.end();)
+        {
+            if (it->second.running_)
+                it++;
+            else
+                it = entries_.erase(it);
+        }
+        work_cv_.notify_all();
+    }
+    for (auto& worker : workers_)
+        worker.join();
+    workers_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    idle_cv_.notify_all();
+}
+
+ingestQueue::ingest_stats_t ingestQueue::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ingestQueue::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+        // Deadlines only ever move later, so the earliest one among the waiting paths is the next to run
+        auto next = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); it++)
+        {
+            if (!it->second.running_ && (next == entries_.end() || it->second.due_ < next->second.due_))
+                next = it;
+        }
+        if (next == entries_.end())
+        {
+            work_cv_.wait(lock);
+            continue;
+        }
+        if (next->second.due_ > std::chrono::steady_clock::now())
+        {
+            // By value: the entry may be erased or rescheduled while we sleep
+            auto due = next->second.due_;
+            work_cv_.wait_until(lock, due);
+            continue;
+        }
+        next->second.running_ = true;
+        std::string path = next->first;
+        lock.unlock();
+        try
+        {
+            ingest_(path);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Unable to ingest " << path << ": " << e.what() << std::endl;
+        }
+        lock.lock();
+        stats_.ingested_++;
+        // Only the worker that set running_ removes the entry, so it is still there
+        auto it = entries_.find(path);
+        if (it->second.again_)
+        {
+            it->second = {std::chrono::steady_clock::now() + debounce_, false, false};
+            work_cv_.notify_one();
+        }
+        else
+            entries_.erase(it);
+        if (entries_.empty())
+            idle_cv_.notify_all();
+    }
+}
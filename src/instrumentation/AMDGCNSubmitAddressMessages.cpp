@@ -24,7 +24,11 @@ THE SOFTWARE.
 #include "InstrumentationCommon.h"
 #include "utils.h"
 
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/IR/PassManager.h"
@@ -32,6 +36,8 @@ THE SOFTWARE.
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
 #include <iostream>
 #include <vector>
 
@@ -39,9 +45,13 @@ THE SOFTWARE.
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
 #include <cstdlib>
 #include <dlfcn.h>
 #include <limits.h>
+#include <map>
+#include <set>
+#include <tuple>
 #include <type_traits>
 #include <unistd.h>
 
@@ -84,19 +94,9 @@ bool isAMDGCNBufferStore(const CallInst *CI) {
          Name.starts_with("llvm.amdgcn.struct.ptr.buffer.store");
 }
 
-// Instrumentation function for buffer intrinsics
-void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
-                                         const Function &F, llvm::Module &M,
-                                         uint32_t &LocationCounter,
-                                         llvm::Value *Ptr, bool IsLoad,
-                                         bool PrintLocationInfo) {
-  auto &CTX = M.getContext();
-  auto CI = dyn_cast<CallInst>(I);
-  if (!CI)
-    return;
-
-  IRBuilder<> Builder(CI);
-
+// The address a buffer intrinsic accesses, as an i64
+Value *bufferIntrinsicAddress(CallInst *CI, IRBuilder<> &Builder,
+                              bool IsLoad) {
   // For buffer intrinsics:
   // - Load:  buffer_load(buffer_desc, offset, ...)
   // - Store: buffer_store(data, buffer_desc, offset, ...)
@@ -118,7 +118,7 @@ void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
 
   if (!OrigPtr) {
     // Fallback if we can't trace the original pointer - use null pointer
-    OrigPtr = ConstantPointerNull::get(PointerType::get(CTX, 1));
+    OrigPtr = ConstantPointerNull::get(PointerType::get(CI->getContext(), 1));
   }
 
   // Calculate the actual address by adding the byte offset to the base pointer
@@ -126,7 +126,217 @@ void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
   // representation
   Value *PtrAsInt = Builder.CreatePtrToInt(OrigPtr, Builder.getInt64Ty());
   Value *OffsetExt = Builder.CreateSExt(Offset, Builder.getInt64Ty());
-  Value *ActualAddrInt = Builder.CreateAdd(PtrAsInt, OffsetExt);
+  return Builder.CreateAdd(PtrAsInt, OffsetExt);
+}
+
+// Wave-compressed address messages. When INSTRUMENTATION_WAVE_ENCODING is set
+// to anything other than "0" at compile time, each wave looks at the addresses
+// of its active lanes before submitting them and picks one of:
+//
+// - affine: every lane accesses base + stride * (lane - first active lane);
+//   items: exec mask, base, stride
+// - dictionary: at most WaveDictionarySize distinct addresses; items: exec
+//   mask, bit 0 and bit 1 of every lane's index into the dictionary as two
+//   ballots, then the distinct addresses in the order of their first lane
+// - raw: one address per active lane, as without the option
+//
+// The encoded items are submitted by as many of the active lanes as there are
+// items, and only if that is fewer than the active lanes; the DWARF column then
+// carries WaveEncodingColumnFlag and the encoding. Accesses whose column
+// doesn't fit below the flag, affine summaries and access groups are never
+// encoded. The layout must match inc/wave_encoding.h on the host side.
+constexpr uint32_t WaveEncodingColumnFlag = 0x20000000;
+constexpr uint32_t WaveEncodingColumnLimit = 1u << 26;
+constexpr uint32_t WaveEncodingShift = 26;
+constexpr uint32_t WaveEncodingAffine = 1;
+constexpr uint32_t WaveEncodingDictionary = 2;
+constexpr uint32_t WaveDictionarySize = 4;
+// Exec mask and two more items, base and stride or the two index bit planes
+constexpr uint32_t WaveEncodingHeaderItems = 3;
+
+bool waveEncodingEnabled() {
+  const char *Env = std::getenv("INSTRUMENTATION_WAVE_ENCODING");
+  return Env != nullptr && std::string(Env) != "0";
+}
+
+// Reads the i64 V from lane Lane, as two 32-bit readlanes
+static Value *readLane64(IRBuilder<> &Builder, Value *V, Value *Lane) {
+  Type *Int32Ty = Builder.getInt32Ty();
+  // readlane is overloaded on its type in newer LLVM versions only
+  SmallVector<Type *, 1> Types;
+  if (Intrinsic::isOverloaded(Intrinsic::amdgcn_readlane))
+    Types.push_back(Int32Ty);
+  Lane = Builder.CreateTrunc(Lane, Int32Ty);
+  Value *Lo = Builder.CreateIntrinsic(Intrinsic::amdgcn_readlane, Types,
+                                      {Builder.CreateTrunc(V, Int32Ty), Lane});
+  Value *Hi = Builder.CreateIntrinsic(
+      Intrinsic::amdgcn_readlane, Types,
+      {Builder.CreateTrunc(Builder.CreateLShr(V, 32), Int32Ty), Lane});
+  return Builder.CreateOr(
+      Builder.CreateShl(Builder.CreateZExt(Hi, Builder.getInt64Ty()), 32),
+      Builder.CreateZExt(Lo, Builder.getInt64Ty()));
+}
+
+// Emits the v_submit_address call for the access I with the arguments Args,
+// in which Args[1] is the address and Args[4] the DWARF column DbgColumn. With
+// WaveEncoding set, the wave encodes its addresses first as described above;
+// this splits the block of I.
+void SubmitAddressMessage(Instruction *I, FunctionCallee Submit,
+                          ArrayRef<Value *> Args, uint32_t DbgColumn,
+                          bool WaveEncoding) {
+  IRBuilder<> Builder(I);
+  if (!WaveEncoding || DbgColumn >= WaveEncodingColumnLimit) {
+    Builder.CreateCall(Submit, Args);
+    return;
+  }
+  LLVMContext &CTX = I->getContext();
+  Type *Int64Ty = Builder.getInt64Ty();
+  Type *Int32Ty = Builder.getInt32Ty();
+  auto ballot = [&](Value *Cond) {
+    return Builder.CreateIntrinsic(Intrinsic::amdgcn_ballot, {Int64Ty},
+                                   {Cond});
+  };
+  auto cttz = [&](Value *Mask) {
+    return Builder.CreateIntrinsic(Intrinsic::cttz, {Int64Ty},
+                                   {Mask, Builder.getFalse()});
+  };
+  // Number of lanes of Mask below the current lane
+  auto lanesBelow = [&](Value *Mask) {
+    Value *Lo = Builder.CreateIntrinsic(
+        Intrinsic::amdgcn_mbcnt_lo, {},
+        {Builder.CreateTrunc(Mask, Int32Ty), Builder.getInt32(0)});
+    return Builder.CreateIntrinsic(
+        Intrinsic::amdgcn_mbcnt_hi, {},
+        {Builder.CreateTrunc(Builder.CreateLShr(Mask, 32), Int32Ty), Lo});
+  };
+
+  Value *Addr = Builder.CreatePtrToInt(Args[1], Int64Ty, "wave.addr");
+  Value *Exec = ballot(Builder.getTrue());
+  Value *Lane =
+      Builder.CreateZExt(lanesBelow(Builder.getInt64(~0ull)), Int64Ty);
+  Value *Rank = Builder.CreateZExt(lanesBelow(Exec), Int64Ty, "wave.rank");
+  Value *Active = Builder.CreateIntrinsic(Intrinsic::ctpop, {Int64Ty}, {Exec});
+
+  // Affine: the stride is taken from the first two active lanes, then checked
+  // against all of them
+  Value *First = cttz(Exec);
+  Value *Base = readLane64(Builder, Addr, First);
+  Value *Rest =
+      Builder.CreateAnd(Exec, Builder.CreateSub(Exec, Builder.getInt64(1)));
+  Value *Second = Builder.CreateSelect(
+      Builder.CreateICmpEQ(Rest, Builder.getInt64(0)), First, cttz(Rest));
+  Value *Gap = Builder.CreateSub(Second, First);
+  Value *Stride = Builder.CreateSDiv(
+      Builder.CreateSub(readLane64(Builder, Addr, Second), Base),
+      Builder.CreateSelect(Builder.CreateICmpEQ(Gap, Builder.getInt64(0)),
+                           Builder.getInt64(1), Gap),
+      "wave.stride");
+  Value *Expected = Builder.CreateAdd(
+      Base, Builder.CreateMul(Stride, Builder.CreateSub(Lane, First)));
+  Value *Affine = Builder.CreateAnd(
+      Builder.CreateICmpEQ(ballot(Builder.CreateICmpNE(Addr, Expected)),
+                           Builder.getInt64(0)),
+      Builder.CreateICmpUGT(Active, Builder.getInt64(WaveEncodingHeaderItems)),
+      "wave.affine");
+
+  // Dictionary: each round takes the address of the first lane not matched
+  // yet as the next value, starting with the first active lane's
+  Value *Unmatched = Builder.CreateAnd(
+      Exec, Builder.CreateNot(ballot(Builder.CreateICmpEQ(Addr, Base))));
+  Value *Idx = Builder.getInt64(0);
+  Value *Distinct = Builder.getInt64(1);
+  SmallVector<Value *, WaveDictionarySize> Values = {Base};
+  for (uint32_t Round = 1; Round < WaveDictionarySize; Round++) {
+    Value *None = Builder.CreateICmpEQ(Unmatched, Builder.getInt64(0));
+    Value *Candidate = readLane64(
+        Builder, Addr, Builder.CreateSelect(None, First, cttz(Unmatched)));
+    Values.push_back(Candidate);
+    Value *Match = Builder.CreateICmpEQ(Addr, Candidate);
+    Value *WasUnmatched = Builder.CreateTrunc(
+        Builder.CreateLShr(Unmatched, Lane), Builder.getInt1Ty());
+    Idx = Builder.CreateSelect(Builder.CreateAnd(Match, WasUnmatched),
+                               Builder.getInt64(Round), Idx);
+    Distinct = Builder.CreateAdd(
+        Distinct, Builder.CreateZExt(Builder.CreateNot(None), Int64Ty));
+    Unmatched =
+        Builder.CreateAnd(Unmatched, Builder.CreateNot(ballot(Match)));
+  }
+  Value *DictionaryItems = Builder.CreateAdd(
+      Distinct, Builder.getInt64(WaveEncodingHeaderItems));
+  Value *Dictionary = Builder.CreateAnd(
+      Builder.CreateICmpEQ(Unmatched, Builder.getInt64(0)),
+      Builder.CreateICmpUGT(Active, DictionaryItems), "wave.dictionary");
+  Value *Plane0 = ballot(
+      Builder.CreateICmpNE(Builder.CreateAnd(Idx, 1), Builder.getInt64(0)));
+  Value *Plane1 = ballot(
+      Builder.CreateICmpNE(Builder.CreateAnd(Idx, 2), Builder.getInt64(0)));
+
+  // This lane's item, by its rank among the active lanes
+  Value *Item = Builder.CreateSelect(
+      Builder.CreateICmpEQ(Rank, Builder.getInt64(1)), Plane0,
+      Builder.CreateSelect(Builder.CreateICmpEQ(Rank, Builder.getInt64(2)),
+                           Plane1, Builder.getInt64(0)));
+  for (uint32_t V = 0; V < WaveDictionarySize; V++)
+    Item = Builder.CreateSelect(
+        Builder.CreateICmpEQ(
+            Rank, Builder.getInt64(WaveEncodingHeaderItems + V)),
+        Values[V], Item);
+  Item = Builder.CreateSelect(
+      Builder.CreateICmpEQ(Rank, Builder.getInt64(0)), Exec,
+      Builder.CreateSelect(Dictionary, Item, Addr));
+  Item = Builder.CreateSelect(
+      Affine,
+      Builder.CreateSelect(
+          Builder.CreateICmpEQ(Rank, Builder.getInt64(0)), Exec,
+          Builder.CreateSelect(Builder.CreateICmpEQ(Rank, Builder.getInt64(1)),
+                               Base, Stride)),
+      Item, "wave.item");
+  Value *Items = Builder.CreateSelect(
+      Affine, Builder.getInt64(WaveEncodingHeaderItems),
+      Builder.CreateSelect(Dictionary, DictionaryItems, Active), "wave.items");
+  Value *Column = Builder.CreateSelect(
+      Affine,
+      Builder.getInt32(DbgColumn | WaveEncodingColumnFlag |
+                       (WaveEncodingAffine << WaveEncodingShift)),
+      Builder.CreateSelect(
+          Dictionary,
+          Builder.getInt32(DbgColumn | WaveEncodingColumnFlag |
+                           (WaveEncodingDictionary << WaveEncodingShift)),
+          Builder.getInt32(DbgColumn)),
+      "wave.column");
+
+  // Only the lanes with an item submit
+  BasicBlock *Head = I->getParent();
+  BasicBlock *Done = Head->splitBasicBlock(I, "wave.done");
+  BasicBlock *Send = BasicBlock::Create(CTX, "wave.send", I->getFunction(),
+                                        Done);
+  Head->getTerminator()->eraseFromParent();
+  Builder.SetInsertPoint(Head);
+  Builder.CreateCondBr(Builder.CreateICmpULT(Rank, Items), Send, Done);
+  Builder.SetInsertPoint(Send);
+  SmallVector<Value *, 8> Encoded(Args.begin(), Args.end());
+  Encoded[1] = Builder.CreateIntToPtr(Item, Args[1]->getType());
+  Encoded[4] = Column;
+  Builder.CreateCall(Submit, Encoded);
+  Builder.CreateBr(Done);
+}
+
+// Instrumentation function for buffer intrinsics
+void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
+                                         const Function &F, llvm::Module &M,
+                                         uint32_t &LocationCounter,
+                                         InstrumentationSiteManifest &Sites,
+                                         llvm::Value *Ptr, bool IsLoad,
+                                         bool WaveEncoding,
+                                         bool PrintLocationInfo) {
+  auto &CTX = M.getContext();
+  auto CI = dyn_cast<CallInst>(I);
+  if (!CI)
+    return;
+
+  IRBuilder<> Builder(CI);
+
+  Value *ActualAddrInt = bufferIntrinsicAddress(CI, Builder, IsLoad);
 
   // Create a pointer in address space 0 (flat) for instrumentation
   // We use IntToPtr with the flat address space since that's compatible with
@@ -139,20 +349,24 @@ void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
   DILocation *DL = CI->getDebugLoc();
   std::string dbgFile =
       DL != nullptr ? getFullPath(DL) : "<unknown source file>";
-  size_t dbgFileHash = std::hash<std::string>{}(dbgFile);
-
-  Value *DbgFileHashVal = Builder.getInt64(dbgFileHash);
-  Value *DbgLineVal = Builder.getInt32(DL != nullptr ? DL->getLine() : 0);
-  Value *DbgColumnVal = Builder.getInt32(DL != nullptr ? DL->getColumn() : 0);
-
-  // Address space for buffer intrinsics is typically global (1)
-  Value *AddrSpaceVal = Builder.getInt8(1);
+  uint64_t dbgFileHash = std::hash<std::string>{}(dbgFile);
+  uint32_t DbgLine = DL != nullptr ? DL->getLine() : 0;
+  uint32_t DbgColumn = DL != nullptr ? DL->getColumn() : 0;
 
   // Get size from the vector type (e.g., <4 x float> = 16 bytes)
   Type *DataType = IsLoad ? CI->getType() : CI->getArgOperand(0)->getType();
   uint16_t DataSize = M.getDataLayout().getTypeStoreSize(DataType);
   Value *PointeeTypeSizeVal = Builder.getInt16(DataSize);
 
+  // Address space for buffer intrinsics is typically global (1)
+  Value *AddrSpaceVal = Builder.getInt8(1);
+
+  Sites.assignSite(dbgFile, DbgColumn, 1, IsLoad ? 0b01 : 0b10, DataSize,
+                   dbgFileHash, DbgLine);
+  Value *DbgFileHashVal = Builder.getInt64(dbgFileHash);
+  Value *DbgLineVal = Builder.getInt32(DbgLine);
+  Value *DbgColumnVal = Builder.getInt32(DbgColumn);
+
   // Ensure Addr64 has exactly the same type as Ptr using bitcast if needed
   Value *Addr64 = ActualAddr;
   if (Addr64->getType() != Ptr->getType()) {
@@ -172,9 +386,11 @@ void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
       false);
   FunctionCallee InstrumentationFunction =
       M.getOrInsertFunction("v_submit_address", FT);
-  Builder.CreateCall(FT, cast<Function>(InstrumentationFunction.getCallee()),
-                     {Ptr, Addr64, DbgFileHashVal, DbgLineVal, DbgColumnVal,
-                      AccessTypeVal, AddrSpaceVal, PointeeTypeSizeVal});
+  SubmitAddressMessage(
+      CI, {FT, cast<Function>(InstrumentationFunction.getCallee())},
+      {Ptr, Addr64, DbgFileHashVal, DbgLineVal, DbgColumnVal, AccessTypeVal,
+       AddrSpaceVal, PointeeTypeSizeVal},
+      DbgColumn, WaveEncoding);
 
   if (PrintLocationInfo) {
     errs() << "Injecting Buffer Intrinsic Trace Into AMDGPU Kernel: "
@@ -188,7 +404,9 @@ void InjectBufferInstrumentationFunction(const BasicBlock::iterator &I,
 template <typename LoadOrStoreInst>
 void InjectInstrumentationFunction(const BasicBlock::iterator &I,
                                    const Function &F, llvm::Module &M,
-                                   uint32_t &LocationCounter, llvm::Value *Ptr,
+                                   uint32_t &LocationCounter,
+                                   InstrumentationSiteManifest &Sites,
+                                   llvm::Value *Ptr, bool WaveEncoding,
                                    bool PrintLocationInfo) {
   auto &CTX = M.getContext();
   auto LSI = dyn_cast<LoadOrStoreInst>(I);
@@ -197,11 +415,12 @@ void InjectInstrumentationFunction(const BasicBlock::iterator &I,
   IRBuilder<> Builder(dyn_cast<Instruction>(I));
   auto LI = dyn_cast<LoadInst>(I);
   auto SI = dyn_cast<StoreInst>(I);
+  uint8_t AccessType = LI ? 0b01 : 0b10;
   if (LI) {
-    AccessTypeVal = Builder.getInt8(0b01);
+    AccessTypeVal = Builder.getInt8(AccessType);
     PointeeType = LI->getType();
   } else if (SI) {
-    AccessTypeVal = Builder.getInt8(0b10);
+    AccessTypeVal = Builder.getInt8(AccessType);
     PointeeType = SI->getValueOperand()->getType();
   } else {
     return;
@@ -213,17 +432,21 @@ void InjectInstrumentationFunction(const BasicBlock::iterator &I,
 
   std::string dbgFile =
       DL != nullptr ? getFullPath(DL) : "<unknown source file>";
-  size_t dbgFileHash = std::hash<std::string>{}(dbgFile);
+  uint64_t dbgFileHash = std::hash<std::string>{}(dbgFile);
+  uint32_t DbgLine = DL != nullptr ? DL->getLine() : 0;
+  uint32_t DbgColumn = DL != nullptr ? DL->getColumn() : 0;
 
   Value *Addr = LSI->getPointerOperand();
-  Value *DbgFileHashVal = Builder.getInt64(dbgFileHash);
-  Value *DbgLineVal = Builder.getInt32(DL != nullptr ? DL->getLine() : 0);
-  Value *DbgColumnVal = Builder.getInt32(DL != nullptr ? DL->getColumn() : 0);
   Value *Op = LSI->getPointerOperand()->stripPointerCasts();
   uint32_t AddrSpace = cast<PointerType>(Op->getType())->getAddressSpace();
   Value *AddrSpaceVal = Builder.getInt8(AddrSpace);
   uint16_t PointeeTypeSize = M.getDataLayout().getTypeStoreSize(PointeeType);
   Value *PointeeTypeSizeVal = Builder.getInt16(PointeeTypeSize);
+  Sites.assignSite(dbgFile, DbgColumn, AddrSpace, AccessType, PointeeTypeSize,
+                   dbgFileHash, DbgLine);
+  Value *DbgFileHashVal = Builder.getInt64(dbgFileHash);
+  Value *DbgLineVal = Builder.getInt32(DbgLine);
+  Value *DbgColumnVal = Builder.getInt32(DbgColumn);
 
   std::string SourceInfo = (F.getName() + "     " + dbgFile + ":" +
                             Twine(DL != nullptr ? DL->getLine() : 0) + ":" +
@@ -245,9 +468,11 @@ void InjectInstrumentationFunction(const BasicBlock::iterator &I,
       false);
   FunctionCallee InstrumentationFunction =
       M.getOrInsertFunction("v_submit_address", FT);
-  Builder.CreateCall(FT, cast<Function>(InstrumentationFunction.getCallee()),
-                     {Ptr, Addr64, DbgFileHashVal, DbgLineVal, DbgColumnVal,
-                      AccessTypeVal, AddrSpaceVal, PointeeTypeSizeVal});
+  SubmitAddressMessage(
+      &*I, {FT, cast<Function>(InstrumentationFunction.getCallee())},
+      {Ptr, Addr64, DbgFileHashVal, DbgLineVal, DbgColumnVal, AccessTypeVal,
+       AddrSpaceVal, PointeeTypeSizeVal},
+      DbgColumn, WaveEncoding);
   if (PrintLocationInfo) {
     errs() << "Injecting Mem Trace Function Into AMDGPU Kernel: " << SourceInfo
            << "\n";
@@ -257,7 +482,585 @@ void InjectInstrumentationFunction(const BasicBlock::iterator &I,
   LocationCounter++;
 }
 
-bool AMDGCNSubmitAddressMessage::runOnModule(Module &M) {
+// Affine access summaries. When INSTRUMENTATION_AFFINE_SUMMARY is set to
+// anything other than "0" at compile time, loads and stores whose address is
+// {Start,+,Stride} in their innermost loop, and that run exactly once per
+// iteration of a loop with a computable trip count, are not instrumented in the
+// loop body. Instead, each wave submits two messages from the loop preheader:
+//
+// 1. a summary message, i.e., an address message with AffineSummaryColumnFlag
+//    set in the DWARF column, where each lane's data item packs the lane's trip
+//    count (high 32 bits) and the stride in bytes (low 32 bits, signed);
+// 2. an ordinary address message for the first iteration.
+//
+// Host handlers pair the two per wave and expand (or analyze) the remaining
+// iterations as base + iteration * stride. See inc/affine_summary.h on the
+// host side; the flag value must match AFFINE_SUMMARY_COLUMN_FLAG there.
+constexpr uint32_t AffineSummaryColumnFlag = 0x80000000u;
+
+bool affineSummaryEnabled() {
+  const char *Env = std::getenv("INSTRUMENTATION_AFFINE_SUMMARY");
+  return Env != nullptr && *Env != '\0' && std::string(Env) != "0";
+}
+
+struct AffineAccess {
+  Instruction *Access;
+  Loop *L;
+  const SCEV *Start;
+  const SCEV *BackedgeTakenCount;
+  int64_t Stride;
+};
+
+// Returns true if the load or store I can be summarized, filling in A.
+bool findAffineAccess(Instruction *I, ScalarEvolution &SE, LoopInfo &LI,
+                      DominatorTree &DT, SCEVExpander &Expander,
+                      AffineAccess &A) {
+  Value *Addr = nullptr;
+  if (auto LdI = dyn_cast<LoadInst>(I))
+    Addr = LdI->getPointerOperand();
+  else if (auto StI = dyn_cast<StoreInst>(I))
+    Addr = StI->getPointerOperand();
+  else
+    return false;
+
+  // LI.getLoopFor returns the innermost loop, so I is not in a subloop of L.
+  // I has to run exactly once per iteration: L must only be left from its
+  // latch, and I must dominate that latch.
+  BasicBlock *BB = I->getParent();
+  Loop *L = LI.getLoopFor(BB);
+  if (L == nullptr)
+    return false;
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Latch = L->getLoopLatch();
+  if (Preheader == nullptr || Latch == nullptr ||
+      L->getExitingBlock() != Latch || !DT.dominates(BB, Latch))
+    return false;
+
+  const SCEV *BTC = SE.getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC))
+    return false;
+
+  auto AR = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(Addr));
+  if (AR == nullptr || AR->getLoop() != L || !AR->isAffine())
+    return false;
+  auto Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE));
+  if (Step == nullptr || Step->getAPInt().getSignificantBits() > 32)
+    return false;
+
+  Instruction *InsertPt = Preheader->getTerminator();
+  if (!Expander.isSafeToExpandAt(AR->getStart(), InsertPt) ||
+      !Expander.isSafeToExpandAt(BTC, InsertPt))
+    return false;
+
+  A = {I, L, AR->getStart(), BTC, Step->getAPInt().getSExtValue()};
+  return true;
+}
+
+void InjectAffineSummary(const AffineAccess &A, const Function &F,
+                         llvm::Module &M, ScalarEvolution &SE,
+                         SCEVExpander &Expander, uint32_t &LocationCounter,
+                         InstrumentationSiteManifest &Sites, llvm::Value *Ptr,
+                         bool PrintLocationInfo) {
+  auto &CTX = M.getContext();
+  Instruction *I = A.Access;
+  Value *Addr;
+  Type *PointeeType;
+  uint8_t AccessType;
+  if (auto LdI = dyn_cast<LoadInst>(I)) {
+    Addr = LdI->getPointerOperand();
+    PointeeType = LdI->getType();
+    AccessType = 0b01;
+  } else {
+    auto StI = cast<StoreInst>(I);
+    Addr = StI->getPointerOperand();
+    PointeeType = StI->getValueOperand()->getType();
+    AccessType = 0b10;
+  }
+
+  Instruction *InsertPt = A.L->getLoopPreheader()->getTerminator();
+  Value *Base = Expander.expandCodeFor(A.Start, Addr->getType(), InsertPt);
+  Type *I64Ty = Type::getInt64Ty(CTX);
+  const SCEV *TripCount =
+      SE.getAddExpr(SE.getTruncateOrZeroExtend(A.BackedgeTakenCount, I64Ty),
+                    SE.getOne(I64Ty));
+  Value *Trips = Expander.expandCodeFor(TripCount, I64Ty, InsertPt);
+
+  IRBuilder<> Builder(InsertPt);
+  // Trip counts that don't fit in 32 bits are saturated; the host then
+  // under-counts the iterations of such loops.
+  Trips = Builder.CreateBinaryIntrinsic(Intrinsic::umin, Trips,
+                                        Builder.getInt64(UINT32_MAX));
+  Value *Packed = Builder.CreateOr(
+      Builder.CreateShl(Trips, 32),
+      Builder.getInt64(static_cast<uint32_t>(A.Stride)));
+
+  DILocation *DL = I->getDebugLoc();
+  std::string dbgFile =
+      DL != nullptr ? getFullPath(DL) : "<unknown source file>";
+  size_t dbgFileHash = std::hash<std::string>{}(dbgFile);
+  uint32_t DbgLine = DL != nullptr ? DL->getLine() : 0;
+  uint32_t DbgColumn = DL != nullptr ? DL->getColumn() : 0;
+  uint32_t AddrSpace =
+      cast<PointerType>(Addr->stripPointerCasts()->getType())
+          ->getAddressSpace();
+  uint16_t PointeeTypeSize = M.getDataLayout().getTypeStoreSize(PointeeType);
+  // Both messages of the pair refer to the same site
+  uint64_t SiteFileHash = dbgFileHash;
+  uint32_t SiteLine = DbgLine;
+  Sites.assignSite(dbgFile, DbgColumn, AddrSpace, AccessType, PointeeTypeSize,
+                   SiteFileHash, SiteLine);
+
+  FunctionType *FT = FunctionType::get(
+      Type::getVoidTy(CTX),
+      {Ptr->getType(), Ptr->getType(), Type::getInt64Ty(CTX),
+       Type::getInt32Ty(CTX), Type::getInt32Ty(CTX), Type::getInt8Ty(CTX),
+       Type::getInt8Ty(CTX), Type::getInt16Ty(CTX)},
+      false);
+  FunctionCallee InstrumentationFunction =
+      M.getOrInsertFunction("v_submit_address", FT);
+  auto Submit = [&](Value *Addr64, uint32_t Column) {
+    Builder.CreateCall(
+        FT, cast<Function>(InstrumentationFunction.getCallee()),
+        {Ptr, Addr64, Builder.getInt64(SiteFileHash), Builder.getInt32(SiteLine),
+         Builder.getInt32(Column), Builder.getInt8(AccessType),
+         Builder.getInt8(AddrSpace), Builder.getInt16(PointeeTypeSize)});
+  };
+  // The summary goes first, so the host only has to remember summaries, not
+  // every address message, to pair them up.
+  Submit(Builder.CreateIntToPtr(Packed, Ptr->getType()),
+         DbgColumn | AffineSummaryColumnFlag);
+  Submit(Builder.CreatePointerCast(Base, Ptr->getType()), DbgColumn);
+
+  if (PrintLocationInfo) {
+    std::string SourceInfo = (F.getName() + "     " + dbgFile + ":" +
+                              Twine(DbgLine) + ":" + Twine(DbgColumn))
+                                 .str();
+    errs() << "Injecting Affine Summary Into AMDGPU Kernel: " << SourceInfo
+           << "\n";
+    errs() << LocationCounter << "     " << SourceInfo << "     "
+           << AddrSpaceMap[AddrSpace] << "     "
+           << (AccessType == 0b01 ? "LOAD" : "STORE") << "     (stride "
+           << A.Stride << ")\n";
+  }
+  LocationCounter++;
+}
+
+// Access groups. When INSTRUMENTATION_GROUP_ACCESSES is set to anything other
+// than "0" at compile time, loads (or stores) in one basic block that share a
+// base pointer, source location, address space and size, and whose constant
+// offsets from the base are multiples of the access size, are submitted as a
+// single address message at the first of them. Typical cases are unrolled
+// loops and repeated accesses to the same location. The message carries the
+// addresses of the lowest-offset member; the DWARF column packs the column
+// (bits 0..11), a mask of the members at base + i * size (bits 12..27), the
+// number of times each of those was accessed minus one (bits 28..29) and
+// AccessGroupColumnFlag. The layout must match inc/access_group.h, which host
+// handlers use to expand a group back into the individual accesses.
+//
+// The message has room for one column only, so without a site manifest the
+// members also have to share their column, and accesses to different struct
+// fields on one line are not grouped. With the manifest, the members only
+// have to share file and line: every member gets a site of its own, with its
+// own column, at consecutive ids in expansion order (slot by slot, repeats
+// within a slot), and the message carries the id of the first.
+constexpr uint32_t AccessGroupColumnFlag = 0x40000000u;
+constexpr uint32_t AccessGroupColumnLimit = 1u << 12;
+constexpr uint32_t AccessGroupSlotShift = 12;
+constexpr uint32_t AccessGroupSlots = 16;
+constexpr uint32_t AccessGroupRepeatShift = 28;
+constexpr uint32_t AccessGroupMaxRepeat = 4;
+
+bool accessGroupsEnabled() {
+  const char *Env = std::getenv("INSTRUMENTATION_GROUP_ACCESSES");
+  return Env != nullptr && *Env != '\0' && std::string(Env) != "0";
+}
+
+struct AccessGroup {
+  Instruction *First; // the message is submitted right before this member
+  std::vector<Instruction *> Members;
+  Value *Base;
+  int64_t Offset; // byte offset of slot 0 from Base
+  uint32_t SlotMask;
+  uint32_t Repeat;
+  uint8_t AccessType;
+  uint32_t AddrSpace;
+  uint16_t Size;
+  const DILocation *DL;
+};
+
+// Finds the access groups in BB. Instructions in Skip, or outside scope, are
+// left alone. Accesses that don't end up in a group of two or more are
+// instrumented individually as before. MemberSites groups accesses at
+// different columns of a line, for a site manifest to tell them apart.
+std::vector<AccessGroup> findAccessGroups(BasicBlock &BB, const Module &M,
+                                          const std::set<Instruction *> &Skip,
+                                          const InstrumentationScope &scope,
+                                          bool MemberSites) {
+  const DataLayout &DL = M.getDataLayout();
+  struct Candidate {
+    Instruction *I;
+    int64_t Offset;
+  };
+  // base, access type, address space, size, file, line, column
+  using Key = std::tuple<Value *, uint8_t, uint32_t, uint16_t, std::string,
+                         uint32_t, uint32_t>;
+  std::map<Key, std::vector<Candidate>> Candidates;
+  std::map<Key, const DILocation *> Locations;
+
+  for (auto &Inst : BB) {
+    Value *Addr;
+    Type *PointeeType;
+    uint8_t AccessType;
+    if (auto LdI = dyn_cast<LoadInst>(&Inst)) {
+      Addr = LdI->getPointerOperand();
+      PointeeType = LdI->getType();
+      AccessType = 0b01;
+    } else if (auto StI = dyn_cast<StoreInst>(&Inst)) {
+      Addr = StI->getPointerOperand();
+      PointeeType = StI->getValueOperand()->getType();
+      AccessType = 0b10;
+    } else {
+      continue;
+    }
+    if (Skip.count(&Inst) != 0)
+      continue;
+    DILocation *Loc = Inst.getDebugLoc();
+    if (scope.isActive() && !scope.matches(Loc))
+      continue;
+    uint32_t Column = Loc != nullptr ? Loc->getColumn() : 0;
+    if (MemberSites)
+      Column = 0;
+    else if (Column >= AccessGroupColumnLimit)
+      continue;
+
+    APInt Offset(DL.getIndexTypeSizeInBits(Addr->getType()), 0);
+    Value *Base = Addr->stripAndAccumulateConstantOffsets(DL, Offset, true);
+    if (Base->getType() != Addr->getType() ||
+        Offset.getSignificantBits() > 63)
+      continue;
+    uint32_t AddrSpace =
+        cast<PointerType>(Addr->stripPointerCasts()->getType())
+            ->getAddressSpace();
+    uint16_t Size = DL.getTypeStoreSize(PointeeType);
+    if (Size == 0)
+      continue;
+    Key K{Base,
+          AccessType,
+          AddrSpace,
+          Size,
+          Loc != nullptr ? getFullPath(Loc) : "<unknown source file>",
+          Loc != nullptr ? Loc->getLine() : 0,
+          Column};
+    Candidates[K].push_back({&Inst, Offset.getSExtValue()});
+    Locations.emplace(K, Loc);
+  }
+
+  std::vector<AccessGroup> Groups;
+  for (auto &[K, Remaining] : Candidates) {
+    uint16_t Size = std::get<3>(K);
+    // Candidates are in program order; a stable sort keeps that order within
+    // each offset
+    std::stable_sort(Remaining.begin(), Remaining.end(),
+                     [](const Candidate &A, const Candidate &B) {
+                       return A.Offset < B.Offset;
+                     });
+    while (Remaining.size() >= 2) {
+      // Slots relative to the lowest remaining offset
+      int64_t Low = Remaining.front().Offset;
+      std::map<uint32_t, std::vector<size_t>> Slots;
+      for (size_t i = 0; i < Remaining.size(); i++) {
+        int64_t Delta = Remaining[i].Offset - Low;
+        if (Delta % Size == 0 && Delta / Size < AccessGroupSlots)
+          Slots[Delta / Size].push_back(i);
+      }
+      // Every slot has to be accessed the same number of times
+      uint32_t Repeat = AccessGroupMaxRepeat;
+      for (auto &Slot : Slots)
+        Repeat = std::min<uint32_t>(Repeat, Slot.second.size());
+      if (Slots.size() * Repeat < 2) {
+        // The lowest access has no partner; it stays individual
+        Remaining.erase(Remaining.begin());
+        continue;
+      }
+
+      AccessGroup G;
+      G.Base = std::get<0>(K);
+      G.Offset = Low;
+      G.SlotMask = 0;
+      G.Repeat = Repeat;
+      G.AccessType = std::get<1>(K);
+      G.AddrSpace = std::get<2>(K);
+      G.Size = Size;
+      G.DL = Locations[K];
+      std::vector<bool> Taken(Remaining.size(), false);
+      for (auto &[Slot, Indices] : Slots) {
+        G.SlotMask |= 1u << Slot;
+        for (uint32_t r = 0; r < Repeat; r++) {
+          G.Members.push_back(Remaining[Indices[r]].I);
+          Taken[Indices[r]] = true;
+        }
+      }
+      G.First = G.Members.front();
+      for (auto Member : G.Members)
+        if (Member->comesBefore(G.First))
+          G.First = Member;
+      Groups.push_back(G);
+
+      std::vector<Candidate> Rest;
+      for (size_t i = 0; i < Remaining.size(); i++)
+        if (!Taken[i])
+          Rest.push_back(Remaining[i]);
+      Remaining.swap(Rest);
+    }
+  }
+  return Groups;
+}
+
+void InjectAccessGroup(const AccessGroup &G, const Function &F,
+                       llvm::Module &M, uint32_t &LocationCounter,
+                       InstrumentationSiteManifest &Sites, llvm::Value *Ptr,
+                       bool PrintLocationInfo) {
+  auto &CTX = M.getContext();
+  IRBuilder<> Builder(G.First);
+  Value *Addr = Builder.CreateConstGEP1_64(Builder.getInt8Ty(), G.Base,
+                                           static_cast<uint64_t>(G.Offset));
+  Value *Addr64 = Builder.CreatePointerCast(Addr, Ptr->getType());
+
+  std::string dbgFile =
+      G.DL != nullptr ? getFullPath(G.DL) : "<unknown source file>";
+  size_t dbgFileHash = std::hash<std::string>{}(dbgFile);
+  uint32_t DbgLine = G.DL != nullptr ? G.DL->getLine() : 0;
+  uint32_t DbgColumn = G.DL != nullptr ? G.DL->getColumn() : 0;
+  uint64_t SiteFileHash = dbgFileHash;
+  uint32_t SiteLine = DbgLine;
+  if (Sites.isActive()) {
+    // One site per member, in the order host handlers expand the group
+    for (size_t i = 0; i < G.Members.size(); i++) {
+      const DILocation *MemberDL = G.Members[i]->getDebugLoc();
+      uint64_t MemberFileHash = dbgFileHash;
+      uint32_t MemberLine = DbgLine;
+      Sites.assignSite(dbgFile, MemberDL != nullptr ? MemberDL->getColumn() : 0,
+                       G.AddrSpace, G.AccessType, G.Size, MemberFileHash,
+                       MemberLine);
+      if (i == 0) {
+        SiteFileHash = MemberFileHash;
+        SiteLine = MemberLine;
+      }
+    }
+    // The members' columns are in the manifest; the message keeps one that
+    // fits, for tools that only look at the message
+    if (DbgColumn >= AccessGroupColumnLimit)
+      DbgColumn = 0;
+  } else {
+    Sites.assignSite(dbgFile, DbgColumn, G.AddrSpace, G.AccessType, G.Size,
+                     SiteFileHash, SiteLine);
+  }
+  uint32_t GroupColumn = AccessGroupColumnFlag | DbgColumn |
+                         (G.SlotMask << AccessGroupSlotShift) |
+                         ((G.Repeat - 1) << AccessGroupRepeatShift);
+
+  FunctionType *FT = FunctionType::get(
+      Type::getVoidTy(CTX),
+      {Ptr->getType(), Ptr->getType(), Type::getInt64Ty(CTX),
+       Type::getInt32Ty(CTX), Type::getInt32Ty(CTX), Type::getInt8Ty(CTX),
+       Type::getInt8Ty(CTX), Type::getInt16Ty(CTX)},
+      false);
+  FunctionCallee InstrumentationFunction =
+      M.getOrInsertFunction("v_submit_address", FT);
+  Builder.CreateCall(FT, cast<Function>(InstrumentationFunction.getCallee()),
+                     {Ptr, Addr64, Builder.getInt64(SiteFileHash),
+                      Builder.getInt32(SiteLine), Builder.getInt32(GroupColumn),
+                      Builder.getInt8(G.AccessType),
+                      Builder.getInt8(G.AddrSpace), Builder.getInt16(G.Size)});
+
+  if (PrintLocationInfo) {
+    std::string SourceInfo = (F.getName() + "     " + dbgFile + ":" +
+                              Twine(DbgLine) + ":" + Twine(DbgColumn))
+                                 .str();
+    errs() << "Injecting Access Group Into AMDGPU Kernel: " << SourceInfo
+           << "\n";
+    errs() << LocationCounter << "     " << SourceInfo << "     "
+           << AddrSpaceMap[G.AddrSpace] << "     "
+           << (G.AccessType == 0b01 ? "LOAD" : "STORE") << "     ("
+           << G.Members.size() << " accesses)\n";
+  }
+  LocationCounter++;
+}
+
+// Device heatmaps. When INSTRUMENTATION_HEATMAP is set at compile time, the
+// clone sends no address messages. The pointer argument that normally points
+// to the dh_comms descriptor points to a hashed per-page histogram in global
+// memory instead, and every active lane of every load and store counts its
+// page there with atomics; the host reads back only the histogram when the
+// dispatch completes. INSTRUMENTATION_HEATMAP=1 counts 1 MiB pages, the page
+// size of the host's memory_heatmap_t; a power of two of at least 4096 selects
+// another page size. The histogram is a 32-byte header (page shift, slot
+// count, dropped count) followed by HeatmapSlotCount {page index + 1, count}
+// slots. Lanes probe at most HeatmapMaxProbes slots, starting from a
+// multiplicative hash of their page, and count in the header when none of them
+// is free or holds their page. The clone is marked with a constant global named
+// <clone name> + HeatmapMarkerSuffix. The layouts must match
+// inc/device_heatmap.h.
+constexpr uint32_t HeatmapSlotCount = 8192;
+constexpr uint32_t HeatmapMaxProbes = 16;
+constexpr uint64_t HeatmapHeaderSize = 32;
+constexpr uint64_t HeatmapDroppedOffset = 8;
+constexpr uint64_t HeatmapHashMultiplier = 0x9e3779b97f4a7c15ull;
+constexpr uint16_t HeatmapMarkerVersion = 1;
+constexpr const char *HeatmapMarkerSuffix = ".heatmap";
+
+// Returns log2 of the page size, or 0 if device heatmaps are off
+uint32_t heatmapPageShift() {
+  const char *Env = std::getenv("INSTRUMENTATION_HEATMAP");
+  if (Env == nullptr || *Env == '\0' || std::string(Env) == "0")
+    return 0;
+  if (std::string(Env) == "1")
+    return 20;
+  char *End = nullptr;
+  uint64_t PageSize = std::strtoull(Env, &End, 0);
+  if (*End != '\0' || PageSize < 4096 || !isPowerOf2_64(PageSize)) {
+    errs() << "INSTRUMENTATION_HEATMAP=" << Env
+           << " is neither 1 nor a power of two of at least 4096; device "
+              "heatmaps disabled\n";
+    return 0;
+  }
+  return Log2_64(PageSize);
+}
+
+// Counts the page of Addr (an i64) in the histogram Histogram before I
+void InjectHeatmapUpdate(Instruction *I, Value *Addr, Value *Histogram,
+                         uint32_t PageShift) {
+  LLVMContext &CTX = I->getContext();
+  Function *F = I->getFunction();
+  IRBuilder<> Builder(I);
+  Type *Int8Ty = Builder.getInt8Ty();
+  Type *Int64Ty = Builder.getInt64Ty();
+  SyncScope::ID Agent = CTX.getOrInsertSyncScopeID("agent");
+
+  Value *Key = Builder.CreateAdd(Builder.CreateLShr(Addr, PageShift),
+                                 Builder.getInt64(1), "heatmap.key");
+  Value *Hash = Builder.CreateLShr(
+      Builder.CreateMul(Key, Builder.getInt64(HeatmapHashMultiplier)),
+      64 - Log2_32(HeatmapSlotCount), "heatmap.hash");
+  Value *Table =
+      Builder.CreateAddrSpaceCast(Histogram, PointerType::get(CTX, 1));
+
+  BasicBlock *Head = I->getParent();
+  BasicBlock *Done = Head->splitBasicBlock(I, "heatmap.done");
+  BasicBlock *Probe = BasicBlock::Create(CTX, "heatmap.probe", F, Done);
+  BasicBlock *Next = BasicBlock::Create(CTX, "heatmap.next", F, Done);
+  BasicBlock *Count = BasicBlock::Create(CTX, "heatmap.count", F, Done);
+  BasicBlock *Drop = BasicBlock::Create(CTX, "heatmap.drop", F, Done);
+  Head->getTerminator()->eraseFromParent();
+  Builder.SetInsertPoint(Head);
+  Builder.CreateBr(Probe);
+
+  // Claim an empty slot for the page, or find the one that already holds it
+  Builder.SetInsertPoint(Probe);
+  PHINode *Idx = Builder.CreatePHI(Int64Ty, 2, "heatmap.idx");
+  Idx->addIncoming(Builder.getInt64(0), Head);
+  Value *Slot = Builder.CreateAnd(Builder.CreateAdd(Hash, Idx),
+                                  Builder.getInt64(HeatmapSlotCount - 1));
+  Value *SlotPtr = Builder.CreateGEP(
+      Int8Ty, Table,
+      Builder.CreateAdd(Builder.CreateShl(Slot, 4),
+                        Builder.getInt64(HeatmapHeaderSize)),
+      "heatmap.slot");
+  Value *Old = Builder.CreateExtractValue(
+      Builder.CreateAtomicCmpXchg(SlotPtr, Builder.getInt64(0), Key,
+                                  MaybeAlign(8), AtomicOrdering::Monotonic,
+                                  AtomicOrdering::Monotonic, Agent),
+      0);
+  Value *Found = Builder.CreateOr(
+      Builder.CreateICmpEQ(Old, Builder.getInt64(0)),
+      Builder.CreateICmpEQ(Old, Key), "heatmap.found");
+  Builder.CreateCondBr(Found, Count, Next);
+
+  Builder.SetInsertPoint(Next);
+  Value *NextIdx = Builder.CreateAdd(Idx, Builder.getInt64(1));
+  Idx->addIncoming(NextIdx, Next);
+  Builder.CreateCondBr(
+      Builder.CreateICmpULT(NextIdx, Builder.getInt64(HeatmapMaxProbes)),
+      Probe, Drop);
+
+  Builder.SetInsertPoint(Count);
+  Builder.CreateAtomicRMW(AtomicRMWInst::Add,
+                          Builder.CreateConstGEP1_64(Int8Ty, SlotPtr, 8),
+                          Builder.getInt64(1), MaybeAlign(8),
+                          AtomicOrdering::Monotonic, Agent);
+  Builder.CreateBr(Done);
+
+  Builder.SetInsertPoint(Drop);
+  Builder.CreateAtomicRMW(
+      AtomicRMWInst::Add,
+      Builder.CreateConstGEP1_64(Int8Ty, Table, HeatmapDroppedOffset),
+      Builder.getInt64(1), MaybeAlign(8), AtomicOrdering::Monotonic, Agent);
+  Builder.CreateBr(Done);
+}
+
+// Marks a clone built with device heatmaps, so that the runtime passes it a
+// histogram rather than a dh_comms descriptor
+void emitHeatmapMarker(Function &NF, uint32_t PageShift) {
+  std::vector<uint8_t> Bytes = {'O', 'P', 'H', 'M'};
+  auto put = [&Bytes](uint64_t Value, size_t Size) {
+    for (size_t I = 0; I < Size; I++)
+      Bytes.push_back(static_cast<uint8_t>(Value >> (8 * I)));
+  };
+  put(HeatmapMarkerVersion, 2);
+  put(0, 2);
+  put(PageShift, 4);
+  put(HeatmapSlotCount, 4);
+
+  Module &M = *NF.getParent();
+  Constant *Data = ConstantDataArray::get(M.getContext(), Bytes);
+  auto *Marker = new GlobalVariable(
+      M, Data->getType(), /*isConstant=*/true, GlobalValue::ExternalLinkage,
+      Data, NF.getName() + HeatmapMarkerSuffix, nullptr,
+      GlobalValue::NotThreadLocal, /*AddressSpace=*/4);
+  Marker->setVisibility(GlobalValue::ProtectedVisibility);
+  appendToUsed(M, {Marker});
+}
+
+// Counts the accesses of the clone NF in the device heatmap Histogram points
+// to. Returns true if there were any.
+bool InjectHeatmapUpdates(Function &NF, Value *Histogram,
+                          const InstrumentationScope &Scope, uint32_t PageShift,
+                          uint32_t &LocationCounter) {
+  // Counting splits blocks, so collect the accesses first
+  std::vector<Instruction *> Accesses;
+  for (auto &BB : NF) {
+    for (auto &Inst : BB) {
+      if (Scope.isActive() && !Scope.matches(Inst.getDebugLoc()))
+        continue;
+      auto CI = dyn_cast<CallInst>(&Inst);
+      if (isa<LoadInst>(Inst) || isa<StoreInst>(Inst) ||
+          isAMDGCNBufferLoad(CI) || isAMDGCNBufferStore(CI))
+        Accesses.push_back(&Inst);
+    }
+  }
+  for (Instruction *Access : Accesses) {
+    IRBuilder<> Builder(Access);
+    Value *Addr;
+    if (auto CI = dyn_cast<CallInst>(Access)) {
+      Addr = bufferIntrinsicAddress(CI, Builder, isAMDGCNBufferLoad(CI));
+    } else {
+      // LDS addresses are counted as flat addresses, as in address messages
+      Addr = Builder.CreatePtrToInt(
+          Builder.CreatePointerCast(getLoadStorePointerOperand(Access),
+                                    Histogram->getType()),
+          Builder.getInt64Ty());
+    }
+    InjectHeatmapUpdate(Access, Addr, Histogram, PageShift);
+    LocationCounter++;
+  }
+  emitHeatmapMarker(NF, PageShift);
+  errs() << "Counting " << Accesses.size() << " access(es) of "
+         << NF.getName() << " in a device heatmap\n";
+  return !Accesses.empty();
+}
+
+bool AMDGCNSubmitAddressMessage::runOnModule(Module &M,
+                                             ModuleAnalysisManager &MAM) {
   errs() << "Running AMDGCNSubmitAddressMessage on module: " << M.getName()
          << "\n";
 
@@ -277,47 +1080,129 @@ bool AMDGCNSubmitAddressMessage::runOnModule(Module &M) {
            << " definition(s)\n";
   }
 
+  // Device heatmaps count every access on the device, so summaries, groups
+  // and wave encoding, which only exist to shrink address messages, don't
+  // apply
+  uint32_t HeatmapShift = heatmapPageShift();
+  if (HeatmapShift) {
+    errs() << "Device heatmaps enabled, " << (uint64_t(1) << HeatmapShift)
+           << "-byte pages\n";
+  }
+  bool AffineSummary = !HeatmapShift && affineSummaryEnabled();
+  if (AffineSummary) {
+    errs() << "Affine access summaries enabled\n";
+  }
+  bool GroupAccesses = !HeatmapShift && accessGroupsEnabled();
+  if (GroupAccesses) {
+    errs() << "Access groups enabled\n";
+  }
+  bool WaveEncoding = !HeatmapShift && waveEncodingEnabled();
+  if (WaveEncoding) {
+    errs() << "Wave-compressed address messages enabled\n";
+  }
+  InstrumentationSampling Sampling;
+  InstrumentationSiteManifest Sites;
+  auto &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
   std::vector<Function *> GpuKernels = collectGPUKernels(M);
 
   bool ModifiedCodeGen = false;
   for (auto &I : GpuKernels) {
     ValueToValueMapTy VMap;
     Function *NF = cloneKernelWithExtraArg(I, M, VMap);
+    Function *Plain = Sampling.copyBody(NF);
 
     // Get the ptr we just added to the kernel arguments
     Value *bufferPtr = &*NF->arg_end() - 1;
     uint32_t LocationCounter = 0;
-    for (Function::iterator BB = NF->begin(); BB != NF->end(); BB++) {
-      for (BasicBlock::iterator I = BB->begin(); I != BB->end(); I++) {
-        // Scope filtering: skip instructions outside the scope
-        if (scope.isActive()) {
-          DILocation *DL = dyn_cast<Instruction>(I)->getDebugLoc();
-          if (!DL || !scope.matches(getFullPath(DL), DL->getLine()))
+
+    // Find all summarizable accesses before changing the clone, so that the
+    // analyses are computed once per kernel. Accesses covered by a summary or
+    // an access group are not instrumented individually.
+    std::set<Instruction *> Summarized;
+    if (AffineSummary) {
+      auto &SE = FAM.getResult<ScalarEvolutionAnalysis>(*NF);
+      auto &LI = FAM.getResult<LoopAnalysis>(*NF);
+      auto &DT = FAM.getResult<DominatorTreeAnalysis>(*NF);
+      // Shared by all accesses, so that e.g. the trip count of a loop is only
+      // expanded once
+      SCEVExpander Expander(SE, M.getDataLayout(), "affine");
+      std::vector<AffineAccess> Accesses;
+      for (auto &BB : *NF) {
+        for (auto &Inst : BB) {
+          if (scope.isActive() && !scope.matches(Inst.getDebugLoc()))
             continue;
+          AffineAccess A;
+          if (findAffineAccess(&Inst, SE, LI, DT, Expander, A))
+            Accesses.push_back(A);
         }
+      }
+      for (const auto &A : Accesses) {
+        InjectAffineSummary(A, *NF, M, SE, Expander, LocationCounter, Sites,
+                            bufferPtr, true);
+        Summarized.insert(A.Access);
+        ModifiedCodeGen = true;
+      }
+    }
+
+    if (GroupAccesses) {
+      std::vector<AccessGroup> Groups;
+      for (auto &BB : *NF) {
+        auto BBGroups = findAccessGroups(BB, M, Summarized, scope,
+                                         Sites.isActive());
+        Groups.insert(Groups.end(), BBGroups.begin(), BBGroups.end());
+      }
+      for (const auto &G : Groups) {
+        InjectAccessGroup(G, *NF, M, LocationCounter, Sites, bufferPtr, true);
+        Summarized.insert(G.Members.begin(), G.Members.end());
+        ModifiedCodeGen = true;
+      }
+    }
 
-        if (dyn_cast<LoadInst>(I) != nullptr) {
+    if (HeatmapShift) {
+      if (InjectHeatmapUpdates(*NF, bufferPtr, scope, HeatmapShift,
+                               LocationCounter))
+        ModifiedCodeGen = true;
+    } else {
+      // Wave encoding splits blocks, so collect the accesses first
+      std::vector<Instruction *> Accesses;
+      for (auto &BB : *NF) {
+        for (auto &Inst : BB) {
+          // Scope filtering: skip instructions outside the scope
+          if (scope.isActive() && !scope.matches(Inst.getDebugLoc()))
+            continue;
+          if (Summarized.count(&Inst) != 0)
+            continue;
+          auto CI = dyn_cast<CallInst>(&Inst);
+          if (isa<LoadInst>(Inst) || isa<StoreInst>(Inst) ||
+              isAMDGCNBufferLoad(CI) || isAMDGCNBufferStore(CI))
+            Accesses.push_back(&Inst);
+        }
+      }
+      for (Instruction *Access : Accesses) {
+        BasicBlock::iterator I = Access->getIterator();
+        if (isa<LoadInst>(Access)) {
           InjectInstrumentationFunction<LoadInst>(I, *NF, M, LocationCounter,
-                                                  bufferPtr, true);
-          ModifiedCodeGen = true;
-        } else if (dyn_cast<StoreInst>(I) != nullptr) {
+                                                  Sites, bufferPtr,
+                                                  WaveEncoding, true);
+        } else if (isa<StoreInst>(Access)) {
           InjectInstrumentationFunction<StoreInst>(I, *NF, M, LocationCounter,
-                                                   bufferPtr, true);
-          ModifiedCodeGen = true;
-        } else if (auto CI = dyn_cast<CallInst>(I)) {
+                                                   Sites, bufferPtr,
+                                                   WaveEncoding, true);
+        } else {
           // Handle AMDGPU buffer intrinsics
-          if (isAMDGCNBufferLoad(CI)) {
-            InjectBufferInstrumentationFunction(I, *NF, M, LocationCounter,
-                                                bufferPtr, true, true);
-            ModifiedCodeGen = true;
-          } else if (isAMDGCNBufferStore(CI)) {
-            InjectBufferInstrumentationFunction(I, *NF, M, LocationCounter,
-                                                bufferPtr, false, true);
-            ModifiedCodeGen = true;
-          }
+          InjectBufferInstrumentationFunction(
+              I, *NF, M, LocationCounter, Sites, bufferPtr,
+              isAMDGCNBufferLoad(cast<CallInst>(Access)), WaveEncoding, true);
         }
+        ModifiedCodeGen = true;
       }
+      Sites.emit(*NF);
     }
+    if (Plain)
+      Sampling.addGuard(NF, Plain);
+    FAM.invalidate(*NF, PreservedAnalyses::none());
   }
   errs() << "Done running AMDGCNSubmitAddressMessage on module: " << M.getName()
          << "\n";
@@ -331,6 +1216,16 @@ PassPluginLibraryInfo getPassPluginInfo() {
           MPM.addPass(AMDGCNSubmitAddressMessage());
           return true;
         });
+    // Lets opt run the pass by name, e.g. in the lit tests under tests/lit
+    PB.registerPipelineParsingCallback(
+        [](StringRef Name, ModulePassManager &MPM,
+           ArrayRef<PassBuilder::PipelineElement>) {
+          if (Name == "amdgcn-submit-address-message") {
+            MPM.addPass(AMDGCNSubmitAddressMessage());
+            return true;
+          }
+          return false;
+        });
   };
 
   return {LLVM_PLUGIN_API_VERSION, "amdgcn-submit-address-message",
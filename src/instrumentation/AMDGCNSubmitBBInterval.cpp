@@ -24,10 +24,16 @@ THE SOFTWARE.
 #include "InstrumentationCommon.h"
 #include "utils.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Passes/PassBuilder.h"
@@ -36,6 +42,9 @@ THE SOFTWARE.
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Transforms/Utils/UnifyFunctionExitNodes.h"
+#include "llvm/Transforms/Utils/UnifyLoopExits.h"
 #include <cstdlib>
 #include <dlfcn.h>
 #include <iostream>
@@ -48,7 +57,210 @@ using namespace llvm;
 using namespace std;
 using namespace instrumentation::common;
 
-bool AMDGCNSubmitBBInterval::runOnModule(Module &M) {
+// Timing regions. When INSTRUMENTATION_TIMING_REGIONS is set to "loops" (or
+// "loops:D") at compile time, basic blocks are not timed individually, since
+// one interval per block floods the buffer in tight loops and the clock reads
+// distort what they measure. Instead each wave times the whole kernel, from
+// the entry block to its return, and every loop of depth at most D (default
+// 1) whose estimated cost is at least MinLoopCost, from the end of its
+// preheader to the start of its exit block. Cheaper and deeper loops are
+// covered by the enclosing region. A region's message has the first and
+// last source line of the region in its DWARF line and column; user_data packs
+// the region index (bits 0..11), the index of the enclosing timed region
+// (bits 12..23), the loop depth (bits 24..27) and TimingRegionFlag. The layout
+// must match inc/timing_region.h, which basic_block_analysis uses on the host.
+constexpr uint32_t TimingRegionFlag = 0x80000000u;
+constexpr uint32_t TimingRegionParentShift = 12;
+constexpr uint32_t TimingRegionDepthShift = 24;
+constexpr uint32_t TimingRegionMaxDepth = 15;
+constexpr uint32_t TimingRegionMaxRegions = 1u << 12;
+
+// Trip count assumed for loops whose trip count isn't a known constant
+constexpr uint64_t AssumedTripCount = 8;
+// Loops estimated to execute fewer instructions than this per entry are not
+// worth the two clock reads and the message of a region of their own.
+constexpr uint64_t MinLoopCost = 64;
+
+// Returns the maximum loop depth to time, or 0 to time basic blocks.
+unsigned timingRegionDepth() {
+  const char *Env = std::getenv("INSTRUMENTATION_TIMING_REGIONS");
+  if (Env == nullptr || *Env == '\0')
+    return 0;
+  StringRef Value(Env);
+  if (Value == "blocks")
+    return 0;
+  if (Value == "loops")
+    return 1;
+  unsigned Depth;
+  if (Value.consume_front("loops:") && !Value.getAsInteger(10, Depth) &&
+      Depth >= 1 && Depth <= TimingRegionMaxDepth)
+    return Depth;
+  errs() << "AMDGCNSubmitBBInterval: invalid INSTRUMENTATION_TIMING_REGIONS '"
+         << Env << "' (expected blocks, loops or loops:D with 1 <= D <= "
+         << TimingRegionMaxDepth << "). Timing basic blocks.\n";
+  return 0;
+}
+
+// Static estimate of the instructions one entry into L executes: its own
+// instructions plus the cost of its subloops, times its trip count.
+uint64_t estimateLoopCost(const Loop &L, const LoopInfo &LI,
+                          ScalarEvolution &SE) {
+  uint64_t Cost = 0;
+  for (BasicBlock *BB : L.blocks())
+    if (LI.getLoopFor(BB) == &L)
+      Cost += BB->sizeWithoutDebug();
+  for (const Loop *Sub : L)
+    Cost += estimateLoopCost(*Sub, LI, SE);
+  uint64_t TripCount = SE.getSmallConstantTripCount(&L);
+  return Cost * (TripCount ? TripCount : AssumedTripCount);
+}
+
+struct TimingRegion {
+  Instruction *Start;               // the clock is read right before this
+  std::vector<Instruction *> Stops; // and again, and submitted, before these
+  std::vector<BasicBlock *> Blocks; // for the source range
+  uint32_t Parent;
+  uint32_t Depth;
+};
+
+// Finds the source range of a region: the file of its first instruction with
+// a location, and the lowest and highest line in that file. Code inlined from
+// other files doesn't widen the range.
+void getRegionSourceRange(const TimingRegion &R, uint64_t &FileHash,
+                          uint32_t &FirstLine, uint32_t &LastLine) {
+  FileHash = 0;
+  FirstLine = 0xffffff;
+  LastLine = 0xffffff;
+  const DIFile *File = nullptr;
+  for (BasicBlock *BB : R.Blocks) {
+    for (Instruction &I : *BB) {
+      DILocation *DL = I.getDebugLoc();
+      if (!DL || DL->getLine() == 0)
+        continue;
+      if (!File) {
+        File = DL->getFile();
+        FileHash = std::hash<std::string>{}(getFullPath(DL));
+        FirstLine = LastLine = DL->getLine();
+      } else if (DL->getFile() == File) {
+        FirstLine = std::min(FirstLine, DL->getLine());
+        LastLine = std::max(LastLine, DL->getLine());
+      }
+    }
+  }
+}
+
+// Instruments the kernel region and the selected loops of NF. Returns the
+// number of regions.
+unsigned instrumentTimingRegions(Function &NF, Module &M, Value *bufferPtr,
+                                 LoopInfo &LI, DominatorTree &DT,
+                                 ScalarEvolution &SE, unsigned MaxDepth) {
+  std::vector<TimingRegion> Regions;
+  BasicBlock &Entry = NF.getEntryBlock();
+  TimingRegion Kernel{&*Entry.getFirstInsertionPt(), {}, {}, 0, 0};
+  for (BasicBlock &BB : NF) {
+    Kernel.Blocks.push_back(&BB);
+    if (isa<ReturnInst>(BB.getTerminator()))
+      Kernel.Stops.push_back(BB.getTerminator());
+  }
+  Regions.push_back(Kernel);
+
+  // Outer loops come first, siblings in program order. Costs are estimated
+  // for all loops before the CFG is changed below.
+  std::vector<Loop *> Selected;
+  for (Loop *L : LI.getLoopsInPreorder())
+    if (L->getLoopDepth() <= MaxDepth &&
+        estimateLoopCost(*L, LI, SE) >= MinLoopCost)
+      Selected.push_back(L);
+
+  // A region needs a preheader to start in, and exit blocks that only the
+  // loop branches to to stop in. Loops that can't be given both are left to
+  // the enclosing region.
+  DenseMap<const Loop *, uint32_t> RegionOfLoop;
+  for (Loop *L : Selected) {
+    if (Regions.size() == TimingRegionMaxRegions)
+      break;
+    BasicBlock *Preheader = L->getLoopPreheader();
+    if (!Preheader)
+      Preheader = InsertPreheaderForLoop(L, &DT, &LI, nullptr, false);
+    if (!Preheader ||
+        (!L->hasDedicatedExits() &&
+         !formDedicatedExitBlocks(L, &DT, &LI, nullptr, false)))
+      continue;
+    uint32_t Parent = 0;
+    for (Loop *P = L->getParentLoop(); P; P = P->getParentLoop()) {
+      auto It = RegionOfLoop.find(P);
+      if (It != RegionOfLoop.end()) {
+        Parent = It->second;
+        break;
+      }
+    }
+    SmallVector<BasicBlock *, 4> Exits;
+    L->getUniqueExitBlocks(Exits);
+    TimingRegion R{Preheader->getTerminator(), {}, {}, Parent,
+                   L->getLoopDepth()};
+    for (BasicBlock *Exit : Exits)
+      R.Stops.push_back(&*Exit->getFirstInsertionPt());
+    R.Blocks.assign(L->block_begin(), L->block_end());
+    RegionOfLoop[L] = Regions.size();
+    Regions.push_back(R);
+  }
+
+  LLVMContext &Ctx = M.getContext();
+  Type *Int64Ty = Type::getInt64Ty(Ctx);
+  Type *Int32Ty = Type::getInt32Ty(Ctx);
+  Type *VoidPtrTy = PointerType::get(Ctx, 0);
+  FunctionCallee Clock =
+      M.getOrInsertFunction("s_clock64", FunctionType::get(Int64Ty, {}, false));
+  FunctionCallee Submit = M.getOrInsertFunction(
+      "s_submit_time_interval",
+      FunctionType::get(Type::getVoidTy(Ctx),
+                        {bufferPtr->getType(), VoidPtrTy, Int64Ty, Int32Ty,
+                         Int32Ty, Int32Ty},
+                        false));
+  ArrayType *IntervalTy = ArrayType::get(Int64Ty, 2);
+
+  // All intervals live in the entry block, ahead of the kernel region's start,
+  // so that they dominate every start and stop.
+  std::vector<AllocaInst *> Intervals;
+  IRBuilder<> AllocaBuilder(Kernel.Start);
+  for (size_t Idx = 0; Idx < Regions.size(); Idx++)
+    Intervals.push_back(
+        AllocaBuilder.CreateAlloca(IntervalTy, nullptr, "timeRegion"));
+
+  // Where regions start or stop at the same point, an enclosing region must
+  // start before and stop after the regions it contains: starts are inserted
+  // outer first, stops inner first.
+  for (size_t Idx = 0; Idx < Regions.size(); Idx++) {
+    IRBuilder<> BuilderStart(Regions[Idx].Start);
+    BuilderStart.CreateStore(BuilderStart.CreateCall(Clock, {}),
+                             BuilderStart.CreateConstInBoundsGEP2_32(
+                                 IntervalTy, Intervals[Idx], 0, 0));
+  }
+  for (size_t Idx = Regions.size(); Idx-- > 0;) {
+    const TimingRegion &R = Regions[Idx];
+    uint64_t FileHash;
+    uint32_t FirstLine, LastLine;
+    getRegionSourceRange(R, FileHash, FirstLine, LastLine);
+    uint32_t UserData = TimingRegionFlag | static_cast<uint32_t>(Idx) |
+                        (R.Parent << TimingRegionParentShift) |
+                        (R.Depth << TimingRegionDepthShift);
+    for (Instruction *Stop : R.Stops) {
+      IRBuilder<> BuilderEnd(Stop);
+      BuilderEnd.CreateStore(BuilderEnd.CreateCall(Clock, {}),
+                             BuilderEnd.CreateConstInBoundsGEP2_32(
+                                 IntervalTy, Intervals[Idx], 0, 1));
+      BuilderEnd.CreateCall(
+          Submit,
+          {bufferPtr, BuilderEnd.CreatePointerCast(Intervals[Idx], VoidPtrTy),
+           BuilderEnd.getInt64(FileHash), BuilderEnd.getInt32(FirstLine),
+           BuilderEnd.getInt32(LastLine), BuilderEnd.getInt32(UserData)});
+    }
+  }
+  return Regions.size();
+}
+
+bool AMDGCNSubmitBBInterval::runOnModule(Module &M,
+                                         ModuleAnalysisManager &MAM) {
   if (!validateAMDGPUTarget(M)) {
     return false;
   }
@@ -62,14 +274,43 @@ bool AMDGCNSubmitBBInterval::runOnModule(Module &M) {
   }
 
   std::vector<Function *> GpuKernels = collectGPUKernels(M);
+  InstrumentationSampling Sampling;
+  unsigned RegionDepth = timingRegionDepth();
+  if (RegionDepth) {
+    errs() << "Timing regions enabled: kernel and loops up to depth "
+           << RegionDepth << "\n";
+  }
+  auto &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
 
   bool ModifiedCodeGen = false;
   for (auto &I : GpuKernels) {
     ValueToValueMapTy VMap;
     Function *NF = cloneKernelWithExtraArg(I, M, VMap);
+    Function *Plain = Sampling.copyBody(NF);
 
     // Get the ptr we just added to the kernel arguments
     Value *bufferPtr = &*NF->arg_end() - 1;
+    if (RegionDepth) {
+      // Lanes of a wave that leave the kernel or a loop through different
+      // blocks run those blocks one after the other, and a region stopped in
+      // each would be submitted once per block. With a single return, and a
+      // single exit per loop, the lanes reconverge before the region stops.
+      FAM.invalidate(*NF, UnifyFunctionExitNodesPass().run(*NF, FAM));
+      FAM.invalidate(*NF, UnifyLoopExitsPass().run(*NF, FAM));
+      auto &LI = FAM.getResult<LoopAnalysis>(*NF);
+      auto &DT = FAM.getResult<DominatorTreeAnalysis>(*NF);
+      auto &SE = FAM.getResult<ScalarEvolutionAnalysis>(*NF);
+      unsigned NumRegions = instrumentTimingRegions(*NF, M, bufferPtr, LI, DT,
+                                                    SE, RegionDepth);
+      if (Plain)
+        Sampling.addGuard(NF, Plain);
+      FAM.invalidate(*NF, PreservedAnalyses::none());
+      errs() << "AMDGCNSubmitBBInterval: instrumented " << NumRegions
+             << " timing regions for kernel " << I->getName() << "\n";
+      ModifiedCodeGen = true;
+      continue;
+    }
     // Instrument each basic block in the cloned kernel NF:
     unsigned bbIndex = 0;
     for (auto BB = NF->begin(); BB != NF->end(); ++BB) {
@@ -167,6 +408,8 @@ bool AMDGCNSubmitBBInterval::runOnModule(Module &M) {
       bbIndex++;
       ModifiedCodeGen = true;
     }
+    if (Plain)
+      Sampling.addGuard(NF, Plain);
     errs() << "AMDGCNSubmitBBInterval: instrumented " << bbIndex
            << " basic blocks for kernel " << I->getName() << "\n";
   }
@@ -181,9 +424,19 @@ PassPluginLibraryInfo getPassPluginInfo() {
           MPM.addPass(AMDGCNSubmitBBInterval());
           return true;
         });
+    // Lets opt run the pass by name, e.g. in the lit tests under tests/lit
+    PB.registerPipelineParsingCallback(
+        [](StringRef Name, ModulePassManager &MPM,
+           ArrayRef<PassBuilder::PipelineElement>) {
+          if (Name == "amdgcn-submit-bb-interval") {
+            MPM.addPass(AMDGCNSubmitBBInterval());
+            return true;
+          }
+          return false;
+        });
   };
 
-  return {LLVM_PLUGIN_API_VERSION, "amdgcn-submit-address-message",
+  return {LLVM_PLUGIN_API_VERSION, "amdgcn-submit-bb-interval",
           LLVM_VERSION_STRING, callback};
 };
 
@@ -108,11 +108,13 @@ bool AMDGCNSubmitBBStart::runOnModule(Module &M) {
   // Now s_submit_wave_header should be available inside M
 
   std::vector<Function *> GpuKernels = collectGPUKernels(M);
+  InstrumentationSampling Sampling;
 
   bool ModifiedCodeGen = false;
   for (auto &I : GpuKernels) {
     ValueToValueMapTy VMap;
     Function *NF = cloneKernelWithExtraArg(I, M, VMap);
+    Function *Plain = Sampling.copyBody(NF);
 
     // Get the ptr we just added to the kernel arguments
     Value *bufferPtr = &*NF->arg_end() - 1;
@@ -129,6 +131,8 @@ bool AMDGCNSubmitBBStart::runOnModule(Module &M) {
         ModifiedCodeGen = true;
       }
     }
+    if (Plain)
+      Sampling.addGuard(NF, Plain);
   }
   errs() << "Done running AMDGCNSubmitBBStart on module: " << M.getName()
          << "\n";
@@ -26,16 +26,22 @@ THE SOFTWARE.
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+#include <algorithm>
 #include <cstdlib>
 #include <dlfcn.h>
 #include <fstream>
 #include <sstream>
+#include <tuple>
 #include <type_traits>
 
 using namespace llvm;
@@ -422,50 +428,108 @@ InstrumentationScope::InstrumentationScope() {
   active_ = !entries_.empty();
 
   if (active_) {
+    compile();
     llvm::errs() << "InstrumentationScope: " << entries_.size()
                  << " scope definition(s) active\n";
   }
 }
 
-bool InstrumentationScope::matches(const std::string &file,
-                                   uint32_t line) const {
-  if (!active_)
-    return true;
-
-  for (const auto &entry : entries_) {
-    // Check file match
-    bool file_matches = false;
-
-    if (entry.file_pattern.empty()) {
-      // Empty pattern matches any file
-      file_matches = true;
-    } else if (entry.is_full_path) {
-      // Full path: exact match
-      file_matches = (file == entry.file_pattern);
-    } else {
-      // Tail match: file must end with the pattern
-      if (file.size() >= entry.file_pattern.size()) {
-        file_matches =
-            (file.compare(file.size() - entry.file_pattern.size(),
-                          entry.file_pattern.size(), entry.file_pattern) == 0);
+void InstrumentationScope::compile() {
+  trie_.assign(1, TrieNode());
+  for (uint32_t Idx = 0; Idx < entries_.size(); ++Idx) {
+    const ScopeEntry &entry = entries_[Idx];
+    uint32_t node = 0;
+    for (auto c = entry.file_pattern.rbegin(); c != entry.file_pattern.rend();
+         ++c) {
+      auto child = trie_[node].children.find(*c);
+      if (child == trie_[node].children.end()) {
+        child = trie_[node].children.emplace(*c, trie_.size()).first;
+        trie_.emplace_back();
       }
+      node = child->second;
     }
+    if (entry.is_full_path)
+      trie_[node].exact_entries.push_back(Idx);
+    else
+      trie_[node].tail_entries.push_back(Idx);
+  }
+}
 
-    if (!file_matches)
-      continue;
+InstrumentationScope::FileScope
+InstrumentationScope::compileFile(const std::string &file) const {
+  // Walk the path from its last character, collecting the entries whose
+  // pattern is a suffix of it (or all of it, for full paths)
+  std::vector<uint32_t> matched(trie_[0].tail_entries);
+  uint32_t node = 0;
+  for (size_t i = file.size(); i-- > 0;) {
+    auto child = trie_[node].children.find(file[i]);
+    if (child == trie_[node].children.end())
+      break;
+    node = child->second;
+    const TrieNode &n = trie_[node];
+    matched.insert(matched.end(), n.tail_entries.begin(), n.tail_entries.end());
+    if (i == 0)
+      matched.insert(matched.end(), n.exact_entries.begin(),
+                     n.exact_entries.end());
+  }
 
+  FileScope result;
+  for (uint32_t Idx : matched) {
+    const auto &ranges = entries_[Idx].ranges;
     // If no ranges specified, file match alone is sufficient
-    if (entry.ranges.empty())
-      return true;
-
-    // Check if line falls in any range
-    for (const auto &range : entry.ranges) {
-      if (line >= range.first && line < range.second)
-        return true;
+    if (ranges.empty()) {
+      result.all_lines = true;
+      result.ranges.clear();
+      return result;
     }
+    result.ranges.insert(result.ranges.end(), ranges.begin(), ranges.end());
+  }
+
+  // Merge overlapping and adjacent ranges
+  std::sort(result.ranges.begin(), result.ranges.end());
+  size_t merged = 0;
+  for (const auto &range : result.ranges) {
+    if (merged > 0 && range.first <= result.ranges[merged - 1].second)
+      result.ranges[merged - 1].second =
+          std::max(result.ranges[merged - 1].second, range.second);
+    else
+      result.ranges[merged++] = range;
   }
+  result.ranges.resize(merged);
+  return result;
+}
 
-  return false;
+bool InstrumentationScope::FileScope::contains(uint32_t line) const {
+  if (all_lines)
+    return true;
+  // The first range that starts after line; the one before it may hold line
+  auto it = std::upper_bound(
+      ranges.begin(), ranges.end(), line,
+      [](uint32_t l, const std::pair<uint32_t, uint32_t> &range) {
+        return l < range.first;
+      });
+  return it != ranges.begin() && line < std::prev(it)->second;
+}
+
+bool InstrumentationScope::matches(const std::string &file,
+                                   uint32_t line) const {
+  if (!active_)
+    return true;
+  return compileFile(file).contains(line);
+}
+
+bool InstrumentationScope::matches(const llvm::DILocation *DL) const {
+  if (!active_)
+    return true;
+  if (!DL)
+    return false;
+  // getFullPath only depends on the DIFile, so it is built and matched once
+  // per file rather than once per instruction
+  const DIFile *File = DL->getScope()->getFile();
+  auto it = file_cache_.find(File);
+  if (it == file_cache_.end())
+    it = file_cache_.try_emplace(File, compileFile(getFullPath(DL))).first;
+  return it->second.contains(DL->getLine());
 }
 
 bool InstrumentationScope::parseFile(const std::string &path) {
@@ -494,5 +558,341 @@ bool InstrumentationScope::parseFile(const std::string &path) {
   return parseDefinitions(combined);
 }
 
+// --- InstrumentationSampling implementation ---
+
+InstrumentationSampling::InstrumentationSampling() {
+  const char *dual_path_env = std::getenv("INSTRUMENTATION_DUAL_PATH");
+  dual_path_ = dual_path_env && *dual_path_env &&
+               std::string(dual_path_env) != "0";
+  if (dual_path_) {
+    llvm::errs() << "InstrumentationSampling: dual-path clones\n";
+  }
+
+  const char *sample_env = std::getenv("INSTRUMENTATION_SAMPLE");
+  if (!sample_env)
+    return;
+
+  std::string sample_str = trimWhitespace(sample_env);
+  if (sample_str.empty())
+    return;
+
+  if (!parse(sample_str)) {
+    llvm::errs() << "InstrumentationSampling: invalid INSTRUMENTATION_SAMPLE '"
+                 << sample_str
+                 << "' (expected workgroup:N, wave-mask:M or hash:N[:S]). "
+                    "Disabling sampling.\n";
+    mode_ = Mode::None;
+    return;
+  }
+
+  if (isActive()) {
+    llvm::errs() << "InstrumentationSampling: " << sample_str << "\n";
+  } else {
+    llvm::errs() << "InstrumentationSampling: '" << sample_str
+                 << "' samples every wave, no guards added\n";
+  }
+}
+
+bool InstrumentationSampling::parse(const std::string &spec) {
+  StringRef Kind, Rest, Param, Seed;
+  std::tie(Kind, Rest) = StringRef(spec).split(':');
+  std::tie(Param, Seed) = Rest.split(':');
+  // getAsInteger returns true on error; radix 0 accepts 0x-prefixed hex
+  if (Param.empty() || Param.getAsInteger(0, param_))
+    return false;
+
+  if (Kind == "workgroup" && Seed.empty()) {
+    if (param_ == 0 || param_ > UINT32_MAX)
+      return false;
+    mode_ = param_ == 1 ? Mode::None : Mode::WorkgroupStride;
+  } else if (Kind == "wave-mask" && Seed.empty()) {
+    if (param_ == 0)
+      return false;
+    mode_ = param_ == UINT64_MAX ? Mode::None : Mode::WaveMask;
+  } else if (Kind == "hash") {
+    if (param_ == 0 || param_ > UINT32_MAX)
+      return false;
+    if (!Seed.empty() && Seed.getAsInteger(0, seed_))
+      return false;
+    mode_ = param_ == 1 ? Mode::None : Mode::Hash;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+llvm::Function *InstrumentationSampling::copyBody(llvm::Function *NF) const {
+  if (!isActive() && !dual_path_)
+    return nullptr;
+
+  Function *Plain =
+      Function::Create(NF->getFunctionType(), GlobalValue::PrivateLinkage,
+                       NF->getAddressSpace(), NF->getName() + ".plain",
+                       NF->getParent());
+  ValueToValueMapTy VMap;
+  Function::arg_iterator DestI = Plain->arg_begin();
+  for (const Argument &J : NF->args()) {
+    DestI->setName(J.getName());
+    VMap[&J] = &*DestI++;
+  }
+
+  SmallVector<BasicBlock *, 16> Blocks;
+  for (BasicBlock &BB : *NF) {
+    BasicBlock *Copy = CloneBasicBlock(&BB, VMap, ".plain", Plain);
+    VMap[&BB] = Copy;
+    Blocks.push_back(Copy);
+  }
+  // Unlike CloneFunctionInto, this leaves metadata alone, so that the copy
+  // keeps NF's debug info scopes when addGuard moves it back into NF
+  remapInstructionsInBlocks(Blocks, VMap);
+  return Plain;
+}
+
+// Loads a field of the hsa_kernel_dispatch_packet_t and zero-extends it to i32
+static Value *loadDispatchField(IRBuilder<> &Builder, Value *DispatchPtr,
+                                uint64_t Offset, Type *Ty) {
+  Value *Addr = Builder.CreateConstInBoundsGEP1_64(Builder.getInt8Ty(),
+                                                   DispatchPtr, Offset);
+  Value *Field = Builder.CreateAlignedLoad(
+      Ty, Addr, Align(Ty->getPrimitiveSizeInBits() / 8));
+  return Builder.CreateZExt(Field, Builder.getInt32Ty());
+}
+
+// Linear workgroup id, x fastest, as the host numbers blocks
+static Value *workgroupLinearId(IRBuilder<> &Builder, Value *DispatchPtr) {
+  Value *IdX =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_workgroup_id_x, {}, {});
+  Value *IdY =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_workgroup_id_y, {}, {});
+  Value *IdZ =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_workgroup_id_z, {}, {});
+  // Number of workgroups in x and y: ceil(grid_size / workgroup_size)
+  Value *Groups[2];
+  for (unsigned Dim = 0; Dim < 2; Dim++) {
+    Value *WgSize = loadDispatchField(Builder, DispatchPtr, 4 + 2 * Dim,
+                                      Builder.getInt16Ty());
+    Value *GridSize = loadDispatchField(Builder, DispatchPtr, 12 + 4 * Dim,
+                                        Builder.getInt32Ty());
+    Groups[Dim] = Builder.CreateUDiv(
+        Builder.CreateAdd(GridSize,
+                          Builder.CreateSub(WgSize, Builder.getInt32(1))),
+        WgSize);
+  }
+  Value *Linear = Builder.CreateAdd(IdY, Builder.CreateMul(IdZ, Groups[1]));
+  return Builder.CreateAdd(IdX, Builder.CreateMul(Linear, Groups[0]),
+                           "sample.wg");
+}
+
+// Index of the wave within its workgroup, made uniform with readfirstlane so
+// that the guard is a scalar branch
+static Value *waveIndex(IRBuilder<> &Builder, Value *DispatchPtr) {
+  Value *TidX =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_workitem_id_x, {}, {});
+  Value *TidY =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_workitem_id_y, {}, {});
+  Value *TidZ =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_workitem_id_z, {}, {});
+  Value *SizeX =
+      loadDispatchField(Builder, DispatchPtr, 4, Builder.getInt16Ty());
+  Value *SizeY =
+      loadDispatchField(Builder, DispatchPtr, 6, Builder.getInt16Ty());
+  Value *Flat = Builder.CreateAdd(TidY, Builder.CreateMul(TidZ, SizeY));
+  Flat = Builder.CreateAdd(TidX, Builder.CreateMul(Flat, SizeX));
+  Value *WaveSize =
+      Builder.CreateIntrinsic(Intrinsic::amdgcn_wavefrontsize, {}, {});
+  Value *Wave = Builder.CreateUDiv(Flat, WaveSize);
+  // readfirstlane is overloaded on its type in newer LLVM versions only
+  SmallVector<Type *, 1> Types;
+  if (Intrinsic::isOverloaded(Intrinsic::amdgcn_readfirstlane))
+    Types.push_back(Builder.getInt32Ty());
+  return Builder.CreateIntrinsic(Intrinsic::amdgcn_readfirstlane, Types,
+                                 {Wave}, nullptr, "sample.wave");
+}
+
+// 32-bit finalizer of MurmurHash3
+static Value *mixHash(IRBuilder<> &Builder, Value *H) {
+  H = Builder.CreateXor(H, Builder.CreateLShr(H, 16));
+  H = Builder.CreateMul(H, Builder.getInt32(0x85ebca6b));
+  H = Builder.CreateXor(H, Builder.CreateLShr(H, 13));
+  H = Builder.CreateMul(H, Builder.getInt32(0xc2b2ae35));
+  return Builder.CreateXor(H, Builder.CreateLShr(H, 16));
+}
+
+void InstrumentationSampling::addGuard(llvm::Function *NF,
+                                       llvm::Function *Plain) const {
+  BasicBlock *Instrumented = &NF->getEntryBlock();
+  BasicBlock *Uninstrumented = &Plain->getEntryBlock();
+
+  // Static allocas of both bodies move to the new entry block, so that they
+  // stay static
+  std::vector<AllocaInst *> Allocas;
+  for (BasicBlock *BB : {Instrumented, Uninstrumented}) {
+    for (Instruction &Inst : *BB) {
+      auto *AI = dyn_cast<AllocaInst>(&Inst);
+      if (AI && AI->isStaticAlloca())
+        Allocas.push_back(AI);
+    }
+  }
+
+  for (auto PA = Plain->arg_begin(), NA = NF->arg_begin();
+       PA != Plain->arg_end(); ++PA, ++NA) {
+    PA->replaceAllUsesWith(&*NA);
+  }
+  while (!Plain->empty()) {
+    BasicBlock &BB = Plain->front();
+    BB.removeFromParent();
+    BB.insertInto(NF);
+  }
+  Plain->eraseFromParent();
+
+  BasicBlock *Guard = BasicBlock::Create(NF->getContext(), "sample.guard", NF,
+                                         Instrumented);
+  for (AllocaInst *AI : Allocas)
+    AI->moveBefore(*Guard, Guard->end());
+
+  IRBuilder<> Builder(Guard);
+  Value *DispatchPtr = nullptr;
+  if (isActive()) {
+    DispatchPtr =
+        Builder.CreateIntrinsic(Intrinsic::amdgcn_dispatch_ptr, {}, {});
+  }
+  Value *Sampled = nullptr;
+  switch (mode_) {
+  case Mode::WorkgroupStride:
+    Sampled = Builder.CreateICmpEQ(
+        Builder.CreateURem(workgroupLinearId(Builder, DispatchPtr),
+                           Builder.getInt32(param_)),
+        Builder.getInt32(0), "sample.pred");
+    break;
+  case Mode::WaveMask: {
+    Value *Wave = Builder.CreateZExt(waveIndex(Builder, DispatchPtr),
+                                     Builder.getInt64Ty());
+    Wave = Builder.CreateAnd(Wave, 63);
+    Value *Bit =
+        Builder.CreateAnd(Builder.CreateLShr(Builder.getInt64(param_), Wave),
+                          1);
+    Sampled = Builder.CreateICmpNE(Bit, Builder.getInt64(0), "sample.pred");
+    break;
+  }
+  case Mode::Hash: {
+    Value *Workgroup = workgroupLinearId(Builder, DispatchPtr);
+    Value *Wave = waveIndex(Builder, DispatchPtr);
+    Value *Key = Builder.CreateAdd(
+        Builder.CreateMul(Workgroup, Builder.getInt32(0x9e3779b1)),
+        Builder.CreateMul(Wave, Builder.getInt32(0x85ebca77)));
+    Key = Builder.CreateAdd(Key, Builder.getInt32(seed_));
+    Sampled = Builder.CreateICmpEQ(
+        Builder.CreateURem(mixHash(Builder, Key), Builder.getInt32(param_)),
+        Builder.getInt32(0), "sample.pred");
+    break;
+  }
+  case Mode::None:
+    break;
+  }
+  if (dual_path_) {
+    // The dh_comms pointer is a kernel argument, so this is uniform too
+    Value *Comms = &*(NF->arg_end() - 1);
+    Value *Capture = Builder.CreateIsNotNull(Comms, "comms.nonnull");
+    Sampled = Sampled ? Builder.CreateAnd(Capture, Sampled, "capture.pred")
+                      : Capture;
+  }
+  Builder.CreateCondBr(Sampled, Instrumented, Uninstrumented);
+
+  if (dual_path_) {
+    Module &M = *NF->getParent();
+    Type *Int8Ty = Builder.getInt8Ty();
+    auto *Marker = new GlobalVariable(
+        M, Int8Ty, /*isConstant=*/true, GlobalValue::ExternalLinkage,
+        ConstantInt::get(Int8Ty, 1), NF->getName() + DualPathMarkerSuffix,
+        nullptr, GlobalValue::NotThreadLocal, /*AddressSpace=*/4);
+    Marker->setVisibility(GlobalValue::ProtectedVisibility);
+    appendToUsed(M, {Marker});
+  }
+
+  // The sampling predicate reads the dispatch packet and the workgroup and
+  // workitem ids, whatever the original kernel needed
+  if (isActive()) {
+    for (const char *Attr :
+         {"amdgpu-no-dispatch-ptr", "amdgpu-no-workgroup-id-x",
+          "amdgpu-no-workgroup-id-y", "amdgpu-no-workgroup-id-z",
+          "amdgpu-no-workitem-id-x", "amdgpu-no-workitem-id-y",
+          "amdgpu-no-workitem-id-z"}) {
+      NF->removeFnAttr(Attr);
+    }
+  }
+}
+
+// --- InstrumentationSiteManifest implementation ---
+
+InstrumentationSiteManifest::InstrumentationSiteManifest() {
+  const char *Env = std::getenv("INSTRUMENTATION_SITE_MANIFEST");
+  active_ = Env != nullptr && *Env != '\0' && std::string(Env) != "0";
+  if (active_) {
+    llvm::errs() << "InstrumentationSiteManifest: sites are reported by id\n";
+  }
+}
+
+void InstrumentationSiteManifest::assignSite(const std::string &File,
+                                             uint32_t Column,
+                                             uint8_t AddrSpace,
+                                             uint8_t AccessKind, uint16_t Size,
+                                             uint64_t &FileHash,
+                                             uint32_t &Line) {
+  if (!active_)
+    return;
+  auto It = file_index_.find(File);
+  if (It == file_index_.end()) {
+    It = file_index_.emplace(File, files_.size()).first;
+    files_.push_back(File);
+  }
+  FileHash = sites_.size();
+  sites_.push_back({It->second, Line, Column, AddrSpace, AccessKind, Size});
+  Line = SiteManifestLineFlag;
+}
+
+void InstrumentationSiteManifest::emit(Function &NF) {
+  if (!active_)
+    return;
+
+  // Both the device and the host are little endian
+  std::vector<uint8_t> Bytes;
+  auto put = [&Bytes](uint64_t Value, size_t Size) {
+    for (size_t I = 0; I < Size; I++)
+      Bytes.push_back(static_cast<uint8_t>(Value >> (8 * I)));
+  };
+  Bytes.insert(Bytes.end(), {'O', 'P', 'S', 'M'});
+  put(SiteManifestVersion, 2);
+  put(16, 2); // record size
+  put(sites_.size(), 4);
+  put(files_.size(), 4);
+  for (const Site &S : sites_) {
+    put(S.File, 4);
+    put(S.Line, 4);
+    put(S.Column, 4);
+    put(S.AddrSpace, 1);
+    put(S.AccessKind, 1);
+    put(S.Size, 2);
+  }
+  for (const std::string &File : files_) {
+    Bytes.insert(Bytes.end(), File.begin(), File.end());
+    Bytes.push_back(0);
+  }
+
+  Module &M = *NF.getParent();
+  Constant *Data = ConstantDataArray::get(M.getContext(), Bytes);
+  auto *Manifest = new GlobalVariable(
+      M, Data->getType(), /*isConstant=*/true, GlobalValue::ExternalLinkage,
+      Data, NF.getName() + SiteManifestSuffix, nullptr,
+      GlobalValue::NotThreadLocal, /*AddressSpace=*/4);
+  Manifest->setVisibility(GlobalValue::ProtectedVisibility);
+  appendToUsed(M, {Manifest});
+  llvm::errs() << "InstrumentationSiteManifest: " << sites_.size()
+               << " site(s) for " << NF.getName() << "\n";
+
+  sites_.clear();
+  files_.clear();
+  file_index_.clear();
+}
+
 } // namespace common
 } // namespace instrumentation
@@ -32,13 +32,13 @@ namespace {
 
 struct AMDGCNSubmitAddressMessage
     : public PassInfoMixin<AMDGCNSubmitAddressMessage> {
-  PreservedAnalyses run(Module &M, ModuleAnalysisManager &) {
-    bool Changed = runOnModule(M);
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM) {
+    bool Changed = runOnModule(M, MAM);
 
     return (Changed ? llvm::PreservedAnalyses::none()
                     : llvm::PreservedAnalyses::all());
   }
-  bool runOnModule(llvm::Module &M);
+  bool runOnModule(llvm::Module &M, llvm::ModuleAnalysisManager &MAM);
   // isRequired being set to true keeps this pass from being skipped
   // if it has the optnone LLVM attribute
   static bool isRequired() { return true; }
@@ -22,18 +22,21 @@ THE SOFTWARE.
 #ifndef INSTRUMENTATION_COMMON_H
 #define INSTRUMENTATION_COMMON_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace llvm {
+class DIFile;
 class DILocation;
-}
+} // namespace llvm
 
 namespace instrumentation {
 namespace common {
@@ -76,6 +79,12 @@ struct ScopeEntry {
 // Reads INSTRUMENTATION_SCOPE and INSTRUMENTATION_SCOPE_FILE environment
 // variables to determine which source locations should be instrumented.
 // When no scope is set, all instructions are instrumented (default behavior).
+//
+// The entries are compiled into a trie over the reversed file patterns, so
+// finding the entries that match a file is one walk from the end of its path.
+// The line ranges of those entries are merged into one sorted array per file,
+// and the result is cached per DIFile, leaving a binary search per
+// instruction.
 class InstrumentationScope {
 public:
   // Reads env vars and parses scope definitions.
@@ -89,17 +98,152 @@ public:
   // When scope is not active, always returns true.
   bool matches(const std::string &file, uint32_t line) const;
 
+  // Same as above for the file and line of a debug location. Returns false
+  // for a null location when the scope is active.
+  bool matches(const llvm::DILocation *DL) const;
+
   // Returns the number of scope entries (for diagnostic messages).
   size_t size() const { return entries_.size(); }
 
 private:
+  // The lines of one file that are in scope
+  struct FileScope {
+    bool all_lines = false;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges; // sorted, disjoint
+    bool contains(uint32_t line) const;
+  };
+
+  // A node of the reversed-pattern trie. A pattern ends at the node reached
+  // by its last character; entries with an empty pattern sit at the root.
+  struct TrieNode {
+    std::map<char, uint32_t> children;
+    std::vector<uint32_t> tail_entries;  // match any path ending here
+    std::vector<uint32_t> exact_entries; // match only the whole path
+  };
+
   bool parseDefinitions(const std::string &input);
   bool parseFile(const std::string &path);
+  void compile();
+  FileScope compileFile(const std::string &file) const;
 
   std::vector<ScopeEntry> entries_;
+  std::vector<TrieNode> trie_;
+  mutable llvm::DenseMap<const llvm::DIFile *, FileScope> file_cache_;
   bool active_ = false;
 };
 
+// Compile-time wave sampling for instrumented kernels.
+//
+// Reads the INSTRUMENTATION_SAMPLE environment variable, one of:
+//   workgroup:N   - only workgroups whose linear id is a multiple of N
+//   wave-mask:M   - only waves whose index in their workgroup has its bit set
+//                   in the 64-bit mask M (decimal or 0x-prefixed hex)
+//   hash:N[:S]    - about one wave in N, picked by a hash of the workgroup id
+//                   and wave index (S seeds the hash, default 0)
+// When sampling is active, a pass saves an uninstrumented copy of each clone
+// with copyBody() before instrumenting it, then calls addGuard(). Sampled
+// waves run the instrumented body; all others branch at kernel entry to the
+// uninstrumented one.
+//
+// INSTRUMENTATION_DUAL_PATH=1 builds the clones the same way, and also sends
+// every wave to the uninstrumented body when the dh_comms pointer is null.
+// The runtime can then dispatch the clone with a null pointer when it doesn't
+// want to capture a dispatch. addGuard() marks such clones with a global
+// named <clone name> + DualPathMarkerSuffix, which the runtime looks for.
+class InstrumentationSampling {
+public:
+  enum class Mode { None, WorkgroupStride, WaveMask, Hash };
+
+  // Reads and parses INSTRUMENTATION_SAMPLE.
+  // On parse error, prints diagnostic to stderr and disables sampling.
+  InstrumentationSampling();
+
+  // Returns true if sampling is active.
+  bool isActive() const { return mode_ != Mode::None; }
+
+  // Returns true if clones are built with a null dh_comms pointer check.
+  bool isDualPath() const { return dual_path_; }
+
+  // Copies the body of NF into a new private function, to be called before
+  // NF is instrumented. Returns nullptr when neither sampling nor dual-path
+  // clones are active.
+  llvm::Function *copyBody(llvm::Function *NF) const;
+
+  // Moves the blocks of Plain (from copyBody) into the instrumented kernel NF
+  // and adds an entry block that evaluates the sampling predicate once per
+  // wave and branches to the instrumented or the uninstrumented body. Plain
+  // is erased.
+  void addGuard(llvm::Function *NF, llvm::Function *Plain) const;
+
+private:
+  bool parse(const std::string &spec);
+
+  Mode mode_ = Mode::None;
+  uint64_t param_ = 0; // N for workgroup/hash, the mask for wave-mask
+  uint32_t seed_ = 0;
+  bool dual_path_ = false;
+};
+
+// Must match DUAL_PATH_MARKER_SUFFIX in inc/utils.h
+constexpr const char *DualPathMarkerSuffix = ".dual_path";
+
+// Compile-time site manifest for instrumented kernels.
+//
+// When INSTRUMENTATION_SITE_MANIFEST is set to anything other than "0", every
+// instrumented site of a clone gets a dense id, starting at 0 in each clone,
+// and its messages carry that id in place of the source file hash, with
+// SiteManifestLineFlag in place of the line. The file, line, column, address
+// space, access kind and IR access size of each site are written to a
+// constant global named <clone name> + SiteManifestSuffix in the code object,
+// so host handlers can look sites up by index instead of matching DWARF
+// locations against kernelDB. Since version 2, each member of an access group
+// has a site of its own, following the site the group's message carries. The
+// layout must match inc/site_manifest.h:
+//
+//   header   "OPSM", u16 version, u16 record size, u32 sites, u32 files
+//   records  u32 file index, u32 line, u32 column, u8 address space,
+//            u8 access kind, u16 size
+//   files    NUL-terminated file names, in file index order
+class InstrumentationSiteManifest {
+public:
+  // Reads INSTRUMENTATION_SITE_MANIFEST.
+  InstrumentationSiteManifest();
+
+  bool isActive() const { return active_; }
+
+  // Records a site of the current clone. When the manifest is active,
+  // replaces FileHash with the site id and Line with SiteManifestLineFlag, so
+  // that they can be passed on to the dh_comms submit function unchanged.
+  void assignSite(const std::string &File, uint32_t Column, uint8_t AddrSpace,
+                  uint8_t AccessKind, uint16_t Size, uint64_t &FileHash,
+                  uint32_t &Line);
+
+  // Writes the manifest of the sites recorded since the last call next to
+  // the clone NF, and starts over for the next clone.
+  void emit(llvm::Function &NF);
+
+private:
+  struct Site {
+    uint32_t File;
+    uint32_t Line;
+    uint32_t Column;
+    uint8_t AddrSpace;
+    uint8_t AccessKind;
+    uint16_t Size;
+  };
+
+  bool active_ = false;
+  std::vector<Site> sites_;
+  std::vector<std::string> files_;
+  std::map<std::string, uint32_t> file_index_;
+};
+
+// Must match SITE_MANIFEST_SUFFIX and SITE_MANIFEST_LINE_FLAG in
+// inc/site_manifest.h
+constexpr const char *SiteManifestSuffix = ".sites";
+constexpr uint32_t SiteManifestLineFlag = 0x80000000u;
+constexpr uint16_t SiteManifestVersion = 2;
+
 } // namespace common
 } // namespace instrumentation
 
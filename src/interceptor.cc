@@ -37,7 +37,6 @@ THE SOFTWARE.
 #include <sys/types.h>
 #include <sys/mman.h>
 #include <sys/inotify.h>
-#include <sys/select.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <limits.h>
@@ -144,22 +143,44 @@ bool hsaInterceptor::hasPendingSignals()
 
 
 
+/*
+    The async handlers of dispatches still in flight run on the runtime's thread, which we can't join. They reach
+    the interceptor only through singleton_, under singleton_mutex_, so once it is cleared none is running or
+    will run. The interceptor is then deleted only if every dispatch has signaled: a dispatch that hasn't may
+    still be running with our kernargs and comms object, so it is left in place for the process to exit with.
+    Its duration log is closed instead, so that what the destructor would have written isn't lost.
+*/
 void hsaInterceptor::cleanup()
 {
-    if(singleton_)
+    hsaInterceptor *instance;
     {
-        delete singleton_;
+        const lock_guard<mutex> lock(singleton_mutex_);
+        instance = singleton_;
         singleton_ = NULL;
     }
+    if (!instance)
+        return;
+    if (instance->hasUnsignaledDispatches())
+    {
+        cerr << INTERCEPTOR_MSG << "Dispatches still running at shutdown, leaving their resources in place" << endl;
+        instance->log_.close();
+        return;
+    }
+    // Completions queued before singleton_ was cleared are processed by the destructor
+    delete instance;
 }
 
 
 hsaInterceptor::hsaInterceptor(HsaApiTable* table, uint64_t runtime_version, uint64_t failed_tool_count, const char* const* failed_tool_names) :
-    signal_runner_(signal_runner), cache_watcher_(cache_watcher), kernel_cache_(table), allocator_(table, std::cerr),
-        comms_mgr_(table), comms_runner_(comms_runner, std::ref(comms_mgr_))
+    completion_event_(-1), completed_since_(0), unsignaled_dispatches_(0), cache_fd_(-1), co_generation_(0), kernel_cache_(table), allocator_(table, std::cerr), comms_mgr_(table)
 {
     apiTable_ = table;
     getLogDurConfig(config_);
+    if (config_["LOGDUR_TELEMETRY"] == "true" && telemetry_.create(telemetrySegment::defaultName()))
+    {
+        telemetry_.activate();
+        std::cerr << INTERCEPTOR_MSG << "Telemetry is in shared memory segment " << telemetry_.name() << std::endl;
+    }
     comms_mgr_.setConfig(config_);
     log_.setLocation(config_["LOGDUR_LOG_LOCATION"]);
 
@@ -176,7 +197,10 @@ hsaInterceptor::hsaInterceptor(HsaApiTable* table, uint64_t runtime_version, uin
     else
         run_instrumented_ = false;
     if (!run_instrumented_)
+    {
+        log_.setMode(config_["LOGDUR_DURATION_MODE"]);
         log_.logHeaders();
+    }
     //kernel_cache_.setLocation(config_["LOGDUR_KERNEL_CACHE"]);
     for (int i = 0; i < SIGPOOL_INCREMENT; i++)
     {
@@ -203,7 +227,11 @@ hsaInterceptor::hsaInterceptor(HsaApiTable* table, uint64_t runtime_version, uin
                         /* If we're running Triton, the user needs to specify the location of the Triton
                          * code object cache directory - usually in $HOME/.triton/cache */
                         if (cacheLocation.length())
+                        {
                             kernel_cache_.setLocation(agent, cacheLocation, config_["LOGDUR_FILTER"]);
+                            // Created up front so that code objects ingested later never have to touch kdbs_
+                            kdbs_[agent] = std::make_unique<kernelDB::kernelDB>(agent);
+                        }
                         else
                         {
                             /* If a KERNEL_CACHE directory is not supplied, we look for all the kernels in fat binaries
@@ -253,15 +281,27 @@ hsaInterceptor::hsaInterceptor(HsaApiTable* table, uint64_t runtime_version, uin
                     }
                 }
     }
+    completion_event_ = reactor_.addEvent([this]() { processCompletions(); });
+    if (log_.getMode() == LOGDUR_MODE_RAW)
+        reactor_.addTimer(LOGDUR_FLUSH_INTERVAL_MS, [this]() { log_.flush(); });
+    watchKernelCache();
+    if (completion_event_ < 0 || !reactor_.start())
+    {
+        cerr << INTERCEPTOR_MSG << "Unable to start the event reactor, kernel completions can't be tracked" << endl;
+        abort();
+    }
 }
 hsaInterceptor::~hsaInterceptor() {
     shutting_down_.store(true);
 
-    signal_runner_.join();
-    cache_watcher_.join();
-    comms_runner_.join();
+    reactor_.stop();
+    // Nothing enqueues once the reactor is gone; code objects still waiting are dropped
+    co_ingest_.reset();
+    // Anything the async handler queued after the reactor's last wakeup
+    processCompletions();
+    if (cache_fd_ >= 0)
+        close(cache_fd_);
 
-    // Join signal processing thread here
     lock_guard<std::mutex> lock(mutex_);
     for (auto sig : sig_pool_)
         CHECK_STATUS("Signal cleanup error at shutdown", apiTable_->core_->hsa_signal_destroy_fn(sig));
@@ -298,15 +338,10 @@ bool hsaInterceptor::addCodeObject(const std::string& name)
         if (name.length())
         {
             for (auto agent : gpus)
-            {
-                kernel_cache_.addFile(name, agent, config_["LOGDUR_FILTER"]);
-                // kernelDB scanning is deferred to dispatch time via scanCodeObject()
-                {
-                    lock_guard<std::mutex> lock(mutex_);
-                    if (kdbs_.find(agent) == kdbs_.end())
-                        kdbs_[agent] = std::make_unique<kernelDB::kernelDB>(agent);
-                }
-            }
+                kernel_cache_.addFile(name, agent, config_.at("LOGDUR_FILTER"));
+            // New code objects may supply alternatives for kernels we've already resolved
+            co_generation_.fetch_add(1, std::memory_order_release);
+            telemetryCount(TELEMETRY_CODE_OBJECTS);
         }
     }
     return true;
@@ -340,252 +375,211 @@ void hsaInterceptor::restoreHsaApi() {
 
 void hsaInterceptor::signalCompleted(const hsa_signal_t sig)
 {
-    lock_guard<std::mutex> lock(mutex_);
-    auto it = pending_signals_.find(sig);
-    if (it != pending_signals_.end())
+    // Logged after mutex_ is released, so that writing a line or recording a duration never holds up fixupPacket
+    bool completed = false;
+    kernel_name_id_t name_id = KERNEL_NAME_EMPTY;
+    uint64_t dispatchNs = 0, startNs = 0, endNs = 0;
     {
-        kernel_info_t ki = it->second;
-        pending_signals_.erase(sig);
-        // If the application originally provided a completion_signal
-        // We need to decrement it to ensure application behavior isn't affected.
-        if (ki.signal_.handle)
+        lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_signals_.find(sig);
+        if (it != pending_signals_.end())
         {
-            // need to subtract here because that would have been done if we hadn't swapped signals
-            hsa_signal_subtract_scacq_screl(ki.signal_, 1);
+            kernel_info_t ki = it->second;
+            completed = true;
+            name_id = ki.name_id_;
+            pending_signals_.erase(sig);
+            telemetryCount(TELEMETRY_COMPLETIONS);
+            telemetryCount(TELEMETRY_PENDING_SIGNALS, -1);
+            // If the application originally provided a completion_signal
+            // We need to decrement it to ensure application behavior isn't affected.
+            if (ki.signal_.handle)
+            {
+                // need to subtract here because that would have been done if we hadn't swapped signals
+                hsa_signal_subtract_scacq_screl(ki.signal_, 1);
+            }
+            // Need to extract start and stop here
+            hsa_amd_profiling_dispatch_time_t this_time;
+            apiTable_->amd_ext_->hsa_amd_profiling_get_dispatch_time_fn(ki.agent_, sig, &this_time);
+            startNs = this_time.start;
+            endNs = this_time.end;
+            dispatchNs = ki.th_.getStartTime();
+            //cerr << "Elapsed micro seconds with all the host overhead: " << std::dec << ki.th_.getElapsedMicros() << " us\n";
+            //cerr << "\tMeasured kernel duration: " << endNs - startNs << " ns\n";
+            // Reinitialize signal value to 1 for use in next dispatch.
+            (apiTable_->core_->hsa_signal_store_screlease_fn)(sig, 1);
+            // Look to see if we allocated an alternative kernarg  buffer  for this dispatch
+            auto ka_it = pending_kernargs_.find(sig);
+            if (ka_it != pending_kernargs_.end())
+            {
+                // Free any alternative kernarg buffer we allocated.
+                allocator_.free(ka_it->second);
+                pending_kernargs_.erase(sig);
+            }
+            //Put this completion signal back in the pool for subsequent dispatches
+            sig_pool_.push_back(sig);
+            if (ki.comms_obj_) {
+                comms_mgr_.checkinCommsObject(ki.agent_, ki.comms_obj_);
+            }
         }
-        // Need to extract start and stop here
-        hsa_amd_profiling_dispatch_time_t this_time;
-        apiTable_->amd_ext_->hsa_amd_profiling_get_dispatch_time_fn(ki.agent_, sig, &this_time);
-        auto startNs = this_time.start;
-        auto endNs = this_time.end;
-        auto dispatchNs = ki.th_.getStartTime();
-        if (!run_instrumented_)
-            log_.log(ki.name_, dispatchNs, startNs, endNs);
-        //cerr << "Elapsed micro seconds with all the host overhead: " << std::dec << ki.th_.getElapsedMicros() << " us\n";
-        //cerr << "\tMeasured kernel duration: " << endNs - startNs << " ns\n";
-        // Reinitialize signal value to 1 for use in next dispatch.
-        (apiTable_->core_->hsa_signal_store_screlease_fn)(sig, 1);
-        // Look to see if we allocated an alternative kernarg  buffer  for this dispatch
-        auto ka_it = pending_kernargs_.find(sig);
-        if (ka_it != pending_kernargs_.end())
+        else
         {
-            // Free any alternative kernarg buffer we allocated.
-            allocator_.free(ka_it->second);
-            pending_kernargs_.erase(sig);
-        }
-        //Put this completion signal back in the pool for subsequent dispatches
-        sig_pool_.push_back(sig);
-        if (ki.comms_obj_) {
-            comms_mgr_.checkinCommsObject(ki.agent_, ki.comms_obj_);
+            cerr << "Some big problem occurred, a pending signal is missing\n";
         }
     }
-    else
+    if (completed && !run_instrumented_)
+        log_.log(name_id, dispatchNs, startNs, endNs);
+}
+
+/*
+    Called on the runtime's async signal handler thread when a pool signal reaches zero, i.e. the dispatch it was
+    swapped into has completed. The handler is registered per dispatch, so returning false unregisters it.
+*/
+bool hsaInterceptor::signalReady(hsa_signal_value_t, void *arg)
+{
+    // Held across queueCompletion so that cleanup() can't delete the interceptor, or its reactor close the
+    // completion eventfd, while a handler is still using them
+    const lock_guard<mutex> lock(singleton_mutex_);
+    if (singleton_)
     {
-        cerr << "Some big problem occurred, a pending signal is missing\n";
+        singleton_->queueCompletion({reinterpret_cast<uint64_t>(arg)});
+        singleton_->unsignaled_dispatches_.fetch_sub(1);
     }
+    return false;
 }
 
-void comms_runner(comms_mgr& mgr)
+void hsaInterceptor::queueCompletion(hsa_signal_t sig)
 {
-    //cerr << "Comms Runner\n";
-    hsaInterceptor *me = hsaInterceptor::getInstance();
-    while (!me->shuttingdown())
+    bool wake;
     {
-        usleep(500);
+        lock_guard<std::mutex> lock(completed_mutex_);
+        wake = completed_signals_.empty();
+        if (wake)
+            completed_since_ = telemetryEnabled() ? telemetryNow() : 0;
+        completed_signals_.push_back(sig);
     }
-    cerr << "Comms Runner shutting down\n";
+    // The reactor drains the whole queue on each wakeup, so one notification per batch is enough
+    if (wake)
+        eventReactor::notify(completion_event_);
 }
 
-void cache_watcher()
+void hsaInterceptor::processCompletions()
 {
-    //cerr << "Cache Watcher\n";;
-    hsaInterceptor *me = hsaInterceptor::getInstance();
-    std::string dir = me->getCacheLocation();
-    if (dir.length())
+    std::vector<hsa_signal_t> completed;
+    uint64_t since;
     {
-        std::map<int, std::string> watch_map;
-        int fd = inotify_init();
-        if (fd < 0)
-        {
-            perror("inotify_init");
-            exit(EXIT_FAILURE);
-        }
-        auto files = util_get_directory_files(dir, true);
-        for (const auto& entry : files)
-        {
-            if (util_is_directory(entry))
-            {
-                int wd = inotify_add_watch(fd, entry.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
-                if (wd != -1)
-                {
-                    watch_map[wd] = entry;
-                    cerr << "Added " << entry << " to watch list\n";
-                }
-                else
-                {
-                    cerr << "Could not add " << entry << " to watch list\n";
-                }
-            }
-        }
-
+        lock_guard<std::mutex> lock(completed_mutex_);
+        completed.swap(completed_signals_);
+        since = completed_since_;
+    }
+    // How long the oldest completion in the batch waited for the reactor
+    if (since && completed.size())
+        telemetryRecord(TELEMETRY_COMPLETION_LAG_NS, telemetryNow() - since);
+    for (auto sig : completed)
+        signalCompleted(sig);
+}
 
-        int wd = inotify_add_watch(fd, dir.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
-        if (wd == -1)
-        {
-            fprintf(stderr, "Cannot use '%s' as a kernel cache: %s\n", dir.c_str(), strerror(errno));
-            close(fd);
-            while (!me->shuttingdown())
-                usleep(1000);
-        }
-        else
-        {
-            watch_map[wd] = dir.c_str();
-            //printf("Watching directory '%s' for changes.\n", dir.c_str());
-        }
-        while (!me->shuttingdown())
+/*
+    Triton writes JIT-compiled code objects into its cache directory (LOGDUR_KERNEL_CACHE). Watch it and every
+    directory below it with inotify; the reactor calls onCacheEvents whenever there's something to read, which
+    hands new code objects to co_ingest_. An autotuning run can write hundreds of them in a burst; they are loaded
+    in parallel off the dispatch path, and a kernel dispatched before its code object is published just runs
+    without an alternative that once.
+*/
+void hsaInterceptor::watchKernelCache()
+{
+    std::string dir = getCacheLocation();
+    if (!dir.length())
+        return;
+    cache_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (cache_fd_ < 0)
+    {
+        perror("inotify_init");
+        exit(EXIT_FAILURE);
+    }
+    auto files = util_get_directory_files(dir, true);
+    for (const auto& entry : files)
+    {
+        if (util_is_directory(entry))
         {
-            const size_t event_size = sizeof(struct inotify_event);
-            const size_t buf_len = 1024 * (event_size + 16);
-            char buffer[buf_len];
-            fd_set rfds;
-            struct timeval tv;
-            int retval;
-            tv.tv_sec = 0;
-            tv.tv_usec = 10000;
-            FD_ZERO(&rfds);
-            FD_SET(fd, &rfds);
-            retval = select(fd+1, &rfds, NULL, NULL, &tv);
-            if (retval != -1)
+            int wd = inotify_add_watch(cache_fd_, entry.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
+            if (wd != -1)
             {
-                if (retval)
-                {
-                    if (FD_ISSET(fd, &rfds))
-                    {
-                        int length = read(fd, buffer, buf_len);
-                        if (length < 0)
-                        {
-                            perror("read");
-                            exit(EXIT_FAILURE);
-                        }
-
-                        int i = 0;
-                        while (i < length)
-                        {
-                            struct inotify_event* event = (struct inotify_event*)&buffer[i];
-
-                            if (event->len)
-                            {
-                                if (event->mask & IN_CREATE)
-                                {
-                                    struct stat path_stat;
-                                    std::string strNewDirectory = watch_map[event->wd];
-                                    strNewDirectory += "/";
-                                    strNewDirectory += event->name;
-                                    stat(strNewDirectory.c_str(), &path_stat);
-                                    cerr << "Creating: " << strNewDirectory << std::endl;
-                                    if (S_ISDIR(path_stat.st_mode)) {
-                                        int wd = inotify_add_watch(fd, strNewDirectory.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
-                                        if (wd != -1)
-                                            watch_map[wd] = strNewDirectory;
-                                      //  else
-                                        //    cerr << "ERROR: Trying to watch " << strNewDirectory << std::endl;
-                                    }
-                                    else if (strNewDirectory.ends_with(".hsaco"))
-                                    {
-                                        //cerr << "New code object to process";
-                                    }
-                                    //cerr << "The file/directory " << event->name << "was created in directory " << watch_map[event->wd] << std::endl;
-                                }
-                                else if (event->mask & IN_DELETE)
-                                {
-                                    //printf("The file %s was deleted from directory %s.\n", event->name, dir);
-                                }
-                                else if (event->mask & IN_MODIFY)
-                                {
-                                    //cerr << "The file/directory " << event->name << "was modified in directory " << watch_map[event->wd] << std::endl;
-                                }
-                                else if (event->mask & IN_MOVED_FROM)
-                                {
-                                    //printf("The file %s was moved out of directory %s.\n", event->name, dir.c_str());
-                                }
-                                else if (event->mask & IN_MOVED_TO)
-                                {
-                                    std::string strFileName = watch_map[event->wd];
-                                    strFileName += "/";
-                                    strFileName += event->name;
-                                    if (strFileName.ends_with(".hsaco"))
-                                    {
-                                      //  cerr << "I CAN SEE JITTED CODE OBJECT " << strFileName << std::endl;
-                                        me->addCodeObject(strFileName);
-                                    }
-                                    //else
-                                    //    cerr << "The file/directory " << event->name << " was moved to directory " << watch_map[event->wd] << std::endl;
-                                }
-                            }
-
-                            i += event_size + event->len;
-                        }
-                    }
-                }
+                cache_watches_[wd] = entry;
+                cerr << "Added " << entry << " to watch list\n";
             }
             else
-                cerr << "Bug in monitoring kernel cache\n";
+            {
+                cerr << "Could not add " << entry << " to watch list\n";
+            }
         }
-        inotify_rm_watch(fd, wd);
-        close(fd);
     }
-    else
+    int wd = inotify_add_watch(cache_fd_, dir.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
+    if (wd == -1)
     {
-        while (!me->shuttingdown())
-            usleep(1000);
+        fprintf(stderr, "Cannot use '%s' as a kernel cache: %s\n", dir.c_str(), strerror(errno));
+        close(cache_fd_);
+        cache_fd_ = -1;
+        cache_watches_.clear();
+        return;
     }
-    cerr << "Cache Watcher shutting down\n";
+    cache_watches_[wd] = dir;
+    co_ingest_ = std::make_unique<ingestQueue>([this](const std::string& path) { addCodeObject(path); });
+    if (!reactor_.watchFd(cache_fd_, [this]() { onCacheEvents(); }))
+        cerr << "Bug in monitoring kernel cache\n";
 }
 
-void signal_runner()
+void hsaInterceptor::onCacheEvents()
 {
-    hsaInterceptor *me = hsaInterceptor::getInstance();
-    //uint64_t count = 0;
-    while (!me->shuttingdown())
+    const size_t event_size = sizeof(struct inotify_event);
+    const size_t buf_len = 1024 * (event_size + 16);
+    char buffer[buf_len] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (true)
     {
-        std::vector<hsa_signal_t> curr_sigs;
-        if (me->getPendingSignals(curr_sigs))
+        ssize_t length = read(cache_fd_, buffer, buf_len);
+        if (length < 0)
+        {
+            if (errno != EAGAIN && errno != EINTR)
+            {
+                perror("read");
+                exit(EXIT_FAILURE);
+            }
+            if (errno == EAGAIN)
+                return;
+            continue;
+        }
+        ssize_t i = 0;
+        while (i < length)
         {
-            do{
-                auto size = curr_sigs.size();
-                for (unsigned long int i = 0; i < size; i++)
+            struct inotify_event* event = (struct inotify_event*)&buffer[i];
+            if (event->len)
+            {
+                if (event->mask & IN_CREATE)
                 {
-                    assert(curr_sigs[i].handle);
-                    if (!me->signalWait(curr_sigs[i], 1))
+                    struct stat path_stat;
+                    std::string strNewDirectory = cache_watches_[event->wd];
+                    strNewDirectory += "/";
+                    strNewDirectory += event->name;
+                    cerr << "Creating: " << strNewDirectory << std::endl;
+                    if (stat(strNewDirectory.c_str(), &path_stat) == 0 && S_ISDIR(path_stat.st_mode))
                     {
-                        me->signalCompleted(curr_sigs[i]);
-      //                  count++;
+                        int wd = inotify_add_watch(cache_fd_, strNewDirectory.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
+                        if (wd != -1)
+                            cache_watches_[wd] = strNewDirectory;
                     }
-
                 }
-                curr_sigs.clear();
-            }while (me->getPendingSignals(curr_sigs));
+                else if (event->mask & IN_MOVED_TO)
+                {
+                    // Triton writes a code object under a temporary name and renames it into place
+                    std::string strFileName = cache_watches_[event->wd];
+                    strFileName += "/";
+                    strFileName += event->name;
+                    if (strFileName.ends_with(".hsaco"))
+                        co_ingest_->enqueue(strFileName);
+                }
+            }
+            i += event_size + event->len;
         }
-        usleep(1);
-    }
-    cerr << "signal_runner is shutting down\n";
-}
-
-bool hsaInterceptor::signalWait(hsa_signal_t sig, uint64_t timeout)
-{
-    return (apiTable_->core_->hsa_signal_wait_scacquire_fn)(
-                sig, HSA_SIGNAL_CONDITION_EQ, 0,
-                timeout, HSA_WAIT_STATE_ACTIVE);
-}
-
-bool hsaInterceptor::getPendingSignals(std::vector<hsa_signal_t>& outSigs)
-{
-    lock_guard<std::mutex> lock(mutex);
-    for (const auto& pair : pending_signals_)
-    {
-        outSigs.push_back(pair.first);
     }
-    return outSigs.size() != 0;
 }
 
 string hsaInterceptor::packetToText(const packet_t *packet)
@@ -662,41 +656,13 @@ void dumpKernArgs(void *args, uint32_t size)
         std::cout << std::hex << std::setw(8) << std::setfill('0') << ((uint32_t *)args)[i] << std::endl;
 }
 
-void hsaInterceptor::fixupKernArgs(void *dst, void *src, void *comms, arg_descriptor_t desc)
+void hsaInterceptor::fixupKernArgs(void *dst, void *src, void *comms, const kernargRepackPlan& plan)
 {
-    // std::cout << "Fixing up kernargs\n";
-    // std::cout << "  explicit_args_length: " << desc.explicit_args_length << std::endl;
-    // std::cout << "  explicit_args_count: " << desc.explicit_args_count << std::endl;
-    // std::cout << "  hidden_args_length: " << desc.hidden_args_length << std::endl;
-    // std::cout << "  kernarg_length: " << desc.kernarg_length << std::endl;
-    // std::cout << "  private_segment_size: " << desc.private_segment_size << std::endl;
-    // std::cout << "  group_segment_size: " << desc.group_segment_size << std::endl;
-    // std::cout << "  clone_hidden_args_length: " << desc.clone_hidden_args_length << std::endl;
-
-    assert(dst);
-    assert(src);
-    memset(dst, 0, desc.kernarg_length);
-    // The descriptor here is a descriptor of the instrumented kernel, so
+    // The plan is built from the descriptor of the instrumented kernel, so
     // the parameter list of the non-instrumented original is always short one void*
-    // relative to the desriptor supplied to this method
-    // We want to copy all of the source kernargs except for it's original explicit arguments
-    memcpy(dst, src, desc.explicit_args_length - sizeof(void *));
-    // Compute where we want to copy hidden args. Right after the last explicit argument.
-    void *hidden_args_dst = &(((char *)dst)[desc.explicit_args_length]);
-    // We copy from the non-instrumented clone from the location after the last explicit arg in the src.
-    // It has 1 fewer arguments than the instrumented clone (i.e. no dh_comms *)
-    //void *hidden_args_src = &(((void **)src)[desc.explicit_args_count - 1]);
-    void *hidden_args_src = &(((char *)src)[desc.explicit_args_length - sizeof(void *)]);
-    // In Triton, for some reason we sometimes get non-instrumented kernsl with no hidden arguments
-    // So we only want to copy hidden arguments if there ARE some. If there are, the length to
-    // copy is the original size of the kernarg data - the size of explicit arguments. But since its
-    // a kernarg segment from a non-instrumented clone, we subtract one from the arg count
-    if (desc.clone_hidden_args_length)
-    {
-        // assert that we aren't going to copy a larger kernarg segment into a smaller one
-        assert(desc.clone_hidden_args_length <= desc.kernarg_length - desc.explicit_args_length);
-        memcpy(hidden_args_dst, hidden_args_src, desc.clone_hidden_args_length);
-    }
+    // relative to the plan. Explicit args are copied in place, hidden args (if there are any;
+    // in Triton, for some reason we sometimes get non-instrumented kernels with no hidden arguments)
+    // are shifted up by one void *, and only the remainder of the segment gets zero filled.
     /* The weird thing here is that, apparently, kernel arguments are 4-byteb aligned
      * regardless of the actual argument size. This really bit me working on this code
      * because the metadata on kernel objects that is retrievable from comgr shows argument lengths
@@ -707,15 +673,13 @@ void hsaInterceptor::fixupKernArgs(void *dst, void *src, void *comms, arg_descri
      * size. I don't know how portable this is between code object versions. I'm assuming it is some
      * aspect of code object first combined with the expecations of the GPU firmware.
      * */
-    //void **comms_loc = &(((void **)dst)[desc.explicit_args_count  - 1]);
-    // This computation using explicit_args_length is more adaptable to changes in the way the compiler
+    // The plan places the dh_comms pointer using explicit_args_length rather than the arg count.
+    // This is more adaptable to changes in the way the compiler
     // and runtime pack kernel arguments. For example 2 four-byte args might be packed into a single
     // 64 bit slot and the individual parms might not be 64-bit aligned. For any kernel where that
     // turns out to be the case, this address calculation with be resilient whether the args
     // are packed or not.
-    void **comms_loc = (void **)&(((char *)dst)[desc.explicit_args_length  - sizeof(void *)]);
-    *comms_loc = comms;
-    // dumpKernArgs(dst, src, desc);
+    plan.apply(dst, src, comms);
 }
 
 /*
@@ -727,8 +691,71 @@ void hsaInterceptor::fixupKernArgs(void *dst, void *src, void *comms, arg_descri
     Pending signals and the alternative kernarg buffers are stored and processed later when the kernel completes and
     hsaIntereceptor::signalComplete is called.
 */
+/*
+    Resolve, once per (agent, kernel_object), everything fixupPacket needs to know about a dispatch: the
+    alternative kernel object (if any), the arg descriptor used to rewrite kernargs, and the kernelDB for the agent.
+    All the string-keyed lookups, name manipulation and logging happen here on the first dispatch only; subsequent
+    dispatches of the same kernel object hit the cache. The cache is dropped whenever new code objects or kernels
+    show up since either can change which alternative a kernel object resolves to. Must be called with mutex_ held.
+*/
+dispatch_decision_t *hsaInterceptor::resolveDispatch(uint64_t kernel_object, hsa_agent_t agent)
+{
+    uint64_t generation = co_generation_.load(std::memory_order_acquire);
+    return dispatch_decisions_.resolve(agent.handle, kernel_object, generation, [&](dispatch_decision_t& decision) {
+        return resolveDecision(kernel_object, agent, decision);
+    });
+}
+
+// The uncached part of resolveDispatch. Returns false if there is nothing to decide for the dispatch yet.
+bool hsaInterceptor::resolveDecision(uint64_t kernel_object, hsa_agent_t agent, dispatch_decision_t& decision)
+{
+    // Are there any kernels in the cache?
+    if (!kernel_cache_.hasKernels(agent))
+        return false;
+    auto it = kernel_objects_.find(kernel_object);
+    if (it == kernel_objects_.end())
+        return false;
+    decision.kernel_ = &it->second;
+    // If we're running in instrumented mode, we're looking for a certain kernel naming convention along with
+    // an argument list expanded by a single void *
+    if (run_instrumented_)
+    {
+        decision.alt_kernel_object_ = kernel_cache_.findInstrumentedAlternative(it->second.symbol_, it->second.name_, agent);
+        if(decision.alt_kernel_object_){
+            std::cerr << "Found instrumented alternative for " << it->second.name_ << std::endl;
+            CodeObjectRef origRef, instRef;
+            bool hasOrig = kernel_cache_.getCodeObjectRef(agent, it->second.name_, origRef);
+            std::string instName = getInstrumentedName(it->second.name_);
+            bool hasInst = kernel_cache_.getCodeObjectRef(agent, instName, instRef);
+            if (hasOrig && hasInst && origRef.source_file == instRef.source_file)
+                std::cerr << "  kernel location: " << origRef.source_file << std::endl;
+            else
+            {
+                if (hasOrig)
+                    std::cerr << "  uninstrumented kernel: " << origRef.source_file << std::endl;
+                if (hasInst)
+                    std::cerr << "  instrumented kernel:   " << instRef.source_file << std::endl;
+            }
+            decision.has_args_ = kernel_cache_.getArgDescriptor(agent, it->second.name_, decision.args_, run_instrumented_);
+            if (decision.has_args_)
+                decision.repack_ = kernargRepackPlan(decision.args_.explicit_args_length,
+                                                     decision.args_.clone_hidden_args_length,
+                                                     decision.args_.kernarg_length);
+            auto kit = kdbs_.find(agent);
+            if (kit != kdbs_.end())
+                decision.kdb_ = kit->second.get();
+        } else {
+            std::cerr << "No instrumented alternative found for " << it->second.name_ << std::endl;
+        }
+    }
+    else
+        decision.alt_kernel_object_ = kernel_cache_.findAlternative(it->second.symbol_, it->second.name_);
+    return true;
+}
+
 hsa_kernel_dispatch_packet_t * hsaInterceptor::fixupPacket(const hsa_kernel_dispatch_packet_t *packet, hsa_queue_t *queue, uint64_t dispatch_id)
 {
+    telemetryTimer timer(TELEMETRY_FIXUP_NS);
     hsa_kernel_dispatch_packet_t *dispatch = new hsa_kernel_dispatch_packet_t;
     *dispatch = *packet;
     {
@@ -747,91 +774,90 @@ hsa_kernel_dispatch_packet_t * hsaInterceptor::fixupPacket(const hsa_kernel_disp
         sig = sig_pool_.back();
         sig_pool_.pop_back();
         dh_comms::dh_comms *comms = NULL;
-        uint64_t alt_kernel_object = 0;
-        // Are there any kernels in the cache?
-        if (kernel_cache_.hasKernels(queues_[queue]))
+        hsa_agent_t agent = queues_[queue];
+        dispatch_decision_t *decision = resolveDispatch(packet->kernel_object, agent);
+        if (decision && decision->alt_kernel_object_)
         {
-            auto it = kernel_objects_.find(packet->kernel_object);
-            if (it != kernel_objects_.end())
+            uint64_t alt_kernel_object = decision->alt_kernel_object_;
+            if (run_instrumented_ && dispatcher_.canDispatch(alt_kernel_object))
             {
-                uint64_t alt_kernel_object = 0;
-                arg_descriptor_t args = {};
-                // If we're running in instrumented mode, we're looking for a certain kernel naming convention along with
-                // an argument list expanded by a single void *
-                if (run_instrumented_)
+                // Found an instrumented  kernel Vobject to use as an alternative
+                dispatch->kernel_object = alt_kernel_object;
+                if (decision->has_args_ && decision->repack_.valid())
                 {
-                    alt_kernel_object = kernel_cache_.findInstrumentedAlternative(it->second.symbol_, it->second.name_, queues_[queue]);
-                    if(alt_kernel_object){
-                        std::cerr << "Found instrumented alternative for " << it->second.name_ << std::endl;
-                        CodeObjectRef origRef, instRef;
-                        bool hasOrig = kernel_cache_.getCodeObjectRef(queues_[queue], it->second.name_, origRef);
-                        std::string instName = getInstrumentedName(it->second.name_);
-                        bool hasInst = kernel_cache_.getCodeObjectRef(queues_[queue], instName, instRef);
-                        if (hasOrig && hasInst && origRef.source_file == instRef.source_file)
-                            std::cerr << "  kernel location: " << origRef.source_file << std::endl;
-                        else
+                    const arg_descriptor_t& args = decision->args_;
+                    std::string& name = decision->kernel_->name_;
+                    void *new_kernargs = allocator_.allocate(args.kernarg_length, agent);
+
+                    // On-demand: scan the code object for this kernel if not already scanned
+                    kernelDB::kernelDB *kdb = decision->kdb_;
+                    if (kdb && !decision->kdb_scanned_)
+                    {
+                        if (!kdb->hasKernel(name))
                         {
-                            if (hasOrig)
-                                std::cerr << "  uninstrumented kernel: " << origRef.source_file << std::endl;
-                            if (hasInst)
-                                std::cerr << "  instrumented kernel:   " << instRef.source_file << std::endl;
+                            CodeObjectRef coRef;
+                            if (kernel_cache_.getCodeObjectRef(agent, name, coRef))
+                                kdb->scanCodeObject(coRef.co_file);
                         }
-                    } else {
-                        std::cerr << "No instrumented alternative found for " << it->second.name_ << std::endl;
+                        decision->kdb_scanned_ = true;
                     }
+
+                    comms = comms_mgr_.checkoutCommsObject(agent, decision->kernel_->name_id_, dispatch_id, kdb, args.sites, args.heatmap);
+
+                    fixupKernArgs(new_kernargs, packet->kernarg_address, comms_mgr_.getInstrumentationBuffer(comms), decision->repack_);
+                    dispatch->kernarg_address = new_kernargs;
+                    dispatch->private_segment_size = args.private_segment_size;
+                    dispatch->group_segment_size = args.group_segment_size;
+                    // Store the new kernarg address so we can free it up at kernel completion
+                    pending_kernargs_[sig] = new_kernargs;
                 }
                 else
-                    alt_kernel_object = kernel_cache_.findAlternative(it->second.symbol_, it->second.name_);
-                if (alt_kernel_object)
                 {
-                    // What's the kernarg buffer size for this new kernel?
-                    uint32_t size = kernel_cache_.getArgSize(alt_kernel_object);
-                    //uint8_t test_align = kernel_cache_.getArgumentAlignment(packet->kernel_object);
-                    if (run_instrumented_ && dispatcher_.canDispatch(alt_kernel_object))
-                    {
-                        // Found an instrumented  kernel Vobject to use as an alternative
-                        dispatch->kernel_object = alt_kernel_object;
-                        uint8_t align = kernel_cache_.getArgumentAlignment(alt_kernel_object);
-                        assert(size);
-                        if (kernel_cache_.getArgDescriptor(queues_[queue], it->second.name_, args, run_instrumented_))
-                        {
-                            void *new_kernargs = allocator_.allocate(args.kernarg_length,queues_[queue]);
-
-                            kernelDB::kernelDB *kdb = kdbs_[queues_[queue]].get();
-
-                            // On-demand: scan the code object for this kernel if not already scanned
-                            if (kdb && !kdb->hasKernel(it->second.name_))
-                            {
-                                CodeObjectRef coRef;
-                                if (kernel_cache_.getCodeObjectRef(queues_[queue], it->second.name_, coRef))
-                                    kdb->scanCodeObject(coRef.co_file);
-                            }
-
-                            comms = comms_mgr_.checkoutCommsObject(queues_[queue], it->second.name_, dispatch_id, kdb);
-
-                            fixupKernArgs(new_kernargs, packet->kernarg_address, comms->get_dev_rsrc_ptr(), args);
-                            dispatch->kernarg_address = new_kernargs;
-                            dispatch->private_segment_size = args.private_segment_size;
-                            dispatch->group_segment_size = args.group_segment_size;
-                            // Store the new kernarg address so we can free it up at kernel completion
-                            pending_kernargs_[sig] = new_kernargs;
-                        }
-                        else
-                        {
-                            std::cerr << "Missing arg descriptor for " << it->second.name_ << " aborting in line " << __LINE__ << " of file " << __FILE__ << std::endl;
-                            abort();
-                        }
-                    }
-                    else
-                    {
-                        dispatch->kernel_object = packet->kernel_object; // Restore the original kernel object because we're not rewriting the kernargs
-                        //dumpKernArgs(packet->kernarg_address, size);
-                    }
+                    std::cerr << "Missing arg descriptor for " << decision->kernel_->name_ << " aborting in line " << __LINE__ << " of file " << __FILE__ << std::endl;
+                    abort();
                 }
             }
+            else if (run_instrumented_ && decision->args_.dual_path && decision->has_args_ && decision->repack_.valid())
+            {
+                // A dual-path clone runs its uninstrumented body when its dh_comms pointer is null, so dispatches
+                // we don't capture keep using the same kernel object. The kernargs still need the extra slot.
+                const arg_descriptor_t& args = decision->args_;
+                void *new_kernargs = allocator_.allocate(args.kernarg_length, agent);
+                fixupKernArgs(new_kernargs, packet->kernarg_address, NULL, decision->repack_);
+                dispatch->kernel_object = alt_kernel_object;
+                dispatch->kernarg_address = new_kernargs;
+                dispatch->private_segment_size = args.private_segment_size;
+                dispatch->group_segment_size = args.group_segment_size;
+                pending_kernargs_[sig] = new_kernargs;
+            }
+            else
+            {
+                dispatch->kernel_object = packet->kernel_object; // Restore the original kernel object because we're not rewriting the kernargs
+            }
         }
         // Store the signal for processing at kernel completion
-        pending_signals_[sig] = {dispatch->completion_signal, kernel_objects_[packet->kernel_object].name_, queues_[queue], comms};
+        kernel_name_id_t name_id = KERNEL_NAME_EMPTY;
+        if (decision)
+            name_id = decision->kernel_->name_id_;
+        else
+        {
+            auto kit = kernel_objects_.find(packet->kernel_object);
+            if (kit != kernel_objects_.end())
+                name_id = kit->second.name_id_;
+        }
+        pending_signals_[sig] = {dispatch->completion_signal, name_id, agent, comms};
+        telemetryCount(TELEMETRY_DISPATCHES);
+        telemetryCount(TELEMETRY_PENDING_SIGNALS);
+        if (comms)
+            telemetryCount(TELEMETRY_INSTRUMENTED_DISPATCHES);
+        // Completion is reported by the runtime's async handler thread rather than by polling the signal. The
+        // dispatch is counted first, since the handler may run as soon as it is registered.
+        unsignaled_dispatches_.fetch_add(1);
+        hsa_status_t status = apiTable_->amd_ext_->hsa_amd_signal_async_handler_fn(
+            sig, HSA_SIGNAL_CONDITION_EQ, 0, signalReady, reinterpret_cast<void *>(sig.handle));
+        if (status != HSA_STATUS_SUCCESS)
+            unsignaled_dispatches_.fetch_sub(1);
+        CHECK_STATUS("Error registering completion handler", status);
         //replace any pre-existing completion_signal in the dispatch. FWIW, normal HIP/ROCm codes don't use dispatch packet
         //completion signals. The typically enqueue a barrier packet immediately following a kernel dispatch packet.
         dispatch->completion_signal = sig;
@@ -950,7 +976,9 @@ void hsaInterceptor::addKernel(uint64_t kernelObject, std::string& name, hsa_exe
             thisName = kernelDB::demangleName(name.c_str());
             if (!thisName.length())
                 thisName = name;
-            kernel_objects_[kernelObject] = {thisName, symbol, agent, kernarg_size};
+            kernel_objects_[kernelObject] = {thisName, kernelNames().intern(thisName), symbol, agent, kernarg_size};
+            // A newly registered kernel may be the alternative for one we've already resolved
+            dispatch_decisions_.clear();
        }
        else
            return;  // Already registered
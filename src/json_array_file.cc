@@ -0,0 +1,204 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/json_array_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+#include <map>
+#include <memory>
+
+namespace {
+
+const char trailer[] = "\n]\n";
+
+bool writeAll(int fd, const char *data, size_t size, off_t offset)
+{
+    while (size)
+    {
+        ssize_t written = offset < 0 ? write(fd, data, size) : pwrite(fd, data, size, offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= written;
+        if (offset >= 0)
+            offset += written;
+    }
+    return true;
+}
+
+// Holds an exclusive flock on fd for its lifetime, so that records from several processes don't interleave
+class fileLock {
+public:
+    explicit fileLock(int fd) : fd_(fd)
+    {
+        while (flock(fd_, LOCK_EX) < 0 && errno == EINTR)
+            ;
+    }
+    ~fileLock() { flock(fd_, LOCK_UN); }
+
+private:
+    int fd_;
+};
+
+} // namespace
+
+std::string jsonArrayFile::processPath(const std::string& path)
+{
+    std::string expanded;
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        if (path[i] == '%' && i + 1 < path.size() && path[i + 1] == 'p')
+        {
+            expanded += std::to_string(getpid());
+            i++;
+        }
+        else
+            expanded += path[i];
+    }
+    return expanded;
+}
+
+jsonArrayFile *jsonArrayFile::open(const std::string& location)
+{
+    // Handlers come and go with their dispatches; the writers live as long as the process, and are never
+    // destroyed so that a handler reporting from another static destructor still finds its file
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<jsonArrayFile>> *files =
+        new std::map<std::string, std::unique_ptr<jsonArrayFile>>();
+    std::string path = processPath(location);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files->find(path);
+    // A forked child shares its parent's open file, and with it the parent's lock; it needs its own
+    if (it != files->end() && it->second->pid_ == getpid())
+        return it->second.get();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "omniprobe: unable to open " << path << ": " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+    std::string index_path = path + JSON_ARRAY_INDEX_SUFFIX;
+    int index_fd = ::open(index_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    bool indexed = index_fd >= 0;
+    if (indexed)
+    {
+        // The header goes in once, by whichever process gets to the file first
+        fileLock file_lock(fd);
+        struct stat st;
+        indexed = fstat(index_fd, &st) == 0 &&
+                  (st.st_size || writeAll(index_fd, JSON_ARRAY_INDEX_HEADER, strlen(JSON_ARRAY_INDEX_HEADER), -1));
+    }
+    if (!indexed)
+    {
+        // The output is still valid without its index
+        std::cerr << "omniprobe: unable to write " << index_path << ": " << strerror(errno) << std::endl;
+        if (index_fd >= 0)
+            close(index_fd);
+        index_fd = -1;
+    }
+    jsonArrayFile *file = new jsonArrayFile(path, fd, index_fd);
+    // The parent's writer in a forked child is left as it is: its fds are shared with the parent
+    if (it != files->end())
+        it->second.release();
+    (*files)[path].reset(file);
+    return file;
+}
+
+jsonArrayFile::jsonArrayFile(const std::string& path, int fd, int index_fd)
+    : path_(path), fd_(fd), index_fd_(index_fd), pid_(getpid()), records_(0), refused_(false)
+{
+}
+
+jsonArrayFile::~jsonArrayFile()
+{
+    close(fd_);
+    if (index_fd_ >= 0)
+        close(index_fd_);
+}
+
+// Writes record at the end of the array in the file, with the file locked; offset is where it starts
+bool jsonArrayFile::writeRecord(std::string_view record, uint64_t& offset)
+{
+    struct stat st;
+    if (fstat(fd_, &st) < 0)
+        return false;
+    uint64_t end = st.st_size;
+    bool first = end == 0;
+    if (!first)
+    {
+        // The separator takes the place of the closing bracket
+        char tail[sizeof(trailer) - 1];
+        if (end < sizeof(tail) || pread(fd_, tail, sizeof(tail), end - sizeof(tail)) != sizeof(tail) ||
+            memcmp(tail, trailer, sizeof(tail)) != 0)
+        {
+            if (!refused_)
+                std::cerr << "omniprobe: " << path_ << " doesn't end in a JSON array, not adding to it" << std::endl;
+            refused_ = true;
+            return false;
+        }
+        end -= sizeof(tail);
+    }
+    std::string text;
+    text.reserve(record.size() + 8);
+    text += first ? "[\n" : ",\n";
+    text += record;
+    text += trailer;
+    if (!writeAll(fd_, text.data(), text.size(), end))
+    {
+        std::cerr << "omniprobe: unable to write " << path_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    offset = end + 2;
+    return true;
+}
+
+bool jsonArrayFile::append(std::string_view record, const std::string& kernel, uint64_t dispatch_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    fileLock file_lock(fd_);
+    uint64_t offset;
+    if (!writeRecord(record, offset))
+        return false;
+    records_++;
+    // Under the same lock, so index lines from several processes are in the order of their records
+    if (index_fd_ >= 0)
+    {
+        std::string line = std::to_string(offset) + " " + std::to_string(record.size()) + " " +
+                           std::to_string(dispatch_id) + " " + kernel + "\n";
+        writeAll(index_fd_, line.data(), line.size(), -1);
+    }
+    return true;
+}
+
+uint64_t jsonArrayFile::records()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
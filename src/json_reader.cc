@@ -0,0 +1,468 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/json_reader.h"
+
+#include <string.h>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+// Records nest a few levels deep; this only stops runaway recursion on garbage
+const int MAX_DEPTH = 64;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void appendUtf8(std::string& out, uint32_t code)
+{
+    if (code < 0x80)
+        out += static_cast<char>(code);
+    else if (code < 0x800)
+    {
+        out += static_cast<char>(0xc0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+        out += static_cast<char>(0xe0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else
+    {
+        out += static_cast<char>(0xf0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+}
+
+bool hex4(const char *p, uint32_t& value)
+{
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+const jsonValue *jsonValue::find(std::string_view key) const
+{
+    for (const auto& member : members_)
+        if (member.first == key)
+            return &member.second;
+    return nullptr;
+}
+
+uint64_t jsonValue::asUint(uint64_t dflt) const
+{
+    if (type_ != JSON_NUMBER)
+        return dflt;
+    if (integral_)
+        return uint_;
+    return double_ > 0 ? static_cast<uint64_t>(std::llround(double_)) : 0;
+}
+
+double jsonValue::asDouble(double dflt) const
+{
+    if (type_ != JSON_NUMBER)
+        return dflt;
+    return integral_ ? static_cast<double>(uint_) : double_;
+}
+
+uint64_t jsonValue::uintAt(std::string_view key, uint64_t dflt) const
+{
+    const jsonValue *value = find(key);
+    return value ? value->asUint(dflt) : dflt;
+}
+
+double jsonValue::doubleAt(std::string_view key, double dflt) const
+{
+    const jsonValue *value = find(key);
+    return value ? value->asDouble(dflt) : dflt;
+}
+
+std::string jsonValue::stringAt(std::string_view key) const
+{
+    const jsonValue *value = find(key);
+    return value && value->isString() ? value->string_ : std::string();
+}
+
+void jsonReader::skipWhitespace()
+{
+    while (pos_ < end_ && isSpace(*pos_))
+        pos_++;
+}
+
+bool jsonReader::fail(const char *error)
+{
+    error_ = error;
+    return false;
+}
+
+bool jsonReader::read(jsonValue& value)
+{
+    error_ = nullptr;
+    skipWhitespace();
+    return readValue(value, 0);
+}
+
+bool jsonReader::readValue(jsonValue& value, int depth)
+{
+    if (depth > MAX_DEPTH)
+        return fail("nested too deeply");
+    if (pos_ == end_)
+        return fail("unexpected end of input");
+    // The value keeps the members and items it held before, so that reading records of the same shape one
+    // after the other reuses their storage; only the ones read again are kept
+    value.type_ = jsonValue::JSON_NULL;
+    value.bool_ = false;
+    value.integral_ = false;
+    if (*pos_ != '{')
+        value.members_.clear();
+    if (*pos_ != '[')
+        value.items_.clear();
+    size_t count = 0;
+    switch (*pos_)
+    {
+    case '{':
+        value.type_ = jsonValue::JSON_OBJECT;
+        pos_++;
+        skipWhitespace();
+        if (pos_ < end_ && *pos_ == '}')
+        {
+            value.members_.clear();
+            pos_++;
+            return true;
+        }
+        while (true)
+        {
+            skipWhitespace();
+            if (pos_ == end_ || *pos_ != '"')
+                return fail("expected a member name");
+            if (count == value.members_.size())
+                value.members_.emplace_back();
+            jsonValue::member_t& member = value.members_[count++];
+            if (!readString(member.first))
+                return false;
+            skipWhitespace();
+            if (pos_ == end_ || *pos_ != ':')
+                return fail("expected ':'");
+            pos_++;
+            skipWhitespace();
+            if (!readValue(member.second, depth + 1))
+                return false;
+            skipWhitespace();
+            if (pos_ == end_)
+                return fail("unexpected end of input");
+            if (*pos_ == '}')
+            {
+                value.members_.resize(count);
+                pos_++;
+                return true;
+            }
+            if (*pos_ != ',')
+                return fail("expected ',' or '}'");
+            pos_++;
+        }
+    case '[':
+        value.type_ = jsonValue::JSON_ARRAY;
+        pos_++;
+        skipWhitespace();
+        if (pos_ < end_ && *pos_ == ']')
+        {
+            value.items_.clear();
+            pos_++;
+            return true;
+        }
+        while (true)
+        {
+            skipWhitespace();
+            if (count == value.items_.size())
+                value.items_.emplace_back();
+            if (!readValue(value.items_[count++], depth + 1))
+                return false;
+            skipWhitespace();
+            if (pos_ == end_)
+                return fail("unexpected end of input");
+            if (*pos_ == ']')
+            {
+                value.items_.resize(count);
+                pos_++;
+                return true;
+            }
+            if (*pos_ != ',')
+                return fail("expected ',' or ']'");
+            pos_++;
+        }
+    case '"':
+        value.type_ = jsonValue::JSON_STRING;
+        return readString(value.string_);
+    case 't':
+        value.type_ = jsonValue::JSON_BOOL;
+        value.bool_ = true;
+        return readLiteral("true", 4);
+    case 'f':
+        value.type_ = jsonValue::JSON_BOOL;
+        return readLiteral("false", 5);
+    case 'n':
+        return readLiteral("null", 4);
+    default:
+        return readNumber(value);
+    }
+}
+
+bool jsonReader::readLiteral(const char *literal, size_t length)
+{
+    if (static_cast<size_t>(end_ - pos_) < length || memcmp(pos_, literal, length) != 0)
+        return fail("invalid literal");
+    pos_ += length;
+    return true;
+}
+
+bool jsonReader::readNumber(jsonValue& value)
+{
+    value.type_ = jsonValue::JSON_NUMBER;
+    const char *start = pos_;
+    const char *p = pos_;
+    bool integral = true;
+    if (p < end_ && *p == '-')
+    {
+        integral = false;
+        p++;
+    }
+    while (p < end_ && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-'))
+    {
+        if (*p == '.' || *p == 'e' || *p == 'E')
+            integral = false;
+        p++;
+    }
+    if (p == start)
+        return fail("unexpected character");
+    if (integral)
+    {
+        auto result = std::from_chars(start, p, value.uint_);
+        if (result.ec == std::errc() && result.ptr == p)
+        {
+            value.integral_ = true;
+            pos_ = p;
+            return true;
+        }
+    }
+    auto result = std::from_chars(start, p, value.double_);
+    if (result.ec != std::errc() || result.ptr != p)
+        return fail("invalid number");
+    pos_ = p;
+    return true;
+}
+
+// Whether the quote at quote can end a string, see json_reader.h
+bool jsonReader::stringEnds(const char *quote) const
+{
+    const char *p = quote + 1;
+    while (p < end_ && isSpace(*p))
+        p++;
+    if (p == end_)
+        return true;
+    if (*p == ':' || *p == '}' || *p == ']')
+        return true;
+    if (*p != ',')
+        return false;
+    p++;
+    while (p < end_ && isSpace(*p))
+        p++;
+    if (p == end_)
+        return false;
+    char c = *p;
+    if (c == '"' || c == '{' || c == '[' || c == '-' || (c >= '0' && c <= '9'))
+        return true;
+    auto literal = [&](const char *text, size_t length) {
+        return static_cast<size_t>(end_ - p) >= length && memcmp(p, text, length) == 0;
+    };
+    return literal("true", 4) || literal("false", 5) || literal("null", 4);
+}
+
+bool jsonReader::readString(std::string& out)
+{
+    // At the opening quote
+    pos_++;
+    out.clear();
+    while (true)
+    {
+        const char *run = pos_;
+        while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\' && *pos_ != '\n')
+            pos_++;
+        out.append(run, pos_ - run);
+        if (pos_ == end_ || *pos_ == '\n')
+            return fail("unterminated string");
+        if (*pos_ == '"')
+        {
+            if (stringEnds(pos_))
+            {
+                pos_++;
+                return true;
+            }
+            out += '"';
+            pos_++;
+            continue;
+        }
+        // A backslash
+        if (end_ - pos_ < 2)
+            return fail("unterminated string");
+        char c = pos_[1];
+        pos_ += 2;
+        switch (c)
+        {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u':
+        {
+            uint32_t code;
+            if (end_ - pos_ < 4 || !hex4(pos_, code))
+                return fail("invalid \\u escape");
+            pos_ += 4;
+            // A surrogate pair
+            uint32_t low;
+            if (code >= 0xd800 && code < 0xdc00 && end_ - pos_ >= 6 && pos_[0] == '\\' && pos_[1] == 'u' &&
+                hex4(pos_ + 2, low) && low >= 0xdc00 && low < 0xe000)
+            {
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                pos_ += 6;
+            }
+            appendUtf8(out, code);
+            break;
+        }
+        default:
+            return fail("invalid escape");
+        }
+    }
+}
+
+void writeJsonString(std::ostream& out, std::string_view text)
+{
+    static const char hex[] = "0123456789abcdef";
+    out << '"';
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        unsigned char c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        out.write(text.data() + run, i - run);
+        run = i + 1;
+        switch (c)
+        {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default: out << "\\u00" << hex[c >> 4] << hex[c & 0xf]; break;
+        }
+    }
+    out.write(text.data() + run, text.size() - run);
+    out << '"';
+}
+
+void jsonWriter::open(char bracket)
+{
+    out_ << bracket;
+    depth_++;
+    first_ = true;
+}
+
+void jsonWriter::close(char bracket)
+{
+    depth_--;
+    if (!first_)
+    {
+        out_ << '\n';
+        indent();
+    }
+    out_ << bracket;
+    first_ = false;
+}
+
+void jsonWriter::next(const char *name)
+{
+    if (!first_)
+        out_ << ',';
+    out_ << '\n';
+    indent();
+    first_ = false;
+    if (name)
+    {
+        writeJsonString(out_, name);
+        out_ << ": ";
+    }
+}
+
+void jsonWriter::field(const char *name, uint64_t value)
+{
+    next(name);
+    out_ << value;
+}
+
+void jsonWriter::field(const char *name, double value)
+{
+    next(name);
+    out_ << value;
+}
+
+void jsonWriter::field(const char *name, const std::string& value)
+{
+    next(name);
+    writeJsonString(out_, value);
+}
+
+void jsonWriter::field(const char *name, bool value)
+{
+    next(name);
+    out_ << (value ? "true" : "false");
+}
+
+void jsonWriter::indent()
+{
+    for (int i = 0; i < depth_; i++)
+        out_ << "  ";
+}
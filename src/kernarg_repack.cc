@@ -0,0 +1,78 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/kernarg_repack.h"
+
+#include <assert.h>
+#include <string.h>
+
+kernargRepackPlan::kernargRepackPlan(size_t explicit_args_length, size_t clone_hidden_args_length, size_t kernarg_length)
+{
+    // The instrumented clone always has at least the dh_comms pointer as an explicit argument
+    if (explicit_args_length < sizeof(void *) || explicit_args_length > kernarg_length)
+        return;
+    // Don't copy a larger kernarg segment into a smaller one
+    if (clone_hidden_args_length > kernarg_length - explicit_args_length)
+        return;
+    kernarg_length_ = kernarg_length;
+    // See fixupKernArgs: using explicit_args_length rather than the arg count keeps this correct
+    // regardless of how the compiler packs the explicit arguments
+    comms_offset_ = explicit_args_length - sizeof(void *);
+    // Original explicit args land where they were
+    addCopy(0, 0, comms_offset_);
+    // Original hidden args start where the original explicit args ended and land right after the
+    // dh_comms pointer
+    addCopy(explicit_args_length, comms_offset_, clone_hidden_args_length);
+    // Whatever is left of the instrumented hidden args area has no counterpart in the source
+    addZero(explicit_args_length + clone_hidden_args_length, kernarg_length - explicit_args_length - clone_hidden_args_length);
+    valid_ = true;
+}
+
+void kernargRepackPlan::addCopy(size_t dst_offset, size_t src_offset, size_t length)
+{
+    if (!length)
+        return;
+    assert(copy_count_ < MAX_RANGES);
+    copies_[copy_count_++] = {static_cast<uint32_t>(dst_offset), static_cast<uint32_t>(src_offset), static_cast<uint32_t>(length)};
+}
+
+void kernargRepackPlan::addZero(size_t dst_offset, size_t length)
+{
+    if (!length)
+        return;
+    assert(zero_count_ < MAX_RANGES);
+    zeros_[zero_count_++] = {static_cast<uint32_t>(dst_offset), 0, static_cast<uint32_t>(length)};
+}
+
+void kernargRepackPlan::apply(void *dst, const void *src, void *comms) const
+{
+    assert(valid_);
+    assert(dst);
+    // A kernel with no args of its own may legitimately have no kernarg segment to copy from
+    assert(src || !copy_count_);
+    char *d = reinterpret_cast<char *>(dst);
+    const char *s = reinterpret_cast<const char *>(src);
+    for (size_t i = 0; i < copy_count_; i++)
+        memcpy(d + copies_[i].dst_offset_, s + copies_[i].src_offset_, copies_[i].length_);
+    for (size_t i = 0; i < zero_count_; i++)
+        memset(d + zeros_[i].dst_offset_, 0, zeros_[i].length_);
+    memcpy(d + comms_offset_, &comms, sizeof(void *));
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/kernel_names.h"
+
+#include <stdlib.h>
+#include <iostream>
+#include <mutex>
+
+kernelNameTable& kernelNameTable::instance()
+{
+    static kernelNameTable *table = new kernelNameTable();
+    return *table;
+}
+
+kernelNameTable::kernelNameTable() : count_(0)
+{
+    for (auto& chunk : chunks_)
+        chunk.store(nullptr, std::memory_order_relaxed);
+    intern("");
+}
+
+kernel_name_id_t kernelNameTable::intern(std::string_view name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end())
+            return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end())
+        return it->second;
+    uint32_t id = count_.load(std::memory_order_relaxed);
+    uint32_t chunk = id >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS)
+    {
+        std::cerr << "kernelNameTable: more than " << MAX_CHUNKS * CHUNK_SIZE << " kernel names, aborting" << std::endl;
+        abort();
+    }
+    std::string_view *slots = chunks_[chunk].load(std::memory_order_relaxed);
+    if (!slots)
+    {
+        slots = new std::string_view[CHUNK_SIZE];
+        chunks_[chunk].store(slots, std::memory_order_release);
+    }
+    std::string_view stored = storage_.emplace_back(name);
+    slots[id & (CHUNK_SIZE - 1)] = stored;
+    ids_.emplace(stored, id);
+    // Publishes the slot to name() callers that get the id without going through the lock
+    count_.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+kernel_name_id_t kernelNameTable::find(std::string_view name) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    return it != ids_.end() ? it->second : KERNEL_NAME_INVALID;
+}
+
+std::string_view kernelNameTable::name(kernel_name_id_t id) const
+{
+    if (id >= count_.load(std::memory_order_acquire))
+        return std::string_view();
+    return chunks_[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+}
@@ -0,0 +1,293 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/log_duration.h"
+
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string_view>
+
+logDuration::logDuration() : mode_(LOGDUR_MODE_LINES), closed_(false), raw_count_(0)
+{
+    for (auto& chunk : stats_)
+        chunk.store(nullptr, std::memory_order_relaxed);
+    location_ = "console";
+    if (location_ == "console")
+        log_file_ = &std::cout;
+    else
+        log_file_ = new std::ofstream(location_, std::ios::app);
+    //(*log_file_) << "kernel,dispatch,startNs,endNs" << std::endl;
+}
+
+logDuration::logDuration(std::string& location) : mode_(LOGDUR_MODE_LINES), closed_(false), raw_count_(0)
+{
+    for (auto& chunk : stats_)
+        chunk.store(nullptr, std::memory_order_relaxed);
+    location_ = location;
+    if (location == "console")
+        log_file_ = &std::cout;
+    else
+        log_file_ = new std::ofstream(location, std::ios::app);
+    //*log_file_ << "kernel,dispatch,startNs,endNs" << std::endl;
+}
+
+logDuration::~logDuration()
+{
+    close();
+    if (location_ != "console")
+    {
+        delete log_file_;
+    }
+    for (auto& chunk : stats_)
+    {
+        std::atomic<concurrentQuantileSketch *> *slots = chunk.load(std::memory_order_relaxed);
+        if (!slots)
+            continue;
+        for (uint32_t i = 0; i < STATS_CHUNK_SIZE; i++)
+            delete slots[i].load(std::memory_order_relaxed);
+        delete[] slots;
+    }
+}
+
+/* In raw mode the log is a binary stream: the LOGDUR_RAW_MAGIC bytes and a uint32_t LOGDUR_RAW_VERSION,
+ * followed by little-endian, unpadded records each starting with a one byte tag:
+ *   'N' uint32_t id, uint32_t length, length bytes of kernel name   - first time a kernel is seen
+ *   'D' uint32_t id, uint64_t dispatchNs, uint64_t startNs, uint64_t endNs   - one per dispatch
+ */
+template<typename T>
+static void appendRaw(std::vector<char>& buffer, T value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void logDuration::log(kernel_name_id_t kernel, uint64_t dispatchTime, uint64_t startNs, uint64_t endNs)
+{
+    switch (mode_)
+    {
+        case LOGDUR_MODE_AGGREGATE:
+        {
+            getStats(kernel)->record(endNs > startNs ? endNs - startNs : 0);
+            break;
+        }
+        case LOGDUR_MODE_RAW:
+        {
+            std::lock_guard<std::mutex> lock(raw_mutex_);
+            if (kernel >= raw_ids_.size())
+                raw_ids_.resize(kernel + 1, LOGDUR_RAW_UNNAMED);
+            uint32_t& raw_id = raw_ids_[kernel];
+            if (raw_id == LOGDUR_RAW_UNNAMED)
+            {
+                std::string_view name = kernelNames().name(kernel);
+                raw_id = raw_count_++;
+                raw_buffer_.push_back('N');
+                appendRaw<uint32_t>(raw_buffer_, raw_id);
+                appendRaw<uint32_t>(raw_buffer_, static_cast<uint32_t>(name.length()));
+                raw_buffer_.insert(raw_buffer_.end(), name.begin(), name.end());
+            }
+            raw_buffer_.push_back('D');
+            appendRaw<uint32_t>(raw_buffer_, raw_id);
+            appendRaw<uint64_t>(raw_buffer_, dispatchTime);
+            appendRaw<uint64_t>(raw_buffer_, startNs);
+            appendRaw<uint64_t>(raw_buffer_, endNs);
+            break;
+        }
+        default:
+            if (log_file_)
+                *log_file_ << "\"" << kernelNames().name(kernel) << "\"," << std::dec << dispatchTime << "," << startNs << "," << endNs << std::endl;
+            else
+                std::cerr << "Can't find anyplace to log\n";
+            break;
+    }
+}
+
+concurrentQuantileSketch *logDuration::getStats(kernel_name_id_t kernel)
+{
+    uint32_t chunk = kernel >> STATS_CHUNK_BITS;
+    if (chunk < STATS_MAX_CHUNKS)
+    {
+        std::atomic<concurrentQuantileSketch *> *slots = stats_[chunk].load(std::memory_order_acquire);
+        if (slots)
+        {
+            concurrentQuantileSketch *stats = slots[kernel & (STATS_CHUNK_SIZE - 1)].load(std::memory_order_acquire);
+            if (stats)
+                return stats;
+        }
+    }
+    return addStats(kernel);
+}
+
+// First dispatch of a kernel in aggregate mode
+concurrentQuantileSketch *logDuration::addStats(kernel_name_id_t kernel)
+{
+    // kernelNameTable hands out no more ids than fit here; anything beyond is counted with the empty name
+    if ((kernel >> STATS_CHUNK_BITS) >= STATS_MAX_CHUNKS)
+        kernel = KERNEL_NAME_EMPTY;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto& chunk = stats_[kernel >> STATS_CHUNK_BITS];
+    std::atomic<concurrentQuantileSketch *> *slots = chunk.load(std::memory_order_relaxed);
+    if (!slots)
+    {
+        slots = new std::atomic<concurrentQuantileSketch *>[STATS_CHUNK_SIZE];
+        for (uint32_t i = 0; i < STATS_CHUNK_SIZE; i++)
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        chunk.store(slots, std::memory_order_release);
+    }
+    auto& slot = slots[kernel & (STATS_CHUNK_SIZE - 1)];
+    concurrentQuantileSketch *stats = slot.load(std::memory_order_relaxed);
+    if (!stats)
+    {
+        stats = new concurrentQuantileSketch();
+        slot.store(stats, std::memory_order_release);
+    }
+    return stats;
+}
+
+void logDuration::logHeaders()
+{
+    // aggregate mode writes its own header with the summary, raw mode has no text header
+    if (mode_ != LOGDUR_MODE_LINES)
+        return;
+    if (log_file_)
+        *log_file_ << "kernel,dispatch,startNs,endNs" << std::endl;
+    else
+        std::cerr << "Unable to log headers - not log location set\n";
+}
+
+bool logDuration::setLocation(const std::string& strLocation)
+{
+    if (location_ != "console")
+    {
+        if (log_file_)
+            delete log_file_;
+    }
+    //cerr << "logDuration::setLocation = " << strLocation << std::endl;
+    location_ = strLocation;
+    if (!location_.length())
+        location_ = "/dev/null";
+    if (location_ == "console")
+        log_file_ = &std::cout;
+    else
+        log_file_ = new std::ofstream(location_, std::ios::app);
+    return log_file_ != NULL;
+}
+
+bool logDuration::setMode(const std::string& strMode)
+{
+    if (strMode == "aggregate")
+        mode_ = LOGDUR_MODE_AGGREGATE;
+    else if (strMode == "raw")
+    {
+        if (location_ == "console")
+        {
+            std::cerr << "LOGDUR_DURATION_MODE=raw needs a log file location. Using aggregate mode." << std::endl;
+            mode_ = LOGDUR_MODE_AGGREGATE;
+        }
+        else
+        {
+            mode_ = LOGDUR_MODE_RAW;
+            if (log_file_)
+            {
+                log_file_->write(LOGDUR_RAW_MAGIC, strlen(LOGDUR_RAW_MAGIC));
+                uint32_t version = LOGDUR_RAW_VERSION;
+                log_file_->write(reinterpret_cast<const char *>(&version), sizeof(version));
+            }
+        }
+    }
+    else if (strMode.empty() || strMode == "lines")
+        mode_ = LOGDUR_MODE_LINES;
+    else
+    {
+        std::cerr << "Invalid value for LOGDUR_DURATION_MODE: " << strMode << ". Must be one of \"lines\", \"aggregate\" or \"raw\"." << std::endl;
+        mode_ = LOGDUR_MODE_LINES;
+        return false;
+    }
+    return true;
+}
+
+void logDuration::flush()
+{
+    if (mode_ == LOGDUR_MODE_RAW)
+        flushRaw();
+}
+
+void logDuration::close()
+{
+    if (mode_ == LOGDUR_MODE_RAW)
+        flushRaw();
+    else if (mode_ == LOGDUR_MODE_AGGREGATE)
+        writeSummary();
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    closed_ = true;
+    if (log_file_)
+        log_file_->flush();
+}
+
+void logDuration::flushRaw()
+{
+    std::lock_guard<std::mutex> file_lock(file_mutex_);
+    if (closed_)
+        return;
+    std::vector<char> pending;
+    {
+        std::lock_guard<std::mutex> lock(raw_mutex_);
+        pending.swap(raw_buffer_);
+    }
+    if (pending.size() && log_file_)
+    {
+        log_file_->write(pending.data(), pending.size());
+        log_file_->flush();
+    }
+}
+
+void logDuration::writeSummary()
+{
+    std::lock_guard<std::mutex> file_lock(file_mutex_);
+    if (closed_ || !log_file_)
+        return;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    // Sorted by name, as the summary has always been
+    std::map<std::string_view, const concurrentQuantileSketch *> sorted;
+    for (uint32_t chunk = 0; chunk < STATS_MAX_CHUNKS; chunk++)
+    {
+        std::atomic<concurrentQuantileSketch *> *slots = stats_[chunk].load(std::memory_order_acquire);
+        if (!slots)
+            continue;
+        for (uint32_t i = 0; i < STATS_CHUNK_SIZE; i++)
+        {
+            const concurrentQuantileSketch *stats = slots[i].load(std::memory_order_acquire);
+            if (stats)
+                sorted[kernelNames().name((chunk << STATS_CHUNK_BITS) | i)] = stats;
+        }
+    }
+    *log_file_ << "kernel,count,sumNs,minNs,maxNs,meanNs,p50Ns,p90Ns,p99Ns\n";
+    for (auto& it : sorted)
+    {
+        const concurrentQuantileSketch& stats = *it.second;
+        *log_file_ << "\"" << it.first << "\"," << std::dec << stats.count() << "," << stats.sum() << ","
+                   << stats.min() << "," << stats.max() << "," << static_cast<uint64_t>(stats.mean()) << ","
+                   << static_cast<uint64_t>(stats.quantile(0.5)) << ","
+                   << static_cast<uint64_t>(stats.quantile(0.9)) << ","
+                   << static_cast<uint64_t>(stats.quantile(0.99)) << "\n";
+    }
+}
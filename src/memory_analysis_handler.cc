@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include "inc/memory_analysis_handler.h"
+#include "inc/json_array_file.h"
 
 #include "gpu_arch_constants.h"
 #include "hip_utils.h"
@@ -226,17 +227,37 @@ bool memory_analysis_handler_t::handle(const message_t &message) {
 
   assert(message.data_item_size() == sizeof(uint64_t));
 
+  // Affine summaries are held back until the first-iteration message they belong to arrives
+  auto hdr = message.wave_header();
+  if (isAffineSummary(hdr.dwarf_column)) {
+    affineSummary_t summary{hdr.dwarf_fname_hash, hdr.dwarf_line, hdr.dwarf_column & ~AFFINE_SUMMARY_COLUMN_FLAG, {}};
+    summary.items_.resize(message.no_data_items());
+    for (size_t i = 0; i != message.no_data_items(); ++i) {
+      summary.items_[i] = *(const uint64_t *)message.data_item(i);
+    }
+    waveIdentifier_t wave = {hdr.block_idx_x, hdr.block_idx_y, hdr.block_idx_z, hdr.wave_num};
+    pending_summaries_.insert(wave, summary);
+    return true;
+  }
+
+  // Wave-compressed messages are decoded into one address per active lane of the access
+  address_message_t addresses(message);
+  if (not addresses.valid()) {
+    fprintf(stderr, "memory_analysis_handler: malformed wave-encoded address message for %s\n", kernel_.c_str());
+    return false;
+  }
+
   uint8_t mspace = (message.wave_header().user_data >> 2) & 0xf;
   switch (mspace) {
   case address_space::flat:
     break;
   case address_space::global:
-    return handle_cache_line_count_analysis(message);
+    return handle_cache_line_count_analysis(addresses);
     break;
   case address_space::gds:
     break;
   case address_space::shared:
-    return handle_bank_conflict_analysis(message);
+    return handle_bank_conflict_analysis(addresses);
     break;
   case address_space::constant:
     break;
@@ -277,29 +298,24 @@ std::string rw2str(uint8_t rw_kind, const std::map<uint8_t, const char *> &rw2st
 // This function catches the exception and returns 0xffffff, signalling to the caller that no ISA instruction
 // is associated with the source location; the caller will then drop the message.
 
-struct dwarf_info_t {
-  std::string fname;
-  std::string isa_instruction;
-  uint16_t access_size = 0;
-};
+using dwarf_info_t = memory_analysis_handler_t::dwarf_info_t;
 
 dwarf_info_t
-get_dwarf_info(const dh_comms::message_t &message, const std::string &kernel_name, kernelDB::kernelDB *kdb,
+get_dwarf_info(uint64_t fname_hash, uint32_t line, uint32_t column, uint8_t rw_kind, const std::string &kernel_name,
+               kernelDB::kernelDB *kdb,
                const std::map<std::string, dh_comms::memory_analysis_handler_t::access_size_and_type> &instr_size_map,
                bool verbose) {
   dwarf_info_t dwarf_info;
   if (kdb == nullptr) {
     return dwarf_info;
   }
-  auto hdr = message.wave_header();
   if (verbose) {
-    printf("---\nFrom IR instrumentation: dwarf_fname_hash = 0x%lx, line = %u, column = %u\n", hdr.dwarf_fname_hash,
-           hdr.dwarf_line, hdr.dwarf_column);
+    printf("---\nFrom IR instrumentation: dwarf_fname_hash = 0x%lx, line = %u, column = %u\n", fname_hash, line,
+           column);
   }
-  uint8_t rw_kind = message.wave_header().user_data & 0b11;
   std::string isa_instruction = "";
   try {
-    auto instructions = kdb->getInstructionsForLine(kernel_name, hdr.dwarf_line);
+    auto instructions = kdb->getInstructionsForLine(kernel_name, line);
     for (auto inst : instructions) {
       isa_instruction = inst.inst_;
       if (verbose) {
@@ -307,8 +323,7 @@ get_dwarf_info(const dh_comms::message_t &message, const std::string &kernel_nam
       }
       auto kdb_dwarf_fname = kdb->getFileName(kernel_name, inst.path_id_);
       size_t kdb_dwarf_fname_hash = std::hash<std::string>{}(kdb_dwarf_fname);
-      if (kdb_dwarf_fname_hash == hdr.dwarf_fname_hash and inst.line_ == hdr.dwarf_line and
-          inst.column_ == hdr.dwarf_column) {
+      if (kdb_dwarf_fname_hash == fname_hash and inst.line_ == line and inst.column_ == column) {
         if (verbose) {
           printf("\tsource location: %s:%u:%u\n", kdb_dwarf_fname.c_str(), inst.line_, inst.column_);
           printf("\tdwarf_fname_hash = 0x%lx\n", kdb_dwarf_fname_hash);
@@ -342,7 +357,42 @@ get_dwarf_info(const dh_comms::message_t &message, const std::string &kernel_nam
   return dwarf_info;
 }
 
-bool memory_analysis_handler_t::handle_cache_line_count_analysis(const message_t &message) {
+// Messages of a clone with a site manifest carry a site id rather than a source location. The manifest
+// has the location, so the kernelDB lookup above is done once per site instead of once per message.
+const dwarf_info_t &memory_analysis_handler_t::site_dwarf_info(uint64_t site_id, const siteRecord_t &site) {
+  if (site_dwarf_info_.size() != sites_->size()) {
+    site_dwarf_info_.assign(sites_->size(), std::nullopt);
+  }
+  auto &dwarf_info = site_dwarf_info_[site_id];
+  if (not dwarf_info) {
+    const std::string &fname = sites_->fileName(site);
+    dwarf_info = get_dwarf_info(std::hash<std::string>{}(fname), site.line_, site.column_, site.access_kind_,
+                                kernel_name_, kdb_p_, instr_size_map, verbose_);
+    if (dwarf_info->fname.empty()) {
+      dwarf_info->fname = fname;
+    }
+  }
+  return *dwarf_info;
+}
+
+bool memory_analysis_handler_t::take_affine_summary(const address_message_t &message, affineSummary_t &summary) {
+  if (pending_summaries_.size() == 0) {
+    return false;
+  }
+  auto hdr = message.wave_header();
+  waveIdentifier_t wave = {hdr.block_idx_x, hdr.block_idx_y, hdr.block_idx_z, hdr.wave_num};
+  auto pending = pending_summaries_.find(wave);
+  if (pending == nullptr or
+      not affineSummaryMatches(*pending, hdr.dwarf_fname_hash, hdr.dwarf_line, hdr.dwarf_column,
+                               message.no_data_items())) {
+    return false;
+  }
+  summary = *pending;
+  pending_summaries_.erase(wave);
+  return true;
+}
+
+bool memory_analysis_handler_t::handle_cache_line_count_analysis(const address_message_t &message) {
   uint8_t L2_cache_line_size = gpu_arch_constants::get_l2_cache_line_size(message.wave_header().arch);
   if (L2_cache_line_size == 0) {
     if (verbose_) {
@@ -353,167 +403,333 @@ bool memory_analysis_handler_t::handle_cache_line_count_analysis(const message_t
 
   uint8_t rw_kind = message.wave_header().user_data & 0b11;
   uint16_t ir_data_size = (message.wave_header().user_data >> 6) & 0xffff;
+  auto hdr = message.wave_header();
+  const siteRecord_t *site = sites_ ? sites_->find(hdr.dwarf_fname_hash, hdr.dwarf_line) : nullptr;
+
+  // Messages are dropped and counted per site, so group members scale by the site of their message
+  size_t site_id = site ? hdr.dwarf_fname_hash : MESSAGE_LOSS_NO_SITE;
+
+  // Where the accesses analyzed next are recorded; set by locate()
+  uint64_t located_id = hdr.dwarf_fname_hash;
+  auto line = hdr.dwarf_line;
   uint16_t data_size = ir_data_size;
-  dwarf_info_t dwarf_info = get_dwarf_info(message, kernel_name_, kdb_p_, instr_size_map, verbose_);
-  if (dwarf_info.access_size ==
-      0xffff) { // no instruction found in ISA for source line in IR, may have been combined with other instructions.
-    if (verbose_) {
-      printf("No instruction found in ISA for source line in IR, may have been combined with other instructions.\n");
-    }
-    return true;
-  }
   bool data_size_corrected = false;
-  if (dwarf_info.access_size != 0 && dwarf_info.access_size != data_size) {
-    if (verbose_) {
-      printf("Corrected data size from %hu to %hu using DWARF information\n", data_size, dwarf_info.access_size);
+  dwarf_info_t looked_up;
+  const dwarf_info_t *dwarf_info = &looked_up;
+  std::vector<global_accesses_t> *accesses = nullptr;
+  // Locates the accesses of site id of the manifest, or, for a null located, those of the message's source
+  // location. Returns false if there is no ISA instruction to attribute them to.
+  auto locate = [&](uint64_t id, const siteRecord_t *located) {
+    auto column = accessGroupColumn(hdr.dwarf_column);
+    located_id = id;
+    if (located) {
+      line = located->line_;
+      column = located->column_;
+      dwarf_info = &site_dwarf_info(id, *located);
+    } else {
+      looked_up = get_dwarf_info(hdr.dwarf_fname_hash, line, column, rw_kind, kernel_name_, kdb_p_, instr_size_map,
+                                 verbose_);
+      dwarf_info = &looked_up;
     }
-    data_size = dwarf_info.access_size;
-    data_size_corrected = true;
-  }
-  size_t min_cache_lines_needed = (message.no_data_items() * data_size + L2_cache_line_size - 1) / L2_cache_line_size;
-  std::set<uint64_t> cache_lines;
-  for (size_t i = 0; i != message.no_data_items(); ++i) {
-    // take into account that in odd cases, the memory access may stride more than a single cache line
-    uint64_t first_byte_of_address = *(const uint64_t *)message.data_item(i);
-    uint64_t last_byte_of_address = first_byte_of_address + data_size - 1;
-    uint64_t first_cache_line_of_address = first_byte_of_address / L2_cache_line_size;
-    uint64_t last_cache_line_of_address = last_byte_of_address / L2_cache_line_size;
-    for (uint64_t cache_line = first_cache_line_of_address; cache_line <= last_cache_line_of_address; ++cache_line) {
-      cache_lines.insert(cache_line);
-    }
-  }
-  uint64_t cache_lines_used = cache_lines.size();
-
-  // heuristic: if the data size changed from IR to ISA, we may get accesses that seem to
-  // need one more cache line than needed. This happens for address messages emitted at the
-  // instrumentation level that are combined into larger units at the ISA level. If we encounter
-  // this, we drop the message. There may be pathetic memory access cases that are missed
-  // by this heuristic.
-  if (data_size_corrected and cache_lines_used == min_cache_lines_needed + 1) {
+    if (dwarf_info->access_size ==
+        0xffff) { // no instruction found in ISA for source line in IR, may have been combined with other instructions.
+      if (verbose_) {
+        printf("No instruction found in ISA for source line in IR, may have been combined with other instructions.\n");
+      }
+      return false;
+    }
+    data_size = ir_data_size;
+    data_size_corrected = false;
+    if (dwarf_info->access_size != 0 && dwarf_info->access_size != data_size) {
+      if (verbose_) {
+        printf("Corrected data size from %hu to %hu using DWARF information\n", data_size, dwarf_info->access_size);
+      }
+      data_size = dwarf_info->access_size;
+      data_size_corrected = true;
+    }
+    accesses = &global_accesses[dwarf_info->fname][line][column];
+    return true;
+  };
+  if (not locate(hdr.dwarf_fname_hash, site)) {
+    affineSummary_t summary;
+    take_affine_summary(message, summary);
     return true;
   }
 
-  if (verbose_ and (cache_lines_used != min_cache_lines_needed)) {
-    std::string rw_string = rw2str(rw_kind, rw2str_map);
-    printf("line %u: global memory access by %zu lanes:\n"
-           "\t%s of %u bytes/lane, minimum L2 cache lines required %zu, cache lines used %zu\n"
-           "\texecution mask = %s\n",
-           message.wave_header().dwarf_line, message.no_data_items(), rw_string.c_str(), data_size,
-           min_cache_lines_needed, cache_lines_used, exec2binstr(message.wave_header().exec).c_str());
-    auto lane_ids_of_active_lanes = get_lane_ids_of_active_lanes(message.wave_header());
-    printf("\n\tAddresses accessed (lane: address)");
-    constexpr size_t addresses_per_line = 4;
-    size_t addresses_printed = 0;
-    for (size_t i = 0; i != lane_ids_of_active_lanes.size(); ++i) {
-      if (addresses_printed % addresses_per_line == 0) {
-        printf("\n\t");
+  // Analyzes the accesses of one wave-wide load or store, given the addresses of the active lanes
+  auto analyze = [&](const std::vector<uint64_t> &addresses, const auto &lane_ids) {
+    size_t min_cache_lines_needed = (addresses.size() * data_size + L2_cache_line_size - 1) / L2_cache_line_size;
+    std::set<uint64_t> cache_lines;
+    for (auto first_byte_of_address : addresses) {
+      // take into account that in odd cases, the memory access may stride more than a single cache line
+      uint64_t last_byte_of_address = first_byte_of_address + data_size - 1;
+      uint64_t first_cache_line_of_address = first_byte_of_address / L2_cache_line_size;
+      uint64_t last_cache_line_of_address = last_byte_of_address / L2_cache_line_size;
+      for (uint64_t cache_line = first_cache_line_of_address; cache_line <= last_cache_line_of_address; ++cache_line) {
+        cache_lines.insert(cache_line);
       }
-      ++addresses_printed;
-      size_t lane = lane_ids_of_active_lanes[i];
-      uint64_t address = *(const uint64_t *)message.data_item(i);
-      printf("%2zu: 0x%lx   ", lane, address);
-    }
-    printf("\n\n\tCache line size = 0x%hhx. Lowest addresses on cache lines used:", L2_cache_line_size);
-    addresses_printed = 0;
-    for (const auto cl : cache_lines) {
-      if (addresses_printed % addresses_per_line == 0) {
-        printf("\n\t");
+    }
+    uint64_t cache_lines_used = cache_lines.size();
+
+    // heuristic: if the data size changed from IR to ISA, we may get accesses that seem to
+    // need one more cache line than needed. This happens for address messages emitted at the
+    // instrumentation level that are combined into larger units at the ISA level. If we encounter
+    // this, we drop the message. There may be pathetic memory access cases that are missed
+    // by this heuristic.
+    if (data_size_corrected and cache_lines_used == min_cache_lines_needed + 1) {
+      return;
+    }
+
+    if (verbose_ and (cache_lines_used != min_cache_lines_needed)) {
+      std::string rw_string = rw2str(rw_kind, rw2str_map);
+      printf("line %u: global memory access by %zu lanes:\n"
+             "\t%s of %u bytes/lane, minimum L2 cache lines required %zu, cache lines used %zu\n"
+             "\texecution mask = %s\n",
+             line, addresses.size(), rw_string.c_str(), data_size,
+             min_cache_lines_needed, cache_lines_used, exec2binstr(message.wave_header().exec).c_str());
+      printf("\n\tAddresses accessed (lane: address)");
+      constexpr size_t addresses_per_line = 4;
+      size_t addresses_printed = 0;
+      for (size_t i = 0; i != lane_ids.size(); ++i) {
+        if (addresses_printed % addresses_per_line == 0) {
+          printf("\n\t");
+        }
+        ++addresses_printed;
+        size_t lane = lane_ids[i];
+        printf("%2zu: 0x%lx   ", lane, addresses[i]);
       }
-      printf("%2zu: 0x%lx   ", addresses_printed, cl * L2_cache_line_size);
-      ++addresses_printed;
-    }
-    printf("\n");
-  }
-
-  auto line = message.wave_header().dwarf_line;
-  auto column = message.wave_header().dwarf_column;
-  const auto &fname = dwarf_info.fname;
-  auto &accesses = global_accesses[fname][line][column]; // reference to std::vector of global_accesses_t
-
-  size_t no_accesses = 1;
-  auto isa_access_size = dwarf_info.access_size;
-  const auto &isa_instruction = dwarf_info.isa_instruction;
-  global_accesses_t current_access{
-      {no_accesses, ir_data_size, isa_access_size, rw_kind, isa_instruction}, min_cache_lines_needed, cache_lines_used};
-  auto it = std::find_if(accesses.begin(), accesses.end(), [&current_access](const memory_accesses_t &access) {
-    return access.ir_access_size == current_access.ir_access_size &&
-           access.isa_access_size == current_access.isa_access_size && access.rw_kind == current_access.rw_kind;
-  });
-
-  if (it != accesses.end()) {
-    ++(it->no_accesses);
-    it->min_cache_lines_needed += min_cache_lines_needed;
-    it->no_cache_lines_used += cache_lines_used;
-  } else {
-    accesses.push_back(current_access);
+      printf("\n\n\tCache line size = 0x%hhx. Lowest addresses on cache lines used:", L2_cache_line_size);
+      addresses_printed = 0;
+      for (const auto cl : cache_lines) {
+        if (addresses_printed % addresses_per_line == 0) {
+          printf("\n\t");
+        }
+        printf("%2zu: 0x%lx   ", addresses_printed, cl * L2_cache_line_size);
+        ++addresses_printed;
+      }
+      printf("\n");
+    }
+
+    size_t no_accesses = 1;
+    global_accesses_t current_access{
+        {no_accesses, ir_data_size, dwarf_info->access_size, rw_kind, dwarf_info->isa_instruction, site_id},
+        min_cache_lines_needed, cache_lines_used};
+    auto it = std::find_if(accesses->begin(), accesses->end(), [&current_access](const memory_accesses_t &access) {
+      return access.ir_access_size == current_access.ir_access_size &&
+             access.isa_access_size == current_access.isa_access_size && access.rw_kind == current_access.rw_kind;
+    });
+
+    if (it != accesses->end()) {
+      ++(it->no_accesses);
+      it->min_cache_lines_needed += min_cache_lines_needed;
+      it->no_cache_lines_used += cache_lines_used;
+      if (it->site != site_id) {
+        it->site = MESSAGE_LOSS_NO_SITE;
+      }
+    } else {
+      accesses->push_back(current_access);
+    }
+  };
+  // An access group (see access_group.h) stands for several accesses at fixed offsets from its addresses. With a
+  // site manifest, each of them may have a site of its own.
+  auto analyze_message = [&](const std::vector<uint64_t> &addresses, const auto &lane_ids) {
+    if (not isAccessGroup(message.wave_header().dwarf_column)) {
+      analyze(addresses, lane_ids);
+      return;
+    }
+    uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES];
+    size_t offset_count = accessGroupOffsets(message.wave_header().dwarf_column, ir_data_size, offsets);
+    std::vector<uint64_t> member_addresses(addresses.size());
+    for (size_t j = 0; j != offset_count; ++j) {
+      if (site) {
+        uint64_t id = sites_->memberSite(hdr.dwarf_fname_hash, j);
+        const siteRecord_t *member = sites_->find(id, SITE_MANIFEST_LINE_FLAG);
+        if (not member or (id != located_id and not locate(id, member))) {
+          continue;
+        }
+      }
+      for (size_t i = 0; i != addresses.size(); ++i) {
+        member_addresses[i] = addresses[i] + offsets[j];
+      }
+      analyze(member_addresses, lane_ids);
+    }
+  };
+
+  std::vector<uint64_t> addresses(message.no_data_items());
+  for (size_t i = 0; i != message.no_data_items(); ++i) {
+    addresses[i] = *(const uint64_t *)message.data_item(i);
+  }
+  // An affine summary stands for the remaining iterations of this access
+  affineSummary_t summary;
+  bool expand = take_affine_summary(message, summary);
+  decltype(get_lane_ids_of_active_lanes(message.wave_header())) lane_ids_of_active_lanes;
+  if (verbose_ or expand) {
+    lane_ids_of_active_lanes = get_lane_ids_of_active_lanes(message.wave_header());
+  }
+  analyze_message(addresses, lane_ids_of_active_lanes);
+
+  if (expand) {
+    std::vector<uint64_t> iteration_addresses;
+    std::vector<size_t> iteration_lanes;
+    decltype(lane_ids_of_active_lanes) iteration_lane_ids;
+    uint32_t iterations = affineIterations(summary);
+    for (uint32_t iteration = 1; iteration < iterations; ++iteration) {
+      expandAffineIteration(summary, addresses, iteration, iteration_addresses, iteration_lanes);
+      iteration_lane_ids.clear();
+      for (auto idx : iteration_lanes) {
+        iteration_lane_ids.push_back(lane_ids_of_active_lanes[idx]);
+      }
+      analyze(iteration_addresses, iteration_lane_ids);
+    }
   }
 
   // kernelDB currently doesn't save info for ds_read and ds_write instructions,
   // so to be able to figure out the source file name for theses instructions,
   // we save a mapping while processing global loads and stores.
-  fname_hash_to_fname[message.wave_header().dwarf_fname_hash] = fname;
+  if (not site) {
+    fname_hash_to_fname[hdr.dwarf_fname_hash] = dwarf_info->fname;
+  }
 
   return true;
 }
 
-bool memory_analysis_handler_t::handle_bank_conflict_analysis(const message_t &message) {
+bool memory_analysis_handler_t::handle_bank_conflict_analysis(const address_message_t &message) {
   auto lane_ids_of_active_lanes = get_lane_ids_of_active_lanes(message.wave_header());
   assert(message.no_data_items() == lane_ids_of_active_lanes.size());
   uint8_t rw_kind = message.wave_header().user_data & 0b11;
   uint16_t data_size = (message.wave_header().user_data >> 6) & 0xffff;
   if (conflict_sets.find(data_size) == conflict_sets.end()) {
     printf("bank conflict handling of %u-byte accesses not supported\n", data_size);
+    affineSummary_t summary;
+    take_affine_summary(message, summary);
     return false;
   }
 
-  for (size_t i = 0; i != message.no_data_items(); ++i) {
-    auto lane = lane_ids_of_active_lanes[i];
-    uint64_t address = *(const uint64_t *)message.data_item(i);
-    assert(address % data_size == 0); // we only handle naturally-aligned data
-    for (auto &cs : conflict_sets[data_size]) {
-      if (cs.register_access(lane, address)) {
-        break;
+  auto hdr = message.wave_header();
+  const siteRecord_t *site = sites_ ? sites_->find(hdr.dwarf_fname_hash, hdr.dwarf_line) : nullptr;
+
+  // Messages are dropped and counted per site, so group members scale by the site of their message
+  size_t site_id = site ? hdr.dwarf_fname_hash : MESSAGE_LOSS_NO_SITE;
+
+  // Where the accesses analyzed next are recorded; set by locate()
+  uint64_t located_id = hdr.dwarf_fname_hash;
+  auto line = hdr.dwarf_line;
+  std::vector<lds_accesses_t> *accesses = nullptr;
+  // Locates the accesses of site id of the manifest, or, for a null located, those of the message's source location
+  auto locate = [&](uint64_t id, const siteRecord_t *located) {
+    auto column = accessGroupColumn(hdr.dwarf_column);
+    std::string fname;
+    located_id = id;
+    if (located) {
+      line = located->line_;
+      column = located->column_;
+      fname = sites_->fileName(*located);
+    } else {
+      fname = fname_hash_to_fname[hdr.dwarf_fname_hash];
+    }
+    if (fname == "") {
+      fname = "<unknown source file>";
+    }
+    accesses = &lds_accesses[fname][line][column];
+  };
+  locate(hdr.dwarf_fname_hash, site);
+
+  // Analyzes the accesses of one wave-wide load or store, given the addresses of the active lanes
+  auto analyze = [&](const std::vector<uint64_t> &addresses, const auto &lane_ids) {
+    for (size_t i = 0; i != addresses.size(); ++i) {
+      auto lane = lane_ids[i];
+      uint64_t address = addresses[i];
+      assert(address % data_size == 0); // we only handle naturally-aligned data
+      for (auto &cs : conflict_sets[data_size]) {
+        if (cs.register_access(lane, address)) {
+          break;
+        }
       }
     }
-  }
 
-  size_t bank_conflict_count = 0;
-  for (auto &cs : conflict_sets[data_size]) {
-    bank_conflict_count += cs.bank_conflict_count();
-    cs.clear();
-  }
+    size_t bank_conflict_count = 0;
+    for (auto &cs : conflict_sets[data_size]) {
+      bank_conflict_count += cs.bank_conflict_count();
+      cs.clear();
+    }
 
-  if (verbose_) {
-    std::string rw_string = rw2str(rw_kind, rw2str_map);
-    printf("line %u: LDS access\n"
-           "\t%s of %u bytes/lane, %zu bank conflicts\n"
-           "\texecution mask = %s\n",
-           message.wave_header().dwarf_line, rw_string.c_str(), data_size, bank_conflict_count,
-           exec2binstr(message.wave_header().exec).c_str());
-  }
+    if (verbose_) {
+      std::string rw_string = rw2str(rw_kind, rw2str_map);
+      printf("line %u: LDS access\n"
+             "\t%s of %u bytes/lane, %zu bank conflicts\n"
+             "\texecution mask = %s\n",
+             line, rw_string.c_str(), data_size, bank_conflict_count,
+             exec2binstr(message.wave_header().exec).c_str());
+    }
 
-  auto line = message.wave_header().dwarf_line;
-  auto column = message.wave_header().dwarf_column;
-  auto fname = fname_hash_to_fname[message.wave_header().dwarf_fname_hash];
-  if (fname == "") {
-    fname = "<unknown source file>";
-  }
-  auto &accesses = lds_accesses[fname][line][column]; // reference to std::vector of lds_accesses_t
+    size_t no_accesses = 1;
+    uint16_t isa_access_size = 0; // kernelDB currently doesn't handle LDS instructions yet.
+    std::string isa_instruction = "";
+    lds_accesses_t current_access{{no_accesses, data_size, isa_access_size, rw_kind, isa_instruction, site_id},
+                                  bank_conflict_count};
+    auto it = std::find_if(accesses->begin(), accesses->end(), [&current_access](const memory_accesses_t &access) {
+      return access.ir_access_size == current_access.ir_access_size &&
+             access.isa_access_size == current_access.isa_access_size && access.rw_kind == current_access.rw_kind;
+    });
+    if (it != accesses->end()) {
+      ++(it->no_accesses);
+      it->no_bank_conflicts += bank_conflict_count;
+      if (it->site != site_id) {
+        it->site = MESSAGE_LOSS_NO_SITE;
+      }
+    } else {
+      accesses->push_back(current_access);
+    }
+  };
+  // An access group (see access_group.h) stands for several accesses at fixed offsets from its addresses. With a
+  // site manifest, each of them may have a site of its own.
+  auto analyze_message = [&](const std::vector<uint64_t> &addresses, const auto &lane_ids) {
+    if (not isAccessGroup(message.wave_header().dwarf_column)) {
+      analyze(addresses, lane_ids);
+      return;
+    }
+    uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES];
+    size_t offset_count = accessGroupOffsets(message.wave_header().dwarf_column, data_size, offsets);
+    std::vector<uint64_t> member_addresses(addresses.size());
+    for (size_t j = 0; j != offset_count; ++j) {
+      if (site) {
+        uint64_t id = sites_->memberSite(hdr.dwarf_fname_hash, j);
+        const siteRecord_t *member = sites_->find(id, SITE_MANIFEST_LINE_FLAG);
+        if (not member) {
+          continue;
+        }
+        if (id != located_id) {
+          locate(id, member);
+        }
+      }
+      for (size_t i = 0; i != addresses.size(); ++i) {
+        member_addresses[i] = addresses[i] + offsets[j];
+      }
+      analyze(member_addresses, lane_ids);
+    }
+  };
 
-  size_t no_accesses = 1;
-  uint16_t isa_access_size = 0; // kernelDB currently doesn't handle LDS instructions yet.
-  std::string isa_instruction = "";
-  lds_accesses_t current_access{{no_accesses, data_size, isa_access_size, rw_kind, isa_instruction},
-                                bank_conflict_count};
-  auto it = std::find_if(accesses.begin(), accesses.end(), [&current_access](const memory_accesses_t &access) {
-    return access.ir_access_size == current_access.ir_access_size &&
-           access.isa_access_size == current_access.isa_access_size && access.rw_kind == current_access.rw_kind;
-  });
-  if (it != accesses.end()) {
-    ++(it->no_accesses);
-    it->no_bank_conflicts += bank_conflict_count;
-  } else {
-    accesses.push_back(current_access);
+  std::vector<uint64_t> addresses(message.no_data_items());
+  for (size_t i = 0; i != message.no_data_items(); ++i) {
+    addresses[i] = *(const uint64_t *)message.data_item(i);
+  }
+  analyze_message(addresses, lane_ids_of_active_lanes);
+
+  // An affine summary stands for the remaining iterations of this access
+  affineSummary_t summary;
+  if (take_affine_summary(message, summary)) {
+    std::vector<uint64_t> iteration_addresses;
+    std::vector<size_t> iteration_lanes;
+    decltype(lane_ids_of_active_lanes) iteration_lane_ids;
+    uint32_t iterations = affineIterations(summary);
+    for (uint32_t iteration = 1; iteration < iterations; ++iteration) {
+      expandAffineIteration(summary, addresses, iteration, iteration_addresses, iteration_lanes);
+      iteration_lane_ids.clear();
+      for (auto idx : iteration_lanes) {
+        iteration_lane_ids.push_back(lane_ids_of_active_lanes[idx]);
+      }
+      analyze(iteration_addresses, iteration_lane_ids);
+    }
   }
 
   return true;
@@ -583,7 +799,8 @@ void memory_analysis_handler_t::report_bank_conflicts() {
           show_line(fname, line, col);
           std::string rw_string = rw2str(access.rw_kind, rw2str_map);
           printf("\t%s of %u bytes at IR level\n", rw_string.c_str(), access.ir_access_size);
-          printf("\texecuted %lu times, %lu bank conflicts in total\n", access.no_accesses, access.no_bank_conflicts);
+          printf("\texecuted %lu times, %lu bank conflicts in total%s\n", scaled(access.site, access.no_accesses),
+                 scaled(access.site, access.no_bank_conflicts), scales(access.site) ? " (estimated)" : "");
         }
       }
     }
@@ -610,8 +827,9 @@ void memory_analysis_handler_t::report_cache_line_use() {
           std::string rw_string = rw2str(access.rw_kind, rw2str_map);
           printf("\t%s of %u bytes at IR level (%u bytes at ISA level: \"%s\")\n", rw_string.c_str(),
                  access.ir_access_size, access.isa_access_size, access.isa_instruction.c_str());
-          printf("\texecuted %lu times, %lu cache lines needed, %lu cache lines used\n", access.no_accesses,
-                 access.min_cache_lines_needed, access.no_cache_lines_used);
+          printf("\texecuted %lu times, %lu cache lines needed, %lu cache lines used%s\n",
+                 scaled(access.site, access.no_accesses), scaled(access.site, access.min_cache_lines_needed),
+                 scaled(access.site, access.no_cache_lines_used), scales(access.site) ? " (estimated)" : "");
         }
       }
     }
@@ -624,10 +842,8 @@ void memory_analysis_handler_t::report_cache_line_use() {
 
 void memory_analysis_handler_t::setupLogger()
 {
-    if (location_ == "console")
-        log_file_ = &std::cout;
-    else
-        log_file_ = new std::ofstream(location_, std::ios::app);
+    // Files are written through jsonArrayFile (see report_json)
+    log_file_ = location_ == "console" ? &std::cout : nullptr;
 }
 
 
@@ -647,14 +863,28 @@ void memory_analysis_handler_t::report() {
   if (bFormatJson) {
     report_json();
   } else {
+    report_loss();
     report_cache_line_use();
     report_bank_conflicts();
   }
 }
 
+void memory_analysis_handler_t::report_loss() {
+  if (not loss_ or loss_->dropped() == 0) {
+    return;
+  }
+  printf("\n=== Dropped messages report =======================\n");
+  std::ostringstream out;
+  loss_->report(out, kernel_, dispatch_id_, sites_.get());
+  printf("%s", out.str().c_str());
+  printf("Counts marked (estimated) are scaled up for the dropped messages\n");
+  printf("=== End of dropped messages report ================\n");
+}
+
 void memory_analysis_handler_t::clear() {
   global_accesses.clear();
   lds_accesses.clear();
+  pending_summaries_.clear();
 }
 
 template <typename T>
@@ -757,19 +987,11 @@ std::string getCodeContext(const std::string &fname, uint16_t line) {
 void memory_analysis_handler_t::report_json() {
   std::stringstream json_output;
 
-  // Check if this is the first dispatch to write the opening bracket
-  bool is_first_dispatch = (dispatch_id_ == 1);
   bool is_console_output = (location_ == "console");
 
-  // For kernel filtering, we may have uninitialized dispatch_id_ or only one dispatch
-  // Check if we have any data to output
-  bool has_data = !global_accesses.empty() || !lds_accesses.empty();
-
-  // Write opening bracket for first dispatch (but not for console output)
-  // Also handle case where dispatch_id_ is uninitialized (0) but we have data
-  if (!is_console_output && (is_first_dispatch || (dispatch_id_ == 0 && has_data))) {
-    json_output << "[\n";
-  } else if (!is_first_dispatch && dispatch_id_ > 0) {
+  // A file gets its array brackets and separators from jsonArrayFile; on the console, dispatches after the
+  // first are separated by commas
+  if (is_console_output && dispatch_id_ > 1) {
     json_output << ",\n";
   }
 
@@ -779,8 +1001,12 @@ void memory_analysis_handler_t::report_json() {
   // Kernel info section
   json_output << "    \"kernel_info\": {\n";
   json_output << "      \"name\": \"" << kernel_ << "\",\n";
-  json_output << "      \"dispatch_id\": " << dispatch_id_ << "\n";
-  json_output << "    },\n";
+  json_output << "      \"dispatch_id\": " << dispatch_id_;
+  if (loss_ and loss_->dropped() != 0) {
+    json_output << ",\n      \"messages_dropped\": " << loss_->dropped() << ",\n";
+    json_output << "      \"loss_rate\": " << loss_->lossRate();
+  }
+  json_output << "\n    },\n";
 
   // Cache analysis section
   json_output << "    \"cache_analysis\": {\n";
@@ -805,14 +1031,14 @@ void memory_analysis_handler_t::report_json() {
           json_output << "          \"code_context\": \"" << getCodeContext(fname, line) << "\",\n";
           json_output << "          \"access_info\": {\n";
           json_output << "            \"type\": \"" << rw2str(access.rw_kind, rw2str_map) << "\",\n";
-          json_output << "            \"execution_count\": " << access.no_accesses << ",\n";
+          json_output << "            \"execution_count\": " << scaled(access.site, access.no_accesses) << ",\n";
           json_output << "            \"ir_bytes\": " << access.ir_access_size << ",\n";
           json_output << "            \"isa_bytes\": " << access.isa_access_size << ",\n";
           json_output << "            \"isa_instruction\": \"" << access.isa_instruction << "\",\n";
           json_output << "            \"cache_lines\": {\n";
-          json_output << "              \"needed\": " << access.min_cache_lines_needed << ",\n";
-          json_output << "              \"used\": " << access.no_cache_lines_used << "\n";
-          json_output << "            }\n";
+          json_output << "              \"needed\": " << scaled(access.site, access.min_cache_lines_needed) << ",\n";
+          json_output << "              \"used\": " << scaled(access.site, access.no_cache_lines_used) << "\n";
+          json_output << "            }" << (scales(access.site) ? ",\n            \"estimated\": true\n" : "\n");
           json_output << "          }\n";
           json_output << "        }";
         }
@@ -846,9 +1072,10 @@ void memory_analysis_handler_t::report_json() {
           json_output << "          \"code_context\": \"" << getCodeContext(fname, line) << "\",\n";
           json_output << "          \"access_info\": {\n";
           json_output << "            \"type\": \"" << rw2str(access.rw_kind, rw2str_map) << "\",\n";
-          json_output << "            \"execution_count\": " << access.no_accesses << ",\n";
+          json_output << "            \"execution_count\": " << scaled(access.site, access.no_accesses) << ",\n";
           json_output << "            \"ir_bytes\": " << access.ir_access_size << ",\n";
-          json_output << "            \"total_conflicts\": " << access.no_bank_conflicts << "\n";
+          json_output << "            \"total_conflicts\": " << scaled(access.site, access.no_bank_conflicts)
+                      << (scales(access.site) ? ",\n            \"estimated\": true\n" : "\n");
           json_output << "          }\n";
           json_output << "        }";
         }
@@ -925,13 +1152,15 @@ void memory_analysis_handler_t::report_json() {
   json_output << "  }\n";
   json_output << "}";
 
-  // Add newline for console output (for readability)
   if (is_console_output) {
+    // Add newline for console output (for readability)
     json_output << "\n";
+    *log_file_ << json_output.str();
+    return;
+  }
+  if (jsonArrayFile *file = jsonArrayFile::open(location_)) {
+    file->append(json_output.str(), kernel_, dispatch_id_);
   }
-
-  // Write to the log file
-  *log_file_ << json_output.str();
 }
 
 } // namespace dh_comms
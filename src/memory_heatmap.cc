@@ -21,7 +21,9 @@
 // SOFTWARE.
 
 #include "inc/memory_heatmap.h"
+#include "inc/device_heatmap.h"
 #include "inc/json_helpers.h"
+#include "inc/wave_encoding.h"
 
 #include "data_headers.h"
 #include "message.h"
@@ -58,15 +60,73 @@ bool memory_heatmap_t::handle(const message_t &message) {
     return false;
   }
   assert(message.data_item_size() == sizeof(uint64_t));
-  for (size_t i = 0; i != message.no_data_items(); ++i) {
-    uint64_t address = *(const uint64_t *)message.data_item(i);
-    // map address to lowest address in page and update page count
-    address /= page_size_;
-    address *= page_size_;
-    ++page_counts_[address];
-    if (verbose_) {
-      printf("memory_heatmap: added address 0x%lx to map\n", address);
+  auto hdr = message.wave_header();
+  waveIdentifier_t wave = {hdr.block_idx_x, hdr.block_idx_y, hdr.block_idx_z, hdr.wave_num};
+  if (isAffineSummary(hdr.dwarf_column)) {
+    // Held back until the first-iteration message it belongs to arrives
+    affineSummary_t summary{hdr.dwarf_fname_hash, hdr.dwarf_line, hdr.dwarf_column & ~AFFINE_SUMMARY_COLUMN_FLAG, {}};
+    summary.items_.resize(message.no_data_items());
+    for (size_t i = 0; i != message.no_data_items(); ++i) {
+      summary.items_[i] = *(const uint64_t *)message.data_item(i);
     }
+    pending_summaries_.insert(wave, summary);
+    return true;
+  }
+  // Wave-compressed messages (see wave_encoding.h) are decoded into the addresses of the access
+  waveAddressView<message_t> view(message);
+  if (!view.valid()) {
+    fprintf(stderr, "memory_heatmap: malformed wave-encoded address message for %s\n", kernel_.c_str());
+    return false;
+  }
+  hdr = view.wave_header();
+  std::vector<uint64_t> addresses(view.no_data_items());
+  // An access group (see access_group.h) stands for several accesses at fixed offsets from its addresses
+  uint16_t access_size = (hdr.user_data >> 6) & 0xffff;
+  uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES];
+  size_t offset_count = accessGroupOffsets(hdr.dwarf_column, access_size, offsets);
+  for (size_t j = 0; j != offset_count; ++j) {
+    uint64_t offset = offsets[j];
+    for (size_t i = 0; i != view.no_data_items(); ++i) {
+      uint64_t address = *(const uint64_t *)view.data_item(i);
+      addresses[i] = address;
+      address += offset;
+      // map address to lowest address in page and update page count
+      address /= page_size_;
+      address *= page_size_;
+      ++page_counts_[address];
+      if (verbose_) {
+        printf("memory_heatmap: added address 0x%lx to map\n", address);
+      }
+    }
+  }
+
+  // An affine summary stands for the remaining iterations of this access
+  auto pending = pending_summaries_.size() != 0 ? pending_summaries_.find(wave) : nullptr;
+  if (pending != nullptr and
+      affineSummaryMatches(*pending, hdr.dwarf_fname_hash, hdr.dwarf_line, hdr.dwarf_column, addresses.size())) {
+    std::vector<uint64_t> iteration_addresses;
+    std::vector<size_t> iteration_lanes;
+    uint32_t iterations = affineIterations(*pending);
+    for (uint32_t iteration = 1; iteration < iterations; ++iteration) {
+      expandAffineIteration(*pending, addresses, iteration, iteration_addresses, iteration_lanes);
+      for (auto address : iteration_addresses) {
+        ++page_counts_[address / page_size_ * page_size_];
+      }
+    }
+    pending_summaries_.erase(wave);
+  }
+  return true;
+}
+
+bool memory_heatmap_t::add_device_histogram(const void *histogram, size_t length) {
+  uint64_t dropped = 0;
+  if (!deviceHeatmapMerge(histogram, length, page_size_, page_counts_, dropped)) {
+    fprintf(stderr, "memory_heatmap: malformed device histogram for %s\n", kernel_.c_str());
+    return false;
+  }
+  if (dropped) {
+    fprintf(stderr, "memory_heatmap: %lu accesses of %s[%lu] found no slot in the device histogram\n",
+            dropped, kernel_.c_str(), dispatch_id_);
   }
   return true;
 }
@@ -115,6 +175,9 @@ void memory_heatmap_t::report() {
   }
 }
 
-void memory_heatmap_t::clear() { page_counts_.clear(); }
+void memory_heatmap_t::clear() {
+  page_counts_.clear();
+  pending_summaries_.clear();
+}
 
 } // namespace dh_comms
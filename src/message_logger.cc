@@ -66,21 +66,29 @@ bool message_logger_t::handle(const dh_comms::message_t &message)
     switch(hdr.user_type)
     {
         case dh_comms::message_type::address:
-            handle_header(message, json);
-            handle_address_message(message, json);
+        {
+            waveAddressView<dh_comms::message_t> addresses(message);
+            if (!addresses.valid())
+            {
+                fprintf(stderr, "message_logger: malformed wave-encoded address message for %s\n", strKernel_.c_str());
+                return false;
+            }
+            handle_header(addresses.wave_header(), json);
+            handle_address_message(addresses, json);
             *log_file_ << json.getJSON() << std::endl;
             break;
+        }
         case dh_comms::message_type::time_interval:
             break;
         default:
-            handle_header(message, json);
+            handle_header(hdr, json);
             *log_file_ << json.getJSON() << std::endl;
             break;
     }
     return true;
 }
     
-bool message_logger_t::handle_address_message(const dh_comms::message_t& message, JSONHelper& json)
+bool message_logger_t::handle_address_message(const waveAddressView<dh_comms::message_t>& message, JSONHelper& json)
 {
     auto hdr = message.wave_header();
     if (message.wave_header().user_type != dh_comms::message_type::address)
@@ -132,9 +140,8 @@ bool message_logger_t::handle_timeinterval_message(const dh_comms::message_t& me
     return true;
 }
 
-void message_logger_t::handle_header(const dh_comms::message_t& message, JSONHelper& json)
+void message_logger_t::handle_header(const dh_comms::wave_header_t& hdr, JSONHelper& json)
 {
-    auto hdr = message.wave_header();
     json.addField("kernel_name", strKernel_, true);
     json.addField("dispatch_id", dispatch_id_);
     json.addField("exec", hdr.exec, false, false);
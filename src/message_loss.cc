@@ -0,0 +1,149 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/message_loss.h"
+#include "inc/code_object_symbols.h"
+#include "inc/site_manifest.h"
+
+#include <string.h>
+#include <iomanip>
+
+void messageLossInit(uint32_t site_count, void *block)
+{
+    memset(block, 0, messageLossBytes(site_count));
+    messageLossHeader_t header = {};
+    memcpy(header.magic_, MESSAGE_LOSS_MAGIC, sizeof(header.magic_));
+    header.version_ = MESSAGE_LOSS_VERSION;
+    header.site_count_ = site_count;
+    memcpy(block, &header, sizeof(header));
+}
+
+messageLoss::messageLoss(size_t site_count)
+    : delivered_(site_count, 0), dropped_(site_count, 0), delivered_total_(0), dropped_total_(0), site_drops_(false)
+{
+}
+
+void messageLoss::addDelivered(size_t site, uint64_t count)
+{
+    delivered_total_ += count;
+    if (site < delivered_.size())
+        delivered_[site] += count;
+}
+
+void messageLoss::addDeliveredMessage(uint64_t fname_hash, uint32_t line)
+{
+    bool site = line == SITE_MANIFEST_LINE_FLAG && fname_hash < delivered_.size();
+    addDelivered(site ? fname_hash : MESSAGE_LOSS_NO_SITE);
+}
+
+bool messageLoss::merge(const void *block, size_t length)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(block);
+    if (length < sizeof(messageLossHeader_t) || memcmp(bytes, MESSAGE_LOSS_MAGIC, 4) != 0 ||
+        readLE<uint16_t>(bytes + 4) != MESSAGE_LOSS_VERSION)
+        return false;
+    uint32_t site_count = readLE<uint32_t>(bytes + 8);
+    uint64_t dropped = readLE<uint64_t>(bytes + 16);
+    if (site_count && (site_count != dropped_.size() || length < messageLossBytes(site_count)))
+        return false;
+    const uint8_t *sites = bytes + sizeof(messageLossHeader_t);
+    uint64_t site_total = 0;
+    for (uint32_t i = 0; i < site_count; i++)
+        site_total += readLE<uint64_t>(sites + i * sizeof(uint64_t));
+    // The total includes the drops of every site
+    if (site_total > dropped)
+        return false;
+    for (uint32_t i = 0; i < site_count; i++)
+        dropped_[i] += readLE<uint64_t>(sites + i * sizeof(uint64_t));
+    dropped_total_ += dropped;
+    if (site_count)
+        site_drops_ = true;
+    return true;
+}
+
+uint64_t messageLoss::delivered(size_t site) const
+{
+    return site < delivered_.size() ? delivered_[site] : 0;
+}
+
+uint64_t messageLoss::dropped(size_t site) const
+{
+    return site < dropped_.size() ? dropped_[site] : 0;
+}
+
+double messageLoss::lossRate() const
+{
+    uint64_t sent = delivered_total_ + dropped_total_;
+    return sent ? static_cast<double>(dropped_total_) / sent : 0.0;
+}
+
+double messageLoss::lossRate(size_t site) const
+{
+    uint64_t sent = delivered(site) + dropped(site);
+    return sent ? static_cast<double>(dropped(site)) / sent : 0.0;
+}
+
+double messageLoss::scale(uint64_t delivered, uint64_t dropped) const
+{
+    if (!dropped || delivered < MESSAGE_LOSS_MIN_DELIVERED)
+        return 1.0;
+    return static_cast<double>(delivered + dropped) / delivered;
+}
+
+double messageLoss::scale(size_t site) const
+{
+    if (site < delivered_.size())
+        return site_drops_ ? scale(delivered_[site], dropped_[site]) : 1.0;
+    // Without a manifest the dispatch is one site; with one, a message without a site has no drop count
+    if (delivered_.empty())
+        return scale(delivered_total_, dropped_total_);
+    return 1.0;
+}
+
+uint64_t messageLoss::scaleCount(size_t site, uint64_t count) const
+{
+    double factor = scale(site);
+    return factor == 1.0 ? count : static_cast<uint64_t>(count * factor + 0.5);
+}
+
+void messageLoss::report(std::ostream& out, const std::string& kernel, uint64_t dispatch_id,
+                         const siteManifest *sites) const
+{
+    if (!dropped_total_)
+        return;
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "Lossy mode: " << kernel << " dispatch " << dispatch_id << " dropped " << dropped_total_ << " of "
+        << delivered_total_ + dropped_total_ << " messages (" << lossRate() * 100 << "%)" << std::endl;
+    for (size_t i = 0; i < dropped_.size(); i++)
+    {
+        if (!dropped_[i])
+            continue;
+        out << "    site " << i;
+        if (sites && i < sites->size())
+            out << " " << sites->fileName((*sites)[i]) << ":" << (*sites)[i].line_ << ":" << (*sites)[i].column_;
+        out << " dropped " << dropped_[i] << " of " << delivered_[i] + dropped_[i] << " (" << lossRate(i) * 100 << "%)";
+        if (!scalable(i))
+            out << ", too few delivered to scale";
+        out << std::endl;
+    }
+    out.flags(flags);
+}
@@ -0,0 +1,54 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/message_recorder.h"
+
+#include <string.h>
+#include <vector>
+
+message_recorder_t::message_recorder_t(std::shared_ptr<messageRecordWriter> writer, const std::string& strKernel,
+                                       uint64_t dispatch_id)
+    : writer_(std::move(writer))
+{
+    dispatch_ = writer_->beginDispatch(strKernel, dispatch_id);
+}
+
+bool message_recorder_t::handle(const dh_comms::message_t &message)
+{
+    const dh_comms::wave_header_t& hdr = message.wave_header();
+    size_t item_size = message.data_item_size();
+    size_t item_count = message.no_data_items();
+    std::vector<char> items(item_size * item_count);
+    for (size_t i = 0; i < item_count; i++)
+        memcpy(items.data() + i * item_size, message.data_item(i), item_size);
+    writer_->append(dispatch_, &hdr, static_cast<uint32_t>(item_size), static_cast<uint32_t>(item_count), items.data());
+    // Not handled, so that the message still reaches the analysis handlers
+    return false;
+}
+
+void message_recorder_t::report()
+{
+    writer_->flush();
+}
+
+void message_recorder_t::clear()
+{
+}
@@ -0,0 +1,213 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/message_replay.h"
+
+#include <string.h>
+#include <iterator>
+
+template<typename T>
+static void appendRecord(std::vector<char>& buffer, T value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+messageRecordWriter::messageRecordWriter() : header_size_(0), dispatches_(0)
+{
+}
+
+messageRecordWriter::~messageRecordWriter()
+{
+    close();
+}
+
+bool messageRecordWriter::open(const std::string& path, uint32_t header_size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open())
+        return false;
+    header_size_ = header_size;
+    dispatches_ = 0;
+    buffer_.clear();
+    buffer_.insert(buffer_.end(), MESSAGE_RECORD_MAGIC, MESSAGE_RECORD_MAGIC + strlen(MESSAGE_RECORD_MAGIC));
+    appendRecord<uint32_t>(buffer_, MESSAGE_RECORD_VERSION);
+    appendRecord<uint32_t>(buffer_, header_size_);
+    return true;
+}
+
+uint32_t messageRecordWriter::beginDispatch(const std::string& kernel, uint64_t dispatch_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t dispatch = dispatches_++;
+    buffer_.push_back('K');
+    appendRecord<uint32_t>(buffer_, dispatch);
+    appendRecord<uint64_t>(buffer_, dispatch_id);
+    appendRecord<uint32_t>(buffer_, static_cast<uint32_t>(kernel.length()));
+    buffer_.insert(buffer_.end(), kernel.begin(), kernel.end());
+    return dispatch;
+}
+
+void messageRecordWriter::append(uint32_t dispatch, const void *header, uint32_t item_size, uint32_t item_count,
+                                 const void *items)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open())
+        return;
+    buffer_.push_back('M');
+    appendRecord<uint32_t>(buffer_, dispatch);
+    appendRecord<uint32_t>(buffer_, item_size);
+    appendRecord<uint32_t>(buffer_, item_count);
+    const char *bytes = static_cast<const char *>(header);
+    buffer_.insert(buffer_.end(), bytes, bytes + header_size_);
+    bytes = static_cast<const char *>(items);
+    buffer_.insert(buffer_.end(), bytes, bytes + static_cast<size_t>(item_size) * item_count);
+    if (buffer_.size() >= MESSAGE_RECORD_FLUSH_BYTES)
+        flushLocked();
+}
+
+void messageRecordWriter::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+}
+
+void messageRecordWriter::flushLocked()
+{
+    if (!file_.is_open() || buffer_.empty())
+        return;
+    file_.write(buffer_.data(), buffer_.size());
+    file_.flush();
+    buffer_.clear();
+}
+
+void messageRecordWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+    if (file_.is_open())
+        file_.close();
+}
+
+bool messageRecording::load(const std::string& path, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        error = "can't open " + path;
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(std::move(data), error);
+}
+
+template<typename T>
+static bool readRecord(const std::vector<char>& data, size_t& offset, T& value)
+{
+    if (data.size() - offset < sizeof(T))
+        return false;
+    memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+bool messageRecording::parse(std::vector<char>&& data, std::string& error)
+{
+    dispatches_.clear();
+    data_ = std::move(data);
+    size_t magic_length = strlen(MESSAGE_RECORD_MAGIC);
+    size_t offset = magic_length;
+    uint32_t version = 0;
+    if (data_.size() < magic_length || memcmp(data_.data(), MESSAGE_RECORD_MAGIC, magic_length) != 0)
+    {
+        error = "not a message recording";
+        return false;
+    }
+    if (!readRecord(data_, offset, version) || version != MESSAGE_RECORD_VERSION)
+    {
+        error = "unsupported message recording version " + std::to_string(version);
+        return false;
+    }
+    if (!readRecord(data_, offset, header_size_) || header_size_ == 0)
+    {
+        error = "truncated message recording header";
+        return false;
+    }
+
+    size_t record_start = offset;
+    bool complete = true;
+    while (offset < data_.size())
+    {
+        record_start = offset;
+        complete = false;
+        char tag = data_[offset++];
+        uint32_t dispatch = 0;
+        if (!readRecord(data_, offset, dispatch))
+            break;
+        if (tag == 'K')
+        {
+            recordedDispatch_t record;
+            uint32_t length = 0;
+            if (dispatch != dispatches_.size() || !readRecord(data_, offset, record.dispatch_id_) ||
+                !readRecord(data_, offset, length) || data_.size() - offset < length)
+                break;
+            record.kernel_.assign(data_.data() + offset, length);
+            offset += length;
+            dispatches_.push_back(std::move(record));
+            complete = true;
+        }
+        else if (tag == 'M')
+        {
+            recordedMessage_t message;
+            if (dispatch >= dispatches_.size() || !readRecord(data_, offset, message.item_size_) ||
+                !readRecord(data_, offset, message.item_count_))
+                break;
+            uint64_t items_size = static_cast<uint64_t>(message.item_size_) * message.item_count_;
+            if (data_.size() - offset < header_size_ + items_size)
+                break;
+            message.header_ = data_.data() + offset;
+            message.items_ = message.header_ + header_size_;
+            offset += header_size_ + items_size;
+            dispatches_[dispatch].messages_.push_back(message);
+            complete = true;
+        }
+        else
+        {
+            error = "unknown record tag at offset " + std::to_string(record_start);
+            return false;
+        }
+    }
+    if (!complete)
+    {
+        error = "truncated or malformed record at offset " + std::to_string(record_start);
+        return false;
+    }
+    return true;
+}
+
+size_t messageRecording::messageCount() const
+{
+    size_t count = 0;
+    for (const auto& dispatch : dispatches_)
+        count += dispatch.messages_.size();
+    return count;
+}
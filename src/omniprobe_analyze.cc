@@ -0,0 +1,127 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* omniprobe-analyze: cross-dispatch summaries of MemoryAnalysis and basic block outputs, read in parallel
+ * (see result_analysis.h). Run by `omniprobe analyze`.
+ *
+ * Usage: omniprobe-analyze [--output FILE] [--format text|json] [--top N] [--threads N] [--chunk-mb N] INPUT... */
+#include "inc/result_analysis.h"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage()
+{
+    std::cerr << "Usage: omniprobe-analyze [--output FILE] [--format text|json] [--top N] [--threads N] [--chunk-mb N] "
+                 "INPUT..." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    mergeOptions_t options;
+    analysisOptions_t analysis_options;
+    std::string output_path;
+    std::string format = "text";
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.size() < 2 || arg.compare(0, 2, "--") != 0)
+        {
+            inputs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--output")
+            output_path = value;
+        else if (arg == "--format" && (value == "text" || value == "json"))
+            format = value;
+        else if (arg == "--top")
+            analysis_options.top_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--threads")
+            options.threads_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--chunk-mb")
+            options.chunk_bytes_ = strtoull(value.c_str(), nullptr, 0) * 1024 * 1024;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (inputs.empty())
+    {
+        usage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    resultMerger merger(options);
+    if (!merger.merge(inputs))
+        return 1;
+    resultAnalysis analysis(merger.table(), analysis_options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t bytes = 0;
+    for (const auto& input : inputs)
+    {
+        struct stat st;
+        if (stat(input.c_str(), &st) == 0)
+            bytes += st.st_size;
+    }
+    std::cerr << "omniprobe analyze: " << merger.table().records_ << " records, " << bytes / (1024.0 * 1024.0)
+              << " MiB from " << inputs.size() << " inputs in " << seconds << " s ("
+              << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << " GB/s)" << std::endl;
+
+    auto write = [&](std::ostream& out) {
+        if (format == "json")
+            analysis.writeJson(out);
+        else
+            analysis.writeText(out);
+    };
+    if (output_path.empty())
+    {
+        write(std::cout);
+        return std::cout.good() ? 0 : 1;
+    }
+    std::ofstream output(output_path, std::ios::trunc);
+    if (!output)
+    {
+        std::cerr << "omniprobe analyze: unable to create " << output_path << std::endl;
+        return 1;
+    }
+    write(output);
+    output.close();
+    return output.good() ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* omniprobe-merge: combines the JSON outputs of several processes into one report aggregated by kernel and
+ * source location (see result_merge.h). Run by `omniprobe merge`.
+ *
+ * Usage: omniprobe-merge [--output FILE] [--threads N] [--chunk-mb N] INPUT... */
+#include "inc/result_merge.h"
+
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage()
+{
+    std::cerr << "Usage: omniprobe-merge [--output FILE] [--threads N] [--chunk-mb N] INPUT..." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    mergeOptions_t options;
+    std::string output_path;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.size() < 2 || arg.compare(0, 2, "--") != 0)
+        {
+            inputs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--output")
+            output_path = value;
+        else if (arg == "--threads")
+            options.threads_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--chunk-mb")
+            options.chunk_bytes_ = strtoull(value.c_str(), nullptr, 0) * 1024 * 1024;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (inputs.empty())
+    {
+        usage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    resultMerger merger(options);
+    if (!merger.merge(inputs))
+        return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const mergeTable& table = merger.table();
+    std::cerr << "omniprobe merge: " << table.records_ << " records from " << inputs.size() << " inputs, "
+              << table.kernels_.size() << " kernels in " << seconds << " s";
+    if (table.skipped_records_)
+        std::cerr << ", " << table.skipped_records_ << " records of other kinds left out";
+    if (table.malformed_records_)
+        std::cerr << ", " << table.malformed_records_ << " malformed records skipped";
+    std::cerr << std::endl;
+
+    if (output_path.empty())
+    {
+        merger.write(std::cout);
+        return std::cout.good() ? 0 : 1;
+    }
+    std::ofstream output(output_path, std::ios::trunc);
+    if (!output)
+    {
+        std::cerr << "omniprobe merge: unable to create " << output_path << std::endl;
+        return 1;
+    }
+    merger.write(output);
+    output.close();
+    return output.good() ? 0 : 1;
+}
@@ -21,6 +21,83 @@ THE SOFTWARE.
 *******************************************************************************/
 #include "inc/pyHandler.h"
 
+#include <stdlib.h>
+#include <map>
+#include <memory>
+
+namespace {
+
+std::mutex interpreter_mutex;
+
+// Starts the interpreter unless it is running already, as in a Python application, and gives up the GIL so
+// that any thread can take it. It is never finalized: other handlers may still use it until exit.
+bool startPython()
+{
+    std::lock_guard<std::mutex> lock(interpreter_mutex);
+    if (Py_IsInitialized())
+        return true;
+    Py_InitializeEx(0);
+    if (!Py_IsInitialized())
+        return false;
+    PyEval_SaveThread();
+    return true;
+}
+
+PyObject *optionalFunction(PyObject *module, const char *name)
+{
+    PyObject *func = PyObject_GetAttrString(module, name);
+    if (func && PyCallable_Check(func))
+        return func;
+    Py_XDECREF(func);
+    PyErr_Clear();
+    return nullptr;
+}
+
+// A typed, read-only memoryview of column; format must be a literal, the view keeps a pointer to it
+template <typename T>
+PyObject *columnView(std::vector<T>& column, const char *format)
+{
+    static T empty;
+    Py_buffer buffer = {};
+    buffer.buf = column.empty() ? &empty : column.data();
+    buffer.len = column.size() * sizeof(T);
+    buffer.readonly = 1;
+    buffer.itemsize = sizeof(T);
+    buffer.format = const_cast<char *>(format);
+    buffer.ndim = 1;
+    return PyMemoryView_FromBuffer(&buffer);
+}
+
+template <typename T>
+void addColumn(PyObject *batch, std::vector<PyObject *>& views, const char *name, std::vector<T>& column)
+{
+    static_assert(sizeof(T) == 8 || sizeof(T) == 4, "columns are uint64_t or uint32_t");
+    PyObject *view = columnView(column, sizeof(T) == 8 ? "Q" : "I");
+    if (!view)
+        return;
+    PyDict_SetItemString(batch, name, view);
+    views.push_back(view);
+}
+
+/* Releases the views handed to Python, so that a module that kept one gets an error rather than the next
+ * batch's data. A view that can't be released has been exported, e.g. to numpy.frombuffer(), and the array
+ * still points at the column: the column's storage is then left to it for good and the column starts over. */
+template <typename T>
+void releaseView(PyObject *view, std::vector<T>& column)
+{
+    PyObject *result = PyObject_CallMethod(view, "release", nullptr);
+    if (result)
+        Py_DECREF(result);
+    else
+    {
+        PyErr_Clear();
+        new std::vector<T>(std::move(column));
+        column = std::vector<T>();
+    }
+    Py_DECREF(view);
+}
+
+} // namespace
 
 std::mutex pythonMessageHandler::global_mutex_;
 
@@ -28,25 +105,24 @@ pythonMessageHandler::pythonMessageHandler(std::string& module_name)
 {
     module_name_ = module_name;
     std::lock_guard<std::mutex> lock(global_mutex_);
-    if (!Py_IsInitialized()) {
-        Py_Initialize();
-        if (!Py_IsInitialized())
-        {
-            std::cerr << "Python initialization failed!" << std::endl;
-            throw std::runtime_error(std::string("Python initialization failed!"));
-        }
+    if (!startPython())
+    {
+        std::cerr << "Python initialization failed!" << std::endl;
+        throw std::runtime_error(std::string("Python initialization failed!"));
     }
+    PyGILState_STATE gil = PyGILState_Ensure();
     pModule_ = PyImport_ImportModule(module_name_.c_str());
     if (!pModule_) {
         PyErr_Print();
+        PyGILState_Release(gil);
         std::cerr << "Failed to load Python module!" << std::endl;
-        Py_Finalize();
         throw std::runtime_error(std::string("Failed to load Python module!"));
     }
     
     pAddressFunc_ = PyObject_GetAttrString(pModule_, "handleAddressMessage");
     if (!pAddressFunc_ || !PyCallable_Check(pAddressFunc_)) {
         PyErr_Print();
+        PyGILState_Release(gil);
         std::cerr << "Cannot find function '" << "handleAddressMessage" << "'!" << std::endl;
         throw std::runtime_error(std::string("Failed to find handleAddressMessage!"));
     }
@@ -54,76 +130,343 @@ pythonMessageHandler::pythonMessageHandler(std::string& module_name)
     pTimingFunc_ = PyObject_GetAttrString(pModule_, "handleTimeMessage");
     if (!pTimingFunc_ || !PyCallable_Check(pTimingFunc_)) {
         PyErr_Print();
+        PyGILState_Release(gil);
         std::cerr << "Cannot find function '" << "handleTimeMessage" << "'!" << std::endl;
         throw std::runtime_error(std::string("Failed to find handleTimeMessage!"));
     }
+    PyGILState_Release(gil);
 }
 
 pythonMessageHandler::~pythonMessageHandler()
 {
+    PyGILState_STATE gil = PyGILState_Ensure();
     if (pAddressFunc_)
         Py_DECREF(pAddressFunc_);
     if (pTimingFunc_)
         Py_DECREF(pTimingFunc_);
     if (pModule_)
         Py_DECREF(pModule_);
-    Py_Finalize();
+    PyGILState_Release(gil);
 }
 void pythonMessageHandler::addressMessage(void *address)
 {
+    PyGILState_STATE gil = PyGILState_Ensure();
     PyObject* pDict = PyDict_New();
     if (!pDict) {
         PyErr_Print();
+        PyGILState_Release(gil);
         std::cerr << "Failed to create dictionary!" << std::endl;
         throw std::runtime_error("Failed to create python dictionary in addressMessage");
     }
 
     // Populate the Python dictionary (add key-value pairs)
-    PyDict_SetItemString(pDict, "address", PyLong_FromUnsignedLong(reinterpret_cast<unsigned long>(address)));  // Add integer value
+    PyObject* pAddress = PyLong_FromUnsignedLong(reinterpret_cast<unsigned long>(address));
+    PyDict_SetItemString(pDict, "address", pAddress);  // Add integer value
+    Py_XDECREF(pAddress);
 
     // Call the Python function with the dictionary as an argument
-    PyObject* pArgs = PyTuple_New(1);  // Create a tuple for function arguments
-    PyTuple_SetItem(pArgs, 0, pDict);  // Add dictionary to the tuple
-
-    PyObject* pValue = PyObject_CallObject(pAddressFunc_, pArgs);
+    PyObject* pValue = PyObject_CallFunctionObjArgs(pAddressFunc_, pDict, nullptr);
     if (!pValue) {
         PyErr_Print();
         std::cerr << "Function call to addressMessageHandler failed!" << std::endl;
     } else {
-        std::cout << "Function call to addressMessageHandler succeeded!" << std::endl;
         Py_DECREF(pValue);
     }
-    Py_DECREF(pArgs);
     Py_DECREF(pDict);
+    PyGILState_Release(gil);
     return;
 }
 
 void pythonMessageHandler::timingMessage(uint64_t time)
 {
+    PyGILState_STATE gil = PyGILState_Ensure();
     PyObject* pDict = PyDict_New();
     if (!pDict) {
         PyErr_Print();
+        PyGILState_Release(gil);
         std::cerr << "Failed to create dictionary!" << std::endl;
         throw std::runtime_error("Failed to create python dictionary in timingMessage");
     }
 
     // Populate the Python dictionary (add key-value pairs)
-    PyDict_SetItemString(pDict, "elapsed_time", PyLong_FromUnsignedLong(time));  // Add integer value
+    PyObject* pTime = PyLong_FromUnsignedLong(time);
+    PyDict_SetItemString(pDict, "elapsed_time", pTime);  // Add integer value
+    Py_XDECREF(pTime);
 
     // Call the Python function with the dictionary as an argument
-    PyObject* pArgs = PyTuple_New(1);  // Create a tuple for function arguments
-    PyTuple_SetItem(pArgs, 0, pDict);  // Add dictionary to the tuple
-
-    PyObject* pValue = PyObject_CallObject(pTimingFunc_, pArgs);
+    PyObject* pValue = PyObject_CallFunctionObjArgs(pTimingFunc_, pDict, nullptr);
     if (!pValue) {
         PyErr_Print();
         std::cerr << "Function call to timeMessageHandler failed!" << std::endl;
     } else {
-        std::cout << "Function call to timeMessageHandler succeeded!" << std::endl;
         Py_DECREF(pValue);
     }
-    Py_DECREF(pArgs);
     Py_DECREF(pDict);
+    PyGILState_Release(gil);
     return;
 }
 
+pythonBatchHandler::pythonBatchHandler(const std::string& module_name, size_t batch_messages)
+    : module_name_(module_name), module_(nullptr), address_func_(nullptr), time_func_(nullptr),
+      dispatch_end_func_(nullptr), batch_messages_(batch_messages), pending_ready_(false), stop_(false), batches_(0),
+      failed_calls_(0)
+{
+    if (!startPython())
+        throw std::runtime_error("Python initialization failed");
+    PyGILState_STATE gil = PyGILState_Ensure();
+    module_ = PyImport_ImportModule(module_name_.c_str());
+    if (!module_)
+    {
+        PyErr_Print();
+        PyGILState_Release(gil);
+        throw std::runtime_error("unable to import Python module " + module_name_);
+    }
+    address_func_ = optionalFunction(module_, "handleAddressBatch");
+    time_func_ = optionalFunction(module_, "handleTimeBatch");
+    dispatch_end_func_ = optionalFunction(module_, "handleDispatchEnd");
+    const char *env = getenv("LOGDUR_PYTHON_BATCH");
+    if (!batch_messages_ && env)
+        batch_messages_ = strtoull(env, nullptr, 0);
+    if (!batch_messages_)
+    {
+        PyObject *size = PyObject_GetAttrString(module_, "BATCH_MESSAGES");
+        if (size && PyLong_Check(size))
+            batch_messages_ = PyLong_AsSize_t(size);
+        Py_XDECREF(size);
+        PyErr_Clear();
+    }
+    bool usable = address_func_ || time_func_;
+    if (!usable)
+    {
+        Py_DECREF(module_);
+        Py_XDECREF(dispatch_end_func_);
+    }
+    PyGILState_Release(gil);
+    if (!usable)
+        throw std::runtime_error("Python module " + module_name_ + " defines neither handleAddressBatch nor handleTimeBatch");
+    if (!batch_messages_ || batch_messages_ == static_cast<size_t>(-1))
+        batch_messages_ = PYTHON_BATCH_MESSAGES;
+    worker_ = std::thread(&pythonBatchHandler::work, this);
+}
+
+pythonBatchHandler::~pythonBatchHandler()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    ready_.notify_one();
+    worker_.join();
+    PyGILState_STATE gil = PyGILState_Ensure();
+    Py_XDECREF(address_func_);
+    Py_XDECREF(time_func_);
+    Py_XDECREF(dispatch_end_func_);
+    Py_XDECREF(module_);
+    PyGILState_Release(gil);
+}
+
+pythonBatchHandler *pythonBatchHandler::get(const std::string& module_name)
+{
+    // Handlers are per dispatch but the module is loaded once. The handlers are never destroyed, so that they
+    // outlive the dispatches that still report at exit.
+    static std::mutex handlers_mutex;
+    static auto *handlers = new std::map<std::string, std::unique_ptr<pythonBatchHandler>>;
+    std::lock_guard<std::mutex> lock(handlers_mutex);
+    auto found = handlers->find(module_name);
+    if (found != handlers->end())
+        return found->second.get();
+    pythonBatchHandler *handler = nullptr;
+    try
+    {
+        handler = new pythonBatchHandler(module_name);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "omniprobe: " << e.what() << std::endl;
+    }
+    // A module that failed to load isn't tried again
+    (*handlers)[module_name].reset(handler);
+    return handler;
+}
+
+size_t pythonBatchHandler::pendingMessages(const pythonBatch_t& batch) const
+{
+    return batch.dispatch_id_.size() + batch.start_.size();
+}
+
+void pythonBatchHandler::addressMessage(const pythonMessageHeader_t& header, const uint64_t *addresses, size_t count)
+{
+    if (!address_func_)
+        return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    waitForRoom(lock);
+    uint32_t index = filling_.dispatch_id_.size();
+    filling_.dispatch_id_.push_back(header.dispatch_id_);
+    filling_.timestamp_.push_back(header.timestamp_);
+    filling_.exec_.push_back(header.exec_);
+    filling_.line_.push_back(header.line_);
+    filling_.column_.push_back(header.column_);
+    filling_.user_data_.push_back(header.user_data_);
+    filling_.address_.insert(filling_.address_.end(), addresses, addresses + count);
+    filling_.message_.insert(filling_.message_.end(), count, index);
+    if (pendingMessages(filling_) >= batch_messages_)
+        handOff(lock);
+}
+
+void pythonBatchHandler::timeIntervals(uint64_t dispatch_id, const uint64_t *intervals, size_t count)
+{
+    if (!time_func_)
+        return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    waitForRoom(lock);
+    for (size_t i = 0; i < count; i++)
+    {
+        filling_.interval_dispatch_id_.push_back(dispatch_id);
+        filling_.start_.push_back(intervals[2 * i]);
+        filling_.stop_.push_back(intervals[2 * i + 1]);
+    }
+    if (pendingMessages(filling_) >= batch_messages_)
+        handOff(lock);
+}
+
+void pythonBatchHandler::waitForRoom(std::unique_lock<std::mutex>& lock)
+{
+    // A full batch is being handed off by the producer that filled it
+    done_.wait(lock, [this]() { return pendingMessages(filling_) < batch_messages_; });
+}
+
+void pythonBatchHandler::handOff(std::unique_lock<std::mutex>& lock)
+{
+    done_.wait(lock, [this]() { return !pending_ready_; });
+    std::swap(filling_, pending_);
+    pending_ready_ = true;
+    ready_.notify_one();
+    done_.notify_all();
+}
+
+void pythonBatchHandler::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (pendingMessages(filling_))
+        handOff(lock);
+    done_.wait(lock, [this]() { return !pending_ready_; });
+}
+
+void pythonBatchHandler::dispatchEnd(const std::string& kernel, uint64_t dispatch_id)
+{
+    flush();
+    if (!dispatch_end_func_)
+        return;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    PyObject *result = PyObject_CallFunction(dispatch_end_func_, "sK", kernel.c_str(),
+                                             static_cast<unsigned long long>(dispatch_id));
+    if (result)
+        Py_DECREF(result);
+    else
+    {
+        PyErr_Print();
+        failed_calls_++;
+    }
+    PyGILState_Release(gil);
+}
+
+void pythonBatchHandler::work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        ready_.wait(lock, [this]() { return pending_ready_ || stop_; });
+        if (!pending_ready_)
+            break;
+        // Producers fill the other batch meanwhile
+        lock.unlock();
+        deliver(pending_);
+        lock.lock();
+        pending_ready_ = false;
+        done_.notify_all();
+    }
+}
+
+void pythonBatchHandler::deliver(pythonBatch_t& batch)
+{
+    PyGILState_STATE gil = PyGILState_Ensure();
+    auto call = [this](PyObject *func, PyObject *columns) {
+        PyObject *result = columns ? PyObject_CallFunctionObjArgs(func, columns, nullptr) : nullptr;
+        if (result)
+            Py_DECREF(result);
+        else
+        {
+            PyErr_Print();
+            failed_calls_++;
+        }
+        batches_++;
+    };
+    if (!batch.dispatch_id_.empty())
+    {
+        PyObject *columns = PyDict_New();
+        std::vector<PyObject *> views;
+        if (columns)
+        {
+            addColumn(columns, views, "dispatch_id", batch.dispatch_id_);
+            addColumn(columns, views, "timestamp", batch.timestamp_);
+            addColumn(columns, views, "exec", batch.exec_);
+            addColumn(columns, views, "line", batch.line_);
+            addColumn(columns, views, "column", batch.column_);
+            addColumn(columns, views, "user_data", batch.user_data_);
+            addColumn(columns, views, "address", batch.address_);
+            addColumn(columns, views, "message", batch.message_);
+        }
+        call(address_func_, views.size() == 8 ? columns : nullptr);
+        if (views.size() == 8)
+        {
+            releaseView(views[0], batch.dispatch_id_);
+            releaseView(views[1], batch.timestamp_);
+            releaseView(views[2], batch.exec_);
+            releaseView(views[3], batch.line_);
+            releaseView(views[4], batch.column_);
+            releaseView(views[5], batch.user_data_);
+            releaseView(views[6], batch.address_);
+            releaseView(views[7], batch.message_);
+        }
+        else
+            for (PyObject *view : views)
+                Py_DECREF(view);
+        Py_XDECREF(columns);
+    }
+    if (!batch.start_.empty())
+    {
+        PyObject *columns = PyDict_New();
+        std::vector<PyObject *> views;
+        if (columns)
+        {
+            addColumn(columns, views, "dispatch_id", batch.interval_dispatch_id_);
+            addColumn(columns, views, "start", batch.start_);
+            addColumn(columns, views, "stop", batch.stop_);
+        }
+        call(time_func_, views.size() == 3 ? columns : nullptr);
+        if (views.size() == 3)
+        {
+            releaseView(views[0], batch.interval_dispatch_id_);
+            releaseView(views[1], batch.start_);
+            releaseView(views[2], batch.stop_);
+        }
+        else
+            for (PyObject *view : views)
+                Py_DECREF(view);
+        Py_XDECREF(columns);
+    }
+    PyGILState_Release(gil);
+    // Emptied, keeping their capacity for the next batch
+    batch.dispatch_id_.clear();
+    batch.timestamp_.clear();
+    batch.exec_.clear();
+    batch.line_.clear();
+    batch.column_.clear();
+    batch.user_data_.clear();
+    batch.address_.clear();
+    batch.message_.clear();
+    batch.interval_dispatch_id_.clear();
+    batch.start_.clear();
+    batch.stop_.clear();
+}
@@ -0,0 +1,79 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/python_batch_handler.h"
+#include "inc/time_interval_handler.h"
+#include "inc/wave_encoding.h"
+
+python_batch_handler_t::python_batch_handler_t(const std::string& strKernel, uint64_t dispatch_id,
+                                               pythonBatchHandler *handler)
+    : strKernel_(strKernel), dispatch_id_(dispatch_id), handler_(handler)
+{
+}
+
+bool python_batch_handler_t::handle(const dh_comms::message_t &message)
+{
+    switch (message.wave_header().user_type)
+    {
+        case dh_comms::message_type::address:
+        {
+            waveAddressView<dh_comms::message_t> addresses(message);
+            if (!addresses.valid())
+                return true;
+            const auto& hdr = addresses.wave_header();
+            pythonMessageHeader_t header;
+            header.dispatch_id_ = dispatch_id_;
+            header.timestamp_ = hdr.timestamp;
+            header.exec_ = hdr.exec;
+            header.line_ = hdr.dwarf_line;
+            header.column_ = hdr.dwarf_column;
+            header.user_data_ = hdr.user_data;
+            scratch_.resize(addresses.no_data_items());
+            for (size_t i = 0; i != scratch_.size(); ++i)
+                scratch_[i] = *static_cast<const uint64_t *>(addresses.data_item(i));
+            handler_->addressMessage(header, scratch_.data(), scratch_.size());
+            return true;
+        }
+        case dh_comms::message_type::time_interval:
+        {
+            scratch_.resize(message.no_data_items() * 2);
+            for (size_t i = 0; i != message.no_data_items(); ++i)
+            {
+                dh_comms::time_interval ti = *static_cast<const dh_comms::time_interval *>(message.data_item(i));
+                scratch_[2 * i] = ti.start;
+                scratch_[2 * i + 1] = ti.stop;
+            }
+            handler_->timeIntervals(dispatch_id_, scratch_.data(), message.no_data_items());
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void python_batch_handler_t::report()
+{
+    handler_->dispatchEnd(strKernel_, dispatch_id_);
+}
+
+void python_batch_handler_t::clear()
+{
+}
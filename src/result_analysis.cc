@@ -0,0 +1,282 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/result_analysis.h"
+#include "inc/json_reader.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+// Keeps the top entries of candidates by score, highest first; equal scores keep the table's order
+template <typename entry_t, typename score_t>
+void rank(std::vector<const entry_t *>& candidates, size_t top, score_t score)
+{
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [&](const entry_t *a, const entry_t *b) { return score(*a) > score(*b); });
+    if (top && candidates.size() > top)
+        candidates.resize(top);
+}
+
+std::string location(const std::string& file, uint64_t line, uint64_t column)
+{
+    return file + ":" + std::to_string(line) + (column ? ":" + std::to_string(column) : std::string());
+}
+
+void writeAccess(jsonWriter& json, const analyzedAccess_t& entry)
+{
+    const mergedAccessKey_t& key = entry.first;
+    const mergedAccess_t& access = entry.second;
+    json.field("kernel", key.kernel_);
+    json.field("file", key.file_);
+    json.field("line", key.line_);
+    json.field("column", key.column_);
+    json.field("code_context", access.code_context_);
+    json.field("type", key.type_);
+    json.field("ir_bytes", key.ir_bytes_);
+    json.field("execution_count", access.execution_count_);
+    json.field("dispatches", access.dispatches_);
+    if (access.estimated_)
+        json.field("estimated", true);
+}
+
+} // namespace
+
+resultAnalysis::resultAnalysis(const mergeTable& table, const analysisOptions_t& options) : table_(table)
+{
+    // The table is ordered by kernel, so each kernel's accesses and blocks are contiguous and in step with
+    // kernels_
+    for (const auto& [name, kernel] : table.kernels_)
+    {
+        kernelSummary_t summary;
+        summary.name_ = name;
+        summary.processes_ = std::count(kernel.inputs_.begin(), kernel.inputs_.end(), true);
+        summary.dispatches_ = kernel.dispatches_.size();
+        summary.messages_dropped_ = kernel.messages_dropped_;
+        kernels_.push_back(summary);
+    }
+    auto summary = [&](const std::string& name) -> kernelSummary_t& {
+        return *std::lower_bound(kernels_.begin(), kernels_.end(), name,
+                                 [](const kernelSummary_t& kernel, const std::string& key) { return kernel.name_ < key; });
+    };
+
+    for (const analyzedAccess_t& entry : table.accesses_)
+    {
+        const mergedAccess_t& access = entry.second;
+        kernelSummary_t& kernel = summary(entry.first.kernel_);
+        kernel.execution_count_ += access.execution_count_;
+        kernel.estimated_ |= access.estimated_;
+        if (entry.first.kind_ == MERGED_CACHE_LINES)
+        {
+            kernel.global_sites_++;
+            kernel.cache_lines_needed_ += access.cache_lines_needed_;
+            kernel.cache_lines_used_ += access.cache_lines_used_;
+            if (excessCacheLines(access))
+                uncoalesced_.push_back(&entry);
+        }
+        else
+        {
+            kernel.lds_sites_++;
+            kernel.bank_conflicts_ += access.bank_conflicts_;
+            if (access.bank_conflicts_)
+                bank_conflicts_.push_back(&entry);
+        }
+    }
+    for (const analyzedBlock_t& entry : table.blocks_)
+    {
+        // Regions nest and overlap the blocks, so they stay out of the block totals
+        if (entry.first.region_)
+            continue;
+        kernelSummary_t& kernel = summary(entry.first.kernel_);
+        kernel.blocks_++;
+        kernel.block_duration_ += entry.second.duration_;
+        hottest_blocks_.push_back(&entry);
+    }
+
+    rank(uncoalesced_, options.top_, [](const analyzedAccess_t& entry) { return excessCacheLines(entry.second); });
+    rank(bank_conflicts_, options.top_, [](const analyzedAccess_t& entry) { return entry.second.bank_conflicts_; });
+    rank(hottest_blocks_, options.top_, [](const analyzedBlock_t& entry) { return entry.second.duration_; });
+}
+
+void resultAnalysis::writeText(std::ostream& out) const
+{
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    out << "Analyzed " << table_.records_ << " records: " << kernels_.size() << " kernels";
+    if (table_.malformed_records_)
+        out << ", " << table_.malformed_records_ << " malformed records skipped";
+    out << std::endl;
+
+    out << std::endl << "Kernels" << std::endl;
+    for (const auto& kernel : kernels_)
+    {
+        out << "  " << kernel.name_ << std::endl;
+        out << "      " << kernel.dispatches_ << " dispatches in " << kernel.processes_ << " processes";
+        if (kernel.messages_dropped_)
+            out << ", " << kernel.messages_dropped_ << " messages dropped";
+        out << std::endl;
+        if (kernel.global_sites_ || kernel.lds_sites_)
+        {
+            out << "      " << kernel.execution_count_ << " accesses at " << kernel.global_sites_ << " global and "
+                << kernel.lds_sites_ << " LDS sites";
+            if (kernel.estimated_)
+                out << " (estimated)";
+            out << std::endl;
+            out << "      " << kernel.cache_lines_used_ << " cache lines used, " << kernel.cache_lines_needed_
+                << " needed; " << kernel.bank_conflicts_ << " bank conflicts" << std::endl;
+        }
+        if (kernel.blocks_)
+            out << "      " << kernel.blocks_ << " basic blocks, " << kernel.block_duration_ << " total duration"
+                << std::endl;
+    }
+
+    out << std::endl << "Top uncoalesced global accesses (cache lines used beyond the minimum)" << std::endl;
+    if (uncoalesced_.empty())
+        out << "  none" << std::endl;
+    for (size_t i = 0; i < uncoalesced_.size(); i++)
+    {
+        const mergedAccessKey_t& key = uncoalesced_[i]->first;
+        const mergedAccess_t& access = uncoalesced_[i]->second;
+        out << std::setw(4) << i + 1 << ". " << location(key.file_, key.line_, key.column_) << " in " << key.kernel_
+            << std::endl;
+        out << "      " << key.type_ << " of " << key.ir_bytes_ << " bytes, " << access.execution_count_
+            << " executions: " << access.cache_lines_used_ << " cache lines used, " << access.cache_lines_needed_
+            << " needed (" << excessCacheLines(access) << " excess";
+        if (access.cache_lines_needed_)
+            out << ", " << static_cast<double>(access.cache_lines_used_) / access.cache_lines_needed_ << "x";
+        out << ")" << (access.estimated_ ? " (estimated)" : "") << std::endl;
+        if (!access.code_context_.empty())
+            out << "      " << access.code_context_ << std::endl;
+    }
+
+    out << std::endl << "Worst LDS bank conflicts" << std::endl;
+    if (bank_conflicts_.empty())
+        out << "  none" << std::endl;
+    for (size_t i = 0; i < bank_conflicts_.size(); i++)
+    {
+        const mergedAccessKey_t& key = bank_conflicts_[i]->first;
+        const mergedAccess_t& access = bank_conflicts_[i]->second;
+        out << std::setw(4) << i + 1 << ". " << location(key.file_, key.line_, key.column_) << " in " << key.kernel_
+            << std::endl;
+        out << "      " << key.type_ << " of " << key.ir_bytes_ << " bytes, " << access.execution_count_
+            << " executions: " << access.bank_conflicts_ << " bank conflicts"
+            << (access.estimated_ ? " (estimated)" : "") << std::endl;
+        if (!access.code_context_.empty())
+            out << "      " << access.code_context_ << std::endl;
+    }
+
+    out << std::endl << "Hottest basic blocks" << std::endl;
+    if (hottest_blocks_.empty())
+        out << "  none" << std::endl;
+    for (size_t i = 0; i < hottest_blocks_.size(); i++)
+    {
+        const mergedBlockKey_t& key = hottest_blocks_[i]->first;
+        const mergedBlock_t& block = hottest_blocks_[i]->second;
+        out << std::setw(4) << i + 1 << ". " << key.file_ << ":" << key.start_line_ << "-" << key.end_line_ << " in "
+            << key.kernel_ << std::endl;
+        out << "      duration " << block.duration_ << " over " << block.count_ << " visits in " << block.dispatches_
+            << " dispatches, p99 up to " << block.duration_p99_max_ << std::endl;
+    }
+    out.flags(flags);
+}
+
+void resultAnalysis::writeJson(std::ostream& out) const
+{
+    jsonWriter json(out);
+    json.open('{');
+    json.field("records", table_.records_);
+    json.field("malformed_records", table_.malformed_records_);
+
+    json.next("kernels");
+    json.open('[');
+    for (const auto& kernel : kernels_)
+    {
+        json.next();
+        json.open('{');
+        json.field("name", kernel.name_);
+        json.field("processes", kernel.processes_);
+        json.field("dispatches", kernel.dispatches_);
+        json.field("global_sites", kernel.global_sites_);
+        json.field("lds_sites", kernel.lds_sites_);
+        json.field("execution_count", kernel.execution_count_);
+        json.field("cache_lines_needed", kernel.cache_lines_needed_);
+        json.field("cache_lines_used", kernel.cache_lines_used_);
+        json.field("bank_conflicts", kernel.bank_conflicts_);
+        json.field("basic_blocks", kernel.blocks_);
+        json.field("block_duration", kernel.block_duration_);
+        if (kernel.messages_dropped_)
+            json.field("messages_dropped", kernel.messages_dropped_);
+        if (kernel.estimated_)
+            json.field("estimated", true);
+        json.close('}');
+    }
+    json.close(']');
+
+    json.next("uncoalesced");
+    json.open('[');
+    for (const analyzedAccess_t *entry : uncoalesced_)
+    {
+        json.next();
+        json.open('{');
+        writeAccess(json, *entry);
+        json.field("isa_instruction", entry->first.isa_instruction_);
+        json.field("cache_lines_needed", entry->second.cache_lines_needed_);
+        json.field("cache_lines_used", entry->second.cache_lines_used_);
+        json.field("excess_cache_lines", excessCacheLines(entry->second));
+        json.close('}');
+    }
+    json.close(']');
+
+    json.next("bank_conflicts");
+    json.open('[');
+    for (const analyzedAccess_t *entry : bank_conflicts_)
+    {
+        json.next();
+        json.open('{');
+        writeAccess(json, *entry);
+        json.field("total_conflicts", entry->second.bank_conflicts_);
+        json.close('}');
+    }
+    json.close(']');
+
+    json.next("hottest_blocks");
+    json.open('[');
+    for (const analyzedBlock_t *entry : hottest_blocks_)
+    {
+        const mergedBlockKey_t& key = entry->first;
+        const mergedBlock_t& block = entry->second;
+        json.next();
+        json.open('{');
+        json.field("kernel", key.kernel_);
+        json.field("file", key.file_);
+        json.field("start_line", key.start_line_);
+        json.field("end_line", key.end_line_);
+        json.field("duration", block.duration_);
+        json.field("count", block.count_);
+        json.field("duration_p99_max", block.duration_p99_max_);
+        json.field("dispatches", block.dispatches_);
+        json.close('}');
+    }
+    json.close(']');
+    json.close('}');
+    out << '\n';
+}
@@ -0,0 +1,516 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/result_merge.h"
+#include "inc/json_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+typedef struct {
+    const char *data_;
+    size_t size_;
+} mappedInput_t;
+
+typedef struct {
+    uint32_t input_;
+    size_t begin_;
+    size_t end_;
+} mergeChunk_t;
+
+// The next line starting with '{' at or after pos, or end
+const char *nextRecordStart(const char *pos, const char *begin, const char *end)
+{
+    if (pos == begin)
+        return pos < end && *pos == '{' ? pos : nextRecordStart(pos + 1, begin, end);
+    if (pos >= end)
+        return end;
+    const void *found = memmem(pos - 1, end - pos + 1, "\n{", 2);
+    return found ? static_cast<const char *>(found) + 1 : end;
+}
+
+void dropPages(const char *begin, const char *end)
+{
+    // Only whole pages inside the chunk; the ones at its edges may still be needed by a neighbour
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t first = (reinterpret_cast<uintptr_t>(begin) + page - 1) & ~(page - 1);
+    uintptr_t last = reinterpret_cast<uintptr_t>(end) & ~(page - 1);
+    if (last > first)
+        madvise(reinterpret_cast<void *>(first), last - first, MADV_DONTNEED);
+}
+
+uint64_t activeLanes(double branchiness, uint64_t count)
+{
+    double lanes = (1.0 - branchiness) * static_cast<double>(count) * 64.0;
+    return lanes > 0 ? static_cast<uint64_t>(std::llround(lanes)) : 0;
+}
+
+void keepContext(std::string& kept, const std::string& context)
+{
+    // The same line should read the same in every process; if not, keep one deterministically
+    if (!context.empty() && (kept.empty() || context < kept))
+        kept = context;
+}
+
+// The member named key of a record, or an empty string, without a copy
+const std::string& stringRef(const jsonValue& record, std::string_view key)
+{
+    static const std::string empty;
+    const jsonValue *value = record.find(key);
+    return value && value->isString() ? value->asString() : empty;
+}
+
+void writeSourceLocation(jsonWriter& json, const std::string& file, uint64_t line, uint64_t column)
+{
+    json.next("source_location");
+    json.open('{');
+    json.field("file", file);
+    json.field("line", line);
+    json.field("column", column);
+    json.close('}');
+}
+
+} // namespace
+
+bool operator<(const mergedAccessKey_t& a, const mergedAccessKey_t& b)
+{
+    return std::tie(a.kernel_, a.kind_, a.file_, a.line_, a.column_, a.type_, a.ir_bytes_, a.isa_bytes_,
+                    a.isa_instruction_) <
+           std::tie(b.kernel_, b.kind_, b.file_, b.line_, b.column_, b.type_, b.ir_bytes_, b.isa_bytes_,
+                    b.isa_instruction_);
+}
+
+bool operator<(const mergedBlockKey_t& a, const mergedBlockKey_t& b)
+{
+    return std::tie(a.kernel_, a.region_, a.file_, a.index_, a.start_line_, a.end_line_, a.region_kind_) <
+           std::tie(b.kernel_, b.region_, b.file_, b.index_, b.start_line_, b.end_line_, b.region_kind_);
+}
+
+mergedKernel_t& mergeTable::kernel(const std::string& name, uint64_t dispatch_id, uint32_t input)
+{
+    mergedKernel_t& kernel = kernels_[name];
+    kernel.dispatches_.insert(static_cast<uint64_t>(input) << 40 | dispatch_id);
+    if (kernel.inputs_.size() <= input)
+        kernel.inputs_.resize(input + 1, false);
+    kernel.inputs_[input] = true;
+    return kernel;
+}
+
+void mergeTable::add(const jsonValue& record, uint32_t input)
+{
+    if (!record.isObject())
+    {
+        skipped_records_++;
+        return;
+    }
+    if (const jsonValue *analysis = record.find("kernel_analysis"))
+    {
+        if (!analysis->isObject())
+        {
+            malformed_records_++;
+            return;
+        }
+        addMemoryAnalysis(*analysis, input);
+    }
+    else if (record.find("block_start_line"))
+        addBlock(record, input, false);
+    else if (record.find("region") && record.find("region_start_line"))
+        addBlock(record, input, true);
+    else
+    {
+        skipped_records_++;
+        return;
+    }
+    records_++;
+}
+
+void mergeTable::addMemoryAnalysis(const jsonValue& analysis, uint32_t input)
+{
+    const jsonValue *info = analysis.find("kernel_info");
+    std::string name = info ? info->stringAt("name") : std::string();
+    mergedKernel_t& totals = kernel(name, info ? info->uintAt("dispatch_id") : 0, input);
+    if (info)
+        totals.messages_dropped_ += info->uintAt("messages_dropped");
+
+    // One key for all the accesses, so that its strings are only allocated once
+    mergedAccessKey_t key{name, MERGED_CACHE_LINES, "", 0, 0, "", 0, 0, ""};
+    auto addAccesses = [&](const char *section, mergedAccessKind_t kind) {
+        const jsonValue *accesses = analysis.find(section);
+        accesses = accesses ? accesses->find("accesses") : nullptr;
+        if (!accesses)
+            return;
+        key.kind_ = kind;
+        for (const jsonValue& access : accesses->items())
+        {
+            const jsonValue *location = access.find("source_location");
+            const jsonValue *access_info = access.find("access_info");
+            if (!location || !access_info)
+                continue;
+            key.file_ = stringRef(*location, "file");
+            key.line_ = location->uintAt("line");
+            key.column_ = location->uintAt("column");
+            key.type_ = stringRef(*access_info, "type");
+            key.ir_bytes_ = access_info->uintAt("ir_bytes");
+            key.isa_bytes_ = access_info->uintAt("isa_bytes");
+            key.isa_instruction_ = stringRef(*access_info, "isa_instruction");
+            mergedAccess_t& merged = accesses_[key];
+            merged.execution_count_ += access_info->uintAt("execution_count");
+            if (const jsonValue *lines = access_info->find("cache_lines"))
+            {
+                merged.cache_lines_needed_ += lines->uintAt("needed");
+                merged.cache_lines_used_ += lines->uintAt("used");
+            }
+            merged.bank_conflicts_ += access_info->uintAt("total_conflicts");
+            if (const jsonValue *estimated = access_info->find("estimated"))
+                merged.estimated_ |= estimated->asBool();
+            merged.dispatches_++;
+            keepContext(merged.code_context_, stringRef(access, "code_context"));
+        }
+    };
+    addAccesses("cache_analysis", MERGED_CACHE_LINES);
+    addAccesses("bank_conflicts", MERGED_BANK_CONFLICTS);
+}
+
+void mergeTable::addBlock(const jsonValue& record, uint32_t input, bool region)
+{
+    const std::string& name = stringRef(record, "kernel");
+    kernel(name, record.uintAt("dispatch_id"), input);
+    // Field names are the prefix and a suffix, put together without allocating
+    const char *prefix = region ? "region_" : "block_";
+    char field_name[32];
+    size_t prefix_length = strlen(prefix);
+    memcpy(field_name, prefix, prefix_length);
+    auto at = [&](const char *field) {
+        size_t length = std::min(strlen(field), sizeof(field_name) - prefix_length);
+        memcpy(field_name + prefix_length, field, length);
+        return std::string_view(field_name, prefix_length + length);
+    };
+    mergedBlockKey_t key{name, region, stringRef(record, "kernel_file_name"), region ? record.uintAt("region") : 0,
+                         record.uintAt(at("start_line")), record.uintAt(at("end_line")),
+                         region ? stringRef(record, "region_kind") : std::string()};
+    mergedBlock_t& merged = blocks_[key];
+    uint64_t count = record.uintAt(at("count"));
+    merged.duration_ += record.uintAt(at("duration"));
+    if (region)
+        merged.self_duration_ += record.uintAt("region_self_duration");
+    merged.count_ += count;
+    merged.thread_count_ += activeLanes(record.doubleAt(at("branchiness")), count);
+    merged.duration_p50_max_ = std::max(merged.duration_p50_max_, record.uintAt(at("duration_p50")));
+    merged.duration_p90_max_ = std::max(merged.duration_p90_max_, record.uintAt(at("duration_p90")));
+    merged.duration_p99_max_ = std::max(merged.duration_p99_max_, record.uintAt(at("duration_p99")));
+    merged.dispatches_++;
+}
+
+void mergeTable::add(const mergeTable& other)
+{
+    for (const auto& [key, access] : other.accesses_)
+    {
+        mergedAccess_t& merged = accesses_[key];
+        merged.execution_count_ += access.execution_count_;
+        merged.cache_lines_needed_ += access.cache_lines_needed_;
+        merged.cache_lines_used_ += access.cache_lines_used_;
+        merged.bank_conflicts_ += access.bank_conflicts_;
+        merged.dispatches_ += access.dispatches_;
+        merged.estimated_ |= access.estimated_;
+        keepContext(merged.code_context_, access.code_context_);
+    }
+    for (const auto& [key, block] : other.blocks_)
+    {
+        mergedBlock_t& merged = blocks_[key];
+        merged.duration_ += block.duration_;
+        merged.self_duration_ += block.self_duration_;
+        merged.count_ += block.count_;
+        merged.thread_count_ += block.thread_count_;
+        merged.duration_p50_max_ = std::max(merged.duration_p50_max_, block.duration_p50_max_);
+        merged.duration_p90_max_ = std::max(merged.duration_p90_max_, block.duration_p90_max_);
+        merged.duration_p99_max_ = std::max(merged.duration_p99_max_, block.duration_p99_max_);
+        merged.dispatches_ += block.dispatches_;
+    }
+    for (const auto& [name, kernel] : other.kernels_)
+    {
+        mergedKernel_t& merged = kernels_[name];
+        merged.dispatches_.insert(kernel.dispatches_.begin(), kernel.dispatches_.end());
+        if (merged.inputs_.size() < kernel.inputs_.size())
+            merged.inputs_.resize(kernel.inputs_.size(), false);
+        for (size_t i = 0; i < kernel.inputs_.size(); i++)
+            if (kernel.inputs_[i])
+                merged.inputs_[i] = true;
+        merged.messages_dropped_ += kernel.messages_dropped_;
+    }
+    records_ += other.records_;
+    skipped_records_ += other.skipped_records_;
+    malformed_records_ += other.malformed_records_;
+}
+
+resultMerger::resultMerger(const mergeOptions_t& options) : options_(options)
+{
+    if (!options_.chunk_bytes_)
+        options_.chunk_bytes_ = mergeOptions_t().chunk_bytes_;
+}
+
+std::vector<size_t> resultMerger::chunkStarts(const char *data, size_t size, size_t chunk_bytes)
+{
+    std::vector<size_t> starts;
+    if (!size)
+        return starts;
+    starts.push_back(0);
+    size_t pos = chunk_bytes;
+    while (pos < size)
+    {
+        const char *start = nextRecordStart(data + pos, data, data + size);
+        if (start == data + size)
+            break;
+        starts.push_back(start - data);
+        pos = starts.back() + chunk_bytes;
+    }
+    return starts;
+}
+
+void resultMerger::mergeChunk(const char *begin, const char *end, uint32_t input, mergeTable& table)
+{
+    jsonReader reader(begin, end);
+    jsonValue record;
+    while (true)
+    {
+        reader.skipWhitespace();
+        if (reader.atEnd())
+            break;
+        const char *start = reader.position();
+        // Array punctuation between MemoryAnalysis records
+        if (*start == '[' || *start == ',' || *start == ']')
+        {
+            reader.seek(start + 1);
+            continue;
+        }
+        if (*start == '{')
+        {
+            if (reader.read(record))
+            {
+                table.add(record, input);
+                continue;
+            }
+            table.malformed_records_++;
+        }
+        // Anything else is text the handlers wrote around their records; carry on at the next record
+        reader.seek(nextRecordStart(start + 1, begin, end));
+    }
+}
+
+bool resultMerger::merge(const std::vector<std::string>& inputs)
+{
+    std::vector<mappedInput_t> mapped;
+    auto unmapAll = [&]() {
+        for (const auto& input : mapped)
+            if (input.size_)
+                munmap(const_cast<char *>(input.data_), input.size_);
+    };
+    for (const auto& path : inputs)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0)
+        {
+            std::cerr << "omniprobe merge: unable to open " << path << ": " << strerror(errno) << std::endl;
+            if (fd >= 0)
+                close(fd);
+            unmapAll();
+            return false;
+        }
+        mappedInput_t input{nullptr, static_cast<size_t>(st.st_size)};
+        if (input.size_)
+        {
+            void *data = mmap(nullptr, input.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                std::cerr << "omniprobe merge: unable to map " << path << ": " << strerror(errno) << std::endl;
+                close(fd);
+                unmapAll();
+                return false;
+            }
+            madvise(data, input.size_, MADV_SEQUENTIAL);
+            input.data_ = static_cast<const char *>(data);
+        }
+        close(fd);
+        mapped.push_back(input);
+    }
+
+    uint32_t first_input = inputs_.size();
+    std::vector<mergeChunk_t> chunks;
+    for (size_t i = 0; i < mapped.size(); i++)
+    {
+        std::vector<size_t> starts = chunkStarts(mapped[i].data_, mapped[i].size_, options_.chunk_bytes_);
+        for (size_t c = 0; c < starts.size(); c++)
+            chunks.push_back({static_cast<uint32_t>(first_input + i), starts[c],
+                              c + 1 < starts.size() ? starts[c + 1] : mapped[i].size_});
+    }
+    inputs_.insert(inputs_.end(), inputs.begin(), inputs.end());
+
+    size_t threads = options_.threads_ ? options_.threads_ : std::thread::hardware_concurrency();
+    threads = std::max<size_t>(1, std::min(threads, chunks.size()));
+    std::vector<mergeTable> tables(threads);
+    std::atomic<size_t> next(0);
+    auto work = [&](mergeTable& table) {
+        for (size_t c = next.fetch_add(1); c < chunks.size(); c = next.fetch_add(1))
+        {
+            const mergeChunk_t& chunk = chunks[c];
+            const char *data = mapped[chunk.input_ - first_input].data_;
+            mergeChunk(data + chunk.begin_, data + chunk.end_, chunk.input_, table);
+            dropPages(data + chunk.begin_, data + chunk.end_);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++)
+        workers.emplace_back(work, std::ref(tables[t]));
+    work(tables[0]);
+    for (auto& worker : workers)
+        worker.join();
+    for (const auto& table : tables)
+        table_.add(table);
+    unmapAll();
+    return true;
+}
+
+void resultMerger::write(std::ostream& out) const
+{
+    jsonWriter json(out);
+    json.open('{');
+    json.next("merge_info");
+    json.open('{');
+    json.next("inputs");
+    json.open('[');
+    for (const auto& input : inputs_)
+    {
+        json.next();
+        writeJsonString(out, input);
+    }
+    json.close(']');
+    json.field("records", table_.records_);
+    json.field("skipped_records", table_.skipped_records_);
+    json.field("malformed_records", table_.malformed_records_);
+    json.close('}');
+
+    json.next("kernels");
+    json.open('[');
+    auto access = table_.accesses_.begin();
+    auto block = table_.blocks_.begin();
+    for (const auto& [name, kernel] : table_.kernels_)
+    {
+        json.next();
+        json.open('{');
+        json.field("name", name);
+        json.field("processes", static_cast<uint64_t>(std::count(kernel.inputs_.begin(), kernel.inputs_.end(), true)));
+        json.field("dispatches", static_cast<uint64_t>(kernel.dispatches_.size()));
+        if (kernel.messages_dropped_)
+            json.field("messages_dropped", kernel.messages_dropped_);
+
+        // Both maps are ordered by kernel first, so this kernel's entries come next
+        for (mergedAccessKind_t kind : {MERGED_CACHE_LINES, MERGED_BANK_CONFLICTS})
+        {
+            json.next(kind == MERGED_CACHE_LINES ? "cache_analysis" : "bank_conflicts");
+            json.open('{');
+            json.next("accesses");
+            json.open('[');
+            for (; access != table_.accesses_.end() && access->first.kernel_ == name && access->first.kind_ == kind;
+                 ++access)
+            {
+                const mergedAccessKey_t& key = access->first;
+                const mergedAccess_t& merged = access->second;
+                json.next();
+                json.open('{');
+                writeSourceLocation(json, key.file_, key.line_, key.column_);
+                json.field("code_context", merged.code_context_);
+                json.next("access_info");
+                json.open('{');
+                json.field("type", key.type_);
+                json.field("execution_count", merged.execution_count_);
+                json.field("ir_bytes", key.ir_bytes_);
+                if (kind == MERGED_CACHE_LINES)
+                {
+                    json.field("isa_bytes", key.isa_bytes_);
+                    json.field("isa_instruction", key.isa_instruction_);
+                    json.next("cache_lines");
+                    json.open('{');
+                    json.field("needed", merged.cache_lines_needed_);
+                    json.field("used", merged.cache_lines_used_);
+                    json.close('}');
+                }
+                else
+                    json.field("total_conflicts", merged.bank_conflicts_);
+                if (merged.estimated_)
+                    json.field("estimated", true);
+                json.close('}');
+                json.field("dispatches", merged.dispatches_);
+                json.close('}');
+            }
+            json.close(']');
+            json.close('}');
+        }
+
+        for (bool region : {false, true})
+        {
+            json.next(region ? "regions" : "basic_blocks");
+            json.open('[');
+            for (; block != table_.blocks_.end() && block->first.kernel_ == name && block->first.region_ == region;
+                 ++block)
+            {
+                const mergedBlockKey_t& key = block->first;
+                const mergedBlock_t& merged = block->second;
+                json.next();
+                json.open('{');
+                json.field("file", key.file_);
+                if (region)
+                {
+                    json.field("region", key.index_);
+                    json.field("kind", key.region_kind_);
+                }
+                json.field("start_line", key.start_line_);
+                json.field("end_line", key.end_line_);
+                json.field("duration", merged.duration_);
+                if (region)
+                    json.field("self_duration", merged.self_duration_);
+                json.field("count", merged.count_);
+                double lanes = merged.count_ ? static_cast<double>(merged.thread_count_) / (merged.count_ * 64.0) : 1.0;
+                json.field("branchiness", 1.0 - lanes);
+                json.field("duration_p50_max", merged.duration_p50_max_);
+                json.field("duration_p90_max", merged.duration_p90_max_);
+                json.field("duration_p99_max", merged.duration_p99_max_);
+                json.field("dispatches", merged.dispatches_);
+                json.close('}');
+            }
+            json.close(']');
+        }
+        json.close('}');
+    }
+    json.close(']');
+    json.close('}');
+    out << '\n';
+}
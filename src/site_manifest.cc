@@ -0,0 +1,94 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/site_manifest.h"
+#include "inc/code_object_symbols.h"
+
+#include <string.h>
+
+bool siteManifest::parse(const void *data, size_t length)
+{
+    const size_t header_size = 16;
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    sites_.clear();
+    files_.clear();
+    version_ = 0;
+    if (length < header_size || memcmp(bytes, SITE_MANIFEST_MAGIC, 4) != 0)
+        return false;
+    uint16_t version = readLE<uint16_t>(bytes + 4);
+    uint16_t record_size = readLE<uint16_t>(bytes + 6);
+    uint32_t site_count = readLE<uint32_t>(bytes + 8);
+    uint32_t file_count = readLE<uint32_t>(bytes + 12);
+    if (version < SITE_MANIFEST_MIN_VERSION || version > SITE_MANIFEST_VERSION ||
+        record_size < sizeof(siteRecord_t) ||
+        site_count > (length - header_size) / record_size)
+        return false;
+
+    const uint8_t *p = bytes + header_size;
+    sites_.resize(site_count);
+    for (uint32_t i = 0; i < site_count; i++, p += record_size)
+    {
+        siteRecord_t& site = sites_[i];
+        site.file_ = readLE<uint32_t>(p);
+        site.line_ = readLE<uint32_t>(p + 4);
+        site.column_ = readLE<uint32_t>(p + 8);
+        site.addr_space_ = p[12];
+        site.access_kind_ = p[13];
+        site.size_ = readLE<uint16_t>(p + 14);
+    }
+
+    const uint8_t *end = bytes + length;
+    for (uint32_t i = 0; i < file_count; i++)
+    {
+        const uint8_t *nul = static_cast<const uint8_t *>(memchr(p, 0, end - p));
+        if (!nul)
+            break;
+        files_.emplace_back(reinterpret_cast<const char *>(p), nul - p);
+        p = nul + 1;
+    }
+    bool valid = files_.size() == file_count;
+    for (const siteRecord_t& site : sites_)
+        valid = valid && site.file_ < file_count;
+    if (!valid)
+    {
+        sites_.clear();
+        files_.clear();
+    }
+    else
+        version_ = version;
+    return valid;
+}
+
+size_t findSiteManifests(const void *image, size_t length, siteManifestMap_t& manifests)
+{
+    size_t found = 0;
+    forEachCloneSymbol(image, length, SITE_MANIFEST_SUFFIX,
+                       [&](const std::string& clone, const uint8_t *data, size_t size) {
+        if (manifests.count(clone))
+            return;
+        auto manifest = std::make_shared<siteManifest>();
+        if (!manifest->parse(data, size))
+            return;
+        manifests[clone] = manifest;
+        found++;
+    });
+    return found;
+}
@@ -0,0 +1,174 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/synthetic_messages.h"
+#include "inc/timing_region.h"
+
+#include <algorithm>
+
+static const char *pattern_names[SYNTHETIC_PATTERN_COUNT] = {
+    "coalesced", "strided", "gather", "lds-conflict", "time-intervals", "timing-regions"
+};
+
+// Waves per simulated workgroup, i.e. 256 work items of wave64
+#define SYNTHETIC_WAVES_PER_BLOCK 4
+#define SYNTHETIC_BUFFER_BASE 0x7f0000000000ull
+#define SYNTHETIC_GATHER_SPAN (1ull << 30)
+#define SYNTHETIC_FILE_NAME "synthetic_kernel.hip"
+
+const char *syntheticPatternName(syntheticPattern_t pattern)
+{
+    return pattern < SYNTHETIC_PATTERN_COUNT ? pattern_names[pattern] : "unknown";
+}
+
+bool parseSyntheticPattern(const std::string& name, syntheticPattern_t& pattern)
+{
+    for (int i = 0; i < SYNTHETIC_PATTERN_COUNT; i++)
+    {
+        if (name == pattern_names[i])
+        {
+            pattern = static_cast<syntheticPattern_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t nextRandom(uint64_t& state)
+{
+    // xorshift64*, plenty for spreading addresses around
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1dull;
+}
+
+static uint32_t addressUserData(uint32_t rw_kind, uint32_t space, uint32_t size)
+{
+    return (rw_kind & 0x3) | ((space & 0xf) << 2) | ((size & 0xffff) << 6);
+}
+
+void generateSyntheticMessages(syntheticPattern_t pattern, const syntheticConfig_t& config,
+                               const std::function<void(const syntheticMessage_t&)>& emit)
+{
+    uint32_t wave_size = config.wave_size_ > 64 ? 64 : config.wave_size_;
+    uint32_t lanes = config.active_lanes_ > wave_size ? wave_size : config.active_lanes_;
+    uint32_t sites = config.sites_ ? config.sites_ : 1;
+    if (pattern == SYNTHETIC_TIMING_REGIONS)
+        sites = std::min(sites, TIMING_REGION_MAX_REGIONS);
+    uint32_t element_size = config.element_size_ ? config.element_size_ : 4;
+    uint64_t state = config.seed_ ? config.seed_ : 1;
+    uint64_t timestamp = 0;
+
+    syntheticMessage_t message = {};
+    message.exec_ = lanes == 64 ? ~0ull : (1ull << lanes) - 1;
+    message.dwarf_fname_hash_ = std::hash<std::string>{}(SYNTHETIC_FILE_NAME);
+
+    // Timing regions form a binary tree under the kernel region
+    std::vector<uint32_t> region_depth(sites, 0);
+    for (uint32_t r = 1; r < sites; r++)
+        region_depth[r] = std::min<uint32_t>(region_depth[r / 2] + 1, TIMING_REGION_DEPTH_MASK);
+
+    for (size_t wave = 0; wave < config.waves_; wave++)
+    {
+        message.block_idx_x_ = static_cast<uint32_t>(wave / SYNTHETIC_WAVES_PER_BLOCK);
+        message.block_idx_y_ = 0;
+        message.block_idx_z_ = 0;
+        message.wave_num_ = static_cast<uint32_t>(wave % SYNTHETIC_WAVES_PER_BLOCK);
+        for (size_t m = 0; m < config.messages_per_wave_; m++)
+        {
+            uint32_t site = static_cast<uint32_t>(m % sites);
+            uint64_t slot = wave * config.messages_per_wave_ + m;
+            timestamp += 16 + nextRandom(state) % 64;
+            message.timestamp_ = timestamp;
+            message.dwarf_line_ = 10 + site;
+            message.dwarf_column_ = 5;
+            message.items_.clear();
+            switch (pattern)
+            {
+                case SYNTHETIC_COALESCED:
+                {
+                    uint64_t base = SYNTHETIC_BUFFER_BASE + slot * wave_size * element_size;
+                    message.kind_ = SYNTHETIC_ADDRESS_MESSAGE;
+                    message.user_data_ = addressUserData(site % 2 ? 2 : 1, SYNTHETIC_GLOBAL_SPACE, element_size);
+                    for (uint32_t lane = 0; lane < lanes; lane++)
+                        message.items_.push_back(base + lane * element_size);
+                    break;
+                }
+                case SYNTHETIC_STRIDED:
+                {
+                    uint64_t stride = 128ull << (site % 4);
+                    uint64_t base = SYNTHETIC_BUFFER_BASE + slot * wave_size * stride;
+                    message.kind_ = SYNTHETIC_ADDRESS_MESSAGE;
+                    message.user_data_ = addressUserData(1, SYNTHETIC_GLOBAL_SPACE, element_size);
+                    for (uint32_t lane = 0; lane < lanes; lane++)
+                        message.items_.push_back(base + lane * stride);
+                    break;
+                }
+                case SYNTHETIC_GATHER:
+                {
+                    message.kind_ = SYNTHETIC_ADDRESS_MESSAGE;
+                    message.user_data_ = addressUserData(1, SYNTHETIC_GLOBAL_SPACE, element_size);
+                    for (uint32_t lane = 0; lane < lanes; lane++)
+                        message.items_.push_back(SYNTHETIC_BUFFER_BASE +
+                                                 ((nextRandom(state) % SYNTHETIC_GATHER_SPAN) & ~uint64_t(element_size - 1)));
+                    break;
+                }
+                case SYNTHETIC_LDS_CONFLICT:
+                {
+                    // Strides of 2, 4, 8 and 16 elements give 2, 4, 8 and 16-way bank conflicts
+                    uint64_t stride = static_cast<uint64_t>(element_size) << (1 + site % 4);
+                    message.kind_ = SYNTHETIC_ADDRESS_MESSAGE;
+                    message.user_data_ = addressUserData(2, SYNTHETIC_LDS_SPACE, element_size);
+                    for (uint32_t lane = 0; lane < lanes; lane++)
+                        message.items_.push_back(lane * stride);
+                    break;
+                }
+                case SYNTHETIC_TIME_INTERVALS:
+                {
+                    message.kind_ = SYNTHETIC_TIME_INTERVAL_MESSAGE;
+                    message.user_data_ = 0;
+                    message.items_.push_back(timestamp);
+                    message.items_.push_back(timestamp + 100 + nextRandom(state) % 1000);
+                    break;
+                }
+                case SYNTHETIC_TIMING_REGIONS:
+                {
+                    uint32_t parent = site / 2;
+                    message.kind_ = SYNTHETIC_TIME_INTERVAL_MESSAGE;
+                    message.user_data_ = TIMING_REGION_FLAG | site | (parent << TIMING_REGION_PARENT_SHIFT) |
+                                         (region_depth[site] << TIMING_REGION_DEPTH_SHIFT);
+                    // A region's message has its first line in dwarf_line and its last in dwarf_column
+                    message.dwarf_line_ = site ? 10 + site : 1;
+                    message.dwarf_column_ = site ? 20 + site : 100;
+                    message.items_.push_back(timestamp);
+                    message.items_.push_back(timestamp + (site ? 1000 >> region_depth[site] : 4000) +
+                                             nextRandom(state) % 100);
+                    break;
+                }
+                default:
+                    return;
+            }
+            message.item_size_ = message.kind_ == SYNTHETIC_TIME_INTERVAL_MESSAGE ? 16 : 8;
+            emit(message);
+        }
+    }
+}
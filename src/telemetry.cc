@@ -0,0 +1,222 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/telemetry.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+std::atomic<telemetry_shard_t *> telemetrySegment::active_(nullptr);
+std::atomic<uint32_t> telemetrySegment::next_shard_(0);
+
+namespace {
+
+const char *counter_names[TELEMETRY_COUNTER_COUNT] = {
+    "dispatches",
+    "instrumented_dispatches",
+    "completions",
+    "pending_signals",
+    "comms_in_use",
+    "messages",
+    "handler_calls",
+    "code_objects",
+};
+
+const char *histogram_names[TELEMETRY_HISTOGRAM_COUNT] = {
+    "fixup_ns",
+    "completion_lag_ns",
+    "comms_drain_ns",
+    "handler_ns",
+};
+
+size_t headerSize()
+{
+    return (sizeof(telemetry_header_t) + 63) & ~size_t(63);
+}
+
+size_t segmentSize()
+{
+    return headerSize() + TELEMETRY_SHARDS * sizeof(telemetry_shard_t);
+}
+
+void describe(telemetry_descriptor_t& descriptor, const char *name, telemetry_kind_t kind)
+{
+    strncpy(descriptor.name_, name, TELEMETRY_NAME_LENGTH - 1);
+    descriptor.kind_ = kind;
+}
+
+} // namespace
+
+telemetrySegment::telemetrySegment() : base_(nullptr), size_(0), owner_(false), activated_(false)
+{
+}
+
+telemetrySegment::~telemetrySegment()
+{
+    if (owner_)
+        shm_unlink(name_.c_str());
+    // A thread that read active_ just before deactivate() may still be adding to the shards, so the mapping of a
+    // segment that was ever active stays until exit
+    deactivate();
+    if (!activated_)
+        unmap();
+}
+
+std::string telemetrySegment::defaultName()
+{
+    return "/omniprobe." + std::to_string(getpid());
+}
+
+bool telemetrySegment::create(const std::string& name)
+{
+    if (base_)
+        return false;
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST)
+    {
+        // Left behind by an earlier process with the same pid
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0)
+    {
+        std::cerr << "telemetry: unable to create shared memory segment " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    size_t size = segmentSize();
+    if (ftruncate(fd, size) != 0)
+    {
+        std::cerr << "telemetry: unable to size " << name << ": " << strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "telemetry: unable to map " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+    // ftruncate zero fills, so the shards start out at zero
+    telemetry_header_t *header = static_cast<telemetry_header_t *>(base);
+    header->version_ = TELEMETRY_VERSION;
+    header->header_size_ = headerSize();
+    header->shard_count_ = TELEMETRY_SHARDS;
+    header->shard_size_ = sizeof(telemetry_shard_t);
+    header->counter_count_ = TELEMETRY_COUNTER_COUNT;
+    header->histogram_count_ = TELEMETRY_HISTOGRAM_COUNT;
+    header->bucket_count_ = TELEMETRY_BUCKETS;
+    header->pid_ = getpid();
+    header->start_time_ns_ = telemetryNow();
+    for (int i = 0; i < TELEMETRY_COUNTER_COUNT; i++)
+        describe(header->counters_[i], counter_names[i],
+                 i == TELEMETRY_PENDING_SIGNALS || i == TELEMETRY_COMMS_IN_USE ? TELEMETRY_KIND_GAUGE : TELEMETRY_KIND_COUNTER);
+    for (int i = 0; i < TELEMETRY_HISTOGRAM_COUNT; i++)
+        describe(header->histograms_[i], histogram_names[i], TELEMETRY_KIND_HISTOGRAM);
+    // The magic goes in last: readers reject the segment until the header is complete
+    memcpy(header->magic_, TELEMETRY_MAGIC, sizeof(header->magic_));
+    name_ = name;
+    base_ = base;
+    size_ = size;
+    owner_ = true;
+    return true;
+}
+
+bool telemetrySegment::attach(const std::string& name)
+{
+    if (base_)
+        return false;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(telemetry_header_t))
+        base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    const telemetry_header_t *header = static_cast<const telemetry_header_t *>(base);
+    if (memcmp(header->magic_, TELEMETRY_MAGIC, sizeof(header->magic_)) != 0 || header->version_ != TELEMETRY_VERSION ||
+        header->header_size_ != headerSize() || header->shard_size_ != sizeof(telemetry_shard_t) ||
+        header->shard_count_ != TELEMETRY_SHARDS || static_cast<size_t>(st.st_size) < segmentSize())
+    {
+        munmap(base, st.st_size);
+        return false;
+    }
+    name_ = name;
+    base_ = base;
+    size_ = st.st_size;
+    return true;
+}
+
+void telemetrySegment::activate()
+{
+    if (!base_ || !owner_)
+        return;
+    activated_ = true;
+    active_.store(reinterpret_cast<telemetry_shard_t *>(static_cast<char *>(base_) + headerSize()), std::memory_order_release);
+}
+
+void telemetrySegment::deactivate()
+{
+    if (!base_)
+        return;
+    telemetry_shard_t *expected = reinterpret_cast<telemetry_shard_t *>(static_cast<char *>(base_) + headerSize());
+    active_.compare_exchange_strong(expected, nullptr);
+}
+
+bool telemetrySegment::snapshot(telemetry_snapshot_t& snapshot) const
+{
+    if (!base_)
+        return false;
+    memset(&snapshot, 0, sizeof(snapshot));
+    const telemetry_shard_t *shards = reinterpret_cast<const telemetry_shard_t *>(static_cast<const char *>(base_) + headerSize());
+    for (int s = 0; s < TELEMETRY_SHARDS; s++)
+    {
+        const telemetry_shard_t& shard = shards[s];
+        for (int i = 0; i < TELEMETRY_COUNTER_COUNT; i++)
+            snapshot.counters_[i] += shard.counters_[i].load(std::memory_order_relaxed);
+        for (int i = 0; i < TELEMETRY_HISTOGRAM_COUNT; i++)
+        {
+            snapshot.histograms_[i].count_ += shard.histograms_[i].count_.load(std::memory_order_relaxed);
+            snapshot.histograms_[i].sum_ += shard.histograms_[i].sum_.load(std::memory_order_relaxed);
+            for (int b = 0; b < TELEMETRY_BUCKETS; b++)
+                snapshot.histograms_[i].buckets_[b] += shard.histograms_[i].buckets_[b].load(std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+void telemetrySegment::unmap()
+{
+    if (base_)
+        munmap(base_, size_);
+    base_ = nullptr;
+    size_ = 0;
+}
@@ -171,7 +171,7 @@ coCache::coCache(HsaApiTable *apiTable)
 
 coCache::~coCache()
 {
-    lock_guard<std::mutex> lock(mutex);
+    lock_guard<std::mutex> lock(mutex_);
     for(auto it : cache_objects_)
     {
         CHECK_STATUS("Unable to destroy loaded code objects", apiTable_->core_->hsa_executable_destroy_fn(it.second.executable_));
@@ -198,7 +198,7 @@ uint8_t coCache::getArgumentAlignment(uint64_t kernel_object)
 
 bool coCache::hasKernels(hsa_agent_t agent)
 {
-    lock_guard<std::mutex> lock(mutex);
+    lock_guard<std::mutex> lock(mutex_);
     return lookup_map_.find(agent) != lookup_map_.end();
 
 }
@@ -206,18 +206,19 @@ bool coCache::hasKernels(hsa_agent_t agent)
 void coCache::registerRuntimeKernel(const std::string& name, hsa_executable_symbol_t symbol,
                                     uint64_t kernel_object, hsa_agent_t agent, uint32_t kernarg_size)
 {
+    kernel_name_id_t id = kernelNames().intern(name);
     lock_guard<std::mutex> lock(mutex_);
     // Add to lookup_map_ so findAlternative() can find this kernel by name
     auto it = lookup_map_.find(agent);
     if (it != lookup_map_.end()) {
-        if (it->second.find(name) != it->second.end())
+        if (it->second.find(id) != it->second.end())
             return;  // Already registered
-        it->second[name] = symbol;
+        it->second[id] = symbol;
     } else {
-        lookup_map_[agent] = {{name, symbol}};
+        lookup_map_[agent] = {{id, symbol}};
     }
     kernarg_sizes_[kernel_object] = kernarg_size;
-    runtime_kernel_objects_[agent][name] = kernel_object;
+    runtime_kernel_objects_[agent][id] = kernel_object;
 }
 
 bool coCache::isKernelFromExcludedFile(uint64_t kernel_object, const LibraryFilter& filter)
@@ -404,7 +405,7 @@ bool coCache::resolveRuntimeArgDescriptors(hsa_agent_t agent)
                                 am_it->second.find(kname) != am_it->second.end())
                                 continue;
                             arg_descriptor_t desc;
-                            if (kah.getArgDescriptor(kname, desc)) {
+                            if (kah.getArgDescriptor(std::string(kernelNames().name(kname)), desc)) {
                                 d->self->arg_map_[d->agent][kname] = desc;
                             }
                         }
@@ -419,28 +420,27 @@ bool coCache::resolveRuntimeArgDescriptors(hsa_agent_t agent)
 
 bool coCache::getArgDescriptor(hsa_agent_t agent, std::string& name, arg_descriptor_t& desc, bool instrumented)
 {
-    // First attempt: look up in arg_map_ (populated by addFile or resolveRuntimeArgDescriptors)
-    {
+    // Names that were never interned can't be in arg_map_
+    kernel_name_id_t id = kernelNames().find(name);
+    kernel_name_id_t lookup_id = instrumented ? kernelNames().find(getInstrumentedName(name)) : id;
+    if (lookup_id == KERNEL_NAME_INVALID)
+        return false;
+    auto lookup = [&]() {
         std::lock_guard<std::mutex> lock(mutex_);
         auto it = arg_map_.find(agent);
         size_t clone_hidden_args_length = 0;
         if (it != arg_map_.end())
         {
-            std::string strName;
             if (instrumented)
             {
-                auto itclone = it->second.find(name);
+                auto itclone = it->second.find(id);
                 if (itclone != it->second.end())
                 {
                     if (itclone->second.hidden_args_length)
                         clone_hidden_args_length = itclone->second.kernarg_length - itclone->second.explicit_args_length;
                 }
-
-                strName = getInstrumentedName(name);
             }
-            else
-                strName = name;
-            auto dit = it->second.find(strName);
+            auto dit = it->second.find(lookup_id);
             if (dit != it->second.end())
             {
                 desc = dit->second;
@@ -448,49 +448,27 @@ bool coCache::getArgDescriptor(hsa_agent_t agent, std::string& name, arg_descrip
                 return true;
             }
         }
-    }
+        return false;
+    };
 
+    // First attempt: look up in arg_map_ (populated by addFile or resolveRuntimeArgDescriptors)
+    if (lookup())
+        return true;
     // Second attempt: resolve arg descriptors from runtime-loaded code objects via
     // the AMD loader API, then retry the lookup
-    if (resolveRuntimeArgDescriptors(agent))
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = arg_map_.find(agent);
-        size_t clone_hidden_args_length = 0;
-        if (it != arg_map_.end())
-        {
-            std::string strName;
-            if (instrumented)
-            {
-                auto itclone = it->second.find(name);
-                if (itclone != it->second.end())
-                {
-                    if (itclone->second.hidden_args_length)
-                        clone_hidden_args_length = itclone->second.kernarg_length - itclone->second.explicit_args_length;
-                }
-                strName = getInstrumentedName(name);
-            }
-            else
-                strName = name;
-            auto dit = it->second.find(strName);
-            if (dit != it->second.end())
-            {
-                desc = dit->second;
-                desc.clone_hidden_args_length = clone_hidden_args_length;
-                return true;
-            }
-        }
-    }
-    return false;
+    return resolveRuntimeArgDescriptors(agent) && lookup();
 }
 
 bool coCache::getCodeObjectRef(hsa_agent_t agent, const std::string& name, CodeObjectRef& ref)
 {
+    kernel_name_id_t id = kernelNames().find(name);
+    if (id == KERNEL_NAME_INVALID)
+        return false;
     lock_guard<std::mutex> lock(mutex_);
     auto it = kernel_co_map_.find(agent);
     if (it != kernel_co_map_.end())
     {
-        auto it2 = it->second.find(name);
+        auto it2 = it->second.find(id);
         if (it2 != it->second.end())
         {
             ref = it2->second;
@@ -502,8 +480,23 @@ bool coCache::getCodeObjectRef(hsa_agent_t agent, const std::string& name, CodeO
 
 bool coCache::addFile(const std::string& name, hsa_agent_t agent, const std::string& strFilter)
 {
-    bool bResult = false;
+    coCacheBatch_t batch;
+    if (!loadFile(name, agent, strFilter, batch))
+        return false;
+    publish(batch);
+    return true;
+}
+
+/*
+    Loads every code object in a file onto an agent and collects its kernels into batch. Only touches the HSA
+    loader and the batch, never the cache's own maps, so it runs without mutex_ and several files can be loaded at
+    once. Nothing is visible to lookups until the batch is published.
+*/
+bool coCache::loadFile(const std::string& name, hsa_agent_t agent, const std::string& strFilter, coCacheBatch_t& batch)
+{
     hsa_status_t status;
+    batch.agent_ = agent;
+    batch.source_ = name;
 
     // Extract code objects — returns temp .hsaco file paths for fat binaries,
     // or {name} for .hsaco files. Uses kernelDB's extractCodeObjects() to avoid
@@ -512,6 +505,23 @@ bool coCache::addFile(const std::string& name, hsa_agent_t agent, const std::str
     if (code_object_files.empty())
         return false;
 
+    // If a kernel filter was supplied, only kernels whose demangled name matches it are cached, because we
+    // don't want to run instrumented for kernels whose names don't match on the filter
+    std::regex filter_regex;
+    if (strFilter.size())
+    {
+        try
+        {
+            filter_regex.assign(strFilter, std::regex_constants::ECMAScript);
+        }
+        catch(const std::regex_error& error)
+        {
+            std::cout << "ERROR: There is a problem with your kernel filter (\"" << strFilter << "\"):\n";
+            std::cout << "\t" << error.what() << std::endl;
+            abort();
+        }
+    }
+
     // Create and load an HSA executable for each code object
     std::vector<hsa_executable_t> executables;
     std::vector<KernelArgHelper *> arg_helpers;
@@ -567,7 +577,6 @@ bool coCache::addFile(const std::string& name, hsa_agent_t agent, const std::str
         CHECK_STATUS("Error in freezing executable object", status);
 
         // Get symbol handle.
-        hsa_executable_symbol_t kernelSymbol;
         std::vector<hsa_executable_symbol_t> symbols;
         status = apiTable_->core_->hsa_executable_iterate_symbols_fn(executable, [](hsa_executable_t exec, hsa_executable_symbol_t symbol, void *data){
             std::vector<hsa_executable_symbol_t> *syms = reinterpret_cast<std::vector<hsa_executable_symbol_t> *>(data);
@@ -581,85 +590,56 @@ bool coCache::addFile(const std::string& name, hsa_agent_t agent, const std::str
             CHECK_STATUS("Unable to get valid symbol info", apiTable_->core_->hsa_executable_symbol_get_info_fn(sym,HSA_EXECUTABLE_SYMBOL_INFO_TYPE,&kind));
             if (kind == HSA_SYMBOL_KIND_KERNEL)
             {
-                {
-                    lock_guard<std::mutex> lock(mutex_);
-                    auto it = kernels_.find(agent);
-                    if (it != kernels_.end())
-                        it->second.push_back(sym);
-                    else
-                        kernels_[agent].push_back(sym);
-                }
-
-                uint64_t kernel_object;
+                batch.kernels_.push_back(sym);
 
-                CHECK_STATUS("Can't retrieve a kernel object from a valid symbol", apiTable_->core_->hsa_executable_symbol_get_info_fn(sym, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT, reinterpret_cast<void *>(&kernel_object)));
                 uint32_t length;
                 CHECK_STATUS("Can't retrieve the length of kernel name from a valid symbol",
                     apiTable_->core_->hsa_executable_symbol_get_info_fn(sym, HSA_EXECUTABLE_SYMBOL_INFO_NAME_LENGTH,&length));
-                char *sym_name = reinterpret_cast<char *>(malloc(length + 1));
-                if (sym_name)
-                {
-                    sym_name[length] = '\0';
-                    CHECK_STATUS("Can't retrieve name from valid symbol", apiTable_->core_->hsa_executable_symbol_get_info_fn(sym, HSA_EXECUTABLE_SYMBOL_INFO_NAME, sym_name));
-                    std::string mangledName(sym_name);
-
-                    string strName = kernelDB::demangleName(sym_name);
-                    // If a kernel filter was supplied, match the demangled name to the filter. If there's no match,
-                    // skip this symbol because we don't want to run instrumented for kernels whose names don't
-                    // match on the filter
-                    if (strFilter.size())
-                    {
-                        try
-                        {
-                            std::regex filter_regex(strFilter, std::regex_constants::ECMAScript);
-                            if (!std::regex_search(strName, filter_regex))
-                                continue;
-                        }
-                        catch(const std::regex_error& error)
-                        {
-                            std::cout << "ERROR: There is a problem with your kernel filter (\"" << strFilter << "\"):\n";
-                            std::cout << "\t" << error.what() << std::endl;
-                            abort();
-                        }
-                    }
-                    arg_descriptor_t desc;
-                    if (p_kh->getArgDescriptor(strName, desc))
-                    {
-                       lock_guard<std::mutex> lock(mutex_);
-                       auto itMap = arg_map_.find(agent);
-                       if (itMap != arg_map_.end())
-                           itMap->second[strName] = desc;
-                       else
-                            arg_map_[agent] = {{strName, desc}};
-                    }
-                    else
-                        std::cerr << "Unable to find arg descriptor for " << strName << std::endl;
-                    free(reinterpret_cast<void *>(sym_name));
-                    {
-                        lock_guard<std::mutex> lock(mutex_);
-                        auto it = lookup_map_.find(agent);
-                        if (it != lookup_map_.end())
-                            it->second[strName] = sym;
-                        else
-                            lookup_map_[agent] = {{strName,sym}};
-                        kernel_co_map_[agent][strName] = {name, loaded_co_files[exec_idx], mangledName};
-                    }
-                }
+                std::string mangledName(length, '\0');
+                CHECK_STATUS("Can't retrieve name from valid symbol", apiTable_->core_->hsa_executable_symbol_get_info_fn(sym, HSA_EXECUTABLE_SYMBOL_INFO_NAME, mangledName.data()));
+
+                string strName = kernelDB::demangleName(mangledName.c_str());
+                if (strFilter.size() && !std::regex_search(strName, filter_regex))
+                    continue;
+                kernel_name_id_t id = kernelNames().intern(strName);
+                arg_descriptor_t desc;
+                if (p_kh->getArgDescriptor(strName, desc))
+                    batch.args_[id] = desc;
+                else
+                    std::cerr << "Unable to find arg descriptor for " << strName << std::endl;
+                batch.symbols_[id] = sym;
+                batch.refs_[id] = {name, loaded_co_files[exec_idx], mangledName};
             }
         }
-
-        // TODO: cache_objects_[agent] currently stores only one executable per agent.
-        // With multiple code objects in fat binaries, this will overwrite previous executables.
-        // Consider changing cache_objects_ to support multiple executables per agent.
-        {
-            lock_guard<std::mutex> lock(mutex_);
-            cache_objects_[agent] = {executable, name, std::chrono::system_clock::now()};
-        }
+        batch.executables_.push_back(executable);
 
         delete p_kh;
     }
 
-    return bResult;
+    return !batch.executables_.empty();
+}
+
+/*
+    Makes everything loadFile collected visible at once: a lookup either sees none of the batch's kernels or all
+    of them along with their arg descriptors and code object references.
+*/
+void coCache::publish(coCacheBatch_t& batch)
+{
+    hsa_agent_t agent = batch.agent_;
+    lock_guard<std::mutex> lock(mutex_);
+    auto& kernels = kernels_[agent];
+    kernels.insert(kernels.end(), batch.kernels_.begin(), batch.kernels_.end());
+    for (auto& it : batch.args_)
+        arg_map_[agent][it.first] = it.second;
+    for (auto& it : batch.symbols_)
+        lookup_map_[agent][it.first] = it.second;
+    for (auto& it : batch.refs_)
+        kernel_co_map_[agent][it.first] = it.second;
+    // TODO: cache_objects_[agent] currently stores only one executable per agent.
+    // With multiple code objects in fat binaries, this will overwrite previous executables.
+    // Consider changing cache_objects_ to support multiple executables per agent.
+    for (auto executable : batch.executables_)
+        cache_objects_[agent] = {executable, batch.source_, std::chrono::system_clock::now()};
 }
 
 bool coCache::setLocation(hsa_agent_t agent, const std::string& directory, const std::string& strFilter, bool instrumented)
@@ -712,11 +692,14 @@ uint64_t coCache::findAlternative(hsa_executable_symbol_t symbol, const std::str
     CHECK_STATUS("Unable to get kernarg size", hsa_executable_symbol_get_info_fn(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_KERNARG_SEGMENT_SIZE, reinterpret_cast<void *>(&kernarg_size)));
     if (queue_agent.handle && agent.handle != queue_agent.handle)
         std::cout << "Something is amiss in findAlternative\n";
+    kernel_name_id_t id = kernelNames().find(name);
+    if (id == KERNEL_NAME_INVALID)
+        return 0;
     lock_guard<std::mutex> lock(mutex_);
     auto it = lookup_map_.find(agent);
     if (it != lookup_map_.end())
     {
-        auto kern_it = it->second.find(name);
+        auto kern_it = it->second.find(id);
         if (kern_it != it->second.end())
         {
             uint32_t alt_kernarg_size;
@@ -737,7 +720,7 @@ uint64_t coCache::findInstrumentedAlternative(hsa_executable_symbol_t symbol, co
 {
     uint64_t result = 0;
     {
-        lock_guard<std::mutex> lock(mutex);
+        lock_guard<std::mutex> lock(mutex_);
         auto it = alternatives_.find(queue_agent);
         if (it != alternatives_.end())
         {
@@ -755,7 +738,7 @@ uint64_t coCache::findInstrumentedAlternative(hsa_executable_symbol_t symbol, co
         result = findAlternative(symbol, getInstrumentedName(std::string(name)), queue_agent);
         if (result)
         {
-            lock_guard<std::mutex> lock(mutex);
+            lock_guard<std::mutex> lock(mutex_);
             alternatives_[queue_agent][symbol] = result;
         }
     }
@@ -773,6 +756,9 @@ unsigned int getLogDurConfig(std::map<std::string, std::string>& config) {
     const char* logDurKernelFilter = std::getenv("LOGDUR_FILTER");
     const char* logDurDispatches = std::getenv("LOGDUR_DISPATCHES");
     const char* logDurLibraryFilter = std::getenv("LOGDUR_LIBRARY_FILTER");
+    const char* logDurDurationMode = std::getenv("LOGDUR_DURATION_MODE");
+    const char* logDurRecordMessages = std::getenv("LOGDUR_RECORD_MESSAGES");
+    const char* logDurTelemetry = std::getenv("LOGDUR_TELEMETRY");
 
     config["LOGDUR_LOG_LOCATION"] = logDurLogLocation ? logDurLogLocation : "console";
 
@@ -801,69 +787,15 @@ unsigned int getLogDurConfig(std::map<std::string, std::string>& config) {
 
     config["LOGDUR_LIBRARY_FILTER"] = logDurLibraryFilter ? logDurLibraryFilter : "";
 
-    return config.size();
-}
-
-logDuration::logDuration()
-{
-    location_ = "console";
-    if (location_ == "console")
-        log_file_ = &cout;
-    else
-        log_file_ = new std::ofstream(location_, std::ios::app);
-    //(*log_file_) << "kernel,dispatch,startNs,endNs" << std::endl;
-}
-
-logDuration::logDuration(std::string& location)
-{
-    location_ = location;
-    if (location == "console")
-        log_file_ = &cout;
-    else
-        log_file_ = new std::ofstream(location, std::ios::app);
-    //*log_file_ << "kernel,dispatch,startNs,endNs" << std::endl;
-}
+    config["LOGDUR_DURATION_MODE"] = logDurDurationMode ? logDurDurationMode : "lines";
 
-logDuration::~logDuration()
-{
-    if (location_ != "console")
-    {
-        delete log_file_;
-    }
-}
-
-void logDuration::log(std::string& kernelName, uint64_t dispatchTime, uint64_t startNs, uint64_t endNs)
-{
-    if (log_file_)
-        *log_file_ << "\"" << kernelName << "\"," << std::dec << dispatchTime << "," << startNs << "," << endNs << std::endl;
-    else
-        cerr << "Can't find anyplace to log\n";
-}
+    config["LOGDUR_RECORD_MESSAGES"] = logDurRecordMessages ? logDurRecordMessages : "";
 
-void logDuration::logHeaders()
-{
-    if (log_file_)
-        *log_file_ << "kernel,dispatch,startNs,endNs" << std::endl;
-    else
-        std::cerr << "Unable to log headers - not log location set\n";
-}
+    std::string telemetry = logDurTelemetry ? logDurTelemetry : "";
+    std::transform(telemetry.begin(), telemetry.end(), telemetry.begin(), [](unsigned char c){ return std::tolower(c); });
+    config["LOGDUR_TELEMETRY"] = telemetry == "true" || telemetry == "1" ? "true" : "false";
 
-bool logDuration::setLocation(const std::string& strLocation)
-{
-    if (location_ != "console")
-    {
-        if (log_file_)
-            delete log_file_;
-    }
-    //cerr << "logDuration::setLocation = " << strLocation << std::endl;
-    location_ = strLocation;
-    if (!location_.length())
-        location_ = "/dev/null";
-    if (location_ == "console")
-        log_file_ = &cout;
-    else
-        log_file_ = new std::ofstream(location_, std::ios::app);
-    return log_file_ != NULL;
+    return config.size();
 }
 
 void clipKernelName(std::string& str)
@@ -988,6 +920,9 @@ KernelArgHelper::KernelArgHelper(const std::string file_name)
     {
         std::string strIndent("");
         std::map<std::string, arg_descriptor_t> parms;
+        findDualPathMarkers(executable);
+        findSiteManifests(buff.data(), buff.size(), site_manifests_);
+        findDeviceHeatmaps(buff.data(), buff.size(), device_heatmaps_);
         computeKernargData(metadata);
     }
     CHECK_COMGR(amd_comgr_release_data(executable));
@@ -1015,6 +950,9 @@ void KernelArgHelper::addCodeObject(const char *bits, size_t length)
     {
         std::string strIndent("");
         std::map<std::string, arg_descriptor_t> parms;
+        findDualPathMarkers(executable);
+        findSiteManifests(bits, length, site_manifests_);
+        findDeviceHeatmaps(bits, length, device_heatmaps_);
         computeKernargData(metadata);
     }
     CHECK_COMGR(amd_comgr_release_data(executable));
@@ -1037,6 +975,26 @@ void KernelArgHelper::getSharedLibraries(std::vector<std::string>& libraries) {
     }, &libraries);
     return;
 }
+/* Collect the kernel symbols that have a DUAL_PATH_MARKER_SUFFIX marker next to them; computeKernargData
+ * flags their arg descriptors so the interceptor knows it can dispatch them with a null dh_comms pointer. */
+void KernelArgHelper::findDualPathMarkers(amd_comgr_data_t executable)
+{
+    CHECK_COMGR(amd_comgr_iterate_symbols(executable, [](amd_comgr_symbol_t symbol, void *data) -> amd_comgr_status_t {
+        auto *kernels = static_cast<std::set<std::string> *>(data);
+        uint64_t length = 0;
+        if (amd_comgr_symbol_get_info(symbol, AMD_COMGR_SYMBOL_INFO_NAME_LENGTH, &length) != AMD_COMGR_STATUS_SUCCESS)
+            return AMD_COMGR_STATUS_SUCCESS;
+        std::vector<char> name(length + 1);
+        if (amd_comgr_symbol_get_info(symbol, AMD_COMGR_SYMBOL_INFO_NAME, name.data()) != AMD_COMGR_STATUS_SUCCESS)
+            return AMD_COMGR_STATUS_SUCCESS;
+        std::string strName(name.data(), length);
+        const std::string suffix(DUAL_PATH_MARKER_SUFFIX);
+        if (strName.size() > suffix.size() && strName.compare(strName.size() - suffix.size(), suffix.size(), suffix) == 0)
+            kernels->insert(strName.substr(0, strName.size() - suffix.size()));
+        return AMD_COMGR_STATUS_SUCCESS;
+    }, &dual_path_kernels_));
+}
+
 std::string KernelArgHelper::get_metadata_string(amd_comgr_metadata_node_t node)
 {
     std::string strValue;
@@ -1083,8 +1041,17 @@ void KernelArgHelper::computeKernargData(amd_comgr_metadata_node_t exec_map)
             amd_comgr_metadata_node_t field;
             CHECK_COMGR(amd_comgr_metadata_lookup(value,".symbol", &field));
             std::string strName = get_metadata_string(field);
-            strName = kernelDB::demangleName(strName.c_str());
             arg_descriptor_t desc = {};
+            // .symbol is the kernel descriptor, <kernel>.kd
+            std::string strKernel = strName.substr(0, strName.rfind(".kd"));
+            desc.dual_path = dual_path_kernels_.count(strKernel) != 0;
+            auto sites = site_manifests_.find(strKernel);
+            if (sites != site_manifests_.end())
+                desc.sites = sites->second;
+            auto heatmap = device_heatmaps_.find(strKernel);
+            if (heatmap != device_heatmaps_.end())
+                desc.heatmap = heatmap->second;
+            strName = kernelDB::demangleName(strName.c_str());
             amd_comgr_metadata_node_t args;
             CHECK_COMGR(amd_comgr_metadata_lookup(value, ".args", &args));
             CHECK_COMGR(amd_comgr_get_metadata_kind(args, &kind));
@@ -0,0 +1,127 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/wave_encoding.h"
+
+namespace {
+
+uint32_t firstLane(uint64_t mask)
+{
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+}
+
+} // namespace
+
+bool decodeWaveAddresses(uint32_t dwarf_column, const uint64_t *items, size_t count, uint64_t& exec,
+                         std::vector<uint64_t>& addresses)
+{
+    addresses.clear();
+    if (count == 0 || items[0] == 0)
+        return false;
+    exec = items[0];
+    switch (waveEncoding(dwarf_column))
+    {
+    case WAVE_ENCODING_AFFINE:
+    {
+        if (count != WAVE_AFFINE_ITEMS)
+            return false;
+        uint64_t base = items[1];
+        uint64_t stride = items[2];
+        uint32_t first = firstLane(exec);
+        for (uint64_t lanes = exec; lanes; lanes &= lanes - 1)
+            addresses.push_back(base + stride * (firstLane(lanes) - first));
+        return true;
+    }
+    case WAVE_ENCODING_DICTIONARY:
+    {
+        if (count <= WAVE_DICTIONARY_HEADER_ITEMS || count > WAVE_DICTIONARY_HEADER_ITEMS + WAVE_DICTIONARY_SIZE)
+            return false;
+        const uint64_t *values = items + WAVE_DICTIONARY_HEADER_ITEMS;
+        size_t value_count = count - WAVE_DICTIONARY_HEADER_ITEMS;
+        for (uint64_t lanes = exec; lanes; lanes &= lanes - 1)
+        {
+            uint64_t lane_bit = lanes & -lanes;
+            size_t idx = ((items[1] & lane_bit) ? 1 : 0) | ((items[2] & lane_bit) ? 2 : 0);
+            if (idx >= value_count)
+            {
+                addresses.clear();
+                return false;
+            }
+            addresses.push_back(values[idx]);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+uint32_t encodeWaveAddresses(uint32_t dwarf_column, uint64_t exec, const std::vector<uint64_t>& addresses,
+                             std::vector<uint64_t>& items)
+{
+    items = addresses;
+    if (exec == 0 || dwarf_column > WAVE_ENCODING_COLUMN_MASK)
+        return dwarf_column;
+
+    // Affine: the stride is taken from the first two active lanes, then checked against all of them
+    uint32_t first = firstLane(exec);
+    uint64_t rest = exec & (exec - 1);
+    uint64_t stride = 0;
+    if (rest)
+    {
+        int64_t gap = firstLane(rest) - first;
+        stride = static_cast<uint64_t>(static_cast<int64_t>(addresses[1] - addresses[0]) / gap);
+    }
+    bool affine = true;
+    size_t i = 0;
+    for (uint64_t lanes = exec; lanes; lanes &= lanes - 1, i++)
+        affine = affine && addresses[i] == addresses[0] + stride * (firstLane(lanes) - first);
+    if (affine && addresses.size() > WAVE_AFFINE_ITEMS)
+    {
+        items = {exec, addresses[0], stride};
+        return dwarf_column | WAVE_ENCODING_COLUMN_FLAG | (WAVE_ENCODING_AFFINE << WAVE_ENCODING_SHIFT);
+    }
+
+    // Dictionary: distinct values in the order of the first lane that has them
+    std::vector<uint64_t> values;
+    uint64_t planes[2] = {0, 0};
+    i = 0;
+    for (uint64_t lanes = exec; lanes; lanes &= lanes - 1, i++)
+    {
+        size_t idx = 0;
+        while (idx < values.size() && values[idx] != addresses[i])
+            idx++;
+        if (idx == values.size())
+        {
+            if (values.size() == WAVE_DICTIONARY_SIZE)
+                return dwarf_column;
+            values.push_back(addresses[i]);
+        }
+        uint64_t lane_bit = lanes & -lanes;
+        planes[0] |= (idx & 1) ? lane_bit : 0;
+        planes[1] |= (idx & 2) ? lane_bit : 0;
+    }
+    if (addresses.size() <= WAVE_DICTIONARY_HEADER_ITEMS + values.size())
+        return dwarf_column;
+    items = {exec, planes[0], planes[1]};
+    items.insert(items.end(), values.begin(), values.end());
+    return dwarf_column | WAVE_ENCODING_COLUMN_FLAG | (WAVE_ENCODING_DICTIONARY << WAVE_ENCODING_SHIFT);
+}
@@ -0,0 +1,239 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Throughput of basic_block_analysis' per-message bookkeeping on a synthetic basic block interval
+ * stream, with the previous data structures (std::map keyed by a padded wave identifier compared with
+ * memcmp, block state in maps keyed by basicBlock *, a std::set of blocks seen, and a string compare
+ * per message to detect s_endpgm) against the current ones (waveStateTable plus flat per-block arrays
+ * indexed by block number).
+ *
+ * The handler itself needs dh_comms and kernelDB, so this reproduces just the bookkeeping it does per
+ * message. Usage: bb_interval_bench [waves] [blocks] [iterations] */
+#include "inc/wave_state_table.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef struct {
+    uint64_t wave_;       // Index into the list of waves
+    uint32_t block_;
+    uint64_t timestamp_;
+    uint64_t exec_;
+}synthetic_message_t;
+
+typedef struct {
+    uint64_t thread_count_;
+    uint64_t count_;
+    uint64_t duration_;
+}block_info_t;
+
+// Stand-in for kernelDB::basicBlock
+struct fakeBlock {
+    std::vector<std::string> instructions_;
+    std::vector<fakeBlock *> instruction_blocks_;
+};
+
+// Waves run a loop over the blocks for some iterations then hit the final s_endpgm block. Messages
+// from waves that are resident at the same time are interleaved, the way they arrive from the device.
+std::vector<synthetic_message_t> makeStream(uint64_t waves, uint32_t blocks, uint32_t iterations)
+{
+    const uint64_t resident = 256;
+    std::vector<synthetic_message_t> stream;
+    uint64_t timestamp = 0;
+    for (uint64_t first = 0; first < waves; first += resident)
+    {
+        uint64_t last = std::min(waves, first + resident);
+        for (uint32_t it = 0; it < iterations; it++)
+            for (uint32_t b = 0; b + 1 < blocks; b++)
+                for (uint64_t w = first; w < last; w++)
+                    stream.push_back({w, b, timestamp++, w & 1 ? ~0ull : 0xffffffffull});
+        for (uint64_t w = first; w < last; w++)
+            stream.push_back({w, blocks - 1, timestamp++, ~0ull});
+    }
+    return stream;
+}
+
+uint32_t popcount(uint64_t v)
+{
+    return static_cast<uint32_t>(__builtin_popcountll(v));
+}
+
+typedef struct {
+    uint32_t block_x_;
+    uint32_t block_y_;
+    uint32_t block_z_;
+    uint8_t wave_id_;
+}padded_wave_t;
+
+struct memcmpLess
+{
+    bool operator()(const padded_wave_t& a, const padded_wave_t& b) const
+    {
+        return memcmp(&a, &b, sizeof(padded_wave_t)) < 0;
+    }
+};
+
+typedef struct {
+    fakeBlock *current_block_;
+    uint64_t start_time_;
+    uint64_t count_;
+}map_wave_state_t;
+
+typedef struct {
+    uint32_t current_block_;
+    uint64_t start_time_;
+    uint64_t count_;
+}flat_wave_state_t;
+
+uint64_t runMaps(const std::vector<synthetic_message_t>& stream, std::vector<std::unique_ptr<fakeBlock>>& blocks)
+{
+    std::map<padded_wave_t, map_wave_state_t, memcmpLess> wave_states;
+    std::map<fakeBlock *, block_info_t> block_info;
+    std::set<fakeBlock *> blocks_seen;
+    for (const auto& msg : stream)
+    {
+        padded_wave_t wave;
+        wave.block_x_ = static_cast<uint32_t>(msg.wave_ / 4);
+        wave.block_y_ = 0;
+        wave.block_z_ = 0;
+        wave.wave_id_ = static_cast<uint8_t>(msg.wave_ % 4);
+        fakeBlock *block = blocks[msg.block_].get();
+        for (auto *b : block->instruction_blocks_)
+            blocks_seen.insert(b);
+        auto wsit = wave_states.find(wave);
+        if (wsit != wave_states.end())
+        {
+            auto biit = block_info.find(wsit->second.current_block_);
+            uint64_t elapsed = msg.timestamp_ - wsit->second.start_time_;
+            if (biit != block_info.end())
+            {
+                biit->second.count_ += wsit->second.count_;
+                biit->second.thread_count_ += popcount(msg.exec_);
+                biit->second.duration_ += elapsed;
+            }
+            else
+                block_info[wsit->second.current_block_] = {popcount(msg.exec_), 1, elapsed};
+            if (block->instructions_[block->instructions_.size() - 1] == "s_endpgm")
+                wave_states.erase(wsit);
+            else
+                wsit->second = {block, msg.timestamp_, 1};
+        }
+        else
+            wave_states[wave] = {block, msg.timestamp_, 1};
+    }
+    uint64_t total = 0;
+    for (auto& it : block_info)
+        total += it.second.count_;
+    return total;
+}
+
+uint64_t runFlat(const std::vector<synthetic_message_t>& stream, std::vector<std::unique_ptr<fakeBlock>>& blocks)
+{
+    // What loadBlocks() precomputes
+    std::vector<uint8_t> ends_program(blocks.size());
+    for (size_t i = 0; i < blocks.size(); i++)
+        ends_program[i] = blocks[i]->instructions_.back() == "s_endpgm";
+    std::vector<block_info_t> block_info(blocks.size(), block_info_t{});
+    waveStateTable<flat_wave_state_t> wave_states;
+    for (const auto& msg : stream)
+    {
+        waveIdentifier_t wave = {static_cast<uint32_t>(msg.wave_ / 4), 0, 0, static_cast<uint32_t>(msg.wave_ % 4)};
+        flat_wave_state_t *state = wave_states.find(wave);
+        if (state)
+        {
+            block_info_t& info = block_info[state->current_block_];
+            uint64_t elapsed = msg.timestamp_ - state->start_time_;
+            if (info.count_)
+            {
+                info.count_ += state->count_;
+                info.thread_count_ += popcount(msg.exec_);
+                info.duration_ += elapsed;
+            }
+            else
+                info = {popcount(msg.exec_), 1, elapsed};
+            if (ends_program[msg.block_])
+                wave_states.erase(wave);
+            else
+                *state = {msg.block_, msg.timestamp_, 1};
+        }
+        else
+            wave_states.insert(wave, {msg.block_, msg.timestamp_, 1});
+    }
+    uint64_t total = 0;
+    for (auto& info : block_info)
+        total += info.count_;
+    return total;
+}
+
+template<typename F>
+double timeIt(F fn, uint64_t& result)
+{
+    auto start = std::chrono::steady_clock::now();
+    result = fn();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t waves = argc > 1 ? strtoull(argv[1], nullptr, 0) : 65536;
+    uint32_t block_count = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 0)) : 32;
+    uint32_t iterations = argc > 3 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 0)) : 4;
+    if (block_count < 2)
+        block_count = 2;
+
+    std::vector<std::unique_ptr<fakeBlock>> blocks;
+    for (uint32_t i = 0; i < block_count; i++)
+    {
+        auto block = std::make_unique<fakeBlock>();
+        for (int j = 0; j < 8; j++)
+            block->instructions_.push_back(j % 2 ? "v_add_u32" : "s_load_dword");
+        block->instructions_.push_back(i + 1 == block_count ? "s_endpgm" : "s_cbranch_scc1");
+        block->instruction_blocks_.assign(block->instructions_.size(), block.get());
+        blocks.push_back(std::move(block));
+    }
+    std::vector<synthetic_message_t> stream = makeStream(waves, block_count, iterations);
+
+    uint64_t map_result = 0, flat_result = 0;
+    double map_seconds = timeIt([&]() { return runMaps(stream, blocks); }, map_result);
+    double flat_seconds = timeIt([&]() { return runFlat(stream, blocks); }, flat_result);
+    if (map_result != flat_result)
+    {
+        std::cerr << "Results differ: " << map_result << " vs " << flat_result << std::endl;
+        return 1;
+    }
+    std::cout << stream.size() << " messages, " << waves << " waves, " << block_count << " blocks\n";
+    std::cout << "maps:  " << map_seconds << " s, " << stream.size() / map_seconds / 1e6 << " M msgs/s\n";
+    std::cout << "flat:  " << flat_seconds << " s, " << stream.size() / flat_seconds / 1e6 << " M msgs/s\n";
+    std::cout << "speedup: " << map_seconds / flat_seconds << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,359 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Throughput of the message handlers on the host, without a GPU.
+ *
+ * Feeds the messages of a recording (LOGDUR_RECORD_MESSAGES, see inc/message_replay.h) or of a
+ * synthetic pattern (see inc/synthetic_messages.h) through each handler as fast as it takes them, and
+ * prints messages/s and bytes/s for handle(), the time report() takes, and the peak RSS of the process.
+ * Each handler runs in a child process of its own, so the peak RSS is that handler's; the messages are
+ * built before forking and are included in it, so compare against the "none" row, which handles
+ * nothing. Handlers write their reports to /dev/null.
+ *
+ * basic_block_analysis only gets timing region messages and messages of recordings: without a kernelDB
+ * it drops basic block messages unread. --min-rate makes the run fail when a handler is slower than
+ * the given messages/s, for use as a regression check, and --save writes the synthetic messages out
+ * as a recording so that the same input can be replayed later.
+ *
+ * Usage: handler_replay_bench [--recording FILE | --pattern NAME] [--waves N] [--messages-per-wave N]
+ *            [--lanes N] [--handlers a,b,...] [--repeat N] [--save FILE] [--min-rate HANDLER=N ...]
+ *        Patterns: coalesced, strided, gather, lds-conflict, time-intervals, timing-regions
+ *        Handlers: none, heatmap, memory-analysis, basic-block, time-interval, logger */
+#include "inc/basic_block_analysis.h"
+#include "inc/memory_analysis_handler.h"
+#include "inc/memory_heatmap.h"
+#include "inc/message_logger.h"
+#include "inc/message_replay.h"
+#include "inc/synthetic_messages.h"
+#include "inc/time_interval_handler.h"
+
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *handler_names[] = {"none", "heatmap", "memory-analysis", "basic-block", "time-interval", "logger"};
+
+// Handles nothing, for the cost of the loop and the RSS of the messages themselves
+class null_handler_t : public dh_comms::message_handler_base
+{
+public:
+    virtual bool handle(const dh_comms::message_t &) override { return true; }
+    virtual void report() override {}
+    virtual void clear() override {}
+};
+
+typedef struct {
+    std::string kernel_;
+    uint64_t dispatch_id_;
+    std::vector<dh_comms::message_t> messages_;
+} benchDispatch_t;
+
+typedef struct {
+    std::vector<benchDispatch_t> dispatches_;
+    size_t messages_;
+    size_t bytes_;
+} benchInput_t;
+
+std::unique_ptr<dh_comms::message_handler_base> makeHandler(const std::string& name, const benchDispatch_t& dispatch)
+{
+    std::string location = "/dev/null";
+    if (name == "heatmap")
+        return std::make_unique<dh_comms::memory_heatmap_t>(dispatch.kernel_, dispatch.dispatch_id_, location);
+    if (name == "memory-analysis")
+        return std::make_unique<dh_comms::memory_analysis_handler_t>(dispatch.kernel_, dispatch.dispatch_id_, location,
+                                                                     false);
+    if (name == "basic-block")
+        return std::make_unique<basic_block_analysis>(dispatch.kernel_, dispatch.dispatch_id_, location);
+    if (name == "time-interval")
+        return std::make_unique<dh_comms::time_interval_handler_t>(dispatch.kernel_, dispatch.dispatch_id_, location);
+    if (name == "logger")
+        return std::make_unique<message_logger_t>(dispatch.kernel_, dispatch.dispatch_id_, location);
+    if (name == "none")
+        return std::make_unique<null_handler_t>();
+    return nullptr;
+}
+
+// A message as dh_comms reads it from a sub-buffer: the wave header, then the data items
+void appendMessage(benchDispatch_t& dispatch, const void *header, const void *items, size_t items_size,
+                   benchInput_t& input)
+{
+    std::vector<char> buffer(sizeof(dh_comms::wave_header_t) + items_size);
+    memcpy(buffer.data(), header, sizeof(dh_comms::wave_header_t));
+    if (items_size)
+        memcpy(buffer.data() + sizeof(dh_comms::wave_header_t), items, items_size);
+    dispatch.messages_.emplace_back(buffer.data());
+    input.messages_++;
+    input.bytes_ += buffer.size();
+}
+
+bool loadRecording(const std::string& path, benchInput_t& input)
+{
+    messageRecording recording;
+    std::string error;
+    if (!recording.load(path, error))
+    {
+        std::cerr << path << ": " << error << std::endl;
+        return false;
+    }
+    if (recording.headerSize() != sizeof(dh_comms::wave_header_t))
+    {
+        std::cerr << path << ": recorded with a " << recording.headerSize() << " byte wave header, this dh_comms has "
+                  << sizeof(dh_comms::wave_header_t) << std::endl;
+        return false;
+    }
+    for (const auto& recorded : recording.dispatches())
+    {
+        input.dispatches_.push_back({recorded.kernel_, recorded.dispatch_id_, {}});
+        for (const auto& message : recorded.messages_)
+            appendMessage(input.dispatches_.back(), message.header_, message.items_,
+                          static_cast<size_t>(message.item_size_) * message.item_count_, input);
+    }
+    return true;
+}
+
+void buildSynthetic(syntheticPattern_t pattern, const syntheticConfig_t& config, const std::string& save_path,
+                    benchInput_t& input)
+{
+    input.dispatches_.push_back({std::string("synthetic_") + syntheticPatternName(pattern), 1, {}});
+    messageRecordWriter writer;
+    uint32_t recorded_dispatch = 0;
+    if (!save_path.empty())
+    {
+        if (writer.open(save_path, sizeof(dh_comms::wave_header_t)))
+            recorded_dispatch = writer.beginDispatch(input.dispatches_.back().kernel_, 1);
+        else
+            std::cerr << "Unable to open " << save_path << ", not saving the messages" << std::endl;
+    }
+    generateSyntheticMessages(pattern, config, [&](const syntheticMessage_t& message) {
+        dh_comms::wave_header_t hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        size_t items_size = message.items_.size() * sizeof(uint64_t);
+        hdr.exec = message.exec_;
+        hdr.data_size = items_size;
+        // Address messages have an item per active lane, time intervals a single one
+        hdr.is_vector_message = message.kind_ == SYNTHETIC_ADDRESS_MESSAGE;
+        hdr.has_lane_headers = 0;
+        hdr.active_lane_count = __builtin_popcountll(message.exec_);
+        hdr.timestamp = message.timestamp_;
+        hdr.dwarf_fname_hash = message.dwarf_fname_hash_;
+        hdr.dwarf_line = message.dwarf_line_;
+        hdr.dwarf_column = message.dwarf_column_;
+        hdr.user_type = message.kind_ == SYNTHETIC_ADDRESS_MESSAGE ? dh_comms::message_type::address
+                                                                   : dh_comms::message_type::time_interval;
+        hdr.user_data = message.user_data_;
+        hdr.block_idx_x = message.block_idx_x_;
+        hdr.block_idx_y = message.block_idx_y_;
+        hdr.block_idx_z = message.block_idx_z_;
+        hdr.wave_num = message.wave_num_;
+        appendMessage(input.dispatches_.back(), &hdr, message.items_.data(), items_size, input);
+        if (writer.isOpen())
+            writer.append(recorded_dispatch, &hdr, message.item_size_,
+                          static_cast<uint32_t>(items_size / message.item_size_), message.items_.data());
+    });
+}
+
+typedef struct {
+    double handle_seconds_;
+    double report_seconds_;
+    long peak_rss_kb_;
+} benchResult_t;
+
+// Runs in the child: the best of repeat runs, each with fresh handlers
+benchResult_t runHandler(const std::string& name, const benchInput_t& input, size_t repeat)
+{
+    benchResult_t result = {0, 0, 0};
+    for (size_t r = 0; r < repeat; r++)
+    {
+        double handle_seconds = 0, report_seconds = 0;
+        for (const auto& dispatch : input.dispatches_)
+        {
+            auto handler = makeHandler(name, dispatch);
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& message : dispatch.messages_)
+                handler->handle(message);
+            auto handled = std::chrono::steady_clock::now();
+            handler->report();
+            std::chrono::duration<double> handle_time = handled - start;
+            std::chrono::duration<double> report_time = std::chrono::steady_clock::now() - handled;
+            handle_seconds += handle_time.count();
+            report_seconds += report_time.count();
+        }
+        if (r == 0 || handle_seconds < result.handle_seconds_)
+            result = {handle_seconds, report_seconds, 0};
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peak_rss_kb_ = usage.ru_maxrss;
+    return result;
+}
+
+bool benchHandler(const std::string& name, const benchInput_t& input, size_t repeat, benchResult_t& result)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0)
+    {
+        close(fds[0]);
+        // Keep handler chatter off the table
+        if (!freopen("/dev/null", "w", stdout))
+            _exit(1);
+        benchResult_t child = runHandler(name, input, repeat);
+        ssize_t written = write(fds[1], &child, sizeof(child));
+        _exit(written == sizeof(child) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void usage()
+{
+    std::cerr << "Usage: handler_replay_bench [--recording FILE | --pattern NAME] [--waves N] [--messages-per-wave N]\n"
+                 "           [--lanes N] [--handlers a,b,...] [--repeat N] [--save FILE] [--min-rate HANDLER=N ...]"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string recording_path, save_path, handlers_arg;
+    syntheticPattern_t pattern = SYNTHETIC_COALESCED;
+    syntheticConfig_t config;
+    size_t repeat = 3;
+    std::map<std::string, double> min_rates;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--recording")
+            recording_path = value;
+        else if (arg == "--pattern")
+        {
+            if (!parseSyntheticPattern(value, pattern))
+            {
+                std::cerr << "Unknown pattern " << value << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--waves")
+            config.waves_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--messages-per-wave")
+            config.messages_per_wave_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--lanes")
+            config.active_lanes_ = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 0));
+        else if (arg == "--handlers")
+            handlers_arg = value;
+        else if (arg == "--repeat")
+            repeat = std::max<size_t>(1, strtoull(value.c_str(), nullptr, 0));
+        else if (arg == "--save")
+            save_path = value;
+        else if (arg == "--min-rate" && value.find('=') != std::string::npos)
+            min_rates[value.substr(0, value.find('='))] = strtod(value.c_str() + value.find('=') + 1, nullptr);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<std::string> handlers;
+    if (handlers_arg.empty())
+        handlers.assign(std::begin(handler_names), std::end(handler_names));
+    else
+    {
+        std::stringstream stream(handlers_arg);
+        std::string name;
+        while (std::getline(stream, name, ','))
+            handlers.push_back(name);
+    }
+
+    benchInput_t input = {{}, 0, 0};
+    if (!recording_path.empty())
+    {
+        if (!loadRecording(recording_path, input))
+            return 1;
+        std::cout << recording_path << ": ";
+    }
+    else
+    {
+        buildSynthetic(pattern, config, save_path, input);
+        std::cout << syntheticPatternName(pattern) << ": ";
+    }
+    std::cout << input.messages_ << " messages, " << input.bytes_ << " bytes in " << input.dispatches_.size()
+              << " dispatch(es), best of " << repeat << std::endl;
+
+    int failed = 0;
+    printf("%-16s %14s %12s %10s %12s\n", "handler", "messages/s", "MB/s", "report s", "peak RSS MB");
+    for (const auto& name : handlers)
+    {
+        benchDispatch_t empty = {"", 0, {}};
+        if (!makeHandler(name, empty))
+        {
+            std::cerr << "Unknown handler " << name << std::endl;
+            return 1;
+        }
+        benchResult_t result;
+        if (!benchHandler(name, input, repeat, result))
+        {
+            printf("%-16s failed\n", name.c_str());
+            failed++;
+            continue;
+        }
+        double seconds = result.handle_seconds_ > 0 ? result.handle_seconds_ : 1e-9;
+        double rate = input.messages_ / seconds;
+        printf("%-16s %14.0f %12.1f %10.4f %12.1f\n", name.c_str(), rate, input.bytes_ / seconds / 1e6,
+               result.report_seconds_, result.peak_rss_kb_ / 1024.0);
+        auto min_rate = min_rates.find(name);
+        if (min_rate != min_rates.end() && rate < min_rate->second)
+        {
+            printf("%-16s below the minimum of %.0f messages/s\n", name.c_str(), min_rate->second);
+            failed++;
+        }
+    }
+    return failed ? 1 : 0;
+}
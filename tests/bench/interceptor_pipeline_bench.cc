@@ -0,0 +1,247 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Host overhead of the interception and completion pipeline, without a GPU.
+ *
+ * Runs the same dispatch stream on the fake HSA runtime (tests/fake_hsa/fake_hsa.h) twice: straight onto the
+ * fake hardware queues ("direct"), then through hsaInterceptor in duration mode ("intercepted"), which copies
+ * every dispatch packet, swaps in a pooled completion signal and forwards completion to the application from
+ * its signal runner thread. For each it prints
+ *   - dispatches/s with --queues application threads, each keeping a batch of --batch dispatches in flight
+ *   - the submit-to-completion latency of single dispatches on one queue, as p50/p99/max over --samples
+ * With --latency-ns 0 the fake device completes a packet as soon as it sees it, so the numbers are host
+ * overhead only; the difference between the two rows is what the interceptor adds. --mode selects the
+ * LOGDUR_DURATION_MODE of the intercepted run; the log goes to /dev/null. After each run it also prints the
+ * process CPU time per second of wall time over --idle-ms with no dispatches in flight.
+ *
+ * Usage: interceptor_pipeline_bench [--queues N] [--dispatches N] [--batch N] [--latency-ns N] [--samples N]
+ *            [--mode lines|aggregate|raw] [--idle-ms N] */
+#include "fake_hsa.h"
+#include "inc/interceptor.h"
+
+#include <string.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef struct {
+    size_t queues_ = 4;
+    size_t dispatches_ = 20000; // Per queue
+    size_t batch_ = 64;
+    uint64_t latency_ns_ = 0;
+    size_t samples_ = 2000;
+    uint64_t idle_ms_ = 1000;
+} benchConfig_t;
+
+typedef struct {
+    double rate_;
+    double p50_us_;
+    double p99_us_;
+    double max_us_;
+    double idle_cpu_ms_;    // Per second of wall time
+} benchResult_t;
+
+uint64_t kernelObject(HsaApiTable *table, hsa_executable_symbol_t symbol)
+{
+    // Through the API table, so that the interceptor sees the kernel once it is hooked in
+    uint64_t object = 0;
+    table->core_->hsa_executable_symbol_get_info_fn(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT, &object);
+    return object;
+}
+
+double cpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+hsa_kernel_dispatch_packet_t dispatchPacket(uint64_t kernel_object, hsa_signal_t signal)
+{
+    hsa_kernel_dispatch_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.header = HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE;
+    packet.setup = 1 << HSA_KERNEL_DISPATCH_PACKET_SETUP_DIMENSIONS;
+    packet.workgroup_size_x = 256;
+    packet.workgroup_size_y = packet.workgroup_size_z = 1;
+    packet.grid_size_x = 1 << 20;
+    packet.grid_size_y = packet.grid_size_z = 1;
+    packet.kernel_object = kernel_object;
+    packet.completion_signal = signal;
+    return packet;
+}
+
+hsa_queue_t *createQueue(HsaApiTable *table, hsa_agent_t agent)
+{
+    hsa_queue_t *queue = NULL;
+    if (table->core_->hsa_queue_create_fn(agent, 4096, HSA_QUEUE_TYPE_MULTI, NULL, NULL, UINT32_MAX, UINT32_MAX,
+                                          &queue) != HSA_STATUS_SUCCESS)
+    {
+        std::cerr << "Queue creation failed" << std::endl;
+        exit(1);
+    }
+    return queue;
+}
+
+// Every dispatch of a batch carries the same signal, set to the batch size, so it reaches zero when all are done
+void submitBatches(HsaApiTable *table, hsa_agent_t agent, uint64_t kernel_object, const benchConfig_t& config)
+{
+    hsa_queue_t *queue = createQueue(table, agent);
+    hsa_signal_t signal;
+    table->core_->hsa_signal_create_fn(0, 0, NULL, &signal);
+    std::vector<hsa_kernel_dispatch_packet_t> packets(config.batch_, dispatchPacket(kernel_object, signal));
+    for (size_t done = 0; done < config.dispatches_; done += config.batch_)
+    {
+        size_t count = std::min(config.batch_, config.dispatches_ - done);
+        table->core_->hsa_signal_store_screlease_fn(signal, static_cast<hsa_signal_value_t>(count));
+        fakeHsaSubmit(queue, packets.data(), count);
+        table->core_->hsa_signal_wait_scacquire_fn(signal, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                                   HSA_WAIT_STATE_BLOCKED);
+    }
+    table->core_->hsa_signal_destroy_fn(signal);
+    table->core_->hsa_queue_destroy_fn(queue);
+}
+
+benchResult_t runPipeline(HsaApiTable *table, hsa_executable_symbol_t symbol, const benchConfig_t& config)
+{
+    benchResult_t result = {};
+    hsa_agent_t agent = fakeHsaGpuAgents()[0];
+    uint64_t kernel_object = kernelObject(table, symbol);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < config.queues_; i++)
+        threads.emplace_back(submitBatches, table, agent, kernel_object, std::cref(config));
+    for (auto& thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.rate_ = config.queues_ * config.dispatches_ / (seconds > 0 ? seconds : 1e-9);
+
+    hsa_queue_t *queue = createQueue(table, agent);
+    hsa_signal_t signal;
+    table->core_->hsa_signal_create_fn(1, 0, NULL, &signal);
+    hsa_kernel_dispatch_packet_t packet = dispatchPacket(kernel_object, signal);
+    std::vector<double> latencies;
+    for (size_t i = 0; i < config.samples_; i++)
+    {
+        table->core_->hsa_signal_store_screlease_fn(signal, 1);
+        auto submitted = std::chrono::steady_clock::now();
+        fakeHsaSubmit(queue, &packet, 1);
+        table->core_->hsa_signal_wait_scacquire_fn(signal, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                                   HSA_WAIT_STATE_ACTIVE);
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submitted)
+                                .count());
+    }
+    table->core_->hsa_signal_destroy_fn(signal);
+    table->core_->hsa_queue_destroy_fn(queue);
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50_us_ = latencies[latencies.size() / 2];
+        result.p99_us_ = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+        result.max_us_ = latencies.back();
+    }
+    fakeHsaDrain(10000000000ull);
+
+    double cpu = cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.idle_ms_));
+    result.idle_cpu_ms_ = (cpuSeconds() - cpu) * 1000.0 / (config.idle_ms_ / 1000.0);
+    return result;
+}
+
+void printResult(const char *name, const benchResult_t& result)
+{
+    printf("%-12s %14.0f %10.1f %10.1f %10.1f %12.2f\n", name, result.rate_, result.p50_us_, result.p99_us_,
+           result.max_us_, result.idle_cpu_ms_);
+}
+
+void usage()
+{
+    std::cerr << "Usage: interceptor_pipeline_bench [--queues N] [--dispatches N] [--batch N] [--latency-ns N]\n"
+                 "           [--samples N] [--mode lines|aggregate|raw] [--idle-ms N]"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    benchConfig_t config;
+    std::string mode = "aggregate";
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--queues")
+            config.queues_ = std::max<size_t>(1, strtoull(value.c_str(), nullptr, 0));
+        else if (arg == "--dispatches")
+            config.dispatches_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--batch")
+            config.batch_ = std::max<size_t>(1, strtoull(value.c_str(), nullptr, 0));
+        else if (arg == "--latency-ns")
+            config.latency_ns_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--samples")
+            config.samples_ = strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--idle-ms")
+            config.idle_ms_ = std::max<uint64_t>(1, strtoull(value.c_str(), nullptr, 0));
+        else if (arg == "--mode")
+            mode = value;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    setenv("LOGDUR_LOG_LOCATION", "/dev/null", 1);
+    setenv("LOGDUR_DURATION_MODE", mode.c_str(), 1);
+    setenv("LOGDUR_INSTRUMENTED", "false", 1);
+    fakeHsaConfig_t fake;
+    fake.kernel_latency_ns_ = config.latency_ns_;
+    fakeHsaConfigure(fake);
+    HsaApiTable *table = fakeHsaApiTable();
+    hsa_executable_symbol_t symbol = fakeHsaAddKernel(fakeHsaGpuAgents()[0], "_Z10bench_kernelPf", 8);
+
+    std::cout << config.queues_ << " queue(s) x " << config.dispatches_ << " dispatches in batches of "
+              << config.batch_ << ", " << config.latency_ns_ << " ns per kernel, duration mode " << mode << std::endl;
+    printf("%-12s %14s %10s %10s %10s %12s\n", "pipeline", "dispatches/s", "p50 us", "p99 us", "max us",
+           "idle CPU ms/s");
+    printResult("direct", runPipeline(table, symbol, config));
+
+    if (!hsaInterceptor::getInstance(table))
+        return 1;
+    printResult("intercepted", runPipeline(table, symbol, config));
+    hsaInterceptor::cleanup();
+    return 0;
+}
@@ -0,0 +1,183 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Cost of handing address messages to a Python module (see inc/pyHandler.h), per wave message of --lanes
+ * addresses, with --threads threads producing them:
+ *
+ *   - per address: pythonMessageHandler, one call with a dict per address (one producer thread)
+ *   - batch N: pythonBatchHandler with N messages per batch, one call with memoryview columns per batch
+ *
+ * Both modules sum the addresses they are given, which is checked against the expected total.
+ *
+ * Usage: python_handler_bench [--messages N] [--lanes N] [--threads N] */
+#include "inc/pyHandler.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+#define BENCH_MODULE "omniprobe_python_bench"
+
+const char *module_source = R"(
+total = 0
+
+def handleAddressMessage(message):
+    global total
+    total += message["address"]
+
+def handleTimeMessage(message):
+    pass
+
+def handleAddressBatch(batch):
+    global total
+    total += sum(batch["address"])
+)";
+
+// Reads and clears the module's total
+uint64_t moduleTotal()
+{
+    PyGILState_STATE gil = PyGILState_Ensure();
+    uint64_t total = 0;
+    PyObject *module = PyImport_ImportModule(BENCH_MODULE);
+    if (module)
+    {
+        PyObject *value = PyObject_GetAttrString(module, "total");
+        if (value)
+            total = PyLong_AsUnsignedLongLongMask(value);
+        Py_XDECREF(value);
+        PyObject *zero = PyLong_FromLong(0);
+        PyObject_SetAttrString(module, "total", zero);
+        Py_XDECREF(zero);
+        Py_DECREF(module);
+    }
+    PyErr_Clear();
+    PyGILState_Release(gil);
+    return total;
+}
+
+uint64_t address(size_t message, size_t lane)
+{
+    return 0x7f0000000000ull + message * 256 + lane * 4;
+}
+
+void report(const std::string& what, size_t threads, size_t messages, double seconds, bool valid)
+{
+    printf("%-14s %3zu threads %12.0f messages/s %10.3f s%s\n", what.c_str(), threads, messages / seconds, seconds,
+           valid ? "" : "  WRONG TOTAL");
+}
+
+void usage()
+{
+    std::cerr << "Usage: python_handler_bench [--messages N] [--lanes N] [--threads N]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t messages = 20000;
+    size_t lanes = 64;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        uint64_t value = strtoull(argv[++i], nullptr, 0);
+        if (arg == "--messages")
+            messages = std::max<uint64_t>(1, value);
+        else if (arg == "--lanes")
+            lanes = std::max<uint64_t>(1, value);
+        else if (arg == "--threads")
+            threads = std::max<uint64_t>(1, value);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    char dir[] = "/tmp/omniprobe_bench_XXXXXX";
+    if (!mkdtemp(dir))
+        return 1;
+    std::string module_path = std::string(dir) + "/" BENCH_MODULE ".py";
+    std::ofstream(module_path) << module_source;
+    setenv("PYTHONPATH", dir, 1);
+    setenv("PYTHONDONTWRITEBYTECODE", "1", 1);
+
+    uint64_t expected = 0;
+    for (size_t m = 0; m < messages; m++)
+        for (size_t lane = 0; lane < lanes; lane++)
+            expected += address(m, lane);
+
+    {
+        std::string module_name = BENCH_MODULE;
+        pythonMessageHandler handler(module_name);
+        auto start = bench_clock::now();
+        for (size_t m = 0; m < messages; m++)
+            for (size_t lane = 0; lane < lanes; lane++)
+                handler.addressMessage(reinterpret_cast<void *>(address(m, lane)));
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        report("per address", 1, messages, seconds, moduleTotal() == expected);
+    }
+
+    for (size_t batch_messages : {64, 512, PYTHON_BATCH_MESSAGES})
+    {
+        pythonBatchHandler handler(BENCH_MODULE, batch_messages);
+        auto start = bench_clock::now();
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < threads; t++)
+            producers.emplace_back([&, t]() {
+                pythonMessageHeader_t header = {};
+                std::vector<uint64_t> addresses(lanes);
+                for (size_t m = t; m < messages; m += threads)
+                {
+                    for (size_t lane = 0; lane < lanes; lane++)
+                        addresses[lane] = address(m, lane);
+                    header.line_ = m;
+                    handler.addressMessage(header, addresses.data(), lanes);
+                }
+            });
+        for (auto& producer : producers)
+            producer.join();
+        handler.flush();
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        report("batch " + std::to_string(batch_messages), threads, messages, seconds, moduleTotal() == expected);
+    }
+
+    unlink(module_path.c_str());
+    rmdir(dir);
+    return 0;
+}
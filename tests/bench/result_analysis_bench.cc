@@ -0,0 +1,205 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Throughput of omniprobe-analyze's reading and ranking (see inc/result_analysis.h) on synthetic outputs.
+ *
+ * Writes a MemoryAnalysis array and a file of basic block lines to a temporary directory, laid out the way
+ * the handlers write them, about --mb MiB in all. Then reads both with resultMerger and ranks the merged
+ * table with resultAnalysis at 1, 2, 4, ... up to --threads workers, printing GB/s of input.
+ *
+ * Usage: result_analysis_bench [--mb N] [--threads N] [--chunk-mb N] */
+#include "inc/result_analysis.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+const int KERNELS = 8;
+const int GLOBAL_SITES = 24;
+const int LDS_SITES = 8;
+const int BLOCKS = 32;
+
+void writeAccess(std::ostream& out, uint64_t dispatch_id, int site, bool lds)
+{
+    uint64_t count = 1000 + (dispatch_id * 7 + site * 13) % 5000;
+    out << "        {\n          \"source_location\": {\n            \"file\": \"/work/app/src/kernels.hip\",\n";
+    out << "            \"line\": " << 100 + site << ",\n            \"column\": " << 9 + site % 4 << "\n";
+    out << "          },\n          \"code_context\": \"    out[idx] = alpha * in[idx * stride + " << site
+        << "];\",\n";
+    out << "          \"access_info\": {\n            \"type\": \"" << (site % 3 ? "read" : "write") << "\",\n";
+    out << "            \"execution_count\": " << count << ",\n            \"ir_bytes\": 4,\n";
+    if (lds)
+        out << "            \"total_conflicts\": " << count * (site % 4) << "\n";
+    else
+    {
+        out << "            \"isa_bytes\": 4,\n            \"isa_instruction\": \"global_load_dword v1, v[2:3], off\",\n";
+        out << "            \"cache_lines\": {\n              \"needed\": " << count * 2 << ",\n";
+        out << "              \"used\": " << count * (2 + site % 5) << "\n            }\n";
+    }
+    out << "          }\n        }";
+}
+
+// One dispatch's MemoryAnalysis record, as memory_analysis_handler_t::report_json() lays it out
+void writeMemoryAnalysis(std::ostream& out, uint64_t dispatch_id)
+{
+    out << "{\n  \"kernel_analysis\": {\n    \"kernel_info\": {\n      \"name\": \"_Z7kernel" << dispatch_id % KERNELS
+        << "PfS_i\",\n      \"dispatch_id\": " << dispatch_id << "\n    },\n";
+    for (bool lds : {false, true})
+    {
+        out << (lds ? "    \"bank_conflicts\": {\n" : "    \"cache_analysis\": {\n") << "      \"accesses\": [\n";
+        int sites = lds ? LDS_SITES : GLOBAL_SITES;
+        for (int site = 0; site < sites; site++)
+        {
+            writeAccess(out, dispatch_id, site, lds);
+            out << (site + 1 < sites ? ",\n" : "\n");
+        }
+        out << "      ]\n    }" << (lds ? "\n" : ",\n");
+    }
+    out << "  },\n  \"metadata\": {\n    \"version\": null\n  }\n}";
+}
+
+// One basic block line, as basic_block_analysis::report() writes it
+void writeBlock(std::ostream& out, uint64_t dispatch_id, int block)
+{
+    uint64_t count = 64 + (dispatch_id + block) % 256;
+    out << "{\"kernel\": \"_Z7kernel" << dispatch_id % KERNELS << "PfS_i\",\"kernel_file_name\": "
+        << "\"/work/app/src/kernels.hip\",\"block_duration\": " << count * (100 + block * 17)
+        << ",\"block_duration_p50\": 90,\"block_duration_p90\": 140,\"block_duration_p99\": " << 200 + block
+        << ",\"block_end_line\": " << 120 + block * 4 << ",\"block_start_line\": " << 118 + block * 4
+        << ",\"dispatch_id\": " << dispatch_id << ",\"block_branchiness\": 0.25,\"block_count\": " << count
+        << ",\"block_overhead\": 0.5,\"kernel_branchiness\": 0.1,\"instructions\": {\"s_load_dwordx2\": 4, "
+        << "\"v_add_u32\": 12, \"global_load_dword\": 2}}\n";
+}
+
+// Writes about bytes of output to path, one dispatch at a time
+size_t writeOutput(const std::string& path, size_t bytes, bool blocks)
+{
+    std::ofstream out(path, std::ios::trunc);
+    size_t written = 0;
+    if (!blocks)
+        out << "[\n";
+    for (uint64_t dispatch_id = 1; written < bytes; dispatch_id++)
+    {
+        std::ostringstream record;
+        if (blocks)
+            for (int block = 0; block < BLOCKS; block++)
+                writeBlock(record, dispatch_id, block);
+        else
+        {
+            if (dispatch_id > 1)
+                record << ",\n";
+            writeMemoryAnalysis(record, dispatch_id);
+        }
+        out << record.str();
+        written += record.str().size();
+    }
+    if (!blocks)
+        out << "\n]\n";
+    out.close();
+    return out.good() ? written : 0;
+}
+
+void usage()
+{
+    std::cerr << "Usage: result_analysis_bench [--mb N] [--threads N] [--chunk-mb N]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t mb = 256;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    mergeOptions_t options;
+    options.chunk_bytes_ = 16 * 1024 * 1024;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        uint64_t value = strtoull(argv[++i], nullptr, 0);
+        if (arg == "--mb")
+            mb = std::max<uint64_t>(1, value);
+        else if (arg == "--threads")
+            threads = std::max<uint64_t>(1, value);
+        else if (arg == "--chunk-mb")
+            options.chunk_bytes_ = std::max<uint64_t>(1, value) * 1024 * 1024;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    char dir[] = "/tmp/result_analysis_benchXXXXXX";
+    if (!mkdtemp(dir))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    std::vector<std::string> inputs = {std::string(dir) + "/memory_analysis.json", std::string(dir) + "/blocks.json"};
+    size_t bytes = writeOutput(inputs[0], mb * 1024 * 1024 * 3 / 4, false);
+    bytes += writeOutput(inputs[1], mb * 1024 * 1024 / 4, true);
+    if (!bytes)
+    {
+        std::cerr << "result_analysis_bench: unable to write to " << dir << std::endl;
+        return 1;
+    }
+    printf("%.1f MiB of synthetic output, %zu MiB chunks\n", bytes / (1024.0 * 1024.0), options.chunk_bytes_ >> 20);
+
+    for (size_t n = 1;; n = std::min(n * 2, threads))
+    {
+        options.threads_ = n;
+        auto start = bench_clock::now();
+        resultMerger merger(options);
+        if (!merger.merge(inputs))
+            return 1;
+        auto parsed = bench_clock::now();
+        resultAnalysis analysis(merger.table());
+        auto ranked = bench_clock::now();
+        double parse_s = std::chrono::duration<double>(parsed - start).count();
+        double rank_ms = std::chrono::duration<double, std::milli>(ranked - parsed).count();
+        printf("%3zu threads %8.3f GB/s  (%llu records, parse %.3f s, rank %.3f ms)\n", n,
+               bytes / (parse_s + rank_ms / 1000) / 1e9, static_cast<unsigned long long>(merger.table().records_),
+               parse_s, rank_ms);
+        if (n == threads)
+            break;
+    }
+    for (const auto& input : inputs)
+        unlink(input.c_str());
+    rmdir(dir);
+    return 0;
+}
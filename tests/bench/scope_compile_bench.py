@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+################################################################################
+# Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+################################################################################
+
+"""Compile time of the address message plugin with a large INSTRUMENTATION_SCOPE_FILE.
+
+Generates a module with many kernels, each with many loads and stores spread over
+many source files and lines, plus a scope file with many entries, and times
+`opt -passes=amdgcn-submit-address-message` over it with and without the scope.
+Pass --plugin more than once to compare builds of the plugin; the number of
+instrumented accesses is printed too, so the builds can be checked to agree.
+
+Usage: scope_compile_bench.py --plugin <libAMDGCNSubmitAddressMessages-rocm.so>
+           [--plugin <other build>] [--opt <opt>] [--kernels N] [--accesses N]
+           [--files N] [--entries N] [--repeat N]
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+DATALAYOUT = ("e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32"
+              "-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512"
+              "-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8")
+
+
+def source_file(idx):
+    return ("/work/library/src/kernels/level%d" % (idx % 3), "kernel_%04d.hip" % idx)
+
+
+def generate_module(kernels, accesses, files, rng):
+    lines = ['target datalayout = "%s"' % DATALAYOUT, 'target triple = "amdgcn-amd-amdhsa"', ""]
+    metadata = []
+    next_md = [0]
+
+    def md(text):
+        idx = next_md[0]
+        next_md[0] += 1
+        metadata.append("!%d = %s" % (idx, text))
+        return idx
+
+    cu_file = md('!DIFile(filename: "%s", directory: "%s")' % source_file(0)[::-1])
+    cu = md("distinct !DICompileUnit(language: DW_LANG_C_plus_plus_14, file: !%d, producer: \"clang\", "
+            "isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)" % cu_file)
+    version = md('!{i32 2, !"Debug Info Version", i32 3}')
+    subroutine = md("!DISubroutineType(types: !{})")
+    file_md = [md('!DIFile(filename: "%s", directory: "%s")' % source_file(i)[::-1]) for i in range(files)]
+
+    for k in range(kernels):
+        sp = md('distinct !DISubprogram(name: "k%d", scope: !%d, file: !%d, line: 1, type: !%d, '
+                "scopeLine: 1, spFlags: DISPFlagDefinition | DISPFlagOptimized, unit: !%d)"
+                % (k, file_md[0], file_md[0], subroutine, cu))
+        lines.append("define amdgpu_kernel void @k%d(ptr addrspace(1) %%out, ptr addrspace(1) %%in) "
+                     "#0 !dbg !%d {" % (k, sp))
+        lines.append("entry:")
+        for a in range(accesses):
+            f = file_md[rng.randrange(files)]
+            block = md("distinct !DILexicalBlock(scope: !%d, file: !%d, line: 1)" % (sp, f))
+            loc = md("!DILocation(line: %d, column: %d, scope: !%d)" % (rng.randrange(1, 2000), 3 + a % 40,
+                                                                        block))
+            lines.append("  %%p%d = getelementptr inbounds float, ptr addrspace(1) %%in, i64 %d, !dbg !%d"
+                         % (a, a, loc))
+            lines.append("  %%v%d = load float, ptr addrspace(1) %%p%d, align 4, !dbg !%d" % (a, a, loc))
+            lines.append("  %%q%d = getelementptr inbounds float, ptr addrspace(1) %%out, i64 %d, !dbg !%d"
+                         % (a, a, loc))
+            lines.append("  store float %%v%d, ptr addrspace(1) %%q%d, align 4, !dbg !%d" % (a, a, loc))
+        lines.append("  ret void")
+        lines.append("}")
+        lines.append("")
+
+    lines.append('attributes #0 = { "target-cpu"="gfx90a" }')
+    lines.append("")
+    lines.append("!llvm.dbg.cu = !{!%d}" % cu)
+    lines.append("!llvm.module.flags = !{!%d}" % version)
+    lines.extend(metadata)
+    return "\n".join(lines) + "\n"
+
+
+def generate_scope(entries, files, rng):
+    # A mix of the forms INSTRUMENTATION_SCOPE accepts: full paths, tail patterns, and line lists
+    # and ranges, some of them for files that aren't in the module
+    scope = []
+    for _ in range(entries):
+        directory, name = source_file(rng.randrange(files * 2))
+        kind = rng.randrange(4)
+        if kind == 0:
+            pattern = directory + "/" + name
+        elif kind == 1:
+            pattern = name
+        else:
+            pattern = "kernels/" + directory[-6:] + "/" + name
+        start = rng.randrange(1, 2000)
+        specs = [str(start), "%d:%d" % (start + 10, start + 10 + rng.randrange(1, 200))]
+        scope.append(pattern + ":" + ",".join(specs[:rng.randrange(1, 3)]))
+    return "\n".join(scope) + "\n"
+
+
+def run(opt, plugin, module, scope_file, repeat):
+    env = dict(os.environ)
+    for var in ["INSTRUMENTATION_SCOPE", "INSTRUMENTATION_SCOPE_FILE", "INSTRUMENTATION_AFFINE_SUMMARY",
+                "INSTRUMENTATION_GROUP_ACCESSES", "INSTRUMENTATION_SAMPLE", "INSTRUMENTATION_DUAL_PATH",
+                "INSTRUMENTATION_SITE_MANIFEST", "INSTRUMENTATION_HEATMAP", "INSTRUMENTATION_WAVE_ENCODING"]:
+        env.pop(var, None)
+    if scope_file:
+        env["INSTRUMENTATION_SCOPE_FILE"] = scope_file
+    best = None
+    output = ""
+    for _ in range(repeat):
+        start = time.perf_counter()
+        result = subprocess.run([opt, "-load-pass-plugin", plugin, "-passes=amdgcn-submit-address-message",
+                                 "-S", module, "-o", "-"], env=env, stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL, universal_newlines=True, check=True)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+        output = result.stdout
+    return best, output.count("call void @v_submit_address(")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--plugin", action="append", required=True)
+    parser.add_argument("--opt", default="opt")
+    parser.add_argument("--kernels", type=int, default=20)
+    parser.add_argument("--accesses", type=int, default=500, help="loads and stores per kernel")
+    parser.add_argument("--files", type=int, default=200)
+    parser.add_argument("--entries", type=int, default=2000, help="scope file entries")
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    with tempfile.TemporaryDirectory() as tmp:
+        module = os.path.join(tmp, "module.ll")
+        scope_file = os.path.join(tmp, "scope.txt")
+        with open(module, "w") as f:
+            f.write(generate_module(args.kernels, args.accesses, args.files, rng))
+        with open(scope_file, "w") as f:
+            f.write(generate_scope(args.entries, args.files, rng))
+
+        print("%d kernels x %d accesses over %d files, %d scope entries"
+              % (args.kernels, args.accesses * 2, args.files, args.entries))
+        for plugin in args.plugin:
+            base, base_count = run(args.opt, plugin, module, None, args.repeat)
+            scoped, scoped_count = run(args.opt, plugin, module, scope_file, args.repeat)
+            print("%s\n  no scope: %7.3f s, %d accesses instrumented\n  scoped:   %7.3f s, %d accesses instrumented"
+                  % (plugin, base, base_count, scoped, scoped_count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
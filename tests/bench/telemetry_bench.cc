@@ -0,0 +1,114 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Cost of a telemetry update (see inc/telemetry.h) on the threads that make them: fixupPacket callers, the
+ * reactor and dh_comms handler threads.
+ *
+ *   - off: telemetryCount() and telemetryRecord() with no active segment
+ *   - count / record: ns per update with --threads threads all updating the same counter or histogram
+ *   - timer: ns per telemetryTimer, which adds two clock reads to a record
+ *
+ * Usage: telemetry_bench [--threads N] [--updates N] */
+#include "inc/telemetry.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+// ns per call of update on each of threads threads, running updates times each
+template <typename update_t>
+double run(size_t threads, size_t updates, update_t update)
+{
+    std::vector<std::thread> workers;
+    auto start = bench_clock::now();
+    for (size_t t = 0; t < threads; t++)
+        workers.emplace_back([&]() {
+            for (size_t i = 0; i < updates; i++)
+                update(i);
+        });
+    for (auto& worker : workers)
+        worker.join();
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count() / updates;
+}
+
+void report(const char *what, size_t threads, double ns)
+{
+    printf("%-8s %3zu threads %8.2f ns/update\n", what, threads, ns);
+}
+
+void usage()
+{
+    std::cerr << "Usage: telemetry_bench [--threads N] [--updates N]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t updates = 10000000;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        uint64_t value = strtoull(argv[++i], nullptr, 0);
+        if (arg == "--threads")
+            threads = std::max<uint64_t>(1, value);
+        else if (arg == "--updates")
+            updates = std::max<uint64_t>(1, value);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    report("off", 1, run(1, updates, [](size_t i) { telemetryRecord(TELEMETRY_HANDLER_NS, i); }));
+
+    telemetrySegment segment;
+    if (!segment.create("/omniprobe_bench." + std::to_string(getpid())))
+        return 1;
+    segment.activate();
+    std::vector<size_t> thread_counts = {1};
+    if (threads > 1)
+        thread_counts.push_back(threads);
+    for (size_t n : thread_counts)
+    {
+        report("count", n, run(n, updates, [](size_t) { telemetryCount(TELEMETRY_MESSAGES); }));
+        report("record", n, run(n, updates, [](size_t i) { telemetryRecord(TELEMETRY_HANDLER_NS, i & 0xffff); }));
+        report("timer", n, run(n, updates / 10, [](size_t) { telemetryTimer timer(TELEMETRY_HANDLER_NS); }));
+    }
+    segment.deactivate();
+    return 0;
+}
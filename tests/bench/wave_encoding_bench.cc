@@ -0,0 +1,140 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+/* Bandwidth and host decode cost of wave-compressed address messages (see inc/wave_encoding.h).
+ *
+ * For a few typical per-wave address patterns, prints the data items a message carries raw and with the
+ * encoding the device would pick, then times decoding a stream of such messages through
+ * waveAddressView, the way handlers read them, against reading the same addresses from raw messages.
+ * Wave headers are the same size either way and are left out of the byte counts.
+ *
+ * Usage: wave_encoding_bench [messages per pattern] */
+#include "inc/wave_encoding.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// The parts of dh_comms::message_t that waveAddressView uses
+struct benchHeader {
+    uint64_t exec;
+    uint32_t dwarf_column;
+    uint32_t active_lane_count;
+};
+
+struct benchMessage {
+    benchHeader header_;
+    std::vector<uint64_t> items_;
+    const benchHeader& wave_header() const { return header_; }
+    size_t no_data_items() const { return items_.size(); }
+    size_t data_item_size() const { return sizeof(uint64_t); }
+    const void *data_item(size_t i) const { return &items_[i]; }
+};
+
+typedef struct {
+    const char *name_;
+    uint64_t exec_;
+    uint64_t (*address_)(uint64_t message, uint32_t lane);
+}pattern_t;
+
+const uint64_t base = 0x7f0000000000ull;
+
+const pattern_t patterns[] = {
+    {"unit stride float", ~0ull, [](uint64_t m, uint32_t lane) -> uint64_t { return base + m * 256 + 4 * lane; }},
+    {"row stride", ~0ull, [](uint64_t m, uint32_t lane) -> uint64_t { return base + m * 8 + 4096ull * lane; }},
+    {"broadcast", ~0ull, [](uint64_t m, uint32_t) -> uint64_t { return base + m * 8; }},
+    {"half wave, stride 8", 0xffffffffull,
+     [](uint64_t m, uint32_t lane) -> uint64_t { return base + m * 256 + 8 * lane; }},
+    {"4 rows", ~0ull, [](uint64_t m, uint32_t lane) -> uint64_t { return base + m * 64 + 4096ull * (lane / 16); }},
+    {"gather", ~0ull,
+     [](uint64_t m, uint32_t lane) -> uint64_t { return base + ((m * 64 + lane) * 0x9e3779b97f4a7c15ull >> 40); }},
+};
+
+benchMessage makeMessage(const pattern_t& pattern, uint64_t m, bool encode)
+{
+    std::vector<uint64_t> addresses;
+    for (uint32_t lane = 0; lane < 64; lane++)
+        if (pattern.exec_ & (1ull << lane))
+            addresses.push_back(pattern.address_(m, lane));
+    benchMessage message;
+    uint32_t column = 7;
+    if (encode)
+        column = encodeWaveAddresses(column, pattern.exec_, addresses, message.items_);
+    else
+        message.items_ = addresses;
+    message.header_ = {pattern.exec_, column, static_cast<uint32_t>(message.items_.size())};
+    return message;
+}
+
+// Reads every address of every message through the view; returns their sum so the work isn't dropped
+double decodeSeconds(const std::vector<benchMessage>& stream, uint64_t& checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    checksum = 0;
+    for (const auto& message : stream)
+    {
+        waveAddressView<benchMessage> view(message);
+        for (size_t i = 0; i != view.no_data_items(); ++i)
+            checksum += *static_cast<const uint64_t *>(view.data_item(i));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t count = argc > 1 ? strtoull(argv[1], nullptr, 0) : 200000;
+
+    printf("%-22s %10s %14s %7s %16s %20s\n", "pattern", "raw bytes", "encoded bytes", "ratio", "raw M addr/s",
+           "decoded M addr/s");
+    for (const auto& pattern : patterns)
+    {
+        std::vector<benchMessage> raw, encoded;
+        uint64_t raw_bytes = 0, encoded_bytes = 0, addresses = 0;
+        for (uint64_t m = 0; m < count; m++)
+        {
+            raw.push_back(makeMessage(pattern, m, false));
+            encoded.push_back(makeMessage(pattern, m, true));
+            raw_bytes += raw.back().items_.size() * sizeof(uint64_t);
+            encoded_bytes += encoded.back().items_.size() * sizeof(uint64_t);
+            addresses += raw.back().items_.size();
+        }
+        uint64_t raw_sum = 0, decoded_sum = 0;
+        double raw_seconds = decodeSeconds(raw, raw_sum);
+        double decoded_seconds = decodeSeconds(encoded, decoded_sum);
+        if (raw_sum != decoded_sum)
+        {
+            std::cerr << pattern.name_ << ": decoded addresses differ" << std::endl;
+            return 1;
+        }
+        printf("%-22s %10lu %14lu %7.1f %16.1f %20.1f\n", pattern.name_, raw_bytes / count, encoded_bytes / count,
+               static_cast<double>(raw_bytes) / encoded_bytes, addresses / raw_seconds / 1e6,
+               addresses / decoded_seconds / 1e6);
+    }
+    printf("%lu messages per pattern\n", count);
+    return 0;
+}
@@ -0,0 +1,1253 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "fake_hsa.h"
+
+#include <amd_hsa_kernel_code.h>
+#include <hsa_ven_amd_loader.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+typedef std::chrono::steady_clock fake_clock;
+
+#define FAKE_HSA_PACKET_SIZE 64
+#define FAKE_HSA_ALLOC_GRANULE 4096
+// Timeouts at least this long are treated as waiting forever
+#define FAKE_HSA_FOREVER_NS (1ull << 50)
+// Condition variable timeouts overshoot by tens of microseconds, so the device spins out the last stretch
+#define FAKE_HSA_SPIN_NS 50000
+
+namespace {
+
+struct fakeSignal {
+    std::atomic<hsa_signal_value_t> value_;
+    std::atomic<uint64_t> start_;
+    std::atomic<uint64_t> end_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+struct fakePool {
+    hsa_agent_t agent_;
+    hsa_amd_segment_t segment_;
+    uint32_t global_flags_;
+    bool alloc_allowed_;
+};
+
+struct fakeAgent {
+    hsa_device_type_t type_;
+    std::string name_;
+    uint32_t node_;
+    std::vector<std::unique_ptr<fakePool>> pools_;
+};
+
+struct fakeKernel {
+    amd_kernel_code_t code_; // First, so the kernel object points at its kernel descriptor as on a real device
+    std::string name_;
+    hsa_agent_t agent_;
+    uint32_t kernarg_size_;
+    uint64_t latency_ns_;
+};
+
+struct fakeExecutable {
+    std::vector<fakeKernel *> kernels_;
+};
+
+struct fakeQueue {
+    hsa_queue_t queue_; // First, so the hsa_queue_t pointer handed out is the fakeQueue
+    hsa_agent_t agent_;
+    bool intercept_;
+    hsa_amd_queue_intercept_handler handler_;
+    void *handler_data_;
+    bool profiling_;
+    fakeSignal doorbell_;
+    std::vector<uint8_t> ring_;
+    std::mutex submit_mutex_; // Serializes doorbells, as the runtime does for an intercept queue
+    uint64_t packet_index_;
+    // Guarded by the runtime mutex
+    fake_clock::time_point busy_until_;
+    uint64_t device_clock_;
+};
+
+// A packet on the simulated hardware queue, completing at due_
+struct fakeWork {
+    fake_clock::time_point due_;
+    uint64_t sequence_;
+    hsa_signal_t signal_;
+    uint64_t start_;
+    uint64_t end_;
+
+    bool operator>(const fakeWork& other) const
+    {
+        return due_ != other.due_ ? due_ > other.due_ : sequence_ > other.sequence_;
+    }
+};
+
+// A handler registered with hsa_amd_signal_async_handler
+struct fakeAsyncHandler {
+    hsa_signal_t signal_;
+    hsa_signal_condition_t condition_;
+    hsa_signal_value_t compare_;
+    hsa_amd_signal_handler handler_;
+    void *arg_;
+};
+
+class fakeRuntime {
+public:
+    fakeRuntime();
+    void configure(const fakeHsaConfig_t& config);
+    void write(fakeQueue *queue, const void *packets, uint64_t count);
+    fakeAgent *agent(hsa_agent_t agent);
+    fakeKernel *kernel(uint64_t handle);
+    bool isExecutable(hsa_executable_t executable);
+    void addAsyncHandler(const fakeAsyncHandler& handler);
+    void removeAsyncHandlers(hsa_signal_t signal);
+    void signalChanged();
+
+    std::mutex mutex_;
+    std::condition_variable idle_cv_;
+    fakeHsaConfig_t config_;
+    std::vector<std::unique_ptr<fakeAgent>> agents_;
+    std::vector<std::unique_ptr<fakeKernel>> kernel_storage_;
+    std::unordered_map<uint64_t, fakeKernel *> kernels_;
+    fakeExecutable program_; // Holds the kernels from fakeHsaAddKernel
+    std::set<fakeExecutable *> executables_;
+    std::set<fakeQueue *> queues_;
+    std::map<void *, size_t> allocations_;
+    uint64_t scheduled_;
+    uint64_t completed_;
+
+    std::atomic<uint64_t> packets_;
+    std::atomic<uint64_t> dispatches_;
+    std::atomic<uint64_t> barriers_;
+    std::atomic<uint64_t> intercepted_;
+    std::atomic<uint64_t> signals_live_;
+    std::atomic<uint64_t> bytes_live_;
+
+    CoreApiTable core_;
+    AmdExtTable amd_ext_;
+    FinalizerExtTable finalizer_ext_;
+    ImageExtTable image_ext_;
+    HsaApiTable table_;
+
+private:
+    void deviceLoop();
+    void complete(const fakeWork& work);
+    void asyncLoop();
+
+    std::condition_variable work_cv_;
+    std::priority_queue<fakeWork, std::vector<fakeWork>, std::greater<fakeWork>> work_;
+    uint64_t sequence_;
+    std::thread device_;
+
+    // Async signal handlers run on their own thread, as in the runtime, which rechecks every registered
+    // condition whenever any signal changes
+    std::mutex async_mutex_;
+    std::condition_variable async_cv_;
+    std::vector<fakeAsyncHandler> async_handlers_;
+    uint64_t async_generation_;
+    std::thread async_;
+};
+
+// Never destroyed, so the fake outlives the interceptor's exit-time cleanup and its device thread never needs joining
+fakeRuntime& runtime()
+{
+    static fakeRuntime *instance = new fakeRuntime;
+    return *instance;
+}
+
+thread_local fakeQueue *writing_queue = NULL;
+
+fakeSignal *toSignal(hsa_signal_t signal)
+{
+    return reinterpret_cast<fakeSignal *>(signal.handle);
+}
+
+fakeQueue *toQueue(hsa_queue_t *queue)
+{
+    return reinterpret_cast<fakeQueue *>(queue);
+}
+
+fakePool *toPool(hsa_amd_memory_pool_t pool)
+{
+    return reinterpret_cast<fakePool *>(pool.handle);
+}
+
+/* Every update happens under the signal's mutex, which orders it against a waiter between its check and its
+ * wait, and lets hsa_signal_destroy wait out an update still in progress once a waiter has seen its result. */
+template<typename F>
+void updateSignal(fakeSignal *signal, F update)
+{
+    {
+        std::lock_guard<std::mutex> lock(signal->mutex_);
+        update();
+        signal->cv_.notify_all();
+    }
+    runtime().signalChanged();
+}
+
+bool signalSatisfied(hsa_signal_value_t value, hsa_signal_condition_t condition, hsa_signal_value_t compare)
+{
+    switch (condition)
+    {
+        case HSA_SIGNAL_CONDITION_EQ:
+            return value == compare;
+        case HSA_SIGNAL_CONDITION_NE:
+            return value != compare;
+        case HSA_SIGNAL_CONDITION_LT:
+            return value < compare;
+        case HSA_SIGNAL_CONDITION_GTE:
+            return value >= compare;
+        default:
+            return false;
+    }
+}
+
+hsa_signal_value_t waitSignal(hsa_signal_t sig, hsa_signal_condition_t condition, hsa_signal_value_t compare,
+                              uint64_t timeout_ns)
+{
+    fakeSignal *signal = toSignal(sig);
+    hsa_signal_value_t value = signal->value_.load();
+    if (signalSatisfied(value, condition, compare) || timeout_ns == 0)
+        return value;
+    std::unique_lock<std::mutex> lock(signal->mutex_);
+    if (timeout_ns >= FAKE_HSA_FOREVER_NS)
+    {
+        signal->cv_.wait(lock, [&]() { return signalSatisfied(signal->value_.load(), condition, compare); });
+    }
+    else
+    {
+        signal->cv_.wait_for(lock, std::chrono::nanoseconds(timeout_ns),
+                             [&]() { return signalSatisfied(signal->value_.load(), condition, compare); });
+    }
+    return signal->value_.load();
+}
+
+void copyString(void *value, const std::string& str)
+{
+    char *dst = static_cast<char *>(value);
+    memset(dst, 0, 64);
+    memcpy(dst, str.c_str(), std::min<size_t>(str.length(), 63));
+}
+
+void interceptWriter(const void *packets, uint64_t count)
+{
+    runtime().write(writing_queue, packets, count);
+}
+
+hsa_status_t fakeLoaderQueryHostAddress(const void *device_address, const void **host_address)
+{
+    if (!host_address || !runtime().kernel(reinterpret_cast<uint64_t>(device_address)))
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    // Host and device share memory in the fake
+    *host_address = device_address;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t fakeLoaderQuerySegmentDescriptors(hsa_ven_amd_loader_segment_descriptor_t *, size_t *num_segment_descriptors)
+{
+    if (!num_segment_descriptors)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    *num_segment_descriptors = 0;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t fakeLoaderQueryExecutable(const void *device_address, hsa_executable_t *executable)
+{
+    if (!executable || !runtime().kernel(reinterpret_cast<uint64_t>(device_address)))
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    executable->handle = reinterpret_cast<uint64_t>(&runtime().program_);
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t fakeLoaderIterateLoadedCodeObjects(hsa_executable_t executable,
+                                                hsa_status_t (*)(hsa_executable_t, hsa_loaded_code_object_t, void *),
+                                                void *)
+{
+    // Kernels registered with fakeHsaAddKernel have no code object behind them
+    return runtime().isExecutable(executable) ? HSA_STATUS_SUCCESS : HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+}
+
+hsa_status_t fakeLoaderLoadedCodeObjectGetInfo(hsa_loaded_code_object_t, hsa_ven_amd_loader_loaded_code_object_info_t,
+                                               void *)
+{
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+}
+
+} // namespace
+
+fakeRuntime::fakeRuntime() : core_(), amd_ext_(), finalizer_ext_(), image_ext_(), table_(), sequence_(0),
+    async_generation_(0)
+{
+    scheduled_ = completed_ = 0;
+    packets_ = dispatches_ = barriers_ = intercepted_ = signals_live_ = bytes_live_ = 0;
+
+    table_.version.major_id = HSA_API_TABLE_MAJOR_VERSION;
+    table_.version.minor_id = sizeof(HsaApiTable);
+    table_.core_ = &core_;
+    table_.amd_ext_ = &amd_ext_;
+    table_.finalizer_ext_ = &finalizer_ext_;
+    table_.image_ext_ = &image_ext_;
+
+    core_.version.major_id = HSA_CORE_API_TABLE_MAJOR_VERSION;
+    core_.version.minor_id = sizeof(CoreApiTable);
+    core_.hsa_init_fn = hsa_init;
+    core_.hsa_shut_down_fn = hsa_shut_down;
+    core_.hsa_status_string_fn = hsa_status_string;
+    core_.hsa_system_get_info_fn = hsa_system_get_info;
+    core_.hsa_system_get_major_extension_table_fn = hsa_system_get_major_extension_table;
+    core_.hsa_iterate_agents_fn = hsa_iterate_agents;
+    core_.hsa_agent_get_info_fn = hsa_agent_get_info;
+    core_.hsa_queue_create_fn = hsa_queue_create;
+    core_.hsa_queue_destroy_fn = hsa_queue_destroy;
+    core_.hsa_signal_create_fn = hsa_signal_create;
+    core_.hsa_signal_destroy_fn = hsa_signal_destroy;
+    core_.hsa_signal_load_scacquire_fn = hsa_signal_load_scacquire;
+    core_.hsa_signal_load_relaxed_fn = hsa_signal_load_relaxed;
+    core_.hsa_signal_store_screlease_fn = hsa_signal_store_screlease;
+    core_.hsa_signal_store_relaxed_fn = hsa_signal_store_relaxed;
+    core_.hsa_signal_add_scacq_screl_fn = hsa_signal_add_scacq_screl;
+    core_.hsa_signal_add_relaxed_fn = hsa_signal_add_relaxed;
+    core_.hsa_signal_subtract_scacq_screl_fn = hsa_signal_subtract_scacq_screl;
+    core_.hsa_signal_subtract_relaxed_fn = hsa_signal_subtract_relaxed;
+    core_.hsa_signal_wait_scacquire_fn = hsa_signal_wait_scacquire;
+    core_.hsa_signal_wait_relaxed_fn = hsa_signal_wait_relaxed;
+    core_.hsa_memory_copy_fn = hsa_memory_copy;
+    core_.hsa_executable_create_alt_fn = hsa_executable_create_alt;
+    core_.hsa_executable_destroy_fn = hsa_executable_destroy;
+    core_.hsa_executable_load_agent_code_object_fn = hsa_executable_load_agent_code_object;
+    core_.hsa_executable_freeze_fn = hsa_executable_freeze;
+    core_.hsa_executable_symbol_get_info_fn = hsa_executable_symbol_get_info;
+    core_.hsa_executable_iterate_symbols_fn = hsa_executable_iterate_symbols;
+    core_.hsa_code_object_reader_create_from_file_fn = hsa_code_object_reader_create_from_file;
+    core_.hsa_code_object_reader_destroy_fn = hsa_code_object_reader_destroy;
+
+    amd_ext_.version.major_id = HSA_AMD_EXT_API_TABLE_MAJOR_VERSION;
+    amd_ext_.version.minor_id = sizeof(AmdExtTable);
+    amd_ext_.hsa_amd_profiling_set_profiler_enabled_fn = hsa_amd_profiling_set_profiler_enabled;
+    amd_ext_.hsa_amd_profiling_get_dispatch_time_fn = hsa_amd_profiling_get_dispatch_time;
+    amd_ext_.hsa_amd_agent_iterate_memory_pools_fn = hsa_amd_agent_iterate_memory_pools;
+    amd_ext_.hsa_amd_memory_pool_get_info_fn = hsa_amd_memory_pool_get_info;
+    amd_ext_.hsa_amd_memory_pool_allocate_fn = hsa_amd_memory_pool_allocate;
+    amd_ext_.hsa_amd_memory_pool_free_fn = hsa_amd_memory_pool_free;
+    amd_ext_.hsa_amd_agents_allow_access_fn = hsa_amd_agents_allow_access;
+    amd_ext_.hsa_amd_queue_intercept_create_fn = hsa_amd_queue_intercept_create;
+    amd_ext_.hsa_amd_queue_intercept_register_fn = hsa_amd_queue_intercept_register;
+    amd_ext_.hsa_amd_signal_async_handler_fn = hsa_amd_signal_async_handler;
+
+    configure(fakeHsaConfig_t());
+    device_ = std::thread(&fakeRuntime::deviceLoop, this);
+    device_.detach();
+    async_ = std::thread(&fakeRuntime::asyncLoop, this);
+    async_.detach();
+}
+
+void fakeRuntime::configure(const fakeHsaConfig_t& config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    agents_.clear();
+    kernels_.clear();
+    kernel_storage_.clear();
+    program_.kernels_.clear();
+
+    auto add_agent = [&](hsa_device_type_t type, const std::string& name, hsa_amd_segment_t segment, uint32_t flags) {
+        auto agent = std::make_unique<fakeAgent>();
+        agent->type_ = type;
+        agent->name_ = name;
+        agent->node_ = static_cast<uint32_t>(agents_.size());
+        hsa_agent_t handle = {reinterpret_cast<uint64_t>(agent.get())};
+        agent->pools_.emplace_back(new fakePool{handle, segment, flags, true});
+        if (type == HSA_DEVICE_TYPE_GPU)
+            agent->pools_.emplace_back(new fakePool{handle, HSA_AMD_SEGMENT_GROUP, 0, false});
+        agents_.push_back(std::move(agent));
+    };
+    add_agent(HSA_DEVICE_TYPE_CPU, "Fake CPU", HSA_AMD_SEGMENT_GLOBAL,
+              HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_KERNARG_INIT | HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED);
+    for (uint32_t i = 0; i < config.gpu_agents_; i++)
+        add_agent(HSA_DEVICE_TYPE_GPU, config.gpu_name_, HSA_AMD_SEGMENT_GLOBAL,
+                  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED);
+}
+
+fakeAgent *fakeRuntime::agent(hsa_agent_t agent)
+{
+    for (auto& candidate : agents_)
+    {
+        if (reinterpret_cast<uint64_t>(candidate.get()) == agent.handle)
+            return candidate.get();
+    }
+    return NULL;
+}
+
+fakeKernel *fakeRuntime::kernel(uint64_t handle)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = kernels_.find(handle);
+    return it == kernels_.end() ? NULL : it->second;
+}
+
+bool fakeRuntime::isExecutable(hsa_executable_t executable)
+{
+    fakeExecutable *exec = reinterpret_cast<fakeExecutable *>(executable.handle);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return exec == &program_ || executables_.count(exec);
+}
+
+void fakeRuntime::write(fakeQueue *queue, const void *packets, uint64_t count)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(packets);
+    std::lock_guard<std::mutex> lock(mutex_);
+    fake_clock::time_point now = fake_clock::now();
+    for (uint64_t i = 0; i < count; i++)
+    {
+        const uint8_t *packet = bytes + i * FAKE_HSA_PACKET_SIZE;
+        uint16_t header;
+        memcpy(&header, packet, sizeof(header));
+        uint32_t type = (header >> HSA_PACKET_HEADER_TYPE) & ((1u << HSA_PACKET_HEADER_WIDTH_TYPE) - 1);
+        uint64_t latency = 0;
+        hsa_signal_t signal = {0};
+        switch (type)
+        {
+            case HSA_PACKET_TYPE_KERNEL_DISPATCH:
+            {
+                hsa_kernel_dispatch_packet_t dispatch;
+                memcpy(&dispatch, packet, sizeof(dispatch));
+                auto it = kernels_.find(dispatch.kernel_object);
+                latency = it != kernels_.end() ? it->second->latency_ns_ : config_.kernel_latency_ns_;
+                signal = dispatch.completion_signal;
+                dispatches_++;
+                break;
+            }
+            case HSA_PACKET_TYPE_BARRIER_AND:
+            case HSA_PACKET_TYPE_BARRIER_OR:
+            {
+                // Both barrier packets keep their completion signal in the same place
+                hsa_barrier_and_packet_t barrier;
+                memcpy(&barrier, packet, sizeof(barrier));
+                latency = config_.barrier_latency_ns_;
+                signal = barrier.completion_signal;
+                barriers_++;
+                break;
+            }
+            default:
+                break;
+        }
+        packets_++;
+        fakeWork work;
+        work.due_ = std::max(now, queue->busy_until_) + std::chrono::nanoseconds(latency);
+        work.sequence_ = sequence_++;
+        work.signal_ = signal;
+        work.start_ = queue->device_clock_;
+        work.end_ = queue->device_clock_ + latency;
+        queue->busy_until_ = work.due_;
+        queue->device_clock_ = work.end_;
+        work_.push(work);
+        scheduled_++;
+    }
+    work_cv_.notify_one();
+}
+
+void fakeRuntime::complete(const fakeWork& work)
+{
+    if (!work.signal_.handle)
+        return;
+    fakeSignal *signal = toSignal(work.signal_);
+    updateSignal(signal, [&]() {
+        signal->start_.store(work.start_);
+        signal->end_.store(work.end_);
+        signal->value_.fetch_sub(1);
+    });
+}
+
+void fakeRuntime::deviceLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        if (work_.empty())
+        {
+            work_cv_.wait(lock);
+            continue;
+        }
+        fakeWork next = work_.top();
+        fake_clock::time_point now = fake_clock::now();
+        if (now < next.due_)
+        {
+            if (next.due_ - now > std::chrono::nanoseconds(FAKE_HSA_SPIN_NS))
+                work_cv_.wait_until(lock, next.due_ - std::chrono::nanoseconds(FAKE_HSA_SPIN_NS));
+            else
+            {
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+            }
+            continue;
+        }
+        work_.pop();
+        lock.unlock();
+        complete(next);
+        lock.lock();
+        if (++completed_ == scheduled_)
+            idle_cv_.notify_all();
+    }
+}
+
+void fakeRuntime::addAsyncHandler(const fakeAsyncHandler& handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_handlers_.push_back(handler);
+        async_generation_++;
+    }
+    async_cv_.notify_one();
+}
+
+void fakeRuntime::removeAsyncHandlers(hsa_signal_t signal)
+{
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    async_handlers_.erase(std::remove_if(async_handlers_.begin(), async_handlers_.end(),
+                                         [&](const fakeAsyncHandler& handler) {
+                                             return handler.signal_.handle == signal.handle;
+                                         }),
+                          async_handlers_.end());
+}
+
+void fakeRuntime::signalChanged()
+{
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_generation_++;
+    }
+    async_cv_.notify_one();
+}
+
+void fakeRuntime::asyncLoop()
+{
+    std::unique_lock<std::mutex> lock(async_mutex_);
+    uint64_t seen = 0;
+    while (true)
+    {
+        async_cv_.wait(lock, [&]() { return async_generation_ != seen; });
+        seen = async_generation_;
+        // Conditions are checked under the lock so a signal can't be destroyed mid-check; handlers run outside it
+        std::vector<std::pair<fakeAsyncHandler, hsa_signal_value_t>> ready;
+        for (auto it = async_handlers_.begin(); it != async_handlers_.end();)
+        {
+            hsa_signal_value_t value = toSignal(it->signal_)->value_.load();
+            if (signalSatisfied(value, it->condition_, it->compare_))
+            {
+                ready.emplace_back(*it, value);
+                it = async_handlers_.erase(it);
+            }
+            else
+                ++it;
+        }
+        if (ready.empty())
+            continue;
+        lock.unlock();
+        std::vector<fakeAsyncHandler> keep;
+        for (auto& entry : ready)
+        {
+            if (entry.first.handler_(entry.second, entry.first.arg_))
+                keep.push_back(entry.first);
+        }
+        lock.lock();
+        if (!keep.empty())
+        {
+            async_handlers_.insert(async_handlers_.end(), keep.begin(), keep.end());
+            async_generation_++;
+        }
+    }
+}
+
+void fakeHsaConfigure(const fakeHsaConfig_t& config)
+{
+    runtime().configure(config);
+}
+
+HsaApiTable *fakeHsaApiTable()
+{
+    return &runtime().table_;
+}
+
+std::vector<hsa_agent_t> fakeHsaGpuAgents()
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    std::vector<hsa_agent_t> gpus;
+    for (auto& agent : rt.agents_)
+    {
+        if (agent->type_ == HSA_DEVICE_TYPE_GPU)
+            gpus.push_back({reinterpret_cast<uint64_t>(agent.get())});
+    }
+    return gpus;
+}
+
+hsa_agent_t fakeHsaCpuAgent()
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    return {reinterpret_cast<uint64_t>(rt.agents_.front().get())};
+}
+
+hsa_executable_symbol_t fakeHsaAddKernel(hsa_agent_t agent, const std::string& name, uint32_t kernarg_size,
+                                         uint64_t latency_ns)
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    auto kernel = std::make_unique<fakeKernel>();
+    memset(&kernel->code_, 0, sizeof(kernel->code_));
+    kernel->code_.kernarg_segment_byte_size = kernarg_size;
+    kernel->code_.kernarg_segment_alignment = 4; // log2 of 16 bytes
+    kernel->name_ = name;
+    kernel->agent_ = agent;
+    kernel->kernarg_size_ = kernarg_size;
+    kernel->latency_ns_ = latency_ns ? latency_ns : rt.config_.kernel_latency_ns_;
+    uint64_t handle = reinterpret_cast<uint64_t>(kernel.get());
+    rt.kernels_[handle] = kernel.get();
+    rt.program_.kernels_.push_back(kernel.get());
+    rt.kernel_storage_.push_back(std::move(kernel));
+    return {handle};
+}
+
+void fakeHsaSubmit(hsa_queue_t *queue, const void *packets, uint64_t count)
+{
+    fakeQueue *fq = toQueue(queue);
+    std::lock_guard<std::mutex> lock(fq->submit_mutex_);
+    uint64_t index = fq->packet_index_;
+    fq->packet_index_ += count;
+    if (fq->handler_)
+    {
+        runtime().intercepted_ += count;
+        fakeQueue *previous = writing_queue;
+        writing_queue = fq;
+        fq->handler_(packets, count, index, fq->handler_data_, interceptWriter);
+        writing_queue = previous;
+    }
+    else
+        runtime().write(fq, packets, count);
+}
+
+bool fakeHsaDrain(uint64_t timeout_ns)
+{
+    fakeRuntime& rt = runtime();
+    std::unique_lock<std::mutex> lock(rt.mutex_);
+    return rt.idle_cv_.wait_for(lock, std::chrono::nanoseconds(timeout_ns),
+                                [&]() { return rt.completed_ == rt.scheduled_; });
+}
+
+fakeHsaStats_t fakeHsaStats()
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeHsaStats_t stats;
+    stats.packets_ = rt.packets_;
+    stats.dispatches_ = rt.dispatches_;
+    stats.barriers_ = rt.barriers_;
+    stats.completed_ = rt.completed_;
+    stats.intercepted_ = rt.intercepted_;
+    stats.signals_live_ = rt.signals_live_;
+    stats.queues_live_ = rt.queues_.size();
+    stats.allocations_live_ = rt.allocations_.size();
+    stats.bytes_live_ = rt.bytes_live_;
+    return stats;
+}
+
+/* The HSA entry points. These definitions take precedence over libhsa-runtime64 in executables that export them,
+ * and fill the fake API table. */
+
+hsa_status_t hsa_init()
+{
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_shut_down()
+{
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_status_string(hsa_status_t status, const char **status_string)
+{
+    if (!status_string)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    switch (status)
+    {
+        case HSA_STATUS_SUCCESS:
+            *status_string = "HSA_STATUS_SUCCESS";
+            break;
+        case HSA_STATUS_ERROR_INVALID_ARGUMENT:
+            *status_string = "HSA_STATUS_ERROR_INVALID_ARGUMENT";
+            break;
+        case HSA_STATUS_ERROR_INVALID_AGENT:
+            *status_string = "HSA_STATUS_ERROR_INVALID_AGENT";
+            break;
+        case HSA_STATUS_ERROR_INVALID_QUEUE:
+            *status_string = "HSA_STATUS_ERROR_INVALID_QUEUE";
+            break;
+        case HSA_STATUS_ERROR_INVALID_SIGNAL:
+            *status_string = "HSA_STATUS_ERROR_INVALID_SIGNAL";
+            break;
+        case HSA_STATUS_ERROR_INVALID_FILE:
+            *status_string = "HSA_STATUS_ERROR_INVALID_FILE";
+            break;
+        case HSA_STATUS_ERROR_INVALID_CODE_OBJECT:
+            *status_string = "HSA_STATUS_ERROR_INVALID_CODE_OBJECT";
+            break;
+        default:
+            *status_string = "HSA_STATUS_ERROR (fake runtime)";
+            break;
+    }
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_system_get_info(hsa_system_info_t attribute, void *value)
+{
+    switch (attribute)
+    {
+        case HSA_SYSTEM_INFO_VERSION_MAJOR:
+        case HSA_SYSTEM_INFO_VERSION_MINOR:
+            *static_cast<uint16_t *>(value) = 1;
+            return HSA_STATUS_SUCCESS;
+        case HSA_SYSTEM_INFO_TIMESTAMP:
+            *static_cast<uint64_t *>(value) = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(fake_clock::now().time_since_epoch()).count());
+            return HSA_STATUS_SUCCESS;
+        case HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY:
+            *static_cast<uint64_t *>(value) = 1000000000ull;
+            return HSA_STATUS_SUCCESS;
+        case HSA_SYSTEM_INFO_SIGNAL_MAX_WAIT:
+            *static_cast<uint64_t *>(value) = UINT64_MAX;
+            return HSA_STATUS_SUCCESS;
+        default:
+            return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t version_major, size_t table_length,
+                                                  void *table)
+{
+    if (extension != HSA_EXTENSION_AMD_LOADER || version_major != 1 || !table)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    hsa_ven_amd_loader_1_01_pfn_t loader = {};
+    loader.hsa_ven_amd_loader_query_host_address = fakeLoaderQueryHostAddress;
+    loader.hsa_ven_amd_loader_query_segment_descriptors = fakeLoaderQuerySegmentDescriptors;
+    loader.hsa_ven_amd_loader_query_executable = fakeLoaderQueryExecutable;
+    loader.hsa_ven_amd_loader_executable_iterate_loaded_code_objects = fakeLoaderIterateLoadedCodeObjects;
+    loader.hsa_ven_amd_loader_loaded_code_object_get_info = fakeLoaderLoadedCodeObjectGetInfo;
+    // Newer minor versions of the table are left with NULL entries
+    memset(table, 0, table_length);
+    memcpy(table, &loader, std::min(table_length, sizeof(loader)));
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_iterate_agents(hsa_status_t (*callback)(hsa_agent_t agent, void *data), void *data)
+{
+    if (!callback)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    std::vector<hsa_agent_t> agents;
+    {
+        fakeRuntime& rt = runtime();
+        std::lock_guard<std::mutex> lock(rt.mutex_);
+        for (auto& agent : rt.agents_)
+            agents.push_back({reinterpret_cast<uint64_t>(agent.get())});
+    }
+    for (auto agent : agents)
+    {
+        hsa_status_t status = callback(agent, data);
+        if (status != HSA_STATUS_SUCCESS)
+            return status;
+    }
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_agent_get_info(hsa_agent_t agent, hsa_agent_info_t attribute, void *value)
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeAgent *fa = rt.agent(agent);
+    if (!fa)
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+    if (!value)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    switch (static_cast<int>(attribute))
+    {
+        case HSA_AGENT_INFO_NAME:
+            copyString(value, fa->name_);
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_VENDOR_NAME:
+            copyString(value, "AMD");
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_DEVICE:
+            *static_cast<hsa_device_type_t *>(value) = fa->type_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_NODE:
+            *static_cast<uint32_t *>(value) = fa->node_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_PROFILE:
+            *static_cast<hsa_profile_t *>(value) = HSA_PROFILE_BASE;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_WAVEFRONT_SIZE:
+            *static_cast<uint32_t *>(value) = 64;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_QUEUES_MAX:
+            *static_cast<uint32_t *>(value) = fa->type_ == HSA_DEVICE_TYPE_GPU ? 128 : 0;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AGENT_INFO_QUEUE_MAX_SIZE:
+            *static_cast<uint32_t *>(value) = fa->type_ == HSA_DEVICE_TYPE_GPU ? 131072 : 0;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT:
+            *static_cast<uint32_t *>(value) = fa->type_ == HSA_DEVICE_TYPE_GPU ? 104 : 1;
+            return HSA_STATUS_SUCCESS;
+        default:
+            return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+static hsa_status_t createQueue(hsa_agent_t agent, uint32_t size, bool intercept, hsa_queue_t **queue)
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeAgent *fa = rt.agent(agent);
+    if (!fa || fa->type_ != HSA_DEVICE_TYPE_GPU)
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+    if (!queue || size == 0 || (size & (size - 1)))
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    fakeQueue *fq = new fakeQueue();
+    fq->agent_ = agent;
+    fq->intercept_ = intercept;
+    fq->handler_ = NULL;
+    fq->handler_data_ = NULL;
+    fq->profiling_ = false;
+    fq->doorbell_.value_ = 0;
+    fq->ring_.resize(static_cast<size_t>(size) * FAKE_HSA_PACKET_SIZE);
+    fq->packet_index_ = 0;
+    fq->busy_until_ = fake_clock::time_point();
+    fq->device_clock_ = 0;
+    memset(&fq->queue_, 0, sizeof(fq->queue_));
+    fq->queue_.type = HSA_QUEUE_TYPE_MULTI;
+    fq->queue_.features = HSA_QUEUE_FEATURE_KERNEL_DISPATCH;
+    fq->queue_.base_address = fq->ring_.data();
+    fq->queue_.doorbell_signal.handle = reinterpret_cast<uint64_t>(&fq->doorbell_);
+    fq->queue_.size = size;
+    fq->queue_.id = rt.queues_.size();
+    rt.queues_.insert(fq);
+    *queue = &fq->queue_;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_queue_create(hsa_agent_t agent, uint32_t size, hsa_queue_type32_t,
+                              void (*)(hsa_status_t status, hsa_queue_t *source, void *data), void *, uint32_t,
+                              uint32_t, hsa_queue_t **queue)
+{
+    return createQueue(agent, size, false, queue);
+}
+
+hsa_status_t hsa_amd_queue_intercept_create(hsa_agent_t agent_handle, uint32_t size, hsa_queue_type32_t,
+                                            void (*)(hsa_status_t status, hsa_queue_t *source, void *data), void *,
+                                            uint32_t, uint32_t, hsa_queue_t **queue)
+{
+    return createQueue(agent_handle, size, true, queue);
+}
+
+hsa_status_t hsa_amd_queue_intercept_register(hsa_queue_t *queue, hsa_amd_queue_intercept_handler callback,
+                                              void *user_data)
+{
+    fakeRuntime& rt = runtime();
+    fakeQueue *fq = toQueue(queue);
+    {
+        std::lock_guard<std::mutex> lock(rt.mutex_);
+        if (!rt.queues_.count(fq) || !fq->intercept_)
+            return HSA_STATUS_ERROR_INVALID_QUEUE;
+    }
+    // Doorbells take the queue's lock before the runtime's, so don't hold both here
+    std::lock_guard<std::mutex> submit_lock(fq->submit_mutex_);
+    fq->handler_ = callback;
+    fq->handler_data_ = user_data;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_queue_destroy(hsa_queue_t *queue)
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeQueue *fq = toQueue(queue);
+    if (!rt.queues_.erase(fq))
+        return HSA_STATUS_ERROR_INVALID_QUEUE;
+    delete fq;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_signal_create(hsa_signal_value_t initial_value, uint32_t, const hsa_agent_t *, hsa_signal_t *signal)
+{
+    if (!signal)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    fakeSignal *fs = new fakeSignal();
+    fs->value_ = initial_value;
+    fs->start_ = 0;
+    fs->end_ = 0;
+    signal->handle = reinterpret_cast<uint64_t>(fs);
+    runtime().signals_live_++;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_signal_destroy(hsa_signal_t signal)
+{
+    if (!signal.handle)
+        return HSA_STATUS_ERROR_INVALID_SIGNAL;
+    runtime().removeAsyncHandlers(signal);
+    fakeSignal *fs = toSignal(signal);
+    {
+        std::lock_guard<std::mutex> lock(fs->mutex_);
+    }
+    delete fs;
+    runtime().signals_live_--;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_signal_value_t hsa_signal_load_scacquire(hsa_signal_t signal)
+{
+    return toSignal(signal)->value_.load();
+}
+
+hsa_signal_value_t hsa_signal_load_relaxed(hsa_signal_t signal)
+{
+    return toSignal(signal)->value_.load(std::memory_order_relaxed);
+}
+
+void hsa_signal_store_screlease(hsa_signal_t signal, hsa_signal_value_t value)
+{
+    fakeSignal *fs = toSignal(signal);
+    updateSignal(fs, [&]() { fs->value_.store(value); });
+}
+
+void hsa_signal_store_relaxed(hsa_signal_t signal, hsa_signal_value_t value)
+{
+    hsa_signal_store_screlease(signal, value);
+}
+
+void hsa_signal_add_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value)
+{
+    fakeSignal *fs = toSignal(signal);
+    updateSignal(fs, [&]() { fs->value_.fetch_add(value); });
+}
+
+void hsa_signal_add_relaxed(hsa_signal_t signal, hsa_signal_value_t value)
+{
+    hsa_signal_add_scacq_screl(signal, value);
+}
+
+void hsa_signal_subtract_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value)
+{
+    fakeSignal *fs = toSignal(signal);
+    updateSignal(fs, [&]() { fs->value_.fetch_sub(value); });
+}
+
+void hsa_signal_subtract_relaxed(hsa_signal_t signal, hsa_signal_value_t value)
+{
+    hsa_signal_subtract_scacq_screl(signal, value);
+}
+
+hsa_signal_value_t hsa_signal_wait_scacquire(hsa_signal_t signal, hsa_signal_condition_t condition,
+                                             hsa_signal_value_t compare_value, uint64_t timeout_hint,
+                                             hsa_wait_state_t)
+{
+    return waitSignal(signal, condition, compare_value, timeout_hint);
+}
+
+hsa_signal_value_t hsa_signal_wait_relaxed(hsa_signal_t signal, hsa_signal_condition_t condition,
+                                           hsa_signal_value_t compare_value, uint64_t timeout_hint,
+                                           hsa_wait_state_t)
+{
+    return waitSignal(signal, condition, compare_value, timeout_hint);
+}
+
+hsa_status_t hsa_amd_signal_async_handler(hsa_signal_t signal, hsa_signal_condition_t cond, hsa_signal_value_t value,
+                                          hsa_amd_signal_handler handler, void *arg)
+{
+    if (!signal.handle || !handler)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    runtime().addAsyncHandler({signal, cond, value, handler, arg});
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_profiling_set_profiler_enabled(hsa_queue_t *queue, int enable)
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeQueue *fq = toQueue(queue);
+    if (!rt.queues_.count(fq))
+        return HSA_STATUS_ERROR_INVALID_QUEUE;
+    fq->profiling_ = enable != 0;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_profiling_get_dispatch_time(hsa_agent_t, hsa_signal_t signal,
+                                                 hsa_amd_profiling_dispatch_time_t *time)
+{
+    if (!signal.handle)
+        return HSA_STATUS_ERROR_INVALID_SIGNAL;
+    if (!time)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    time->start = toSignal(signal)->start_.load();
+    time->end = toSignal(signal)->end_.load();
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_agent_iterate_memory_pools(hsa_agent_t agent,
+                                                hsa_status_t (*callback)(hsa_amd_memory_pool_t memory_pool, void *data),
+                                                void *data)
+{
+    std::vector<hsa_amd_memory_pool_t> pools;
+    {
+        fakeRuntime& rt = runtime();
+        std::lock_guard<std::mutex> lock(rt.mutex_);
+        fakeAgent *fa = rt.agent(agent);
+        if (!fa)
+            return HSA_STATUS_ERROR_INVALID_AGENT;
+        for (auto& pool : fa->pools_)
+            pools.push_back({reinterpret_cast<uint64_t>(pool.get())});
+    }
+    if (!callback)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    for (auto pool : pools)
+    {
+        hsa_status_t status = callback(pool, data);
+        if (status != HSA_STATUS_SUCCESS)
+            return status;
+    }
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_memory_pool_get_info(hsa_amd_memory_pool_t memory_pool, hsa_amd_memory_pool_info_t attribute,
+                                          void *value)
+{
+    fakePool *pool = toPool(memory_pool);
+    if (!pool || !value)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    bool global = pool->segment_ == HSA_AMD_SEGMENT_GLOBAL;
+    switch (attribute)
+    {
+        case HSA_AMD_MEMORY_POOL_INFO_SEGMENT:
+            *static_cast<hsa_amd_segment_t *>(value) = pool->segment_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS:
+            *static_cast<uint32_t *>(value) = pool->global_flags_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AMD_MEMORY_POOL_INFO_SIZE:
+            *static_cast<size_t *>(value) = global ? runtime().config_.pool_size_ : 64 * 1024;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED:
+            *static_cast<bool *>(value) = pool->alloc_allowed_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE:
+        case HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT:
+            *static_cast<size_t *>(value) = pool->alloc_allowed_ ? FAKE_HSA_ALLOC_GRANULE : 0;
+            return HSA_STATUS_SUCCESS;
+        case HSA_AMD_MEMORY_POOL_INFO_ACCESSIBLE_BY_ALL:
+            *static_cast<bool *>(value) = global;
+            return HSA_STATUS_SUCCESS;
+        default:
+            return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+hsa_status_t hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool, size_t size, uint32_t, void **ptr)
+{
+    fakePool *pool = toPool(memory_pool);
+    if (!pool || !ptr || size == 0)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    if (!pool->alloc_allowed_)
+        return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+    size = (size + FAKE_HSA_ALLOC_GRANULE - 1) & ~static_cast<size_t>(FAKE_HSA_ALLOC_GRANULE - 1);
+    void *memory = NULL;
+    if (posix_memalign(&memory, FAKE_HSA_ALLOC_GRANULE, size))
+        return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    rt.allocations_[memory] = size;
+    rt.bytes_live_ += size;
+    *ptr = memory;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_memory_pool_free(void *ptr)
+{
+    fakeRuntime& rt = runtime();
+    {
+        std::lock_guard<std::mutex> lock(rt.mutex_);
+        auto it = rt.allocations_.find(ptr);
+        if (it == rt.allocations_.end())
+            return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        rt.bytes_live_ -= it->second;
+        rt.allocations_.erase(it);
+    }
+    free(ptr);
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_agents_allow_access(uint32_t num_agents, const hsa_agent_t *agents, const uint32_t *,
+                                         const void *ptr)
+{
+    if (!num_agents || !agents || !ptr)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_memory_copy(void *dst, const void *src, size_t size)
+{
+    if (!dst || !src)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    memcpy(dst, src, size);
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_executable_create_alt(hsa_profile_t, hsa_default_float_rounding_mode_t, const char *,
+                                       hsa_executable_t *executable)
+{
+    if (!executable)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeExecutable *exec = new fakeExecutable();
+    rt.executables_.insert(exec);
+    executable->handle = reinterpret_cast<uint64_t>(exec);
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_executable_destroy(hsa_executable_t executable)
+{
+    fakeRuntime& rt = runtime();
+    std::lock_guard<std::mutex> lock(rt.mutex_);
+    fakeExecutable *exec = reinterpret_cast<fakeExecutable *>(executable.handle);
+    if (!rt.executables_.erase(exec))
+        return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+    delete exec;
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_code_object_reader_create_from_file(hsa_file_t, hsa_code_object_reader_t *)
+{
+    // There is no loader behind the fake
+    return HSA_STATUS_ERROR_INVALID_FILE;
+}
+
+hsa_status_t hsa_code_object_reader_destroy(hsa_code_object_reader_t)
+{
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_executable_load_agent_code_object(hsa_executable_t, hsa_agent_t, hsa_code_object_reader_t,
+                                                   const char *, hsa_loaded_code_object_t *)
+{
+    return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+}
+
+hsa_status_t hsa_executable_freeze(hsa_executable_t executable, const char *)
+{
+    return runtime().isExecutable(executable) ? HSA_STATUS_SUCCESS : HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+}
+
+hsa_status_t hsa_executable_iterate_symbols(hsa_executable_t executable,
+                                            hsa_status_t (*callback)(hsa_executable_t exec,
+                                                                     hsa_executable_symbol_t symbol, void *data),
+                                            void *data)
+{
+    std::vector<fakeKernel *> kernels;
+    {
+        fakeRuntime& rt = runtime();
+        std::lock_guard<std::mutex> lock(rt.mutex_);
+        fakeExecutable *exec = reinterpret_cast<fakeExecutable *>(executable.handle);
+        if (exec != &rt.program_ && !rt.executables_.count(exec))
+            return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+        kernels = exec->kernels_;
+    }
+    if (!callback)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    for (fakeKernel *kernel : kernels)
+    {
+        hsa_status_t status = callback(executable, {reinterpret_cast<uint64_t>(kernel)}, data);
+        if (status != HSA_STATUS_SUCCESS)
+            return status;
+    }
+    return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_executable_symbol_get_info(hsa_executable_symbol_t executable_symbol,
+                                            hsa_executable_symbol_info_t attribute, void *value)
+{
+    fakeKernel *kernel = runtime().kernel(executable_symbol.handle);
+    if (!kernel)
+        return HSA_STATUS_ERROR_INVALID_EXECUTABLE_SYMBOL;
+    if (!value)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    switch (attribute)
+    {
+        case HSA_EXECUTABLE_SYMBOL_INFO_TYPE:
+            *static_cast<hsa_symbol_kind_t *>(value) = HSA_SYMBOL_KIND_KERNEL;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_NAME_LENGTH:
+            *static_cast<uint32_t *>(value) = static_cast<uint32_t>(kernel->name_.length());
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_NAME:
+            // Like the runtime, the name isn't NUL terminated
+            memcpy(value, kernel->name_.data(), kernel->name_.length());
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_AGENT:
+            *static_cast<hsa_agent_t *>(value) = kernel->agent_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_LINKAGE:
+            *static_cast<hsa_symbol_linkage_t *>(value) = HSA_SYMBOL_LINKAGE_PROGRAM;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_IS_DEFINITION:
+            *static_cast<bool *>(value) = true;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT:
+            *static_cast<uint64_t *>(value) = reinterpret_cast<uint64_t>(&kernel->code_);
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_KERNARG_SEGMENT_SIZE:
+            *static_cast<uint32_t *>(value) = kernel->kernarg_size_;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_KERNARG_SEGMENT_ALIGNMENT:
+            *static_cast<uint32_t *>(value) = 16;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_GROUP_SEGMENT_SIZE:
+        case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_PRIVATE_SEGMENT_SIZE:
+            *static_cast<uint32_t *>(value) = 0;
+            return HSA_STATUS_SUCCESS;
+        case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_DYNAMIC_CALLSTACK:
+            *static_cast<bool *>(value) = false;
+            return HSA_STATUS_SUCCESS;
+        default:
+            return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+}
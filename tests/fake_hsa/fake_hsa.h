@@ -0,0 +1,95 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <hsa.h>
+#include <hsa_ext_amd.h>
+#include <hsa_api_trace.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* A deterministic, CPU-only stand-in for the HSA runtime, for driving the interception and completion pipeline
+ * (hsaInterceptor, its signal pool, coCache, KernArgAllocator) without a GPU.
+ *
+ * The fake defines the hsa_* entry points the interceptor calls directly, and fakeHsaApiTable() returns an
+ * HsaApiTable whose core and AMD extension tables point at the same functions. Test executables export those
+ * definitions (ENABLE_EXPORTS), so logDuration64 binds to them instead of libhsa-runtime64. Entries of the API
+ * table the fake doesn't implement are left NULL, so an unexpected call fails loudly.
+ *
+ * What is simulated:
+ *   - agents: one CPU agent and config.gpu_agents_ GPU agents, each with a global memory pool (KERNARG_INIT on the
+ *     CPU, coarse grained on the GPUs). Pool allocations are plain host memory.
+ *   - signals: host atomics. Waits block on a condition variable; timeouts are in nanoseconds, which is what
+ *     HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY reports. Handlers from hsa_amd_signal_async_handler run on a thread
+ *     of the fake's own, as in the runtime.
+ *   - queues: plain and intercept queues. Packets written to a queue execute in order: a kernel dispatch takes
+ *     its kernel's latency (config.kernel_latency_ns_ unless given to fakeHsaAddKernel), a barrier packet takes
+ *     config.barrier_latency_ns_. Barrier dependency signals are not waited on.
+ *   - profiling: completion signals carry start/end timestamps from a per-queue device clock that starts at zero
+ *     and advances by exactly each packet's latency, so recorded durations are reproducible run to run.
+ *   - executables: fakeHsaAddKernel registers a kernel symbol. Real code objects can't be loaded, so
+ *     hsa_executable_load_agent_code_object fails and instrumented dispatch is out of reach.
+ *
+ * Tests inject packets with fakeHsaSubmit, which stands in for ringing a queue's doorbell: on an intercept queue
+ * it calls the registered handler (hsaInterceptor::OnSubmitPackets) with a writer that feeds the simulated
+ * hardware queue. */
+
+typedef struct {
+    uint32_t gpu_agents_ = 1;
+    uint64_t kernel_latency_ns_ = 10000; // Wall-clock run time of a dispatch on the simulated hardware queue
+    uint64_t barrier_latency_ns_ = 0;
+    uint64_t pool_size_ = 16ull << 30;  // Reported size of every global memory pool
+    std::string gpu_name_ = "gfx90a";
+} fakeHsaConfig_t;
+
+typedef struct {
+    uint64_t packets_;           // Packets that reached a simulated hardware queue
+    uint64_t dispatches_;
+    uint64_t barriers_;
+    uint64_t completed_;         // Packets that have finished executing
+    uint64_t intercepted_;       // Packets handed to an intercept handler
+    uint64_t signals_live_;
+    uint64_t queues_live_;
+    uint64_t allocations_live_;
+    uint64_t bytes_live_;
+} fakeHsaStats_t;
+
+// Resets the fake to the given configuration. Call before handing the API table to anything, and only while no
+// queues, signals or allocations are live.
+void fakeHsaConfigure(const fakeHsaConfig_t& config);
+HsaApiTable *fakeHsaApiTable();
+std::vector<hsa_agent_t> fakeHsaGpuAgents();
+hsa_agent_t fakeHsaCpuAgent();
+
+// Registers a kernel on the agent and returns its symbol. A latency of zero means config.kernel_latency_ns_.
+hsa_executable_symbol_t fakeHsaAddKernel(hsa_agent_t agent, const std::string& name, uint32_t kernarg_size,
+                                         uint64_t latency_ns = 0);
+
+// Rings the queue's doorbell for count 64 byte AQL packets
+void fakeHsaSubmit(hsa_queue_t *queue, const void *packets, uint64_t count);
+
+// Waits until every packet written so far has completed. Returns false on timeout.
+bool fakeHsaDrain(uint64_t timeout_ns);
+
+fakeHsaStats_t fakeHsaStats();
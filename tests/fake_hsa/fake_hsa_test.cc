@@ -0,0 +1,401 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "fake_hsa.h"
+#include "unit_test.h"
+
+#include <amd_hsa_kernel_code.h>
+#include <hsa_ven_amd_loader.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const uint64_t SECOND_NS = 1000000000ull;
+
+hsa_kernel_dispatch_packet_t dispatchPacket(uint64_t kernel_object, hsa_signal_t signal)
+{
+    hsa_kernel_dispatch_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.header = HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE;
+    packet.kernel_object = kernel_object;
+    packet.completion_signal = signal;
+    return packet;
+}
+
+hsa_barrier_and_packet_t barrierPacket(hsa_signal_t signal)
+{
+    hsa_barrier_and_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.header = HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE;
+    packet.completion_signal = signal;
+    return packet;
+}
+
+uint64_t kernelObject(hsa_executable_symbol_t symbol)
+{
+    uint64_t object = 0;
+    CHECK_EQ(hsa_executable_symbol_get_info(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT, &object),
+             HSA_STATUS_SUCCESS);
+    return object;
+}
+
+void testAgentsAndPools()
+{
+    fakeHsaConfig_t config;
+    config.gpu_agents_ = 2;
+    fakeHsaConfigure(config);
+
+    std::vector<hsa_agent_t> agents;
+    CHECK_EQ(hsa_iterate_agents([](hsa_agent_t agent, void *data) {
+                 static_cast<std::vector<hsa_agent_t> *>(data)->push_back(agent);
+                 return HSA_STATUS_SUCCESS;
+             }, &agents), HSA_STATUS_SUCCESS);
+    CHECK_EQ(agents.size(), 3u);
+    CHECK_EQ(fakeHsaGpuAgents().size(), 2u);
+
+    hsa_device_type_t type;
+    CHECK_EQ(hsa_agent_get_info(fakeHsaGpuAgents()[1], HSA_AGENT_INFO_DEVICE, &type), HSA_STATUS_SUCCESS);
+    CHECK_EQ(type, HSA_DEVICE_TYPE_GPU);
+    char name[64];
+    CHECK_EQ(hsa_agent_get_info(fakeHsaGpuAgents()[0], HSA_AGENT_INFO_NAME, name), HSA_STATUS_SUCCESS);
+    CHECK_EQ(std::string(name), config.gpu_name_);
+    hsa_agent_t bogus = {42};
+    CHECK_EQ(hsa_agent_get_info(bogus, HSA_AGENT_INFO_DEVICE, &type), HSA_STATUS_ERROR_INVALID_AGENT);
+
+    // The CPU agent has the kernarg pool KernArgAllocator looks for
+    hsa_amd_memory_pool_t kernarg_pool = {0};
+    hsa_amd_agent_iterate_memory_pools(fakeHsaCpuAgent(), [](hsa_amd_memory_pool_t pool, void *data) {
+        uint32_t flags = 0;
+        hsa_amd_memory_pool_get_info(pool, HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS, &flags);
+        if (flags & HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_KERNARG_INIT)
+            *static_cast<hsa_amd_memory_pool_t *>(data) = pool;
+        return HSA_STATUS_SUCCESS;
+    }, &kernarg_pool);
+    CHECK(kernarg_pool.handle != 0);
+
+    fakeHsaStats_t before = fakeHsaStats();
+    void *memory = NULL;
+    CHECK_EQ(hsa_amd_memory_pool_allocate(kernarg_pool, 100, 0, &memory), HSA_STATUS_SUCCESS);
+    CHECK(memory != NULL);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(memory) % 4096, 0u);
+    CHECK_EQ(fakeHsaStats().allocations_live_, before.allocations_live_ + 1);
+    CHECK_EQ(fakeHsaStats().bytes_live_, before.bytes_live_ + 4096);
+    CHECK_EQ(hsa_amd_agents_allow_access(1, &agents[1], NULL, memory), HSA_STATUS_SUCCESS);
+    CHECK_EQ(hsa_amd_memory_pool_free(memory), HSA_STATUS_SUCCESS);
+    CHECK_EQ(hsa_amd_memory_pool_free(memory), HSA_STATUS_ERROR_INVALID_ARGUMENT);
+    CHECK_EQ(fakeHsaStats().bytes_live_, before.bytes_live_);
+}
+
+void testSignals()
+{
+    uint64_t live = fakeHsaStats().signals_live_;
+    hsa_signal_t signal;
+    CHECK_EQ(hsa_signal_create(2, 0, NULL, &signal), HSA_STATUS_SUCCESS);
+    CHECK_EQ(fakeHsaStats().signals_live_, live + 1);
+
+    // A wait that times out returns the current value
+    CHECK_EQ(hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_EQ, 0, 1000, HSA_WAIT_STATE_ACTIVE), 2);
+    CHECK_EQ(hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, 3, UINT64_MAX, HSA_WAIT_STATE_BLOCKED), 2);
+
+    std::thread decrementer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        hsa_signal_subtract_scacq_screl(signal, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        hsa_signal_subtract_scacq_screl(signal, 1);
+    });
+    CHECK_EQ(hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX, HSA_WAIT_STATE_BLOCKED), 0);
+    decrementer.join();
+
+    hsa_signal_store_screlease(signal, 7);
+    CHECK_EQ(hsa_signal_load_scacquire(signal), 7);
+    CHECK_EQ(hsa_signal_destroy(signal), HSA_STATUS_SUCCESS);
+    CHECK_EQ(fakeHsaStats().signals_live_, live);
+}
+
+struct asyncState {
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<hsa_signal_value_t> values_;
+    std::thread::id thread_;
+    bool keep_;
+};
+
+bool recordAsync(hsa_signal_value_t value, void *arg)
+{
+    asyncState *state = static_cast<asyncState *>(arg);
+    std::lock_guard<std::mutex> lock(state->mutex_);
+    state->values_.push_back(value);
+    state->thread_ = std::this_thread::get_id();
+    state->cv_.notify_all();
+    return state->keep_;
+}
+
+bool waitAsync(asyncState& state, size_t count)
+{
+    std::unique_lock<std::mutex> lock(state.mutex_);
+    return state.cv_.wait_for(lock, std::chrono::seconds(5), [&]() { return state.values_.size() >= count; });
+}
+
+size_t asyncCount(asyncState& state)
+{
+    std::lock_guard<std::mutex> lock(state.mutex_);
+    return state.values_.size();
+}
+
+void testAsyncHandlers()
+{
+    hsa_signal_t signal;
+    hsa_signal_create(2, 0, NULL, &signal);
+    asyncState once;
+    once.keep_ = false;
+    CHECK_EQ(hsa_amd_signal_async_handler(signal, HSA_SIGNAL_CONDITION_EQ, 0, recordAsync, &once), HSA_STATUS_SUCCESS);
+    hsa_signal_subtract_scacq_screl(signal, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    CHECK_EQ(asyncCount(once), 0u);
+    hsa_signal_subtract_scacq_screl(signal, 1);
+    CHECK(waitAsync(once, 1));
+    CHECK_EQ(once.values_[0], 0);
+    // Handlers run on the runtime's own thread
+    CHECK(once.thread_ != std::this_thread::get_id());
+
+    // Returning false unregisters the handler
+    hsa_signal_store_screlease(signal, 1);
+    hsa_signal_store_screlease(signal, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    CHECK_EQ(asyncCount(once), 1u);
+
+    // A condition that already holds fires right away
+    asyncState again;
+    again.keep_ = false;
+    CHECK_EQ(hsa_amd_signal_async_handler(signal, HSA_SIGNAL_CONDITION_LT, 1, recordAsync, &again), HSA_STATUS_SUCCESS);
+    CHECK(waitAsync(again, 1));
+
+    // Destroying a signal drops its handlers
+    asyncState dropped;
+    dropped.keep_ = true;
+    hsa_signal_store_screlease(signal, 5);
+    CHECK_EQ(hsa_amd_signal_async_handler(signal, HSA_SIGNAL_CONDITION_EQ, 0, recordAsync, &dropped), HSA_STATUS_SUCCESS);
+    CHECK_EQ(hsa_signal_destroy(signal), HSA_STATUS_SUCCESS);
+    CHECK_EQ(hsa_amd_signal_async_handler({0}, HSA_SIGNAL_CONDITION_EQ, 0, recordAsync, &dropped),
+             HSA_STATUS_ERROR_INVALID_ARGUMENT);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    CHECK_EQ(asyncCount(dropped), 0u);
+}
+
+void testDispatchLatency()
+{
+    fakeHsaConfig_t config;
+    config.kernel_latency_ns_ = 100000;
+    fakeHsaConfigure(config);
+    hsa_agent_t gpu = fakeHsaGpuAgents()[0];
+    uint64_t slow = kernelObject(fakeHsaAddKernel(gpu, "slow", 16, 2000000));
+    uint64_t fast = kernelObject(fakeHsaAddKernel(gpu, "fast", 16));
+
+    hsa_queue_t *queue = NULL;
+    CHECK_EQ(hsa_queue_create(gpu, 64, HSA_QUEUE_TYPE_MULTI, NULL, NULL, 0, 0, &queue), HSA_STATUS_SUCCESS);
+    CHECK_EQ(hsa_amd_profiling_set_profiler_enabled(queue, 1), HSA_STATUS_SUCCESS);
+    hsa_signal_t first, second;
+    hsa_signal_create(1, 0, NULL, &first);
+    hsa_signal_create(1, 0, NULL, &second);
+    hsa_kernel_dispatch_packet_t packets[2] = {dispatchPacket(slow, first), dispatchPacket(fast, second)};
+
+    auto start = std::chrono::steady_clock::now();
+    fakeHsaSubmit(queue, packets, 2);
+    // The fast kernel runs after the slow one, so it can't finish first
+    CHECK_EQ(hsa_signal_wait_scacquire(second, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX, HSA_WAIT_STATE_BLOCKED), 0);
+    CHECK_EQ(hsa_signal_load_scacquire(first), 0);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(elapsed >= std::chrono::microseconds(2100));
+
+    // Device timestamps advance by exactly each kernel's latency
+    hsa_amd_profiling_dispatch_time_t time;
+    CHECK_EQ(hsa_amd_profiling_get_dispatch_time(gpu, first, &time), HSA_STATUS_SUCCESS);
+    CHECK_EQ(time.start, 0u);
+    CHECK_EQ(time.end, 2000000u);
+    CHECK_EQ(hsa_amd_profiling_get_dispatch_time(gpu, second, &time), HSA_STATUS_SUCCESS);
+    CHECK_EQ(time.start, 2000000u);
+    CHECK_EQ(time.end - time.start, 100000u);
+
+    CHECK(fakeHsaDrain(SECOND_NS));
+    hsa_signal_destroy(first);
+    hsa_signal_destroy(second);
+    CHECK_EQ(hsa_queue_destroy(queue), HSA_STATUS_SUCCESS);
+    CHECK_EQ(hsa_queue_destroy(queue), HSA_STATUS_ERROR_INVALID_QUEUE);
+}
+
+void testBarriers()
+{
+    fakeHsaConfig_t config;
+    config.kernel_latency_ns_ = 1000000;
+    fakeHsaConfigure(config);
+    hsa_agent_t gpu = fakeHsaGpuAgents()[0];
+    uint64_t kernel = kernelObject(fakeHsaAddKernel(gpu, "k", 8));
+
+    // The HIP pattern: a dispatch without a completion signal, then a barrier that carries one
+    hsa_queue_t *queue = NULL;
+    hsa_queue_create(gpu, 64, HSA_QUEUE_TYPE_MULTI, NULL, NULL, 0, 0, &queue);
+    hsa_signal_t done;
+    hsa_signal_create(1, 0, NULL, &done);
+    hsa_kernel_dispatch_packet_t dispatch = dispatchPacket(kernel, {0});
+    hsa_barrier_and_packet_t barrier = barrierPacket(done);
+    fakeHsaStats_t before = fakeHsaStats();
+    fakeHsaSubmit(queue, &dispatch, 1);
+    fakeHsaSubmit(queue, &barrier, 1);
+    CHECK_EQ(hsa_signal_wait_scacquire(done, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX, HSA_WAIT_STATE_BLOCKED), 0);
+    CHECK(fakeHsaDrain(SECOND_NS));
+    CHECK_EQ(fakeHsaStats().completed_, before.completed_ + 2);
+    CHECK_EQ(fakeHsaStats().barriers_, before.barriers_ + 1);
+    hsa_signal_destroy(done);
+    hsa_queue_destroy(queue);
+}
+
+struct interceptState {
+    std::vector<uint64_t> indices_;
+    hsa_signal_t replacement_;
+};
+
+void rewriteSignals(const void *packets, uint64_t count, uint64_t user_pkt_index, void *data,
+                    hsa_amd_queue_intercept_packet_writer writer)
+{
+    interceptState *state = static_cast<interceptState *>(data);
+    state->indices_.push_back(user_pkt_index);
+    const hsa_kernel_dispatch_packet_t *in = static_cast<const hsa_kernel_dispatch_packet_t *>(packets);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        hsa_kernel_dispatch_packet_t packet = in[i];
+        packet.completion_signal = state->replacement_;
+        writer(&packet, 1);
+    }
+}
+
+void testIntercept()
+{
+    fakeHsaConfig_t config;
+    config.kernel_latency_ns_ = 1000;
+    fakeHsaConfigure(config);
+    HsaApiTable *table = fakeHsaApiTable();
+    hsa_agent_t gpu = fakeHsaGpuAgents()[0];
+    uint64_t kernel = kernelObject(fakeHsaAddKernel(gpu, "k", 8));
+
+    hsa_queue_t *plain = NULL;
+    table->core_->hsa_queue_create_fn(gpu, 64, HSA_QUEUE_TYPE_MULTI, NULL, NULL, 0, 0, &plain);
+    CHECK_EQ(table->amd_ext_->hsa_amd_queue_intercept_register_fn(plain, rewriteSignals, NULL),
+             HSA_STATUS_ERROR_INVALID_QUEUE);
+
+    hsa_queue_t *queue = NULL;
+    CHECK_EQ(table->amd_ext_->hsa_amd_queue_intercept_create_fn(gpu, 64, HSA_QUEUE_TYPE_MULTI, NULL, NULL, 0, 0,
+                                                                &queue), HSA_STATUS_SUCCESS);
+    interceptState state;
+    table->core_->hsa_signal_create_fn(4, 0, NULL, &state.replacement_);
+    CHECK_EQ(table->amd_ext_->hsa_amd_queue_intercept_register_fn(queue, rewriteSignals, &state),
+             HSA_STATUS_SUCCESS);
+
+    hsa_signal_t original;
+    table->core_->hsa_signal_create_fn(1, 0, NULL, &original);
+    hsa_kernel_dispatch_packet_t packets[3] = {dispatchPacket(kernel, original), dispatchPacket(kernel, original),
+                                               dispatchPacket(kernel, original)};
+    fakeHsaStats_t before = fakeHsaStats();
+    fakeHsaSubmit(queue, packets, 3);
+    fakeHsaSubmit(queue, packets, 1);
+    CHECK_EQ(table->core_->hsa_signal_wait_scacquire_fn(state.replacement_, HSA_SIGNAL_CONDITION_EQ, 0, SECOND_NS,
+                                                        HSA_WAIT_STATE_BLOCKED), 0);
+    CHECK_EQ(table->core_->hsa_signal_load_scacquire_fn(original), 1);
+    CHECK_EQ(state.indices_.size(), 2u);
+    CHECK_EQ(state.indices_[1], 3u);
+    CHECK_EQ(fakeHsaStats().intercepted_, before.intercepted_ + 4);
+    CHECK_EQ(fakeHsaStats().dispatches_, before.dispatches_ + 4);
+
+    table->core_->hsa_signal_destroy_fn(original);
+    table->core_->hsa_signal_destroy_fn(state.replacement_);
+    table->core_->hsa_queue_destroy_fn(queue);
+    table->core_->hsa_queue_destroy_fn(plain);
+}
+
+void testExecutables()
+{
+    fakeHsaConfigure(fakeHsaConfig_t());
+    HsaApiTable *table = fakeHsaApiTable();
+    hsa_agent_t gpu = fakeHsaGpuAgents()[0];
+    hsa_executable_symbol_t symbol = fakeHsaAddKernel(gpu, "_Z10vector_addPfS_S_", 24);
+
+    uint32_t length = 0;
+    CHECK_EQ(table->core_->hsa_executable_symbol_get_info_fn(symbol, HSA_EXECUTABLE_SYMBOL_INFO_NAME_LENGTH, &length),
+             HSA_STATUS_SUCCESS);
+    std::string name(length, '\0');
+    table->core_->hsa_executable_symbol_get_info_fn(symbol, HSA_EXECUTABLE_SYMBOL_INFO_NAME, &name[0]);
+    CHECK_EQ(name, std::string("_Z10vector_addPfS_S_"));
+    uint32_t kernarg_size = 0;
+    table->core_->hsa_executable_symbol_get_info_fn(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_KERNARG_SEGMENT_SIZE,
+                                                    &kernarg_size);
+    CHECK_EQ(kernarg_size, 24u);
+    hsa_agent_t agent = {0};
+    table->core_->hsa_executable_symbol_get_info_fn(symbol, HSA_EXECUTABLE_SYMBOL_INFO_AGENT, &agent);
+    CHECK_EQ(agent.handle, gpu.handle);
+
+    // coCache reads kernel descriptors through the loader extension
+    hsa_ven_amd_loader_1_01_pfn_t loader;
+    CHECK_EQ(table->core_->hsa_system_get_major_extension_table_fn(HSA_EXTENSION_AMD_LOADER, 1, sizeof(loader),
+                                                                   &loader), HSA_STATUS_SUCCESS);
+    uint64_t object = kernelObject(symbol);
+    const void *host = NULL;
+    CHECK_EQ(loader.hsa_ven_amd_loader_query_host_address(reinterpret_cast<const void *>(object), &host),
+             HSA_STATUS_SUCCESS);
+    CHECK_EQ(static_cast<const amd_kernel_code_t *>(host)->kernarg_segment_byte_size, 24u);
+    hsa_executable_t executable = {0};
+    CHECK_EQ(loader.hsa_ven_amd_loader_query_executable(reinterpret_cast<const void *>(object), &executable),
+             HSA_STATUS_SUCCESS);
+    size_t count = 0;
+    CHECK_EQ(table->core_->hsa_executable_iterate_symbols_fn(executable, [](hsa_executable_t, hsa_executable_symbol_t,
+                                                                            void *data) {
+        ++*static_cast<size_t *>(data);
+        return HSA_STATUS_SUCCESS;
+    }, &count), HSA_STATUS_SUCCESS);
+    CHECK_EQ(count, 1u);
+
+    // Real code objects can't be loaded
+    hsa_code_object_reader_t reader;
+    CHECK(table->core_->hsa_code_object_reader_create_from_file_fn(0, &reader) != HSA_STATUS_SUCCESS);
+    hsa_executable_t created;
+    CHECK_EQ(table->core_->hsa_executable_create_alt_fn(HSA_PROFILE_BASE, HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT, "",
+                                                        &created), HSA_STATUS_SUCCESS);
+    CHECK_EQ(table->core_->hsa_executable_destroy_fn(created), HSA_STATUS_SUCCESS);
+    CHECK_EQ(table->core_->hsa_executable_destroy_fn(created), HSA_STATUS_ERROR_INVALID_EXECUTABLE);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testAgentsAndPools);
+    RUN_TEST(testSignals);
+    RUN_TEST(testAsyncHandlers);
+    RUN_TEST(testDispatchLatency);
+    RUN_TEST(testBarriers);
+    RUN_TEST(testIntercept);
+    RUN_TEST(testExecutables);
+    return unit_test::finish();
+}
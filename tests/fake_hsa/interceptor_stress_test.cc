@@ -0,0 +1,233 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "fake_hsa.h"
+#include "inc/interceptor.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Drives hsaInterceptor in duration mode on the fake HSA runtime: several application threads create queues
+ * through the hooked API table, register kernels, and submit batches of dispatches, half of them completing
+ * through their own signal and half through a trailing barrier the way HIP does. Checks that every application
+ * signal fires, the interceptor drains its pending signals, and the duration log holds one line per dispatch with
+ * the kernel's simulated run time. */
+
+namespace {
+
+const int SUBMITTERS = 8;
+const int BATCHES = 64;
+const int BATCH_SIZE = 16;
+const int KERNELS = 4;
+const uint64_t WAIT_NS = 10000000000ull;
+
+struct appKernel {
+    std::string name_;
+    hsa_executable_symbol_t symbol_;
+    uint64_t latency_ns_;
+};
+
+HsaApiTable *table = NULL;
+std::vector<appKernel> kernels;
+std::string log_path;
+
+uint64_t kernelObject(const appKernel& kernel)
+{
+    // Goes through the hooked entry point, which is how the interceptor learns kernel names
+    uint64_t object = 0;
+    table->core_->hsa_executable_symbol_get_info_fn(kernel.symbol_, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT, &object);
+    return object;
+}
+
+void appendPacket(std::vector<uint8_t>& packets, const void *packet)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(packet);
+    packets.insert(packets.end(), bytes, bytes + 64);
+}
+
+void submitter(hsa_agent_t agent, int id, std::atomic<int>& failures)
+{
+    std::vector<uint64_t> objects;
+    for (const auto& kernel : kernels)
+        objects.push_back(kernelObject(kernel));
+
+    hsa_queue_t *queue = NULL;
+    if (table->core_->hsa_queue_create_fn(agent, 1024, HSA_QUEUE_TYPE_MULTI, NULL, NULL, UINT32_MAX, UINT32_MAX,
+                                          &queue) != HSA_STATUS_SUCCESS)
+    {
+        failures++;
+        return;
+    }
+    std::vector<hsa_signal_t> signals(BATCH_SIZE);
+    for (auto& signal : signals)
+        table->core_->hsa_signal_create_fn(1, 0, NULL, &signal);
+
+    for (int batch = 0; batch < BATCHES; batch++)
+    {
+        std::vector<uint8_t> packets;
+        for (int i = 0; i < BATCH_SIZE; i++)
+        {
+            table->core_->hsa_signal_store_screlease_fn(signals[i], 1);
+            hsa_kernel_dispatch_packet_t dispatch;
+            memset(&dispatch, 0, sizeof(dispatch));
+            dispatch.header = HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE;
+            dispatch.kernel_object = objects[(id + batch + i) % KERNELS];
+            if (i % 2 == 0)
+            {
+                dispatch.completion_signal = signals[i];
+                appendPacket(packets, &dispatch);
+            }
+            else
+            {
+                hsa_barrier_and_packet_t barrier;
+                memset(&barrier, 0, sizeof(barrier));
+                barrier.header = HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE;
+                barrier.completion_signal = signals[i];
+                appendPacket(packets, &dispatch);
+                appendPacket(packets, &barrier);
+            }
+        }
+        fakeHsaSubmit(queue, packets.data(), packets.size() / 64);
+        for (auto signal : signals)
+        {
+            if (table->core_->hsa_signal_wait_scacquire_fn(signal, HSA_SIGNAL_CONDITION_EQ, 0, WAIT_NS,
+                                                           HSA_WAIT_STATE_BLOCKED) != 0)
+                failures++;
+        }
+    }
+    for (auto signal : signals)
+        table->core_->hsa_signal_destroy_fn(signal);
+    table->core_->hsa_queue_destroy_fn(queue);
+}
+
+void testConcurrentSubmitters()
+{
+    fakeHsaStats_t before = fakeHsaStats();
+    std::vector<hsa_agent_t> gpus = fakeHsaGpuAgents();
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < SUBMITTERS; i++)
+        threads.emplace_back(submitter, gpus[i % gpus.size()], i, std::ref(failures));
+    for (auto& thread : threads)
+        thread.join();
+    CHECK_EQ(failures.load(), 0);
+    CHECK(fakeHsaDrain(WAIT_NS));
+
+    // Completions the application doesn't wait on (the dispatches followed by a barrier) may still be queued for
+    // the interceptor's reactor thread
+    hsaInterceptor *interceptor = hsaInterceptor::getInstanceIfExists();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (interceptor->hasPendingSignals() && std::chrono::steady_clock::now() < deadline)
+        usleep(1000);
+    CHECK(!interceptor->hasPendingSignals());
+
+    fakeHsaStats_t after = fakeHsaStats();
+    uint64_t dispatches = static_cast<uint64_t>(SUBMITTERS) * BATCHES * BATCH_SIZE;
+    CHECK_EQ(after.dispatches_ - before.dispatches_, dispatches);
+    CHECK_EQ(after.barriers_ - before.barriers_, dispatches / 2);
+    CHECK_EQ(after.intercepted_ - before.intercepted_, dispatches + dispatches / 2);
+    CHECK_EQ(after.queues_live_, 0u);
+}
+
+void testDurationLog()
+{
+    // Deleting the interceptor joins its threads, closes the log and releases its signal pool
+    hsaInterceptor::cleanup();
+    CHECK(hsaInterceptor::getInstanceIfExists() == nullptr);
+    CHECK_EQ(fakeHsaStats().signals_live_, 0u);
+
+    std::map<std::string, uint64_t> latencies;
+    for (const auto& kernel : kernels)
+        latencies[kernel.name_] = kernel.latency_ns_;
+    std::ifstream log(log_path);
+    std::string line;
+    std::getline(log, line);
+    CHECK_EQ(line, std::string("kernel,dispatch,startNs,endNs"));
+    uint64_t lines = 0;
+    while (std::getline(log, line))
+    {
+        // "name",dispatchNs,startNs,endNs
+        size_t close = line.find('"', 1);
+        size_t start = line.find(',', line.find(',', close) + 1);
+        size_t end = line.find(',', start + 1);
+        if (line.empty() || line[0] != '"' || close == std::string::npos || end == std::string::npos)
+        {
+            CHECK(false);
+            break;
+        }
+        std::string name = line.substr(1, close - 1);
+        uint64_t start_ns = strtoull(line.c_str() + start + 1, NULL, 10);
+        uint64_t end_ns = strtoull(line.c_str() + end + 1, NULL, 10);
+        CHECK(latencies.count(name));
+        CHECK_EQ(end_ns - start_ns, latencies[name]);
+        lines++;
+    }
+    CHECK_EQ(lines, static_cast<uint64_t>(SUBMITTERS) * BATCHES * BATCH_SIZE);
+}
+
+} // namespace
+
+int main()
+{
+    char path[] = "/tmp/interceptor_stress_testXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return 1;
+    close(fd);
+    log_path = path;
+    setenv("LOGDUR_LOG_LOCATION", path, 1);
+    setenv("LOGDUR_DURATION_MODE", "lines", 1);
+    setenv("LOGDUR_INSTRUMENTED", "false", 1);
+    for (const char *name : {"LOGDUR_KERNEL_CACHE", "LOGDUR_FILTER", "LOGDUR_LIBRARY_FILTER", "LOGDUR_HANDLERS",
+                             "LOGDUR_DISPATCHES", "LOGDUR_RECORD_MESSAGES"})
+        unsetenv(name);
+
+    fakeHsaConfig_t config;
+    config.gpu_agents_ = 2;
+    config.kernel_latency_ns_ = 5000;
+    fakeHsaConfigure(config);
+    table = fakeHsaApiTable();
+    std::vector<hsa_agent_t> gpus = fakeHsaGpuAgents();
+    for (int i = 0; i < KERNELS; i++)
+    {
+        appKernel kernel;
+        kernel.name_ = "stress_kernel_" + std::to_string(i);
+        kernel.latency_ns_ = 2000 * (i + 1);
+        kernel.symbol_ = fakeHsaAddKernel(gpus[i % gpus.size()], kernel.name_, 64, kernel.latency_ns_);
+        kernels.push_back(kernel);
+    }
+    if (!hsaInterceptor::getInstance(table))
+        return 1;
+
+    RUN_TEST(testConcurrentSubmitters);
+    RUN_TEST(testDurationLog);
+    unlink(path);
+    return unit_test::finish();
+}
@@ -0,0 +1,146 @@
+; Access groups in the address plugin. With INSTRUMENTATION_GROUP_ACCESSES set,
+; loads or stores in a basic block at constant offsets from the same base, with
+; the same source line and column, kind and size, are submitted as one message whose
+; column packs the slot mask and repeat count; everything else is instrumented
+; as before. With a site manifest, the column may differ.
+
+; RUN: opt -load-pass-plugin %address_plugin -passes=amdgcn-submit-address-message \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+; RUN: env INSTRUMENTATION_GROUP_ACCESSES=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=GROUP
+; RUN: env INSTRUMENTATION_GROUP_ACCESSES=1 INSTRUMENTATION_SITE_MANIFEST=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=MEMBERS
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+; Four consecutive floats, as left behind by an unrolled loop: one message with
+; slots 0..3 (0x4000f000), at the first load, addressing in[1].
+
+; DEFAULT-LABEL: define {{.*}}@__amd_crk_unrolledPv(
+; DEFAULT-COUNT-4: call void @v_submit_address({{.*}}, i8 1, i8 1, i16 4)
+; DEFAULT: call void @v_submit_address({{.*}}, i8 2, i8 1, i16 4)
+
+; GROUP-LABEL: define {{.*}}@__amd_crk_unrolledPv(
+; GROUP: [[BASE:%.*]] = getelementptr i8, ptr addrspace(1) %in, i64 4
+; GROUP-NEXT: [[FLAT:%.*]] = addrspacecast ptr addrspace(1) [[BASE]] to ptr
+; GROUP-NEXT: call void @v_submit_address(ptr %{{.*}}, ptr [[FLAT]], i64 {{-?[0-9]+}}, i32 0, i32 1073803264, i8 1, i8 1, i16 4)
+; GROUP-NEXT: %a1 = load float
+; GROUP-NOT: @v_submit_address
+; GROUP: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 2, i8 1, i16 4)
+; GROUP-NEXT: store float
+
+define amdgpu_kernel void @unrolled(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 {
+entry:
+  %p1 = getelementptr inbounds float, ptr addrspace(1) %in, i64 1
+  %p2 = getelementptr inbounds float, ptr addrspace(1) %in, i64 2
+  %p3 = getelementptr inbounds float, ptr addrspace(1) %in, i64 3
+  %p4 = getelementptr inbounds float, ptr addrspace(1) %in, i64 4
+  %a1 = load float, ptr addrspace(1) %p1, align 4
+  %a2 = load float, ptr addrspace(1) %p2, align 4
+  %a3 = load float, ptr addrspace(1) %p3, align 4
+  %a4 = load float, ptr addrspace(1) %p4, align 4
+  %s1 = fadd float %a1, %a2
+  %s2 = fadd float %a3, %a4
+  %s = fadd float %s1, %s2
+  store float %s, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+; The same location read twice and its neighbour twice: slots 0 and 1, repeat 2
+; (0x50003000). The i32 load differs in size, so it is instrumented on its own.
+
+; GROUP-LABEL: define {{.*}}@__amd_crk_repeatedPv(
+; GROUP: call void @v_submit_address({{.*}}, i32 0, i32 1342189568, i8 1, i8 1, i16 8)
+; GROUP-NEXT: %a = load i64
+; GROUP-NOT: @v_submit_address
+; GROUP: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 1, i8 1, i16 4)
+; GROUP-NEXT: %n = load i32
+; GROUP-NOT: @v_submit_address
+; GROUP: call void @v_submit_address({{.*}}, i8 2, i8 1, i16 8)
+; GROUP-NEXT: store i64
+
+define amdgpu_kernel void @repeated(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 {
+entry:
+  %q = getelementptr inbounds i64, ptr addrspace(1) %in, i64 1
+  %a = load i64, ptr addrspace(1) %in, align 8
+  %b = load i64, ptr addrspace(1) %q, align 8
+  %n = load i32, ptr addrspace(1) %q, align 4
+  %c = load i64, ptr addrspace(1) %in, align 8
+  %d = load i64, ptr addrspace(1) %q, align 8
+  %x = add i64 %a, %b
+  %y = add i64 %c, %d
+  %z = add i64 %x, %y
+  %w = zext i32 %n to i64
+  %r = add i64 %z, %w
+  store i64 %r, ptr addrspace(1) %out, align 8
+  ret void
+}
+
+; Accesses in different basic blocks, or at offsets that aren't a multiple of
+; the access size apart, are not grouped.
+
+; GROUP-LABEL: define {{.*}}@__amd_crk_ungroupedPv(
+; GROUP-NOT: i32 {{1[0-9]+}}, i8
+; GROUP: ret void
+
+define amdgpu_kernel void @ungrouped(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 {
+entry:
+  %p = getelementptr inbounds i8, ptr addrspace(1) %in, i64 2
+  %a = load i32, ptr addrspace(1) %in, align 4
+  %b = load i32, ptr addrspace(1) %p, align 2
+  br label %next
+
+next:
+  %c = load i32, ptr addrspace(1) %in, align 4
+  %s = add i32 %a, %b
+  %t = add i32 %s, %c
+  store i32 %t, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+; Struct fields read on one line, as in p->a + p->b: the loads sit one access
+; size apart but have different columns. A message carries a single column, so
+; without a site manifest they are not grouped. With one, they are grouped
+; (slots 0 and 1, 0x4000300e), and each gets a site with its own column: 14 for
+; site 0, which the message refers to, and 21 for site 1.
+
+; GROUP-LABEL: define {{.*}}@__amd_crk_fieldsPv(
+; GROUP-NOT: i32 {{1[0-9]+}}, i8
+; GROUP: ret void
+
+; MEMBERS: @__amd_crk_fieldsPv.sites = protected addrspace(4) constant [{{[0-9]+}} x i8] c"OPSM\02\00\10\00\03\00\00\00\01\00\00\00
+; MEMBERS-SAME: \00\00\00\00\05\00\00\00\0E\00\00\00\01\01\04\00
+; MEMBERS-SAME: \00\00\00\00\05\00\00\00\15\00\00\00\01\01\04\00
+; MEMBERS-SAME: \00\00\00\00\05\00\00\00\0E\00\00\00\01\02\04\00
+; MEMBERS-SAME: /src/fields.hip\00"
+; MEMBERS-LABEL: define {{.*}}@__amd_crk_fieldsPv(
+; MEMBERS: call void @v_submit_address({{.*}}, i64 0, i32 -2147483648, i32 1073754126, i8 1, i8 1, i16 4)
+; MEMBERS-NEXT: %a = load float
+; MEMBERS-NOT: @v_submit_address
+; MEMBERS: call void @v_submit_address({{.*}}, i64 2, i32 -2147483648, i32 14, i8 2, i8 1, i16 4)
+; MEMBERS-NEXT: store float
+
+define amdgpu_kernel void @fields(ptr addrspace(1) %out, ptr addrspace(1) %p) #0 !dbg !5 {
+entry:
+  %pb = getelementptr inbounds i8, ptr addrspace(1) %p, i64 4
+  %a = load float, ptr addrspace(1) %p, align 4, !dbg !8
+  %b = load float, ptr addrspace(1) %pb, align 4, !dbg !9
+  %s = fadd float %a, %b, !dbg !8
+  store float %s, ptr addrspace(1) %out, align 4, !dbg !8
+  ret void, !dbg !8
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!2}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus_14, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "fields.hip", directory: "/src")
+!2 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = distinct !DISubprogram(name: "fields", scope: !1, file: !1, line: 3, type: !6, scopeLine: 3, spFlags: DISPFlagDefinition | DISPFlagOptimized, unit: !0)
+!6 = !DISubroutineType(types: !7)
+!7 = !{}
+!8 = !DILocation(line: 5, column: 14, scope: !5)
+!9 = !DILocation(line: 5, column: 21, scope: !5)
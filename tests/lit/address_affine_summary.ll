@@ -0,0 +1,137 @@
+; Affine access summaries in the address plugin. With INSTRUMENTATION_AFFINE_SUMMARY
+; set, loads and stores at {base,+,stride} that run once per loop iteration are
+; reported by a summary/first-iteration message pair in the loop preheader instead
+; of a message per iteration; everything else is instrumented as before.
+
+; RUN: opt -load-pass-plugin %address_plugin -passes=amdgcn-submit-address-message \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+; RUN: env INSTRUMENTATION_AFFINE_SUMMARY=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=SUMMARY
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+; out[i] = in[i]: both accesses are summarized, the loop body is left alone.
+
+; DEFAULT-LABEL: define {{.*}}@__amd_crk_copyPv(
+; DEFAULT: loop:
+; DEFAULT: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 1, i8 1, i16 4)
+; DEFAULT-NEXT: load float
+; DEFAULT: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 2, i8 1, i16 4)
+; DEFAULT-NEXT: store float
+
+; SUMMARY-LABEL: define {{.*}}@__amd_crk_copyPv(
+; SUMMARY: loop.preheader:
+; SUMMARY: [[TRIPS:%.*]] = call i64 @llvm.umin.i64(i64 %{{.*}}, i64 4294967295)
+; SUMMARY: [[HI:%.*]] = shl i64 [[TRIPS]], 32
+; SUMMARY: [[PACKED:%.*]] = or i64 [[HI]], 4
+; SUMMARY: [[SUMMARY:%.*]] = inttoptr i64 [[PACKED]] to ptr
+; SUMMARY: call void @v_submit_address(ptr %{{.*}}, ptr [[SUMMARY]], i64 {{-?[0-9]+}}, i32 0, i32 -2147483648, i8 1, i8 1, i16 4)
+; SUMMARY: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 1, i8 1, i16 4)
+; SUMMARY: call void @v_submit_address({{.*}}, i32 0, i32 -2147483648, i8 2, i8 1, i16 4)
+; SUMMARY: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 2, i8 1, i16 4)
+; SUMMARY: loop:
+; SUMMARY-NOT: @v_submit_address
+; SUMMARY: ret void
+
+define amdgpu_kernel void @copy(ptr addrspace(1) %out, ptr addrspace(1) %in, i64 %n) #0 {
+entry:
+  %guard = icmp sgt i64 %n, 0
+  br i1 %guard, label %loop.preheader, label %exit
+
+loop.preheader:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %loop.preheader ], [ %i.next, %loop ]
+  %src = getelementptr inbounds float, ptr addrspace(1) %in, i64 %i
+  %v = load float, ptr addrspace(1) %src, align 4
+  %dst = getelementptr inbounds float, ptr addrspace(1) %out, i64 %i
+  store float %v, ptr addrspace(1) %dst, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cont = icmp slt i64 %i.next, %n
+  br i1 %cont, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; out[i] = in[idx[i]]: the gathered load isn't affine and keeps its per-iteration message.
+
+; SUMMARY-LABEL: define {{.*}}@__amd_crk_gatherPv(
+; SUMMARY: loop.preheader:
+; SUMMARY: call void @v_submit_address({{.*}}, i32 -2147483648, i8 1, i8 1, i16 8)
+; SUMMARY: call void @v_submit_address({{.*}}, i32 -2147483648, i8 2, i8 1, i16 4)
+; SUMMARY: loop:
+; SUMMARY: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 1, i8 1, i16 4)
+; SUMMARY-NEXT: load float
+; SUMMARY-NOT: @v_submit_address
+; SUMMARY: ret void
+
+define amdgpu_kernel void @gather(ptr addrspace(1) %out, ptr addrspace(1) %in, ptr addrspace(1) %idx, i64 %n) #0 {
+entry:
+  %guard = icmp sgt i64 %n, 0
+  br i1 %guard, label %loop.preheader, label %exit
+
+loop.preheader:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %loop.preheader ], [ %i.next, %loop ]
+  %ip = getelementptr inbounds i64, ptr addrspace(1) %idx, i64 %i
+  %j = load i64, ptr addrspace(1) %ip, align 8
+  %src = getelementptr inbounds float, ptr addrspace(1) %in, i64 %j
+  %v = load float, ptr addrspace(1) %src, align 4
+  %dst = getelementptr inbounds float, ptr addrspace(1) %out, i64 %i
+  store float %v, ptr addrspace(1) %dst, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cont = icmp slt i64 %i.next, %n
+  br i1 %cont, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; if (in[i] > 0) out[i] = in[i]: the store doesn't run on every iteration, so only the
+; load is summarized.
+
+; SUMMARY-LABEL: define {{.*}}@__amd_crk_conditionalPv(
+; SUMMARY: loop.preheader:
+; SUMMARY: call void @v_submit_address({{.*}}, i32 -2147483648, i8 1, i8 1, i16 4)
+; SUMMARY-NOT: i32 -2147483648
+; SUMMARY: loop:
+; SUMMARY-NOT: @v_submit_address
+; SUMMARY: then:
+; SUMMARY: call void @v_submit_address({{.*}}, i32 0, i32 0, i8 2, i8 1, i16 4)
+; SUMMARY-NEXT: store float
+
+define amdgpu_kernel void @conditional(ptr addrspace(1) %out, ptr addrspace(1) %in, i64 %n) #0 {
+entry:
+  %guard = icmp sgt i64 %n, 0
+  br i1 %guard, label %loop.preheader, label %exit
+
+loop.preheader:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %loop.preheader ], [ %i.next, %latch ]
+  %src = getelementptr inbounds float, ptr addrspace(1) %in, i64 %i
+  %v = load float, ptr addrspace(1) %src, align 4
+  %pos = fcmp ogt float %v, 0.0
+  br i1 %pos, label %then, label %latch
+
+then:
+  %dst = getelementptr inbounds float, ptr addrspace(1) %out, i64 %i
+  store float %v, ptr addrspace(1) %dst, align 4
+  br label %latch
+
+latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %cont = icmp slt i64 %i.next, %n
+  br i1 %cont, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
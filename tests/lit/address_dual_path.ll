@@ -0,0 +1,49 @@
+; Dual-path clones (INSTRUMENTATION_DUAL_PATH). The clone holds both the
+; instrumented and the uninstrumented body and picks one by whether the
+; dh_comms pointer is null, so the runtime can dispatch it without capturing.
+; A marker global next to the clone tells the runtime which clones do this.
+
+; RUN: env INSTRUMENTATION_DUAL_PATH=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=DUAL
+; RUN: env INSTRUMENTATION_DUAL_PATH=1 INSTRUMENTATION_SAMPLE=workgroup:4 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=SAMPLED
+; RUN: opt -load-pass-plugin %address_plugin -passes=amdgcn-submit-address-message \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+; DUAL: @__amd_crk_copyPv.dual_path = protected addrspace(4) constant i8 1
+; DUAL: @llvm.used = {{.*}}@__amd_crk_copyPv.dual_path
+
+; Without sampling, the guard only tests the pointer and doesn't need the
+; dispatch packet.
+; DUAL-LABEL: define {{.*}}@__amd_crk_copyPv(
+; DUAL-NEXT: sample.guard:
+; DUAL-NEXT: %comms.nonnull = icmp ne ptr %0, null
+; DUAL-NEXT: br i1 %comms.nonnull, label %entry, label %entry.plain
+; DUAL: call void @v_submit_address({{.*}}, i8 1, i8 1, i16 4)
+; DUAL-NEXT: %v = load float
+; DUAL: entry.plain:
+; DUAL-NOT: @v_submit_address
+; DUAL: ret void
+; DUAL-NEXT: }
+
+; SAMPLED-LABEL: define {{.*}}@__amd_crk_copyPv(
+; SAMPLED: %sample.pred = icmp eq i32
+; SAMPLED-NEXT: %comms.nonnull = icmp ne ptr %0, null
+; SAMPLED-NEXT: %capture.pred = and i1 %comms.nonnull, %sample.pred
+; SAMPLED-NEXT: br i1 %capture.pred, label %entry, label %entry.plain
+
+; DEFAULT-NOT: .dual_path = 
+; DEFAULT-LABEL: define {{.*}}@__amd_crk_copyPv(
+; DEFAULT-NOT: comms.nonnull
+
+define amdgpu_kernel void @copy(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 {
+entry:
+  %v = load float, ptr addrspace(1) %in, align 4
+  store float %v, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
@@ -0,0 +1,75 @@
+; Device heatmaps (INSTRUMENTATION_HEATMAP). The clone sends no address
+; messages; before each access, every lane counts the page of its address in
+; the hashed histogram its extra pointer argument points to: claim a slot with
+; cmpxchg, add one to its count, and after 16 probes count the access as
+; dropped in the header instead. A constant <clone>.heatmap global holds the
+; page shift and slot count, laid out as described in inc/device_heatmap.h.
+
+; RUN: env INSTRUMENTATION_HEATMAP=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=HEATMAP
+; RUN: env INSTRUMENTATION_HEATMAP=4096 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=PAGE4K
+; RUN: env INSTRUMENTATION_HEATMAP=1000 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=MESSAGES
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+@tile = internal addrspace(3) global [64 x float] undef, align 4
+
+; "OPHM", version 1, page shift 20, 8192 slots
+; HEATMAP: @__amd_crk_countPv.heatmap = protected addrspace(4) constant [16 x i8] c"OPHM\01\00\00\00\14\00\00\00\00 \00\00"
+; HEATMAP: @llvm.used = {{.*}}@__amd_crk_countPv.heatmap
+
+; HEATMAP-LABEL: define {{.*}}@__amd_crk_countPv(ptr addrspace(1) %out, ptr addrspace(1) %in, ptr %0)
+; HEATMAP: [[FLAT:%.*]] = addrspacecast ptr addrspace(1) %in to ptr
+; HEATMAP: [[ADDR:%.*]] = ptrtoint ptr [[FLAT]] to i64
+; HEATMAP: [[PAGE:%.*]] = lshr i64 [[ADDR]], 20
+; HEATMAP: %heatmap.key = add i64 [[PAGE]], 1
+; HEATMAP: [[MUL:%.*]] = mul i64 %heatmap.key, -7046029254386353131
+; HEATMAP: %heatmap.hash = lshr i64 [[MUL]], 51
+; HEATMAP: [[TABLE:%.*]] = addrspacecast ptr %0 to ptr addrspace(1)
+; HEATMAP: heatmap.probe:
+; HEATMAP: %heatmap.idx = phi i64 [ 0, %entry ], [ [[NEXT:%.*]], %heatmap.next ]
+; HEATMAP: [[SLOT:%.*]] = and i64 {{%.*}}, 8191
+; HEATMAP: [[OFFSET:%.*]] = shl i64 [[SLOT]], 4
+; HEATMAP: [[BYTES:%.*]] = add i64 [[OFFSET]], 32
+; HEATMAP: %heatmap.slot = getelementptr i8, ptr addrspace(1) [[TABLE]], i64 [[BYTES]]
+; HEATMAP: cmpxchg ptr addrspace(1) %heatmap.slot, i64 0, i64 %heatmap.key syncscope("agent") monotonic monotonic, align 8
+; HEATMAP: br i1 %heatmap.found, label %heatmap.count, label %heatmap.next
+; HEATMAP: heatmap.next:
+; HEATMAP: [[NEXT]] = add i64 %heatmap.idx, 1
+; HEATMAP: icmp ult i64 [[NEXT]], 16
+; HEATMAP: heatmap.count:
+; HEATMAP: [[COUNT:%.*]] = getelementptr i8, ptr addrspace(1) %heatmap.slot, i64 8
+; HEATMAP: atomicrmw add ptr addrspace(1) [[COUNT]], i64 1 syncscope("agent") monotonic, align 8
+; HEATMAP: heatmap.drop:
+; HEATMAP: [[DROPPED:%.*]] = getelementptr i8, ptr addrspace(1) [[TABLE]], i64 8
+; HEATMAP: atomicrmw add ptr addrspace(1) [[DROPPED]], i64 1 syncscope("agent") monotonic, align 8
+; HEATMAP: heatmap.done:
+; HEATMAP-NEXT: %v = load float, ptr addrspace(1) %in, align 4
+; LDS addresses are counted as flat addresses
+; HEATMAP: ptrtoint (ptr addrspacecast (ptr addrspace(3) @tile to ptr) to i64)
+; HEATMAP: store float %v, ptr addrspace(3) @tile, align 4
+; HEATMAP: store float %v, ptr addrspace(1) %out, align 4
+; HEATMAP-NOT: call void @v_submit_address(
+; HEATMAP: ret void
+
+; PAGE4K: c"OPHM\01\00\00\00\0C\00\00\00\00 \00\00"
+; PAGE4K-LABEL: define {{.*}}@__amd_crk_countPv(
+; PAGE4K: lshr i64 {{%.*}}, 12
+
+; Not a power of two: the clone sends address messages as usual
+; MESSAGES-NOT: .heatmap =
+; MESSAGES-LABEL: define {{.*}}@__amd_crk_countPv(
+; MESSAGES: call void @v_submit_address(
+
+define amdgpu_kernel void @count(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 {
+entry:
+  %v = load float, ptr addrspace(1) %in, align 4
+  store float %v, ptr addrspace(3) @tile, align 4
+  store float %v, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
@@ -0,0 +1,93 @@
+; Compile-time wave sampling (INSTRUMENTATION_SAMPLE). The clone gets a guard
+; block at entry that evaluates the sampling predicate once per wave and
+; branches to either the instrumented body or an uninstrumented copy of it.
+
+; RUN: opt -load-pass-plugin %address_plugin -passes=amdgcn-submit-address-message \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+; RUN: env INSTRUMENTATION_SAMPLE=workgroup:8 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefixes=GUARD,WORKGROUP
+; RUN: env INSTRUMENTATION_SAMPLE=wave-mask:0x5 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefixes=GUARD,WAVEMASK
+; RUN: env INSTRUMENTATION_SAMPLE=hash:16:7 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefixes=GUARD,HASH
+; RUN: env INSTRUMENTATION_SAMPLE=hash:1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+; RUN: env INSTRUMENTATION_SAMPLE=bogus:3 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>&1 >/dev/null | FileCheck %s --check-prefix=INVALID
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+; DEFAULT-LABEL: define {{.*}}@__amd_crk_copyPv(
+; DEFAULT-NEXT: entry:
+; DEFAULT-NOT: sample.guard
+
+; The static alloca of both bodies stays in the entry block.
+; GUARD: define {{.*}}@__amd_crk_copyPv({{.*}}) #[[CLONE:[0-9]+]] {
+; GUARD-NEXT: sample.guard:
+; GUARD-NEXT: %tmp = alloca float
+; GUARD-NEXT: %tmp.plain = alloca float
+; GUARD: call ptr addrspace(4) @llvm.amdgcn.dispatch.ptr()
+
+; WORKGROUP: %sample.wg = add i32
+; WORKGROUP-NOT: readfirstlane
+; WORKGROUP: urem i32 %sample.wg, 8
+; WORKGROUP: %sample.pred = icmp eq i32
+
+; WAVEMASK-NOT: workgroup.id
+; WAVEMASK: %sample.wave = call i32 @llvm.amdgcn.readfirstlane
+; WAVEMASK: lshr i64 5,
+; WAVEMASK: %sample.pred = icmp ne i64
+
+; HASH: %sample.wg = add i32
+; HASH: %sample.wave = call i32 @llvm.amdgcn.readfirstlane
+; HASH: mul i32 %sample.wave, -2048144777
+; HASH: mul i32 %sample.wg, -1640531535
+; HASH: urem i32 %{{[0-9]+}}, 16
+; HASH: %sample.pred = icmp eq i32
+
+; GUARD: br i1 %sample.pred, label %entry, label %entry.plain
+
+; GUARD: loop:
+; GUARD: call void @v_submit_address({{.*}}, i8 1, i8 1, i16 4)
+; GUARD-NEXT: %v = load float
+; GUARD: call void @v_submit_address({{.*}}, i8 2, i8 5, i16 4)
+; GUARD-NEXT: store float %v, ptr addrspace(5) %tmp
+; GUARD: call void @v_submit_address({{.*}}, i8 2, i8 1, i16 4)
+; GUARD-NEXT: store float %v, ptr addrspace(1) %q
+
+; GUARD: entry.plain:
+; GUARD-NOT: @v_submit_address
+; GUARD: store float %v.plain, ptr addrspace(5) %tmp.plain
+; GUARD-NOT: @v_submit_address
+; GUARD: ret void
+; GUARD-NEXT: }
+
+; The guard reads the dispatch packet and ids, whatever the original kernel used.
+; GUARD: attributes #[[CLONE]] = { "target-cpu"="gfx90a" }
+
+; INVALID: invalid INSTRUMENTATION_SAMPLE 'bogus:3'
+
+define amdgpu_kernel void @copy(ptr addrspace(1) %out, ptr addrspace(1) %in, i32 %n) #0 {
+entry:
+  %tmp = alloca float, align 4, addrspace(5)
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %idx = sext i32 %i to i64
+  %p = getelementptr inbounds float, ptr addrspace(1) %in, i64 %idx
+  %v = load float, ptr addrspace(1) %p, align 4
+  store float %v, ptr addrspace(5) %tmp, align 4
+  %q = getelementptr inbounds float, ptr addrspace(1) %out, i64 %idx
+  store float %v, ptr addrspace(1) %q, align 4
+  %i.next = add nsw i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+attributes #0 = { "amdgpu-no-dispatch-ptr" "amdgpu-no-workgroup-id-y" "target-cpu"="gfx90a" }
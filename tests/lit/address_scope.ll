@@ -0,0 +1,84 @@
+; Scope filtering (INSTRUMENTATION_SCOPE). A definition is a full path, or a
+; pattern that the end of the path has to match, optionally followed by line
+; numbers and half-open N:M ranges. The kernel below has accesses in two files
+; and in two directories with a file of the same name.
+
+; RUN: env INSTRUMENTATION_SCOPE='a.hip' opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=TAIL
+; RUN: env INSTRUMENTATION_SCOPE='/src/one/a.hip:10:12' opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=FULL
+; RUN: env INSTRUMENTATION_SCOPE='one/a.hip:11;two/a.hip:1:5,20;b.hip:30' opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=MIXED
+; RUN: env INSTRUMENTATION_SCOPE=':10:12,11:14;a.hip' opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=ANYFILE
+; RUN: env INSTRUMENTATION_SCOPE='/src/one/a.hi;ne/a.hip:99' opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=NONE
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+; The accesses are /src/one/a.hip:10, /src/one/a.hip:11, /src/two/a.hip:20,
+; /src/b.hip:30 and /src/b.hip:31, in that order. The column tells them apart.
+
+; TAIL-LABEL: define {{.*}}@__amd_crk_scopedPv(
+; TAIL: @v_submit_address({{.*}}, i32 10, i32 1,
+; TAIL: @v_submit_address({{.*}}, i32 11, i32 2,
+; TAIL: @v_submit_address({{.*}}, i32 20, i32 3,
+; TAIL-NOT: @v_submit_address
+; TAIL: ret void
+
+; FULL-LABEL: define {{.*}}@__amd_crk_scopedPv(
+; FULL: @v_submit_address({{.*}}, i32 10, i32 1,
+; FULL: @v_submit_address({{.*}}, i32 11, i32 2,
+; FULL-NOT: @v_submit_address
+; FULL: ret void
+
+; MIXED-LABEL: define {{.*}}@__amd_crk_scopedPv(
+; MIXED-NOT: i32 10, i32 1,
+; MIXED: @v_submit_address({{.*}}, i32 11, i32 2,
+; MIXED: @v_submit_address({{.*}}, i32 20, i32 3,
+; MIXED: @v_submit_address({{.*}}, i32 30, i32 4,
+; MIXED-NOT: @v_submit_address
+; MIXED: ret void
+
+; ANYFILE-LABEL: define {{.*}}@__amd_crk_scopedPv(
+; ANYFILE: @v_submit_address({{.*}}, i32 10, i32 1,
+; ANYFILE: @v_submit_address({{.*}}, i32 11, i32 2,
+; ANYFILE: @v_submit_address({{.*}}, i32 20, i32 3,
+; ANYFILE-NOT: @v_submit_address
+; ANYFILE: ret void
+
+; NONE-LABEL: define {{.*}}@__amd_crk_scopedPv(
+; NONE-NOT: @v_submit_address
+; NONE: ret void
+
+define amdgpu_kernel void @scoped(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 !dbg !5 {
+entry:
+  %a = load float, ptr addrspace(1) %in, align 4, !dbg !10
+  %b = load float, ptr addrspace(1) %in, align 4, !dbg !11
+  %c = load float, ptr addrspace(1) %in, align 4, !dbg !12
+  %d = load float, ptr addrspace(1) %in, align 4, !dbg !13
+  %e = load float, ptr addrspace(1) %in, align 4, !dbg !14
+  ret void, !dbg !10
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus_14, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "a.hip", directory: "/src/one")
+!2 = !DIFile(filename: "a.hip", directory: "/src/two")
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !DIFile(filename: "b.hip", directory: "/src")
+!5 = distinct !DISubprogram(name: "scoped", scope: !1, file: !1, line: 9, type: !6, scopeLine: 9, spFlags: DISPFlagDefinition | DISPFlagOptimized, unit: !0)
+!6 = !DISubroutineType(types: !7)
+!7 = !{}
+!8 = distinct !DILexicalBlockFile(scope: !5, file: !2, discriminator: 0)
+!9 = distinct !DILexicalBlockFile(scope: !5, file: !4, discriminator: 0)
+!10 = !DILocation(line: 10, column: 1, scope: !5)
+!11 = !DILocation(line: 11, column: 2, scope: !5)
+!12 = !DILocation(line: 20, column: 3, scope: !8)
+!13 = !DILocation(line: 30, column: 4, scope: !9)
+!14 = !DILocation(line: 31, column: 5, scope: !9)
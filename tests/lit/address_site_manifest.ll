@@ -0,0 +1,58 @@
+; Site manifests (INSTRUMENTATION_SITE_MANIFEST). Every instrumented access of
+; a clone gets a dense site id, which its address messages carry in place of
+; the file hash, with the line set to 0x80000000 (-2147483648). The source
+; location, address space, access kind and size of each site are written to a
+; constant <clone>.sites global, laid out as described in inc/site_manifest.h.
+
+; RUN: env INSTRUMENTATION_SITE_MANIFEST=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=SITES
+; RUN: opt -load-pass-plugin %address_plugin -passes=amdgcn-submit-address-message \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+@tile = internal addrspace(3) global [64 x float] undef, align 4
+
+; Header: "OPSM", version 2, 16-byte records, 3 sites, 1 file. Then, per site,
+; file index, line, column, address space, access kind and size.
+; SITES: @__amd_crk_stagePv.sites = protected addrspace(4) constant [{{[0-9]+}} x i8] c"OPSM\02\00\10\00\03\00\00\00\01\00\00\00
+; SITES-SAME: \00\00\00\00\03\00\00\00\0C\00\00\00\01\01\04\00
+; SITES-SAME: \00\00\00\00\04\00\00\00\05\00\00\00\03\02\04\00
+; SITES-SAME: \00\00\00\00\05\00\00\00\07\00\00\00\01\02\04\00
+; SITES-SAME: /src/stage.hip\00"
+; SITES: @llvm.used = {{.*}}@__amd_crk_stagePv.sites
+
+; SITES-LABEL: define {{.*}}@__amd_crk_stagePv(
+; SITES: call void @v_submit_address(ptr %0, ptr {{.*}}, i64 0, i32 -2147483648, i32 12, i8 1, i8 1, i16 4)
+; SITES: call void @v_submit_address(ptr %0, ptr {{.*}}, i64 1, i32 -2147483648, i32 5, i8 2, i8 3, i16 4)
+; SITES: call void @v_submit_address(ptr %0, ptr {{.*}}, i64 2, i32 -2147483648, i32 7, i8 2, i8 1, i16 4)
+
+; DEFAULT-NOT: .sites =
+; DEFAULT-LABEL: define {{.*}}@__amd_crk_stagePv(
+; DEFAULT: call void @v_submit_address(ptr %0, ptr {{.*}}, i64 {{-?[0-9]+}}, i32 3, i32 12, i8 1, i8 1, i16 4)
+
+define amdgpu_kernel void @stage(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 !dbg !5 {
+entry:
+  %v = load float, ptr addrspace(1) %in, align 4, !dbg !10
+  store float %v, ptr addrspace(3) @tile, align 4, !dbg !11
+  store float %v, ptr addrspace(1) %out, align 4, !dbg !12
+  ret void, !dbg !13
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus_14, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "stage.hip", directory: "/src")
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !{i32 7, !"Dwarf Version", i32 5}
+!5 = distinct !DISubprogram(name: "stage", scope: !1, file: !1, line: 2, type: !6, scopeLine: 2, spFlags: DISPFlagDefinition | DISPFlagOptimized, unit: !0)
+!6 = !DISubroutineType(types: !7)
+!7 = !{}
+!10 = !DILocation(line: 3, column: 12, scope: !5)
+!11 = !DILocation(line: 4, column: 5, scope: !5)
+!12 = !DILocation(line: 5, column: 7, scope: !5)
+!13 = !DILocation(line: 6, column: 1, scope: !5)
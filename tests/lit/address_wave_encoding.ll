@@ -0,0 +1,80 @@
+; Wave-compressed address messages (INSTRUMENTATION_WAVE_ENCODING). Before
+; submitting, each wave checks whether its addresses are affine in the lane
+; index or take at most four distinct values, and if so only the first lanes
+; submit the exec mask and base and stride, or the two index bit planes and
+; the values. The DWARF column then carries 0x20000000 and the encoding in bits
+; 26..28: 12 becomes 0x2400000C (603979788) when affine and 0x2800000C
+; (671088652) for a dictionary. See inc/wave_encoding.h.
+
+; RUN: env INSTRUMENTATION_WAVE_ENCODING=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=ENCODED
+; RUN: opt -load-pass-plugin %address_plugin -passes=amdgcn-submit-address-message \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=DEFAULT
+; RUN: env INSTRUMENTATION_WAVE_ENCODING=1 INSTRUMENTATION_HEATMAP=1 opt -load-pass-plugin %address_plugin \
+; RUN:   -passes=amdgcn-submit-address-message -S %s 2>/dev/null | FileCheck %s --check-prefix=HEATMAP
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+@tile = internal addrspace(3) global [64 x float] undef, align 4
+
+; ENCODED-LABEL: define {{.*}}@__amd_crk_stagePv(
+; ENCODED: %wave.addr = ptrtoint ptr {{.*}} to i64
+; ENCODED: [[EXEC:%[0-9]+]] = call i64 @llvm.amdgcn.ballot.i64(i1 true)
+; ENCODED: %wave.rank = zext i32
+; ENCODED: %wave.stride = sdiv i64
+; ENCODED: %wave.affine = and i1
+; ENCODED: %wave.dictionary = and i1
+; ENCODED: %wave.item = select i1 %wave.affine
+; ENCODED: %wave.items = select i1 %wave.affine, i64 3,
+; ENCODED: [[DICT:%[0-9]+]] = select i1 %wave.dictionary, i32 671088652, i32 12
+; ENCODED: %wave.column = select i1 %wave.affine, i32 603979788, i32 [[DICT]]
+; ENCODED: [[SEND:%[0-9]+]] = icmp ult i64 %wave.rank, %wave.items
+; ENCODED: br i1 [[SEND]], label %wave.send, label %wave.done
+; ENCODED: wave.send:
+; ENCODED: [[ITEM:%[0-9]+]] = inttoptr i64 %wave.item to ptr
+; ENCODED: call void @v_submit_address(ptr %0, ptr [[ITEM]], i64 {{-?[0-9]+}}, i32 3, i32 %wave.column, i8 1, i8 1, i16 4)
+; ENCODED: wave.done:
+; ENCODED-NEXT: %v = load float, ptr addrspace(1) %in
+; The LDS store and the global store are encoded too, one message each
+; ENCODED: call void @v_submit_address(ptr %0, ptr {{.*}}, i32 4, i32 %wave.column{{[0-9]+}}, i8 2, i8 3, i16 4)
+; ENCODED: call void @v_submit_address(ptr %0, ptr {{.*}}, i32 5, i32 %wave.column{{[0-9]+}}, i8 2, i8 1, i16 4)
+; ENCODED-NOT: @v_submit_address(
+; ENCODED: ret void
+
+; DEFAULT-LABEL: define {{.*}}@__amd_crk_stagePv(
+; DEFAULT-NOT: wave.
+; DEFAULT: call void @v_submit_address(ptr %0, ptr {{.*}}, i64 {{-?[0-9]+}}, i32 3, i32 12, i8 1, i8 1, i16 4)
+; DEFAULT-NOT: wave.
+; DEFAULT: ret void
+
+; Device heatmaps send no address messages, so there is nothing to encode
+; HEATMAP-LABEL: define {{.*}}@__amd_crk_stagePv(
+; HEATMAP-NOT: wave.
+; HEATMAP-NOT: @v_submit_address(
+; HEATMAP: ret void
+
+define amdgpu_kernel void @stage(ptr addrspace(1) %out, ptr addrspace(1) %in) #0 !dbg !5 {
+entry:
+  %v = load float, ptr addrspace(1) %in, align 4, !dbg !10
+  store float %v, ptr addrspace(3) @tile, align 4, !dbg !11
+  store float %v, ptr addrspace(1) %out, align 4, !dbg !12
+  ret void, !dbg !13
+}
+
+attributes #0 = { "target-cpu"="gfx90a" }
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus_14, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "stage.hip", directory: "/src")
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !{i32 7, !"Dwarf Version", i32 5}
+!5 = distinct !DISubprogram(name: "stage", scope: !1, file: !1, line: 2, type: !6, scopeLine: 2, spFlags: DISPFlagDefinition | DISPFlagOptimized, unit: !0)
+!6 = !DISubroutineType(types: !7)
+!7 = !{}
+!10 = !DILocation(line: 3, column: 12, scope: !5)
+!11 = !DILocation(line: 4, column: 5, scope: !5)
+!12 = !DILocation(line: 5, column: 7, scope: !5)
+!13 = !DILocation(line: 6, column: 1, scope: !5)
@@ -0,0 +1,185 @@
+; Timing regions in the basic block interval plugin (INSTRUMENTATION_TIMING_REGIONS).
+; Instead of an interval per basic block, each wave times the kernel and the loops
+; worth timing, from the loop preheader to the loop exits. user_data packs the
+; region index, the enclosing region and the loop depth (see inc/timing_region.h);
+; the DWARF line and column carry the region's first and last source line.
+
+; RUN: env INSTRUMENTATION_TIMING_REGIONS=loops opt -load-pass-plugin %bb_interval_plugin \
+; RUN:   -passes=amdgcn-submit-bb-interval -S %s 2>/dev/null | FileCheck %s --check-prefix=LOOPS
+; RUN: env INSTRUMENTATION_TIMING_REGIONS=loops:2 opt -load-pass-plugin %bb_interval_plugin \
+; RUN:   -passes=amdgcn-submit-bb-interval -S %s 2>/dev/null | FileCheck %s --check-prefix=DEPTH2
+; RUN: opt -load-pass-plugin %bb_interval_plugin -passes=amdgcn-submit-bb-interval \
+; RUN:   -S %s 2>/dev/null | FileCheck %s --check-prefix=BLOCKS
+; RUN: env INSTRUMENTATION_TIMING_REGIONS=loops:0 opt -load-pass-plugin %bb_interval_plugin \
+; RUN:   -passes=amdgcn-submit-bb-interval -S %s 2>&1 >/dev/null | FileCheck %s --check-prefix=INVALID
+
+target datalayout = "e-p:64:64-p1:64:64-p2:32:32-p3:32:32-p4:64:64-p5:32:32-p6:32:32-p7:160:256:256:32-p8:128:128-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-v2048:2048-n32:64-S32-A5-G1-ni:7:8"
+target triple = "amdgcn-amd-amdhsa"
+
+; for (i < n) for (j < m) out[i] += in[j]: by default only the kernel (lines 10-15,
+; user_data 0x80000000) and the outer loop (lines 10-12, region 1 at depth 1) are
+; timed. The shared exit gets a dedicated exit block so that the outer loop's stop
+; doesn't run when the loop is skipped.
+
+; LOOPS-LABEL: define {{.*}}@__amd_crk_nestedPv(
+; LOOPS: entry:
+; LOOPS-NEXT: %timeRegion = alloca [2 x i64]
+; LOOPS-NEXT: %timeRegion1 = alloca [2 x i64]
+; LOOPS-NEXT: [[KSTART:%.*]] = getelementptr inbounds [2 x i64], ptr addrspace(5) %timeRegion, i32 0, i32 0
+; LOOPS-NEXT: [[KCLOCK:%.*]] = call i64 @s_clock64()
+; LOOPS-NEXT: store i64 [[KCLOCK]], ptr addrspace(5) [[KSTART]]
+; LOOPS: outer.preheader:
+; LOOPS: call i64 @s_clock64()
+; LOOPS-NEXT: store
+; LOOPS-NEXT: br label %outer
+; LOOPS-NOT: @s_submit_time_interval
+; LOOPS: exit.loopexit:
+; LOOPS: call void @s_submit_time_interval(ptr %0, ptr %{{.*}}, i64 [[HASH:-?[0-9]+]], i32 10, i32 12, i32 -2130706431)
+; LOOPS-NEXT: br label %exit
+; LOOPS: exit:
+; LOOPS: call void @s_submit_time_interval(ptr %0, ptr %{{.*}}, i64 [[HASH]], i32 10, i32 15, i32 -2147483648)
+; LOOPS-NEXT: ret void
+
+; With loops:2 the inner loop is timed too, as region 2 inside region 1.
+
+; DEPTH2-LABEL: define {{.*}}@__amd_crk_nestedPv(
+; DEPTH2: outer.latch:
+; DEPTH2: call void @s_submit_time_interval({{.*}}, i32 11, i32 12, i32 -2113925118)
+; DEPTH2: exit.loopexit:
+; DEPTH2: call void @s_submit_time_interval({{.*}}, i32 10, i32 12, i32 -2130706431)
+
+; Without the variable every basic block is timed, numbered in order.
+
+; BLOCKS-LABEL: define {{.*}}@__amd_crk_nestedPv(
+; BLOCKS: call void @s_submit_time_interval({{.*}}, i32 0)
+; BLOCKS: call void @s_submit_time_interval({{.*}}, i32 1)
+; BLOCKS: call void @s_submit_time_interval({{.*}}, i32 2)
+; BLOCKS: call void @s_submit_time_interval({{.*}}, i32 3)
+; BLOCKS: call void @s_submit_time_interval({{.*}}, i32 4)
+; BLOCKS-NOT: timeRegion
+
+define amdgpu_kernel void @nested(ptr addrspace(1) %out, ptr addrspace(1) %in, i64 %n, i64 %m) #0 !dbg !5 {
+entry:
+  %guard = icmp sgt i64 %n, 0, !dbg !10
+  br i1 %guard, label %outer, label %exit, !dbg !10
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner, !dbg !11
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %src = getelementptr inbounds float, ptr addrspace(1) %in, i64 %j, !dbg !12
+  %v = load float, ptr addrspace(1) %src, align 4, !dbg !12
+  %dst = getelementptr inbounds float, ptr addrspace(1) %out, i64 %i, !dbg !12
+  %acc = load float, ptr addrspace(1) %dst, align 4, !dbg !12
+  %sum = fadd float %acc, %v, !dbg !12
+  store float %sum, ptr addrspace(1) %dst, align 4, !dbg !12
+  %j.next = add nuw nsw i64 %j, 1, !dbg !13
+  %jcont = icmp slt i64 %j.next, %m, !dbg !13
+  br i1 %jcont, label %inner, label %outer.latch, !dbg !13
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1, !dbg !14
+  %icont = icmp slt i64 %i.next, %n, !dbg !14
+  br i1 %icont, label %outer, label %exit, !dbg !14
+
+exit:
+  ret void, !dbg !15
+}
+
+; The loop runs twice and is too cheap to time on its own: only the kernel is timed.
+
+; LOOPS-LABEL: define {{.*}}@__amd_crk_tinyPv(
+; LOOPS: entry:
+; LOOPS: call i64 @s_clock64()
+; LOOPS: loop:
+; LOOPS-NOT: @s_clock64
+; LOOPS: exit:
+; LOOPS-NEXT: getelementptr
+; LOOPS-NEXT: call i64 @s_clock64()
+; LOOPS: call void @s_submit_time_interval(ptr %0, ptr %{{.*}}, i64 0, i32 16777215, i32 16777215, i32 -2147483648)
+
+define amdgpu_kernel void @tiny(ptr addrspace(1) %out) #0 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %dst = getelementptr inbounds float, ptr addrspace(1) %out, i64 %i
+  store float 0.0, ptr addrspace(1) %dst, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cont = icmp slt i64 %i.next, 2
+  br i1 %cont, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; A loop that lanes can leave through two exits, each of which returns. A wave
+; whose lanes take both exits runs them one after the other, so the exits are
+; first routed through one block, where the loop's region stops, and the returns
+; through another, where the kernel's does: each is submitted once per wave.
+
+; LOOPS-LABEL: define {{.*}}@__amd_crk_searchPv(
+; LOOPS-NOT: call void @s_submit_time_interval
+; LOOPS: UnifiedReturnBlock:
+; LOOPS-NEXT: getelementptr
+; LOOPS-NEXT: call i64 @s_clock64()
+; LOOPS: call void @s_submit_time_interval(ptr %0, ptr %{{.*}}, i64 0, i32 16777215, i32 16777215, i32 -2147483648)
+; LOOPS-NEXT: ret void
+; LOOPS: loop.exit.guard:
+; LOOPS-NEXT: {{%.*}} = phi i1
+; LOOPS-NEXT: getelementptr
+; LOOPS-NEXT: call i64 @s_clock64()
+; LOOPS: call void @s_submit_time_interval(ptr %0, ptr %{{.*}}, i64 0, i32 16777215, i32 16777215, i32 -2130706431)
+; LOOPS-NEXT: br i1 {{%.*}}, label %hit, label %miss
+; LOOPS-NOT: call void @s_submit_time_interval
+
+define amdgpu_kernel void @search(ptr addrspace(1) %out, ptr addrspace(1) %in, i64 %n) #0 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %src = getelementptr inbounds float, ptr addrspace(1) %in, i64 %i
+  %v = load float, ptr addrspace(1) %src, align 4
+  %found = fcmp oeq float %v, 0.0
+  br i1 %found, label %hit, label %latch
+
+latch:
+  %dst = getelementptr inbounds float, ptr addrspace(1) %out, i64 %i
+  store float %v, ptr addrspace(1) %dst, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cont = icmp slt i64 %i.next, %n
+  br i1 %cont, label %loop, label %miss
+
+hit:
+  store float 1.0, ptr addrspace(1) %out, align 4
+  ret void
+
+miss:
+  store float 0.0, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+; INVALID: invalid INSTRUMENTATION_TIMING_REGIONS 'loops:0'
+
+attributes #0 = { "target-cpu"="gfx90a" }
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus_14, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "nested.hip", directory: "/src")
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !{i32 7, !"Dwarf Version", i32 5}
+!5 = distinct !DISubprogram(name: "nested", scope: !1, file: !1, line: 9, type: !6, scopeLine: 9, spFlags: DISPFlagDefinition | DISPFlagOptimized, unit: !0)
+!6 = !DISubroutineType(types: !7)
+!7 = !{}
+!10 = !DILocation(line: 10, column: 3, scope: !5)
+!11 = !DILocation(line: 11, column: 5, scope: !5)
+!12 = !DILocation(line: 12, column: 14, scope: !5)
+!13 = !DILocation(line: 11, column: 27, scope: !5)
+!14 = !DILocation(line: 10, column: 25, scope: !5)
+!15 = !DILocation(line: 15, column: 1, scope: !5)
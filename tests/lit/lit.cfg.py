@@ -0,0 +1,27 @@
+# lit configuration for the instrumentation plugin tests. Run through CTest
+# (label "lit"), or directly with: llvm-lit -v <build>/tests/lit
+
+import os
+
+import lit.formats
+
+config.name = "omniprobe-instrumentation"
+config.test_format = lit.formats.ShTest(True)
+config.suffixes = [".ll"]
+config.excludes = ["CMakeLists.txt"]
+config.test_source_root = os.path.dirname(__file__)
+config.test_exec_root = config.lit_obj_root
+
+config.environment["PATH"] = os.pathsep.join(
+    [config.llvm_tools_dir, config.environment.get("PATH", "")])
+# The plugins read these at compile time; don't let the caller's environment leak into the tests
+for var in ["INSTRUMENTATION_SCOPE", "INSTRUMENTATION_SCOPE_FILE", "INSTRUMENTATION_AFFINE_SUMMARY",
+            "INSTRUMENTATION_GROUP_ACCESSES", "INSTRUMENTATION_SAMPLE", "INSTRUMENTATION_DUAL_PATH",
+            "INSTRUMENTATION_TIMING_REGIONS", "INSTRUMENTATION_SITE_MANIFEST",
+            "INSTRUMENTATION_HEATMAP", "INSTRUMENTATION_WAVE_ENCODING"]:
+    config.environment.pop(var, None)
+
+config.substitutions.append(
+    ("%address_plugin", os.path.join(config.plugin_dir, "libAMDGCNSubmitAddressMessages-rocm.so")))
+config.substitutions.append(
+    ("%bb_interval_plugin", os.path.join(config.plugin_dir, "libAMDGCNSubmitBBInterval-rocm.so")))
@@ -0,0 +1,79 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/access_group.h"
+#include "unit_test.h"
+
+namespace {
+
+uint32_t groupColumn(uint32_t column, uint32_t slots, uint32_t repeat)
+{
+    return ACCESS_GROUP_COLUMN_FLAG | column | (slots << ACCESS_GROUP_SLOT_SHIFT) |
+           ((repeat - 1) << ACCESS_GROUP_REPEAT_SHIFT);
+}
+
+void testOrdinaryMessage()
+{
+    uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES];
+    CHECK(!isAccessGroup(17));
+    CHECK_EQ(accessGroupColumn(17), 17u);
+    CHECK_EQ(accessGroupOffsets(17, 4, offsets), 1u);
+    CHECK_EQ(offsets[0], 0u);
+}
+
+void testSlots()
+{
+    // float loads at base + 0, 4, 12 (unrolled loop with a hole)
+    uint32_t column = groupColumn(9, 0b1011, 1);
+    CHECK(isAccessGroup(column));
+    CHECK_EQ(accessGroupColumn(column), 9u);
+    uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES];
+    CHECK_EQ(accessGroupOffsets(column, 4, offsets), 3u);
+    CHECK_EQ(offsets[0], 0u);
+    CHECK_EQ(offsets[1], 4u);
+    CHECK_EQ(offsets[2], 12u);
+}
+
+void testRepeats()
+{
+    // the same 8-byte location read three times
+    uint32_t column = groupColumn(4095, 0b1, 3);
+    CHECK_EQ(accessGroupColumn(column), 4095u);
+    uint64_t offsets[ACCESS_GROUP_MAX_ACCESSES];
+    CHECK_EQ(accessGroupOffsets(column, 8, offsets), 3u);
+    for (size_t i = 0; i < 3; i++)
+        CHECK_EQ(offsets[i], 0u);
+
+    // largest possible group
+    column = groupColumn(1, 0xffff, ACCESS_GROUP_MAX_REPEAT);
+    CHECK_EQ(accessGroupOffsets(column, 2, offsets), ACCESS_GROUP_MAX_ACCESSES);
+    CHECK_EQ(offsets[ACCESS_GROUP_MAX_ACCESSES - 1], 30u);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testOrdinaryMessage);
+    RUN_TEST(testSlots);
+    RUN_TEST(testRepeats);
+    return unit_test::finish();
+}
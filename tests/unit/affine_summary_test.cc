@@ -0,0 +1,88 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/affine_summary.h"
+#include "unit_test.h"
+
+namespace {
+
+uint64_t pack(uint32_t trip_count, int32_t stride)
+{
+    return (static_cast<uint64_t>(trip_count) << 32) | static_cast<uint32_t>(stride);
+}
+
+void testPacking()
+{
+    CHECK_EQ(affineTripCount(pack(7, 16)), 7u);
+    CHECK_EQ(affineStride(pack(7, 16)), 16);
+    CHECK_EQ(affineTripCount(pack(0xffffffffu, -4)), 0xffffffffu);
+    CHECK_EQ(affineStride(pack(0xffffffffu, -4)), -4);
+    CHECK(isAffineSummary(12 | AFFINE_SUMMARY_COLUMN_FLAG));
+    CHECK(!isAffineSummary(12));
+}
+
+void testMatches()
+{
+    affineSummary_t summary = {0x1234, 10, 5, {pack(4, 4), pack(4, 4)}};
+    CHECK(affineSummaryMatches(summary, 0x1234, 10, 5, 2));
+    CHECK(!affineSummaryMatches(summary, 0x1235, 10, 5, 2));
+    CHECK(!affineSummaryMatches(summary, 0x1234, 11, 5, 2));
+    CHECK(!affineSummaryMatches(summary, 0x1234, 10, 6, 2));
+    CHECK(!affineSummaryMatches(summary, 0x1234, 10, 5, 3));
+}
+
+// Expanding every iteration reproduces the addresses a per-iteration instrumented loop would have
+// submitted, including lanes that leave the loop early and negative strides
+void testExpansion()
+{
+    affineSummary_t summary = {0, 0, 0, {pack(3, 4), pack(1, 4), pack(3, -8)}};
+    std::vector<uint64_t> base = {0x1000, 0x1004, 0x2000};
+    CHECK_EQ(affineIterations(summary), 3u);
+
+    std::vector<uint64_t> addresses;
+    std::vector<size_t> lanes;
+    expandAffineIteration(summary, base, 1, addresses, lanes);
+    CHECK_EQ(addresses.size(), 2u);
+    CHECK_EQ(lanes.size(), 2u);
+    CHECK_EQ(lanes[0], 0u);
+    CHECK_EQ(addresses[0], 0x1004u);
+    CHECK_EQ(lanes[1], 2u);
+    CHECK_EQ(addresses[1], 0x1ff8u);
+
+    expandAffineIteration(summary, base, 2, addresses, lanes);
+    CHECK_EQ(addresses.size(), 2u);
+    CHECK_EQ(addresses[0], 0x1008u);
+    CHECK_EQ(addresses[1], 0x1ff0u);
+
+    expandAffineIteration(summary, base, 3, addresses, lanes);
+    CHECK_EQ(addresses.size(), 0u);
+    CHECK_EQ(lanes.size(), 0u);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testPacking);
+    RUN_TEST(testMatches);
+    RUN_TEST(testExpansion);
+    return unit_test::finish();
+}
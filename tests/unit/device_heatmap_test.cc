@@ -0,0 +1,214 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/device_heatmap.h"
+#include "unit_test.h"
+
+#include <string.h>
+#include <vector>
+
+namespace {
+
+const deviceHeatmapConfig_t CONFIG = {12, 64};
+
+// Counts one lane's access the way the plugin's device code does
+void deviceAccess(std::vector<uint8_t>& histogram, uint64_t address)
+{
+    deviceHeatmapHeader_t header;
+    memcpy(&header, histogram.data(), sizeof(header));
+    uint64_t key = (address >> header.page_shift_) + 1;
+    uint32_t log2_slots = __builtin_ctz(header.slot_count_);
+    uint64_t hash = (key * DEVICE_HEATMAP_HASH_MULTIPLIER) >> (64 - log2_slots);
+    auto *slots = reinterpret_cast<deviceHeatmapSlot_t *>(histogram.data() + sizeof(header));
+    for (uint32_t probe = 0; probe < DEVICE_HEATMAP_MAX_PROBES; probe++)
+    {
+        deviceHeatmapSlot_t& slot = slots[(hash + probe) & (header.slot_count_ - 1)];
+        if (slot.page_ == 0)
+            slot.page_ = key;
+        if (slot.page_ == key)
+        {
+            slot.count_++;
+            return;
+        }
+    }
+    header.dropped_++;
+    memcpy(histogram.data(), &header, sizeof(header));
+}
+
+std::vector<uint8_t> emptyHistogram(const deviceHeatmapConfig_t& config)
+{
+    std::vector<uint8_t> histogram(deviceHeatmapBytes(config), 0xcd);
+    deviceHeatmapInit(config, histogram.data());
+    return histogram;
+}
+
+// What memory_heatmap_t builds from the address messages of the same accesses
+std::map<uint64_t, size_t> messageCounts(const std::vector<uint64_t>& addresses, uint64_t page_size)
+{
+    std::map<uint64_t, size_t> counts;
+    for (uint64_t address : addresses)
+        ++counts[address / page_size * page_size];
+    return counts;
+}
+
+std::vector<uint64_t> someAddresses()
+{
+    std::vector<uint64_t> addresses;
+    uint64_t state = 1;
+    for (int i = 0; i < 2000; i++)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        // Clustered in a few regions, like the buffers of a kernel
+        uint64_t region = 0x7f0000000000ull + ((state >> 60) << 24);
+        addresses.push_back(region + ((state >> 20) & 0x3ffff));
+    }
+    return addresses;
+}
+
+void testInit()
+{
+    std::vector<uint8_t> histogram = emptyHistogram(CONFIG);
+    CHECK_EQ(histogram.size(), 32u + 64u * 16u);
+    deviceHeatmapHeader_t header;
+    memcpy(&header, histogram.data(), sizeof(header));
+    CHECK_EQ(header.page_shift_, 12u);
+    CHECK_EQ(header.slot_count_, 64u);
+    CHECK_EQ(header.dropped_, 0u);
+    for (size_t i = sizeof(header); i < histogram.size(); i++)
+        CHECK_EQ(histogram[i], 0);
+}
+
+void testMergeMatchesMessages()
+{
+    std::vector<uint64_t> addresses = someAddresses();
+    for (uint64_t page_size : {4096ull, 65536ull, 1024ull * 1024ull})
+    {
+        // the device counts 4 KiB pages, which fold into any larger host page
+        std::vector<uint8_t> histogram = emptyHistogram({12, 8192});
+        for (uint64_t address : addresses)
+            deviceAccess(histogram, address);
+        std::map<uint64_t, size_t> counts;
+        uint64_t dropped = 1;
+        CHECK(deviceHeatmapMerge(histogram.data(), histogram.size(), page_size, counts, dropped));
+        CHECK_EQ(dropped, 0u);
+        CHECK(counts == messageCounts(addresses, page_size));
+    }
+}
+
+void testMergeAccumulates()
+{
+    std::vector<uint8_t> histogram = emptyHistogram(CONFIG);
+    deviceAccess(histogram, 0x10000);
+    deviceAccess(histogram, 0x10fff);
+    deviceAccess(histogram, 0x11000);
+    // Dispatches of the same kernel add up, and a page can start at address 0
+    std::map<uint64_t, size_t> counts = {{0x10000, 5}};
+    uint64_t dropped = 0;
+    CHECK(deviceHeatmapMerge(histogram.data(), histogram.size(), 4096, counts, dropped));
+    deviceAccess(histogram, 0x0);
+    CHECK(deviceHeatmapMerge(histogram.data(), histogram.size(), 4096, counts, dropped));
+    CHECK_EQ(counts.size(), 3u);
+    CHECK_EQ(counts[0x0], 1u);
+    CHECK_EQ(counts[0x10000], 9u);
+    CHECK_EQ(counts[0x11000], 2u);
+}
+
+void testDropped()
+{
+    // More pages than slots: the overflow is reported, not lost silently
+    std::vector<uint8_t> histogram = emptyHistogram(CONFIG);
+    std::vector<uint64_t> addresses;
+    for (uint64_t page = 0; page < 100; page++)
+        addresses.push_back(page << 12);
+    for (uint64_t address : addresses)
+        deviceAccess(histogram, address);
+    std::map<uint64_t, size_t> counts;
+    uint64_t dropped = 0;
+    CHECK(deviceHeatmapMerge(histogram.data(), histogram.size(), 4096, counts, dropped));
+    CHECK_EQ(counts.size(), 64u);
+    CHECK_EQ(dropped, 36u);
+    size_t total = 0;
+    for (const auto& [page, count] : counts)
+        total += count;
+    CHECK_EQ(total + dropped, addresses.size());
+}
+
+void testLargeDevicePages()
+{
+    // 64 KiB device pages count towards the 4 KiB host page at their start
+    std::vector<uint8_t> histogram = emptyHistogram({16, 64});
+    deviceAccess(histogram, 0x12345);
+    deviceAccess(histogram, 0x1ffff);
+    std::map<uint64_t, size_t> counts;
+    uint64_t dropped = 0;
+    CHECK(deviceHeatmapMerge(histogram.data(), histogram.size(), 4096, counts, dropped));
+    CHECK_EQ(counts.size(), 1u);
+    CHECK_EQ(counts[0x10000], 2u);
+}
+
+void testMalformed()
+{
+    std::vector<uint8_t> histogram = emptyHistogram(CONFIG);
+    deviceAccess(histogram, 0x1000);
+    std::map<uint64_t, size_t> counts;
+    uint64_t dropped = 0;
+    CHECK(!deviceHeatmapMerge(histogram.data(), 16, 4096, counts, dropped));
+    // slots cut short
+    CHECK(!deviceHeatmapMerge(histogram.data(), histogram.size() - 16, 4096, counts, dropped));
+    CHECK(!deviceHeatmapMerge(histogram.data(), histogram.size(), 0, counts, dropped));
+    CHECK(counts.empty());
+}
+
+void testMarker()
+{
+    std::vector<uint8_t> marker = {'O', 'P', 'H', 'M', DEVICE_HEATMAP_VERSION, 0, 0, 0,
+                                   20, 0, 0, 0, 0, 0x20, 0, 0};
+    deviceHeatmapConfig_t config = {};
+    CHECK(parseDeviceHeatmapMarker(marker.data(), marker.size(), config));
+    CHECK_EQ(config.page_shift_, 20u);
+    CHECK_EQ(config.slot_count_, 8192u);
+    CHECK(!parseDeviceHeatmapMarker(marker.data(), marker.size() - 1, config));
+
+    std::vector<uint8_t> bad = marker;
+    bad[0] = 'X';
+    CHECK(!parseDeviceHeatmapMarker(bad.data(), bad.size(), config));
+    bad = marker;
+    bad[4] = DEVICE_HEATMAP_VERSION + 1;
+    CHECK(!parseDeviceHeatmapMarker(bad.data(), bad.size(), config));
+    // the slot count must be a power of two
+    bad = marker;
+    bad[12] = 3;
+    CHECK(!parseDeviceHeatmapMarker(bad.data(), bad.size(), config));
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testInit);
+    RUN_TEST(testMergeMatchesMessages);
+    RUN_TEST(testMergeAccumulates);
+    RUN_TEST(testDropped);
+    RUN_TEST(testLargeDevicePages);
+    RUN_TEST(testMalformed);
+    RUN_TEST(testMarker);
+    return unit_test::finish();
+}
@@ -0,0 +1,138 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/dispatch_decision_cache.h"
+#include "unit_test.h"
+
+namespace {
+
+// Stands in for dispatch_decision_t: what the resolver found, plus state the interceptor updates in place
+typedef struct {
+    uint64_t alt_kernel_object_;
+    bool kdb_scanned_;
+}decision_t;
+
+// Counts how often the cache falls through to the resolver, the way resolveDispatch does its name lookups
+struct countingResolver {
+    int calls_ = 0;
+    bool result_ = true;
+    uint64_t alt_ = 0;
+
+    decision_t *resolve(dispatchDecisionCache<decision_t>& cache, uint64_t agent, uint64_t kernel_object,
+                        uint64_t generation)
+    {
+        return cache.resolve(agent, kernel_object, generation, [&](decision_t& decision) {
+            calls_++;
+            CHECK_EQ(decision.alt_kernel_object_, 0u);
+            CHECK(!decision.kdb_scanned_);
+            decision.alt_kernel_object_ = alt_ + kernel_object;
+            return result_;
+        });
+    }
+};
+
+void testRepeatedDispatches()
+{
+    dispatchDecisionCache<decision_t> cache;
+    countingResolver resolver;
+    resolver.alt_ = 0x1000;
+    decision_t *first = resolver.resolve(cache, 1, 0x10, 0);
+    CHECK(first != nullptr);
+    if (!first)
+        return;
+    CHECK_EQ(first->alt_kernel_object_, 0x1010u);
+    first->kdb_scanned_ = true;
+    for (int i = 0; i < 100; i++)
+        CHECK(resolver.resolve(cache, 1, 0x10, 0) == first);
+    CHECK_EQ(resolver.calls_, 1);
+    CHECK(first->kdb_scanned_);
+
+    // Another kernel object, or the same one on another agent, is decided separately
+    decision_t *other = resolver.resolve(cache, 1, 0x20, 0);
+    decision_t *other_agent = resolver.resolve(cache, 2, 0x10, 0);
+    CHECK(other != first && other_agent != first && other != other_agent);
+    CHECK_EQ(resolver.calls_, 3);
+    CHECK_EQ(cache.size(), 3u);
+    CHECK(resolver.resolve(cache, 1, 0x10, 0) == first);
+    CHECK_EQ(resolver.calls_, 3);
+}
+
+void testGenerationChange()
+{
+    dispatchDecisionCache<decision_t> cache;
+    countingResolver resolver;
+    decision_t *decision = resolver.resolve(cache, 1, 0x10, 0);
+    CHECK(decision != nullptr);
+    if (!decision)
+        return;
+    decision->kdb_scanned_ = true;
+    resolver.resolve(cache, 1, 0x20, 0);
+    CHECK_EQ(resolver.calls_, 2);
+
+    // A new code object was published: every kernel object is decided again, from scratch
+    resolver.alt_ = 0x1000;
+    decision = resolver.resolve(cache, 1, 0x10, 1);
+    CHECK_EQ(resolver.calls_, 3);
+    CHECK_EQ(cache.size(), 1u);
+    CHECK(decision != nullptr);
+    if (!decision)
+        return;
+    CHECK_EQ(decision->alt_kernel_object_, 0x1010u);
+    CHECK(!decision->kdb_scanned_);
+    resolver.resolve(cache, 1, 0x10, 1);
+    CHECK_EQ(resolver.calls_, 3);
+
+    // Generations only need to differ, as co_generation_ is compared rather than ordered
+    resolver.resolve(cache, 1, 0x10, 5);
+    resolver.resolve(cache, 1, 0x10, 5);
+    CHECK_EQ(resolver.calls_, 4);
+
+    cache.clear();
+    CHECK_EQ(cache.size(), 0u);
+    resolver.resolve(cache, 1, 0x10, 5);
+    CHECK_EQ(resolver.calls_, 5);
+}
+
+void testDeclined()
+{
+    // Nothing in the kernel cache yet: nothing is cached, so the next dispatch asks again
+    dispatchDecisionCache<decision_t> cache;
+    countingResolver resolver;
+    resolver.result_ = false;
+    CHECK(resolver.resolve(cache, 1, 0x10, 0) == nullptr);
+    CHECK(resolver.resolve(cache, 1, 0x10, 0) == nullptr);
+    CHECK_EQ(resolver.calls_, 2);
+    CHECK_EQ(cache.size(), 0u);
+    resolver.result_ = true;
+    CHECK(resolver.resolve(cache, 1, 0x10, 0) != nullptr);
+    CHECK(resolver.resolve(cache, 1, 0x10, 0) != nullptr);
+    CHECK_EQ(resolver.calls_, 3);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testRepeatedDispatches);
+    RUN_TEST(testGenerationChange);
+    RUN_TEST(testDeclined);
+    return unit_test::finish();
+}
@@ -0,0 +1,150 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/event_reactor.h"
+#include "unit_test.h"
+
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+bool waitFor(const std::atomic<int>& counter, int value)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (counter.load() < value && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    return counter.load() >= value;
+}
+
+void testEvents()
+{
+    eventReactor reactor;
+    std::atomic<int> calls(0);
+    std::thread::id handler_thread;
+    int event = reactor.addEvent([&]() {
+        handler_thread = std::this_thread::get_id();
+        calls++;
+    });
+    CHECK(event >= 0);
+    // Notifications before start() are delivered once it's running
+    eventReactor::notify(event);
+    CHECK(reactor.start());
+    CHECK(reactor.running());
+    CHECK(waitFor(calls, 1));
+    CHECK(handler_thread != std::this_thread::get_id());
+
+    // Notifications raised together coalesce into a single handler call
+    int before = calls.load();
+    reactor.stop();
+    for (int i = 0; i < 10; i++)
+        eventReactor::notify(event);
+    CHECK(reactor.start());
+    CHECK(waitFor(calls, before + 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK_EQ(calls.load(), before + 1);
+    reactor.stop();
+    CHECK(!reactor.running());
+    reactor.stop();
+}
+
+void testFds()
+{
+    eventReactor reactor;
+    int fds[2];
+    CHECK_EQ(pipe(fds), 0);
+    std::atomic<int> bytes(0);
+    CHECK(reactor.watchFd(fds[0], [&]() {
+        char buffer[16];
+        ssize_t length = read(fds[0], buffer, sizeof(buffer));
+        if (length > 0)
+            bytes += static_cast<int>(length);
+    }));
+    CHECK(!reactor.watchFd(-1, []() {}));
+    CHECK(reactor.start());
+    CHECK_EQ(write(fds[1], "abc", 3), 3);
+    CHECK(waitFor(bytes, 3));
+
+    // Once unwatched, the fd no longer wakes the reactor
+    reactor.unwatchFd(fds[0]);
+    uint64_t wakeups = reactor.wakeups();
+    CHECK_EQ(write(fds[1], "de", 2), 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK_EQ(bytes.load(), 3);
+    CHECK_EQ(reactor.wakeups(), wakeups);
+    reactor.stop();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void testTimers()
+{
+    eventReactor reactor;
+    std::atomic<int> ticks(0);
+    CHECK_EQ(reactor.addTimer(0, []() {}), -1);
+    CHECK(reactor.addTimer(2, [&]() { ticks++; }) >= 0);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(reactor.start());
+    CHECK(waitFor(ticks, 3));
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(6));
+    reactor.stop();
+}
+
+void testIdle()
+{
+    // With nothing to do the reactor thread stays asleep
+    eventReactor reactor;
+    reactor.addEvent([]() {});
+    CHECK(reactor.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(reactor.wakeups(), 0u);
+    reactor.stop();
+}
+
+void testHandlerRegisters()
+{
+    // Handlers may add sources from the reactor thread
+    eventReactor reactor;
+    std::atomic<int> calls(0);
+    int second = -1;
+    int first = reactor.addEvent([&]() {
+        second = reactor.addEvent([&]() { calls++; });
+        eventReactor::notify(second);
+    });
+    CHECK(reactor.start());
+    eventReactor::notify(first);
+    CHECK(waitFor(calls, 1));
+    reactor.stop();
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testEvents);
+    RUN_TEST(testFds);
+    RUN_TEST(testTimers);
+    RUN_TEST(testIdle);
+    RUN_TEST(testHandlerRegisters);
+    return unit_test::finish();
+}
@@ -0,0 +1,164 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/ingest_queue.h"
+#include "unit_test.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct ingestLog {
+    std::mutex mutex_;
+    std::map<std::string, int> counts_;
+    int running_ = 0;
+    int max_running_ = 0;
+
+    void record(const std::string& path, int sleep_ms)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            counts_[path]++;
+            max_running_ = std::max(max_running_, ++running_);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_--;
+    }
+    int count(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counts_[path];
+    }
+};
+
+void testDebounce()
+{
+    ingestLog log;
+    ingestQueue queue([&](const std::string& path) { log.record(path, 0); }, 200, 2);
+    // A burst of events for the same file is ingested once, after the burst
+    for (int i = 0; i < 10; i++)
+    {
+        queue.enqueue("a.hsaco");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    CHECK_EQ(log.count("a.hsaco"), 0);
+    CHECK(queue.drain(5000));
+    CHECK_EQ(log.count("a.hsaco"), 1);
+    ingestQueue::ingest_stats_t stats = queue.stats();
+    CHECK_EQ(stats.enqueued_, 10u);
+    CHECK_EQ(stats.coalesced_, 9u);
+    CHECK_EQ(stats.ingested_, 1u);
+}
+
+void testParallel()
+{
+    ingestLog log;
+    ingestQueue queue([&](const std::string& path) { log.record(path, 50); }, 1, 4);
+    for (int i = 0; i < 8; i++)
+        queue.enqueue("k" + std::to_string(i) + ".hsaco");
+    CHECK(queue.drain(5000));
+    for (int i = 0; i < 8; i++)
+        CHECK_EQ(log.count("k" + std::to_string(i) + ".hsaco"), 1);
+    CHECK(log.max_running_ > 1);
+    CHECK(log.max_running_ <= 4);
+}
+
+void testEnqueueWhileRunning()
+{
+    // The same path is never ingested twice at once, but an event that arrives mid-ingest runs it again
+    ingestLog log;
+    std::atomic<bool> started(false);
+    ingestQueue queue([&](const std::string& path) {
+        started = true;
+        log.record(path, 50);
+    }, 1, 4);
+    queue.enqueue("a.hsaco");
+    while (!started)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    queue.enqueue("a.hsaco");
+    queue.enqueue("a.hsaco");
+    CHECK(queue.drain(5000));
+    CHECK_EQ(log.count("a.hsaco"), 2);
+    CHECK_EQ(log.max_running_, 1);
+}
+
+void testEnqueueDoesNotWait()
+{
+    std::atomic<bool> release(false);
+    ingestQueue queue([&](const std::string&) {
+        while (!release)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, 0, 1);
+    queue.enqueue("slow.hsaco");
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; i++)
+        queue.enqueue("other" + std::to_string(i) + ".hsaco");
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+    CHECK(!queue.drain(20));
+    release = true;
+    CHECK(queue.drain(5000));
+    CHECK_EQ(queue.stats().ingested_, 101u);
+}
+
+void testErrorsAndStop()
+{
+    ingestLog log;
+    ingestQueue queue([&](const std::string& path) {
+        if (path == "bad.hsaco")
+            throw std::runtime_error("not a code object");
+        log.record(path, 0);
+    }, 1, 1);
+    // A failing ingest doesn't take its worker down
+    queue.enqueue("bad.hsaco");
+    CHECK(queue.drain(5000));
+    queue.enqueue("good.hsaco");
+    CHECK(queue.drain(5000));
+    CHECK_EQ(log.count("good.hsaco"), 1);
+
+    // Paths still waiting at stop() are dropped, and enqueue() after it is ignored
+    ingestQueue stopped([&](const std::string& path) { log.record(path, 0); }, 10000, 1);
+    stopped.enqueue("late.hsaco");
+    stopped.stop();
+    stopped.stop();
+    stopped.enqueue("later.hsaco");
+    CHECK(stopped.drain(10));
+    CHECK_EQ(log.count("late.hsaco"), 0);
+    CHECK_EQ(stopped.stats().ingested_, 0u);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testDebounce);
+    RUN_TEST(testParallel);
+    RUN_TEST(testEnqueueWhileRunning);
+    RUN_TEST(testEnqueueDoesNotWait);
+    RUN_TEST(testErrorsAndStop);
+    return unit_test::finish();
+}
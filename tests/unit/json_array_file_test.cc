@@ -0,0 +1,252 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/json_array_file.h"
+#include "inc/json_reader.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string tempPath()
+{
+    char path[] = "/tmp/json_array_file_testXXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        close(fd);
+    return path;
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// The number of records if text is one complete JSON array, or -1
+int arrayLength(const std::string& text)
+{
+    jsonReader reader(text.data(), text.data() + text.size());
+    jsonValue value;
+    if (!reader.read(value) || !value.isArray())
+        return -1;
+    reader.skipWhitespace();
+    return reader.atEnd() ? static_cast<int>(value.items().size()) : -1;
+}
+
+std::string record(const std::string& kernel, uint64_t dispatch_id)
+{
+    return "{\n  \"kernel_info\": {\n    \"name\": \"" + kernel + "\",\n    \"dispatch_id\": " +
+           std::to_string(dispatch_id) + "\n  }\n}";
+}
+
+void testAppend()
+{
+    std::string path = tempPath();
+    {
+        // Left over from an earlier run
+        std::ofstream stale(path);
+        stale << "[\n{\"stale\": 1}\n]\n";
+    }
+    jsonArrayFile *file = jsonArrayFile::open(path);
+    CHECK(file != nullptr);
+    if (!file)
+        return;
+    CHECK(jsonArrayFile::open(path) == file);
+    // Extended, not truncated
+    CHECK_EQ(readFile(path), std::string("[\n{\"stale\": 1}\n]\n"));
+
+    for (uint64_t dispatch = 1; dispatch <= 5; dispatch++)
+    {
+        CHECK(file->append(record("_Z4gemmPf", dispatch), "_Z4gemmPf", dispatch));
+        // Complete after every record
+        CHECK_EQ(arrayLength(readFile(path)), static_cast<int>(dispatch) + 1);
+    }
+    CHECK_EQ(file->records(), 5u);
+
+    // Each index line points at its record
+    std::string text = readFile(path);
+    std::istringstream index(readFile(path + JSON_ARRAY_INDEX_SUFFIX));
+    std::string line;
+    std::getline(index, line);
+    CHECK_EQ(line + "\n", std::string(JSON_ARRAY_INDEX_HEADER));
+    uint64_t offset, length, dispatch_id, expected = 1;
+    std::string kernel;
+    while (index >> offset >> length >> dispatch_id >> kernel)
+    {
+        CHECK_EQ(dispatch_id, expected);
+        CHECK_EQ(kernel, std::string("_Z4gemmPf"));
+        CHECK(offset + length <= text.size());
+        CHECK_EQ(text.substr(offset, length), record("_Z4gemmPf", expected));
+        expected++;
+    }
+    CHECK_EQ(expected, 6u);
+    unlink(path.c_str());
+    unlink((path + JSON_ARRAY_INDEX_SUFFIX).c_str());
+}
+
+void testConcurrent()
+{
+    // Handlers of dispatches completing on different threads share the file
+    std::string path = tempPath();
+    const int THREADS = 4;
+    const int RECORDS = 200;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < RECORDS; i++)
+            {
+                jsonArrayFile *file = jsonArrayFile::open(path);
+                if (file)
+                    file->append(record("k" + std::to_string(t), i), "k" + std::to_string(t), i);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    CHECK_EQ(arrayLength(readFile(path)), THREADS * RECORDS);
+    std::istringstream index(readFile(path + JSON_ARRAY_INDEX_SUFFIX));
+    std::string line;
+    int lines = 0;
+    while (std::getline(index, line))
+        lines++;
+    CHECK_EQ(lines, THREADS * RECORDS + 1);
+    unlink(path.c_str());
+    unlink((path + JSON_ARRAY_INDEX_SUFFIX).c_str());
+}
+
+void testProcesses()
+{
+    // Ranks of one job, or forked workers, sharing the output location; the parent has written before forking
+    std::string path = tempPath();
+    const int PROCESSES = 4;
+    const int RECORDS = 100;
+    jsonArrayFile *file = jsonArrayFile::open(path);
+    CHECK(file != nullptr);
+    if (!file)
+        return;
+    CHECK(file->append(record("parent", 0), "parent", 0));
+    std::vector<pid_t> children;
+    for (int p = 0; p < PROCESSES; p++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            std::string kernel = "k" + std::to_string(p);
+            jsonArrayFile *child = jsonArrayFile::open(path);
+            bool ok = child && child != file;
+            for (int i = 0; ok && i < RECORDS; i++)
+                ok = child->append(record(kernel, i), kernel, i);
+            _exit(ok ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children)
+    {
+        int status = -1;
+        waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    CHECK(file->append(record("parent", 1), "parent", 1));
+    std::string text = readFile(path);
+    CHECK_EQ(arrayLength(text), PROCESSES * RECORDS + 2);
+
+    // One header, and every index line points at its record
+    std::istringstream index(readFile(path + JSON_ARRAY_INDEX_SUFFIX));
+    std::string line;
+    std::getline(index, line);
+    CHECK_EQ(line + "\n", std::string(JSON_ARRAY_INDEX_HEADER));
+    uint64_t offset, length, dispatch_id;
+    std::string kernel;
+    int lines = 0;
+    while (index >> offset >> length >> dispatch_id >> kernel)
+    {
+        CHECK(offset + length <= text.size());
+        CHECK_EQ(text.substr(offset, length), record(kernel, dispatch_id));
+        lines++;
+    }
+    CHECK_EQ(lines, PROCESSES * RECORDS + 2);
+    unlink(path.c_str());
+    unlink((path + JSON_ARRAY_INDEX_SUFFIX).c_str());
+}
+
+void testProcessPath()
+{
+    std::string pid = std::to_string(getpid());
+    CHECK_EQ(jsonArrayFile::processPath("out.json"), std::string("out.json"));
+    CHECK_EQ(jsonArrayFile::processPath("out.%p.json"), "out." + pid + ".json");
+    CHECK_EQ(jsonArrayFile::processPath("%p/%p%"), pid + "/" + pid + "%");
+
+    std::string path = tempPath();
+    jsonArrayFile *file = jsonArrayFile::open(path + ".%p");
+    CHECK(file != nullptr);
+    if (file)
+        CHECK(file->append(record("k", 1), "k", 1));
+    CHECK_EQ(arrayLength(readFile(path + "." + pid)), 1);
+    unlink(path.c_str());
+    unlink((path + "." + pid).c_str());
+    unlink((path + "." + pid + JSON_ARRAY_INDEX_SUFFIX).c_str());
+}
+
+void testNotAnArray()
+{
+    // Someone else's file is left as it is
+    std::string path = tempPath();
+    {
+        std::ofstream other(path);
+        other << "kernel,dispatch,startNs,endNs\n";
+    }
+    jsonArrayFile *file = jsonArrayFile::open(path);
+    CHECK(file != nullptr);
+    if (file)
+        CHECK(!file->append(record("k", 1), "k", 1));
+    CHECK_EQ(readFile(path), std::string("kernel,dispatch,startNs,endNs\n"));
+    unlink(path.c_str());
+    unlink((path + JSON_ARRAY_INDEX_SUFFIX).c_str());
+}
+
+void testUnwritable()
+{
+    CHECK(jsonArrayFile::open("/nonexistent/omniprobe/output.json") == nullptr);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testAppend);
+    RUN_TEST(testConcurrent);
+    RUN_TEST(testProcesses);
+    RUN_TEST(testProcessPath);
+    RUN_TEST(testNotAnArray);
+    RUN_TEST(testUnwritable);
+    return unit_test::finish();
+}
@@ -0,0 +1,139 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/json_reader.h"
+#include "unit_test.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+
+namespace {
+
+bool parse(const std::string& text, jsonValue& value)
+{
+    jsonReader reader(text.data(), text.data() + text.size());
+    return reader.read(value);
+}
+
+void testValues()
+{
+    std::string text = R"({"name": "vector_add", "count": 18446744073709551615, "rate": -0.25, "exp": 1e3,
+                           "flag": true, "off": false, "none": null, "list": [1, [2, 3], {}], "empty": []})";
+    jsonValue value;
+    CHECK(parse(text, value));
+    CHECK(value.isObject());
+    CHECK_EQ(value.members().size(), 9u);
+    CHECK_EQ(value.stringAt("name"), std::string("vector_add"));
+    CHECK_EQ(value.uintAt("count"), UINT64_MAX);
+    CHECK_EQ(value.doubleAt("rate"), -0.25);
+    CHECK_EQ(value.uintAt("rate", 7), 0u);
+    CHECK_EQ(value.uintAt("exp"), 1000u);
+    CHECK(value.find("flag")->asBool());
+    CHECK(!value.find("off")->asBool(true));
+    CHECK(value.find("none")->isNull());
+    CHECK(value.find("missing") == nullptr);
+    CHECK_EQ(value.uintAt("missing", 5), 5u);
+    CHECK(value.stringAt("count").empty());
+    const jsonValue *list = value.find("list");
+    CHECK(list && list->isArray());
+    CHECK_EQ(list->items().size(), 3u);
+    CHECK_EQ(list->items()[1].items()[1].asUint(), 3u);
+    CHECK(list->items()[2].isObject() && list->items()[2].members().empty());
+    CHECK(value.find("empty")->items().empty());
+}
+
+void testStrings()
+{
+    jsonValue value;
+    CHECK(parse(R"("tab\t quote\" slash\/ back\\ \u00e9 \ud83d\ude00")", value));
+    CHECK_EQ(value.asString(), std::string("tab\t quote\" slash/ back\\ \xc3\xa9 \xf0\x9f\x98\x80"));
+
+    // What MemoryAnalysis writes for a source line with quotes in it
+    std::string text = "{\"code_context\": \"printf(\"%d, %s\", x, \"y\");\",\n \"line\": 12}";
+    CHECK(parse(text, value));
+    CHECK_EQ(value.stringAt("code_context"), std::string("printf(\"%d, %s\", x, \"y\");"));
+    CHECK_EQ(value.uintAt("line"), 12u);
+
+    std::ostringstream out;
+    writeJsonString(out, std::string("a\"b\\c\nd\x01", 8));
+    CHECK_EQ(out.str(), std::string("\"a\\\"b\\\\c\\nd\\u0001\""));
+    CHECK(parse(out.str(), value));
+    CHECK_EQ(value.asString(), std::string("a\"b\\c\nd\x01", 8));
+}
+
+void testErrors()
+{
+    const char *bad[] = {"{\"a\": 1", "{\"a\" 1}", "[1 2]", "tru", "\"open", "{\"a\": \"line\nbreak\"}", "-", "{,}",
+                         "\"\\x\""};
+    for (const char *text : bad)
+    {
+        jsonValue value;
+        jsonReader reader(text, text + strlen(text));
+        CHECK(!reader.read(value));
+        CHECK(reader.error() != nullptr);
+    }
+
+    // Reading stops after one value, wherever the text goes on
+    std::string text = "{\"a\": 1}\n,{\"b\": 2}";
+    jsonReader reader(text.data(), text.data() + text.size());
+    jsonValue value;
+    CHECK(reader.read(value));
+    CHECK_EQ(reader.position() - text.data(), 8);
+    CHECK_EQ(value.uintAt("a"), 1u);
+}
+
+void testReuse()
+{
+    // A value read into again holds only what was read last, whatever it held before
+    jsonValue value;
+    CHECK(parse(R"({"a": [1, 2, 3], "b": {"c": "x"}, "d": 4})", value));
+    CHECK(parse(R"({"a": [5], "b": 6})", value));
+    CHECK_EQ(value.members().size(), 2u);
+    CHECK_EQ(value.find("a")->items().size(), 1u);
+    CHECK_EQ(value.find("a")->items()[0].asUint(), 5u);
+    CHECK(value.find("b")->isNumber() && value.find("b")->members().empty());
+    CHECK_EQ(value.uintAt("b"), 6u);
+    CHECK(value.find("d") == nullptr);
+    CHECK(parse("[{\"a\": true}, 1.5]", value));
+    CHECK(value.isArray() && value.members().empty());
+    CHECK_EQ(value.items().size(), 2u);
+    CHECK(value.items()[0].find("a")->asBool());
+    CHECK_EQ(value.items()[1].asUint(7), 2u);
+    CHECK(parse("\"text\"", value));
+    CHECK(value.isString() && value.items().empty());
+    CHECK(parse("{}", value));
+    CHECK(value.isObject() && value.members().empty());
+    CHECK(parse("false", value));
+    CHECK(!value.asBool(true));
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testValues);
+    RUN_TEST(testStrings);
+    RUN_TEST(testErrors);
+    RUN_TEST(testReuse);
+    return unit_test::finish();
+}
@@ -0,0 +1,180 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/kernarg_repack.h"
+#include "unit_test.h"
+
+#include <string.h>
+#include <vector>
+
+namespace {
+
+const unsigned char GARBAGE = 0xcd;
+
+// The repacking fixupKernArgs did before it used a precompiled plan: zero the whole
+// segment, copy the explicit args, copy the hidden args (if any) up one pointer, then
+// drop in the dh_comms pointer.
+void referenceRepack(char *dst, const char *src, void *comms, size_t explicit_args_length,
+                     size_t clone_hidden_args_length, size_t kernarg_length)
+{
+    memset(dst, 0, kernarg_length);
+    memcpy(dst, src, explicit_args_length - sizeof(void *));
+    if (clone_hidden_args_length)
+        memcpy(dst + explicit_args_length, src + explicit_args_length - sizeof(void *), clone_hidden_args_length);
+    memcpy(dst + explicit_args_length - sizeof(void *), &comms, sizeof(void *));
+}
+
+std::vector<char> makeSource(size_t length)
+{
+    std::vector<char> src(length);
+    for (size_t i = 0; i < length; i++)
+        src[i] = static_cast<char>(i * 7 + 1);
+    return src;
+}
+
+void checkAgainstReference(size_t explicit_args_length, size_t clone_hidden_args_length, size_t kernarg_length)
+{
+    kernargRepackPlan plan(explicit_args_length, clone_hidden_args_length, kernarg_length);
+    CHECK(plan.valid());
+    // The uninstrumented kernarg segment is one pointer shorter in its explicit args
+    std::vector<char> src = makeSource(explicit_args_length - sizeof(void *) + clone_hidden_args_length);
+    void *comms = reinterpret_cast<void *>(0x1122334455667788ull);
+    std::vector<char> expected(kernarg_length, static_cast<char>(GARBAGE));
+    std::vector<char> actual(kernarg_length, static_cast<char>(GARBAGE));
+    referenceRepack(expected.data(), src.data(), comms, explicit_args_length, clone_hidden_args_length, kernarg_length);
+    plan.apply(actual.data(), src.data(), comms);
+    CHECK(expected == actual);
+
+    // Every destination byte is written exactly once by a copy, a zero fill or the comms pointer
+    size_t covered = sizeof(void *);
+    for (size_t i = 0; i < plan.copyCount(); i++)
+        covered += plan.copy(i).length_;
+    for (size_t i = 0; i < plan.zeroCount(); i++)
+        covered += plan.zero(i).length_;
+    CHECK_EQ(covered, kernarg_length);
+}
+
+// HIP kernel: three explicit pointer args plus the dh_comms pointer, 256 bytes of hidden args
+void testHiddenArgs()
+{
+    kernargRepackPlan plan(32, 256, 288);
+    CHECK(plan.valid());
+    CHECK_EQ(plan.commsOffset(), 24u);
+    CHECK_EQ(plan.copyCount(), 2u);
+    CHECK_EQ(plan.zeroCount(), 0u);
+    CHECK_EQ(plan.copy(0).dst_offset_, 0u);
+    CHECK_EQ(plan.copy(0).src_offset_, 0u);
+    CHECK_EQ(plan.copy(0).length_, 24u);
+    CHECK_EQ(plan.copy(1).dst_offset_, 32u);
+    CHECK_EQ(plan.copy(1).src_offset_, 24u);
+    CHECK_EQ(plan.copy(1).length_, 256u);
+    checkAgainstReference(32, 256, 288);
+}
+
+// Instrumented clone has more hidden arg space than the original supplied; the tail is zeroed
+void testHiddenArgsWithTail()
+{
+    kernargRepackPlan plan(20, 56, 96);
+    CHECK(plan.valid());
+    CHECK_EQ(plan.zeroCount(), 1u);
+    CHECK_EQ(plan.zero(0).dst_offset_, 76u);
+    CHECK_EQ(plan.zero(0).length_, 20u);
+    checkAgainstReference(20, 56, 96);
+}
+
+// Triton: the uninstrumented kernel has no hidden args, but the clone does
+void testTritonNoHiddenArgs()
+{
+    kernargRepackPlan plan(40, 0, 296);
+    CHECK(plan.valid());
+    CHECK_EQ(plan.commsOffset(), 32u);
+    CHECK_EQ(plan.copyCount(), 1u);
+    CHECK_EQ(plan.zeroCount(), 1u);
+    CHECK_EQ(plan.zero(0).dst_offset_, 40u);
+    CHECK_EQ(plan.zero(0).length_, 256u);
+    checkAgainstReference(40, 0, 296);
+}
+
+// Triton: neither kernel has hidden args
+void testTritonNoHiddenArgsAtAll()
+{
+    kernargRepackPlan plan(40, 0, 40);
+    CHECK(plan.valid());
+    CHECK_EQ(plan.copyCount(), 1u);
+    CHECK_EQ(plan.zeroCount(), 0u);
+    checkAgainstReference(40, 0, 40);
+}
+
+// A kernel whose only explicit argument is the dh_comms pointer
+void testOnlyCommsPointer()
+{
+    kernargRepackPlan plan(8, 256, 264);
+    CHECK(plan.valid());
+    CHECK_EQ(plan.commsOffset(), 0u);
+    CHECK_EQ(plan.copyCount(), 1u);
+    checkAgainstReference(8, 256, 264);
+    checkAgainstReference(8, 0, 8);
+}
+
+// Packed, non pointer-aligned explicit args
+void testUnalignedExplicitArgs()
+{
+    checkAgainstReference(20, 256, 280);
+    checkAgainstReference(12, 0, 12);
+}
+
+// Dual-path clones are dispatched with a null dh_comms pointer when a dispatch isn't captured
+void testNullCommsPointer()
+{
+    kernargRepackPlan plan(32, 256, 288);
+    std::vector<char> src = makeSource(24 + 256);
+    std::vector<char> expected(288, static_cast<char>(GARBAGE));
+    std::vector<char> actual(288, static_cast<char>(GARBAGE));
+    referenceRepack(expected.data(), src.data(), nullptr, 32, 256, 288);
+    plan.apply(actual.data(), src.data(), nullptr);
+    CHECK(expected == actual);
+    void *comms = reinterpret_cast<void *>(1);
+    memcpy(&comms, actual.data() + plan.commsOffset(), sizeof(void *));
+    CHECK(comms == nullptr);
+}
+
+void testInvalidDescriptors()
+{
+    CHECK(!kernargRepackPlan().valid());
+    CHECK(!kernargRepackPlan(4, 0, 4).valid());      // No room for the dh_comms pointer
+    CHECK(!kernargRepackPlan(32, 0, 16).valid());    // Explicit args longer than the segment
+    CHECK(!kernargRepackPlan(32, 264, 288).valid()); // Hidden args don't fit in the clone
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testHiddenArgs);
+    RUN_TEST(testHiddenArgsWithTail);
+    RUN_TEST(testTritonNoHiddenArgs);
+    RUN_TEST(testTritonNoHiddenArgsAtAll);
+    RUN_TEST(testOnlyCommsPointer);
+    RUN_TEST(testUnalignedExplicitArgs);
+    RUN_TEST(testNullCommsPointer);
+    RUN_TEST(testInvalidDescriptors);
+    return unit_test::finish();
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/kernel_names.h"
+#include "unit_test.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void testIntern()
+{
+    kernelNameTable& names = kernelNames();
+    CHECK(&names == &kernelNameTable::instance());
+    CHECK_EQ(names.intern(""), static_cast<kernel_name_id_t>(KERNEL_NAME_EMPTY));
+    CHECK(names.name(KERNEL_NAME_EMPTY).empty());
+
+    size_t before = names.size();
+    std::string name = "_Z6kernelPfi";
+    kernel_name_id_t id = names.intern(name);
+    CHECK_EQ(static_cast<size_t>(id), before);
+    CHECK_EQ(names.size(), before + 1);
+    // Same text, different storage: same id
+    CHECK_EQ(names.intern(std::string("_Z6kernelPfi")), id);
+    CHECK_EQ(names.name(id), std::string_view(name));
+    CHECK(names.name(id).data() != name.data());
+    CHECK_EQ(names.intern("_Z6kernelPfi_instrumented"), id + 1);
+
+    // find() never adds
+    CHECK_EQ(names.find(name), id);
+    CHECK_EQ(names.find("never_interned"), static_cast<kernel_name_id_t>(KERNEL_NAME_INVALID));
+    CHECK_EQ(names.size(), before + 2);
+    CHECK(names.name(KERNEL_NAME_INVALID).empty());
+}
+
+void testStableViews()
+{
+    // Views handed out early stay valid while the table grows across several chunks
+    kernelNameTable& names = kernelNames();
+    kernel_name_id_t first = names.intern("stable_first");
+    std::string_view view = names.name(first);
+    for (int i = 0; i < 10000; i++)
+        names.intern("stable_" + std::to_string(i));
+    CHECK_EQ(view, std::string_view("stable_first"));
+    CHECK_EQ(names.name(first).data(), view.data());
+    CHECK_EQ(names.name(names.find("stable_9999")), std::string_view("stable_9999"));
+}
+
+void testConcurrent()
+{
+    // Threads interning overlapping names agree on every id, and can read names interned by the others
+    const int THREADS = 8;
+    const int NAMES = 2000;
+    std::vector<std::vector<kernel_name_id_t>> ids(THREADS, std::vector<kernel_name_id_t>(NAMES));
+    std::vector<int> mismatches(THREADS, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < NAMES; i++)
+            {
+                int n = (i + t * 131) % NAMES;
+                std::string name = "concurrent_" + std::to_string(n);
+                kernel_name_id_t id = kernelNames().intern(name);
+                ids[t][n] = id;
+                if (kernelNames().name(id) != name)
+                    mismatches[t]++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    for (int t = 0; t < THREADS; t++)
+    {
+        CHECK_EQ(mismatches[t], 0);
+        CHECK(ids[t] == ids[0]);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testIntern);
+    RUN_TEST(testStableViews);
+    RUN_TEST(testConcurrent);
+    return unit_test::finish();
+}
@@ -0,0 +1,322 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/log_duration.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int THREADS = 4;
+const int RECORDS = 2000;
+
+std::string tempPath()
+{
+    char path[] = "/tmp/log_duration_testXXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        close(fd);
+    return path;
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+std::vector<std::string> lines(const std::string& text)
+{
+    std::vector<std::string> result;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line))
+        result.push_back(line);
+    return result;
+}
+
+// The summary line up to meanNs; the percentiles are approximate and have their own tests
+std::string summaryPrefix(const std::string& line)
+{
+    size_t pos = 0;
+    for (int field = 0; field < 6 && pos != std::string::npos; field++)
+        pos = line.find(',', pos + 1);
+    return line.substr(0, pos);
+}
+
+void testAggregate()
+{
+    std::string path = tempPath();
+    kernel_name_id_t gemm = kernelNames().intern("gemm");
+    kernel_name_id_t axpy = kernelNames().intern("axpy");
+    {
+        logDuration log(path);
+        CHECK(log.setMode("aggregate"));
+        CHECK_EQ(log.getMode(), LOGDUR_MODE_AGGREGATE);
+        log.logHeaders();
+        log.log(gemm, 1, 1000, 1100);
+        log.log(gemm, 2, 2000, 2300);
+        log.log(gemm, 3, 3000, 3200);
+        // A clock that went backwards counts as zero
+        log.log(axpy, 4, 500, 400);
+
+        // Kernels seen for the first time on several threads at once, and a shared one
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++)
+        {
+            threads.emplace_back([&log, t]() {
+                kernel_name_id_t own = kernelNames().intern("thread_" + std::to_string(t));
+                kernel_name_id_t shared = kernelNames().intern("shared");
+                for (int i = 0; i < RECORDS; i++)
+                {
+                    log.log(own, i, 0, 10);
+                    log.log(shared, i, 0, 1);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        // Nothing is written before shutdown
+        CHECK_EQ(readFile(path), std::string());
+    }
+    std::vector<std::string> summary = lines(readFile(path));
+    CHECK_EQ(summary.size(), static_cast<size_t>(4 + THREADS));
+    if (summary.size() != static_cast<size_t>(4 + THREADS))
+        return;
+    CHECK_EQ(summary[0], std::string("kernel,count,sumNs,minNs,maxNs,meanNs,p50Ns,p90Ns,p99Ns"));
+    // Sorted by name
+    CHECK_EQ(summaryPrefix(summary[1]), std::string("\"axpy\",1,0,0,0,0"));
+    CHECK_EQ(summaryPrefix(summary[2]), std::string("\"gemm\",3,600,100,300,200"));
+    CHECK_EQ(summaryPrefix(summary[3]), "\"shared\"," + std::to_string(THREADS * RECORDS) + "," +
+             std::to_string(THREADS * RECORDS) + ",1,1,1");
+    for (int t = 0; t < THREADS; t++)
+        CHECK_EQ(summaryPrefix(summary[4 + t]), "\"thread_" + std::to_string(t) + "\"," +
+                 std::to_string(RECORDS) + "," + std::to_string(RECORDS * 10) + ",10,10,10");
+    unlink(path.c_str());
+}
+
+void testClose()
+{
+    // An owner that can't be destroyed (see hsaInterceptor::cleanup) writes the summary with close()
+    std::string path = tempPath();
+    kernel_name_id_t gemm = kernelNames().intern("gemm");
+    {
+        logDuration log(path);
+        log.setMode("aggregate");
+        log.log(gemm, 1, 0, 50);
+        log.close();
+        CHECK_EQ(lines(readFile(path)).size(), 2u);
+        log.log(gemm, 2, 0, 50);
+        log.close();
+    }
+    std::vector<std::string> summary = lines(readFile(path));
+    CHECK_EQ(summary.size(), 2u);
+    if (summary.size() == 2)
+        CHECK_EQ(summaryPrefix(summary[1]), std::string("\"gemm\",1,50,50,50,50"));
+    unlink(path.c_str());
+}
+
+struct rawRecord {
+    char tag_;
+    uint32_t id_;
+    std::string name_;
+    uint64_t dispatch_ns_;
+    uint64_t start_ns_;
+    uint64_t end_ns_;
+};
+
+template<typename T>
+bool readRaw(const std::string& data, size_t& pos, T& value)
+{
+    if (pos + sizeof(T) > data.size())
+        return false;
+    memcpy(&value, data.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+// Parses a raw log; false if it is malformed
+bool parseRaw(const std::string& data, std::vector<rawRecord>& records)
+{
+    size_t magic = strlen(LOGDUR_RAW_MAGIC);
+    if (data.compare(0, magic, LOGDUR_RAW_MAGIC) != 0)
+        return false;
+    size_t pos = magic;
+    uint32_t version;
+    if (!readRaw(data, pos, version) || version != LOGDUR_RAW_VERSION)
+        return false;
+    while (pos < data.size())
+    {
+        rawRecord record = {};
+        record.tag_ = data[pos++];
+        if (!readRaw(data, pos, record.id_))
+            return false;
+        if (record.tag_ == 'N')
+        {
+            uint32_t length;
+            if (!readRaw(data, pos, length) || pos + length > data.size())
+                return false;
+            record.name_ = data.substr(pos, length);
+            pos += length;
+        }
+        else if (record.tag_ != 'D' || !readRaw(data, pos, record.dispatch_ns_) ||
+                 !readRaw(data, pos, record.start_ns_) || !readRaw(data, pos, record.end_ns_))
+            return false;
+        records.push_back(record);
+    }
+    return true;
+}
+
+void testRaw()
+{
+    std::string path = tempPath();
+    kernel_name_id_t gemm = kernelNames().intern("gemm");
+    kernel_name_id_t axpy = kernelNames().intern("axpy");
+    {
+        logDuration log(path);
+        CHECK(log.setMode("raw"));
+        CHECK_EQ(log.getMode(), LOGDUR_MODE_RAW);
+        log.log(gemm, 10, 11, 12);
+        log.log(axpy, 20, 21, 22);
+        log.flush();
+        std::vector<rawRecord> records;
+        CHECK(parseRaw(readFile(path), records));
+        CHECK_EQ(records.size(), 4u);
+        // The last records are only written by the destructor
+        log.log(gemm, 30, 31, 32);
+    }
+    std::vector<rawRecord> records;
+    CHECK(parseRaw(readFile(path), records));
+    CHECK_EQ(records.size(), 5u);
+    if (records.size() != 5)
+        return;
+    // Names are numbered in first-seen order and written before their first dispatch
+    CHECK_EQ(records[0].tag_, 'N');
+    CHECK_EQ(records[0].id_, 0u);
+    CHECK_EQ(records[0].name_, std::string("gemm"));
+    CHECK_EQ(records[1].tag_, 'D');
+    CHECK_EQ(records[1].id_, 0u);
+    CHECK_EQ(records[1].dispatch_ns_, 10u);
+    CHECK_EQ(records[1].start_ns_, 11u);
+    CHECK_EQ(records[1].end_ns_, 12u);
+    CHECK_EQ(records[2].tag_, 'N');
+    CHECK_EQ(records[2].id_, 1u);
+    CHECK_EQ(records[2].name_, std::string("axpy"));
+    CHECK_EQ(records[3].tag_, 'D');
+    CHECK_EQ(records[3].id_, 1u);
+    CHECK_EQ(records[3].end_ns_, 22u);
+    CHECK_EQ(records[4].tag_, 'D');
+    CHECK_EQ(records[4].id_, 0u);
+    CHECK_EQ(records[4].dispatch_ns_, 30u);
+    unlink(path.c_str());
+}
+
+void testRawConcurrentFlush()
+{
+    // Completions logged while the flush timer and shutdown write the buffer out
+    std::string path = tempPath();
+    {
+        logDuration log(path);
+        log.setMode("raw");
+        std::atomic<bool> done(false);
+        std::thread flusher([&]() {
+            while (!done.load())
+                log.flush();
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++)
+        {
+            threads.emplace_back([&log, t]() {
+                kernel_name_id_t kernel = kernelNames().intern("raw_" + std::to_string(t));
+                for (int i = 0; i < RECORDS; i++)
+                    log.log(kernel, i, i, i + 1);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        log.close();
+        done.store(true);
+        flusher.join();
+    }
+    std::vector<rawRecord> records;
+    CHECK(parseRaw(readFile(path), records));
+    std::map<uint32_t, std::string> names;
+    std::map<std::string, int> dispatches;
+    for (const auto& record : records)
+    {
+        if (record.tag_ == 'N')
+            names[record.id_] = record.name_;
+        else
+        {
+            CHECK(names.count(record.id_));
+            CHECK_EQ(record.end_ns_, record.start_ns_ + 1);
+            dispatches[names[record.id_]]++;
+        }
+    }
+    CHECK_EQ(names.size(), static_cast<size_t>(THREADS));
+    for (int t = 0; t < THREADS; t++)
+        CHECK_EQ(dispatches["raw_" + std::to_string(t)], RECORDS);
+    unlink(path.c_str());
+}
+
+void testLines()
+{
+    std::string path = tempPath();
+    kernel_name_id_t gemm = kernelNames().intern("gemm");
+    {
+        logDuration log(path);
+        CHECK(log.setMode("lines"));
+        log.logHeaders();
+        log.log(gemm, 1, 2, 3);
+    }
+    std::vector<std::string> text = lines(readFile(path));
+    CHECK_EQ(text.size(), 2u);
+    if (text.size() == 2)
+    {
+        CHECK_EQ(text[0], std::string("kernel,dispatch,startNs,endNs"));
+        CHECK_EQ(text[1], std::string("\"gemm\",1,2,3"));
+    }
+    unlink(path.c_str());
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testAggregate);
+    RUN_TEST(testClose);
+    RUN_TEST(testRaw);
+    RUN_TEST(testRawConcurrentFlush);
+    RUN_TEST(testLines);
+    return unit_test::finish();
+}
@@ -0,0 +1,215 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/message_loss.h"
+#include "inc/site_manifest.h"
+#include "inc/synthetic_messages.h"
+#include "unit_test.h"
+
+#include <string.h>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint32_t SITES = 8;
+
+// A loss block as the device leaves it
+std::vector<uint8_t> lossBlock(const std::vector<uint64_t>& site_drops, uint64_t dropped)
+{
+    std::vector<uint8_t> block(messageLossBytes(site_drops.size()));
+    messageLossInit(site_drops.size(), block.data());
+    memcpy(block.data() + offsetof(messageLossHeader_t, dropped_), &dropped, sizeof(dropped));
+    for (size_t i = 0; i < site_drops.size(); i++)
+        memcpy(block.data() + sizeof(messageLossHeader_t) + i * sizeof(uint64_t), &site_drops[i], sizeof(uint64_t));
+    return block;
+}
+
+void testInit()
+{
+    std::vector<uint8_t> block(messageLossBytes(SITES), 0xff);
+    messageLossInit(SITES, block.data());
+    messageLossHeader_t header;
+    memcpy(&header, block.data(), sizeof(header));
+    CHECK(memcmp(header.magic_, MESSAGE_LOSS_MAGIC, 4) == 0);
+    CHECK_EQ(header.version_, MESSAGE_LOSS_VERSION);
+    CHECK_EQ(header.site_count_, SITES);
+    CHECK_EQ(header.dropped_, 0u);
+    for (size_t i = sizeof(header); i < block.size(); i++)
+        CHECK_EQ(block[i], 0);
+
+    // Nothing dropped: nothing to scale and nothing to report
+    messageLoss loss(SITES);
+    loss.addDelivered(3, 100);
+    CHECK(loss.merge(block.data(), block.size()));
+    CHECK_EQ(loss.dropped(), 0u);
+    CHECK_EQ(loss.lossRate(), 0.0);
+    CHECK_EQ(loss.scale(3), 1.0);
+    CHECK_EQ(loss.scaleCount(3, 1234), 1234u);
+    std::ostringstream out;
+    loss.report(out, "kernel", 1);
+    CHECK(out.str().empty());
+}
+
+void testDeliveredMessages()
+{
+    // comms_mgr counts messages by their header: a site id with the manifest flag in place of the line
+    messageLoss loss(SITES);
+    loss.addDeliveredMessage(3, SITE_MANIFEST_LINE_FLAG);
+    loss.addDeliveredMessage(3, SITE_MANIFEST_LINE_FLAG);
+    // A DWARF location, and an id past the manifest, have no site
+    loss.addDeliveredMessage(3, 12);
+    loss.addDeliveredMessage(SITES, SITE_MANIFEST_LINE_FLAG);
+    CHECK_EQ(loss.delivered(), 4u);
+    CHECK_EQ(loss.delivered(3), 2u);
+    for (size_t site = 0; site < SITES; site++)
+        if (site != 3)
+            CHECK_EQ(loss.delivered(site), 0u);
+}
+
+void testSyntheticDispatch()
+{
+    // Drop synthetic messages the way a device short of sub-buffers would: independently of their contents,
+    // at a rate that differs per site. Per-site scaling of a count summed over the messages (here, active
+    // lanes) recovers what a lossless run would have counted.
+    syntheticConfig_t config;
+    config.waves_ = 2048;
+    config.messages_per_wave_ = 16;
+    config.sites_ = SITES;
+    const uint32_t drop_per_mille[SITES] = {0, 50, 100, 250, 500, 750, 900, 998};
+    std::vector<uint64_t> site_drops(SITES, 0), lanes_sent(SITES, 0), lanes_delivered(SITES, 0);
+    uint64_t dropped = 0;
+    uint64_t state = 12345;
+    messageLoss loss(SITES);
+    generateSyntheticMessages(SYNTHETIC_COALESCED, config, [&](const syntheticMessage_t& message) {
+        size_t site = message.dwarf_line_ - 10;
+        uint64_t lanes = __builtin_popcountll(message.exec_);
+        lanes_sent[site] += lanes;
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        if ((state >> 33) % 1000 < drop_per_mille[site])
+        {
+            site_drops[site]++;
+            dropped++;
+            return;
+        }
+        loss.addDelivered(site);
+        lanes_delivered[site] += lanes;
+    });
+    // Messages without a site only show up in the total
+    loss.addDelivered(MESSAGE_LOSS_NO_SITE, 10);
+    std::vector<uint8_t> block = lossBlock(site_drops, dropped + 5);
+    CHECK(loss.merge(block.data(), block.size()));
+
+    uint64_t sent = config.waves_ * config.messages_per_wave_;
+    CHECK_EQ(loss.delivered() + loss.dropped(), sent + 15);
+    CHECK_EQ(loss.dropped(), dropped + 5);
+    CHECK(std::fabs(loss.lossRate() - static_cast<double>(dropped + 5) / (sent + 15)) < 1e-12);
+    for (size_t site = 0; site < SITES; site++)
+    {
+        CHECK_EQ(loss.dropped(site), site_drops[site]);
+        CHECK_EQ(loss.delivered(site) + loss.dropped(site), sent / SITES);
+        CHECK(std::fabs(loss.lossRate(site) - drop_per_mille[site] / 1000.0) < 0.05);
+        uint64_t estimate = loss.scaleCount(site, lanes_delivered[site]);
+        if (site == 0)
+            CHECK_EQ(estimate, lanes_sent[site]);
+        else if (loss.delivered(site) >= MESSAGE_LOSS_MIN_DELIVERED)
+        {
+            CHECK(loss.scalable(site));
+            CHECK(std::fabs(static_cast<double>(estimate) / lanes_sent[site] - 1.0) < 0.01);
+        }
+        else
+            CHECK_EQ(estimate, lanes_delivered[site]);
+    }
+    // Dropping 99.8% of 4096 messages leaves too few to scale by
+    CHECK(loss.delivered(7) < MESSAGE_LOSS_MIN_DELIVERED);
+    CHECK(!loss.scalable(7));
+    // A clone with sites has no drop count for messages without one
+    CHECK_EQ(loss.scale(MESSAGE_LOSS_NO_SITE), 1.0);
+
+    std::ostringstream out;
+    loss.report(out, "_Z6kernelPf", 42);
+    std::string report = out.str();
+    CHECK(report.find("_Z6kernelPf dispatch 42 dropped " + std::to_string(dropped + 5)) != std::string::npos);
+    CHECK(report.find("    site 0 ") == std::string::npos);
+    CHECK(report.find("    site 4 dropped ") != std::string::npos);
+    CHECK(report.find("too few delivered to scale") != std::string::npos);
+}
+
+void testWithoutSites()
+{
+    // Without a site manifest the dispatch is scaled as a whole
+    messageLoss loss;
+    loss.addDelivered(MESSAGE_LOSS_NO_SITE, 300);
+    std::vector<uint8_t> block = lossBlock({}, 100);
+    CHECK(loss.merge(block.data(), block.size()));
+    CHECK_EQ(loss.lossRate(), 0.25);
+    CHECK_EQ(loss.scale(MESSAGE_LOSS_NO_SITE), 400.0 / 300.0);
+    CHECK_EQ(loss.scaleCount(MESSAGE_LOSS_NO_SITE, 3000), 4000u);
+    CHECK_EQ(loss.scaleCount(5, 3000), 4000u);
+
+    // Blocks accumulate, e.g. over the dispatches of one kernel
+    CHECK(loss.merge(block.data(), block.size()));
+    CHECK_EQ(loss.dropped(), 200u);
+
+    // A site manifest without per-site drops gives no site a valid scale
+    messageLoss total_only(SITES);
+    total_only.addDelivered(2, 1000);
+    CHECK(total_only.merge(block.data(), block.size()));
+    CHECK_EQ(total_only.dropped(), 100u);
+    CHECK_EQ(total_only.scale(2), 1.0);
+}
+
+void testMalformed()
+{
+    messageLoss loss(SITES);
+    std::vector<uint8_t> good = lossBlock(std::vector<uint64_t>(SITES, 1), SITES);
+    std::vector<uint8_t> block = good;
+    block[0] = 'X';
+    CHECK(!loss.merge(block.data(), block.size()));
+    block = good;
+    block[4] = MESSAGE_LOSS_VERSION + 1;
+    CHECK(!loss.merge(block.data(), block.size()));
+    CHECK(!loss.merge(good.data(), good.size() - 1));
+    CHECK(!loss.merge(good.data(), sizeof(messageLossHeader_t) - 1));
+    // Site count that doesn't match the manifest
+    std::vector<uint8_t> other = lossBlock(std::vector<uint64_t>(SITES + 1, 0), 0);
+    CHECK(!loss.merge(other.data(), other.size()));
+    // More drops across the sites than in total
+    std::vector<uint8_t> inconsistent = lossBlock(std::vector<uint64_t>(SITES, 1), SITES - 1);
+    CHECK(!loss.merge(inconsistent.data(), inconsistent.size()));
+    CHECK_EQ(loss.dropped(), 0u);
+    CHECK(loss.merge(good.data(), good.size()));
+    CHECK_EQ(loss.dropped(), static_cast<uint64_t>(SITES));
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testInit);
+    RUN_TEST(testDeliveredMessages);
+    RUN_TEST(testSyntheticDispatch);
+    RUN_TEST(testWithoutSites);
+    RUN_TEST(testMalformed);
+    return unit_test::finish();
+}
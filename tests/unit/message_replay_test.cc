@@ -0,0 +1,177 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/message_replay.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Stands in for a dh_comms wave header, which the recording treats as opaque bytes
+struct fakeHeader {
+    uint64_t exec_;
+    uint32_t line_;
+    uint32_t column_;
+};
+
+std::string tempPath()
+{
+    char path[] = "/tmp/message_replay_testXXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        close(fd);
+    return path;
+}
+
+std::vector<char> readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void testRoundTrip()
+{
+    std::string path = tempPath();
+    {
+        messageRecordWriter writer;
+        CHECK(writer.open(path, sizeof(fakeHeader)));
+        uint32_t first = writer.beginDispatch("vector_add", 7);
+        uint32_t second = writer.beginDispatch("reduce", 8);
+        CHECK_EQ(first, 0u);
+        CHECK_EQ(second, 1u);
+        fakeHeader header = {~0ull, 12, 5};
+        std::vector<uint64_t> addresses(64);
+        for (size_t i = 0; i < addresses.size(); i++)
+            addresses[i] = 0x1000 + 4 * i;
+        writer.append(first, &header, 8, 64, addresses.data());
+        header = {0x1, 30, 2};
+        uint64_t interval[2] = {100, 250};
+        writer.append(second, &header, 16, 1, interval);
+        header = {0x3, 13, 9};
+        writer.append(first, &header, 8, 0, nullptr);
+    }
+
+    messageRecording recording;
+    std::string error;
+    CHECK(recording.load(path, error));
+    CHECK_EQ(recording.headerSize(), static_cast<uint32_t>(sizeof(fakeHeader)));
+    CHECK_EQ(recording.messageCount(), 3u);
+    const auto& dispatches = recording.dispatches();
+    CHECK_EQ(dispatches.size(), 2u);
+    if (dispatches.size() != 2 || dispatches[0].messages_.size() != 2 || dispatches[1].messages_.size() != 1)
+    {
+        CHECK(false);
+        unlink(path.c_str());
+        return;
+    }
+    CHECK_EQ(dispatches[0].kernel_, std::string("vector_add"));
+    CHECK_EQ(dispatches[0].dispatch_id_, 7u);
+    CHECK_EQ(dispatches[1].kernel_, std::string("reduce"));
+
+    const recordedMessage_t& addresses = dispatches[0].messages_[0];
+    fakeHeader header;
+    memcpy(&header, addresses.header_, sizeof(header));
+    CHECK_EQ(header.exec_, ~0ull);
+    CHECK_EQ(header.line_, 12u);
+    CHECK_EQ(addresses.item_size_, 8u);
+    CHECK_EQ(addresses.item_count_, 64u);
+    uint64_t address = 0;
+    memcpy(&address, addresses.items_ + 63 * 8, sizeof(address));
+    CHECK_EQ(address, 0x1000u + 4 * 63);
+
+    const recordedMessage_t& interval = dispatches[1].messages_[0];
+    uint64_t times[2] = {};
+    memcpy(times, interval.items_, sizeof(times));
+    CHECK_EQ(interval.item_size_, 16u);
+    CHECK_EQ(times[1] - times[0], 150u);
+
+    CHECK_EQ(dispatches[0].messages_[1].item_count_, 0u);
+    unlink(path.c_str());
+}
+
+void testMalformed()
+{
+    std::string path = tempPath();
+    {
+        messageRecordWriter writer;
+        CHECK(writer.open(path, sizeof(fakeHeader)));
+        uint32_t dispatch = writer.beginDispatch("k", 1);
+        fakeHeader header = {1, 1, 1};
+        uint64_t item = 42;
+        writer.append(dispatch, &header, 8, 1, &item);
+    }
+    std::vector<char> data = readFile(path);
+    unlink(path.c_str());
+
+    std::string error;
+    {
+        messageRecording recording;
+        std::vector<char> copy = data;
+        CHECK(recording.parse(std::move(copy), error));
+    }
+    {
+        // Cut off in the middle of the last message
+        messageRecording recording;
+        std::vector<char> truncated(data.begin(), data.end() - 3);
+        CHECK(!recording.parse(std::move(truncated), error));
+        CHECK(error.find("truncated") != std::string::npos);
+    }
+    {
+        messageRecording recording;
+        std::vector<char> bad_magic = data;
+        bad_magic[0] = 'X';
+        CHECK(!recording.parse(std::move(bad_magic), error));
+    }
+    {
+        messageRecording recording;
+        std::vector<char> bad_version = data;
+        bad_version[strlen(MESSAGE_RECORD_MAGIC)] = 9;
+        CHECK(!recording.parse(std::move(bad_version), error));
+        CHECK(error.find("version") != std::string::npos);
+    }
+    {
+        // A message for a dispatch that was never started
+        messageRecording recording;
+        std::vector<char> bad_dispatch = data;
+        size_t message = data.size() - (1 + 3 * sizeof(uint32_t) + sizeof(fakeHeader) + sizeof(uint64_t));
+        CHECK_EQ(bad_dispatch[message], 'M');
+        bad_dispatch[message + 1] = 5;
+        CHECK(!recording.parse(std::move(bad_dispatch), error));
+    }
+    {
+        messageRecording recording;
+        CHECK(!recording.load("/nonexistent/recording", error));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testRoundTrip);
+    RUN_TEST(testMalformed);
+    return unit_test::finish();
+}
@@ -0,0 +1,279 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/pyHandler.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+#define TEST_MODULE "omniprobe_batch_test"
+
+// Records what it is given, as lists, in the order of the calls
+const char *module_source = R"(
+import pickle
+
+BATCH_MESSAGES = 1000
+events = []
+kept = []
+mode = ""
+
+def reset(new_mode=""):
+    global mode
+    events.clear()
+    kept.clear()
+    mode = new_mode
+
+def handleAddressBatch(batch):
+    if mode == "raise":
+        raise RuntimeError("failing on purpose")
+    events.append(("address", {name: view.tolist() for name, view in batch.items()},
+                   {name: view.format for name, view in batch.items()}))
+    if mode == "keep":
+        kept.append((batch["address"], pickle.PickleBuffer(batch["dispatch_id"]), batch["dispatch_id"].tolist()))
+
+def handleTimeBatch(batch):
+    events.append(("time", {name: view.tolist() for name, view in batch.items()}))
+
+def handleDispatchEnd(kernel, dispatch_id):
+    events.append(("end", kernel, dispatch_id))
+
+def stale_view_released():
+    try:
+        kept[0][0].tolist()
+    except ValueError:
+        return True
+    return False
+)";
+
+std::string module_dir;
+
+void setUp()
+{
+    char dir[] = "/tmp/omniprobe_python_XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    module_dir = dir;
+    std::ofstream(module_dir + "/" TEST_MODULE ".py") << module_source;
+    setenv("PYTHONPATH", module_dir.c_str(), 1);
+    setenv("PYTHONDONTWRITEBYTECODE", "1", 1);
+    unsetenv("LOGDUR_PYTHON_BATCH");
+}
+
+void tearDown()
+{
+    unlink((module_dir + "/" TEST_MODULE ".py").c_str());
+    rmdir(module_dir.c_str());
+}
+
+// Evaluates expression in the test module, or runs it as a statement when it isn't one
+long long python(const std::string& code)
+{
+    PyGILState_STATE gil = PyGILState_Ensure();
+    PyObject *module = PyImport_ImportModule(TEST_MODULE);
+    long long value = -1;
+    if (module)
+    {
+        PyObject *globals = PyModule_GetDict(module);
+        PyObject *result = PyRun_String(code.c_str(), Py_eval_input, globals, globals);
+        if (!result && PyErr_ExceptionMatches(PyExc_SyntaxError))
+        {
+            PyErr_Clear();
+            result = PyRun_String(code.c_str(), Py_file_input, globals, globals);
+        }
+        if (result && PyLong_Check(result))
+            value = PyLong_AsLongLong(result);
+        else if (result)
+            value = 0;
+        Py_XDECREF(result);
+        Py_DECREF(module);
+    }
+    if (PyErr_Occurred())
+        PyErr_Print();
+    PyGILState_Release(gil);
+    return value;
+}
+
+pythonMessageHeader_t header(uint64_t dispatch_id, uint32_t line)
+{
+    pythonMessageHeader_t header = {};
+    header.dispatch_id_ = dispatch_id;
+    header.timestamp_ = 1000 + line;
+    header.exec_ = 0xff;
+    header.line_ = line;
+    header.column_ = 3;
+    header.user_data_ = 0x10;
+    return header;
+}
+
+void testColumns()
+{
+    pythonBatchHandler handler(TEST_MODULE);
+    python("reset()");
+    uint64_t first[] = {0x100, 0x108, 0x110};
+    uint64_t second[] = {0x200, 0x208};
+    handler.addressMessage(header(7, 10), first, 3);
+    handler.addressMessage(header(7, 11), second, 2);
+    handler.flush();
+    CHECK_EQ(handler.batches(), 1u);
+    CHECK_EQ(python("len(events)"), 1);
+    CHECK_EQ(python("events[0][1]['address'] == [0x100, 0x108, 0x110, 0x200, 0x208]"), 1);
+    CHECK_EQ(python("events[0][1]['message'] == [0, 0, 0, 1, 1]"), 1);
+    CHECK_EQ(python("events[0][1]['dispatch_id'] == [7, 7]"), 1);
+    CHECK_EQ(python("events[0][1]['timestamp'] == [1010, 1011]"), 1);
+    CHECK_EQ(python("events[0][1]['line'] == [10, 11] and events[0][1]['column'] == [3, 3]"), 1);
+    CHECK_EQ(python("events[0][1]['exec'] == [0xff, 0xff] and events[0][1]['user_data'] == [0x10, 0x10]"), 1);
+    CHECK_EQ(python("events[0][2]['address'] == 'Q' and events[0][2]['line'] == 'I'"), 1);
+    CHECK_EQ(python("events[0][2]['message'] == 'I' and events[0][2]['timestamp'] == 'Q'"), 1);
+
+    // Nothing collected, nothing called
+    handler.flush();
+    CHECK_EQ(handler.batches(), 1u);
+    CHECK_EQ(handler.failedCalls(), 0u);
+}
+
+void testBatchSize()
+{
+    pythonBatchHandler handler(TEST_MODULE, 4);
+    python("reset()");
+    uint64_t address = 0x40;
+    for (uint32_t i = 0; i < 10; i++)
+        handler.addressMessage(header(1, i), &address, 1);
+    handler.flush();
+    CHECK_EQ(handler.batches(), 3u);
+    CHECK_EQ(python("[len(event[1]['line']) for event in events] == [4, 4, 2]"), 1);
+    CHECK_EQ(python("sum((event[1]['line'] for event in events), []) == list(range(10))"), 1);
+
+    // The module's BATCH_MESSAGES, unless the environment overrides it
+    pythonBatchHandler module_size(TEST_MODULE);
+    python("reset()");
+    for (uint32_t i = 0; i < 2500; i++)
+        module_size.addressMessage(header(1, i), &address, 1);
+    module_size.flush();
+    CHECK_EQ(module_size.batches(), 3u);
+    setenv("LOGDUR_PYTHON_BATCH", "500", 1);
+    pythonBatchHandler env_size(TEST_MODULE);
+    unsetenv("LOGDUR_PYTHON_BATCH");
+    for (uint32_t i = 0; i < 2500; i++)
+        env_size.addressMessage(header(1, i), &address, 1);
+    env_size.flush();
+    CHECK_EQ(env_size.batches(), 5u);
+}
+
+void testDispatchEnd()
+{
+    pythonBatchHandler handler(TEST_MODULE);
+    python("reset()");
+    uint64_t address = 0x40;
+    uint64_t intervals[] = {10, 20, 30, 45};
+    handler.addressMessage(header(5, 1), &address, 1);
+    handler.timeIntervals(5, intervals, 2);
+    handler.dispatchEnd("kernel_a", 5);
+    CHECK_EQ(python("[event[0] for event in events] == ['address', 'time', 'end']"), 1);
+    CHECK_EQ(python("events[1][1] == {'dispatch_id': [5, 5], 'start': [10, 30], 'stop': [20, 45]}"), 1);
+    CHECK_EQ(python("events[2][1:] == ('kernel_a', 5)"), 1);
+    CHECK_EQ(handler.batches(), 2u);
+}
+
+void testProducers()
+{
+    pythonBatchHandler handler(TEST_MODULE, 64);
+    python("reset()");
+    const int producers = 4;
+    const uint32_t messages = 2000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+        threads.emplace_back([&, p]() {
+            uint64_t addresses[4];
+            for (uint32_t i = 0; i < messages; i++)
+            {
+                for (uint64_t lane = 0; lane < 4; lane++)
+                    addresses[lane] = (static_cast<uint64_t>(p) << 32) + i * 4 + lane;
+                handler.addressMessage(header(p, i), addresses, 4);
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+    handler.flush();
+    CHECK_EQ(python("sum(len(event[1]['line']) for event in events)"), producers * messages);
+    CHECK_EQ(python("len(set(sum((event[1]['address'] for event in events), [])))"), producers * messages * 4);
+    // Each address lines up with its message's header
+    CHECK_EQ(python("all(event[1]['address'][k] >> 32 == event[1]['dispatch_id'][event[1]['message'][k]] "
+                    "for event in events for k in range(len(event[1]['address'])))"), 1);
+    CHECK_EQ(python("all(len(event[1]['line']) <= 64 for event in events)"), 1);
+}
+
+void testKeptViews()
+{
+    pythonBatchHandler handler(TEST_MODULE, 2);
+    python("reset('keep')");
+    uint64_t address = 0x40;
+    for (uint32_t i = 0; i < 8; i++)
+        handler.addressMessage(header(100 + i, i), &address, 1);
+    handler.flush();
+    CHECK_EQ(handler.batches(), 4u);
+    CHECK_EQ(handler.failedCalls(), 0u);
+    // A kept view is released, a kept export still sees the data it was given
+    CHECK_EQ(python("stale_view_released()"), 1);
+    CHECK_EQ(python("[ids for _, _, ids in kept] == [[100, 101], [102, 103], [104, 105], [106, 107]]"), 1);
+    CHECK_EQ(python("all(memoryview(export).cast('B').cast('Q').tolist() == ids for _, export, ids in kept)"), 1);
+    python("reset()");
+}
+
+void testFailedCalls()
+{
+    pythonBatchHandler handler(TEST_MODULE, 1);
+    python("reset('raise')");
+    uint64_t address = 0x40;
+    handler.addressMessage(header(1, 1), &address, 1);
+    handler.flush();
+    CHECK_EQ(handler.failedCalls(), 1u);
+    python("reset()");
+    handler.addressMessage(header(1, 2), &address, 1);
+    handler.flush();
+    CHECK_EQ(handler.batches(), 2u);
+    CHECK_EQ(handler.failedCalls(), 1u);
+    CHECK_EQ(python("events[0][1]['line'][0]"), 2);
+
+    CHECK(pythonBatchHandler::get("omniprobe_no_such_module") == nullptr);
+    CHECK(pythonBatchHandler::get(TEST_MODULE) != nullptr);
+    CHECK(pythonBatchHandler::get(TEST_MODULE) == pythonBatchHandler::get(TEST_MODULE));
+}
+
+} // namespace
+
+int main()
+{
+    setUp();
+    RUN_TEST(testColumns);
+    RUN_TEST(testBatchSize);
+    RUN_TEST(testDispatchEnd);
+    RUN_TEST(testProducers);
+    RUN_TEST(testKeptViews);
+    RUN_TEST(testFailedCalls);
+    tearDown();
+    return unit_test::finish();
+}
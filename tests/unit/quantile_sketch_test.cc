@@ -0,0 +1,165 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/quantile_sketch.h"
+#include "unit_test.h"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+double exactQuantile(std::vector<double> samples, double q)
+{
+    std::sort(samples.begin(), samples.end());
+    return samples[static_cast<size_t>(q * (samples.size() - 1))];
+}
+
+bool withinAccuracy(double estimate, double exact)
+{
+    // Allow a hair over the nominal accuracy for floating point error at bucket boundaries
+    double tolerance = sketchMapping::RELATIVE_ACCURACY * 1.001 * exact;
+    return estimate >= exact - tolerance && estimate <= exact + tolerance;
+}
+
+std::vector<double> lognormalSamples(size_t count, uint64_t seed)
+{
+    std::mt19937_64 generator(seed);
+    std::lognormal_distribution<double> distribution(8.0, 2.0);
+    std::vector<double> samples;
+    for (size_t i = 0; i < count; i++)
+        samples.push_back(static_cast<double>(static_cast<uint64_t>(distribution(generator)) + 1));
+    return samples;
+}
+
+void testEmpty()
+{
+    quantileSketch sketch;
+    CHECK_EQ(sketch.count(), 0u);
+    CHECK_EQ(sketch.quantile(0.5), 0.0);
+    concurrentQuantileSketch concurrent;
+    CHECK_EQ(concurrent.count(), 0u);
+    CHECK_EQ(concurrent.min(), 0u);
+    CHECK_EQ(concurrent.quantile(0.99), 0.0);
+}
+
+void testAccuracy()
+{
+    std::vector<double> samples = lognormalSamples(200000, 1);
+    quantileSketch sketch;
+    for (double sample : samples)
+        sketch.record(sample);
+    CHECK_EQ(sketch.count(), samples.size());
+    CHECK_EQ(sketch.min(), *std::min_element(samples.begin(), samples.end()));
+    CHECK_EQ(sketch.max(), *std::max_element(samples.begin(), samples.end()));
+    for (double q : {0.0, 0.25, 0.5, 0.9, 0.99, 0.999, 1.0})
+        CHECK(withinAccuracy(sketch.quantile(q), exactQuantile(samples, q)));
+    // Memory stays bounded by the dynamic range of the data, not the sample count
+    CHECK(sketch.bucketCount() < sketchMapping::BUCKET_COUNT);
+}
+
+void testZeroAndSmallValues()
+{
+    quantileSketch sketch;
+    for (int i = 0; i < 10; i++)
+        sketch.record(0.0);
+    for (int i = 0; i < 10; i++)
+        sketch.record(1000.0);
+    CHECK_EQ(sketch.quantile(0.0), 0.0);
+    CHECK_EQ(sketch.quantile(0.4), 0.0);
+    CHECK(withinAccuracy(sketch.quantile(0.9), 1000.0));
+    CHECK_EQ(sketch.quantile(1.0), 1000.0);
+}
+
+void testMerge()
+{
+    std::vector<double> samples = lognormalSamples(100000, 2);
+    quantileSketch whole;
+    quantileSketch shards[4];
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        whole.record(samples[i]);
+        shards[i % 4].record(samples[i]);
+    }
+    quantileSketch merged;
+    for (auto& shard : shards)
+        merged.merge(shard);
+    CHECK_EQ(merged.count(), whole.count());
+    CHECK_EQ(merged.min(), whole.min());
+    CHECK_EQ(merged.max(), whole.max());
+    // Merging is exact: same buckets, same answers
+    for (double q : {0.0, 0.5, 0.9, 0.99, 1.0})
+        CHECK_EQ(merged.quantile(q), whole.quantile(q));
+
+    // Merging into and from empty sketches
+    quantileSketch empty;
+    merged.merge(empty);
+    CHECK_EQ(merged.count(), whole.count());
+    empty.merge(whole);
+    CHECK_EQ(empty.quantile(0.5), whole.quantile(0.5));
+}
+
+void testConcurrentRecord()
+{
+    const int thread_count = 4;
+    const uint64_t per_thread = 50000;
+    concurrentQuantileSketch concurrent;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; t++)
+        threads.emplace_back([&concurrent, t, per_thread]() {
+            for (uint64_t i = 1; i <= per_thread; i++)
+                concurrent.record(i * (t + 1));
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<double> samples;
+    quantileSketch expected;
+    for (int t = 0; t < thread_count; t++)
+        for (uint64_t i = 1; i <= per_thread; i++)
+        {
+            samples.push_back(static_cast<double>(i * (t + 1)));
+            expected.record(static_cast<double>(i * (t + 1)));
+        }
+    CHECK_EQ(concurrent.count(), thread_count * per_thread);
+    CHECK_EQ(concurrent.min(), 1u);
+    CHECK_EQ(concurrent.max(), per_thread * thread_count);
+    quantileSketch snapshot = concurrent.snapshot();
+    for (double q : {0.0, 0.5, 0.9, 0.99, 1.0})
+    {
+        CHECK(withinAccuracy(concurrent.quantile(q), exactQuantile(samples, q)));
+        CHECK_EQ(snapshot.quantile(q), expected.quantile(q));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testEmpty);
+    RUN_TEST(testAccuracy);
+    RUN_TEST(testZeroAndSmallValues);
+    RUN_TEST(testMerge);
+    RUN_TEST(testConcurrentRecord);
+    return unit_test::finish();
+}
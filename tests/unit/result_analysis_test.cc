@@ -0,0 +1,264 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/result_analysis.h"
+#include "inc/json_reader.h"
+#include "unit_test.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef struct {
+    uint32_t line_;
+    uint64_t count_;
+    uint64_t needed_;     // cache lines, or bank conflicts for an LDS access
+    uint64_t used_;
+    bool lds_;
+} fakeAccess_t;
+
+// A MemoryAnalysis record with the fields the analysis reads, on one line
+std::string memoryAnalysisRecord(const std::string& kernel, uint64_t dispatch_id, const std::vector<fakeAccess_t>& accesses)
+{
+    std::ostringstream out;
+    out << "{\"kernel_analysis\": {\"kernel_info\": {\"name\": \"" << kernel << "\", \"dispatch_id\": " << dispatch_id
+        << "}";
+    for (bool lds : {false, true})
+    {
+        out << (lds ? ", \"bank_conflicts\"" : ", \"cache_analysis\"") << ": {\"accesses\": [";
+        bool first = true;
+        for (const auto& access : accesses)
+        {
+            if (access.lds_ != lds)
+                continue;
+            out << (first ? "" : ", ") << "{\"source_location\": {\"file\": \"k.hip\", \"line\": " << access.line_
+                << ", \"column\": 1}, \"code_context\": \"line " << access.line_
+                << "\", \"access_info\": {\"type\": \"read\", \"execution_count\": " << access.count_
+                << ", \"ir_bytes\": 4, ";
+            if (lds)
+                out << "\"total_conflicts\": " << access.needed_ << "}}";
+            else
+                out << "\"isa_bytes\": 4, \"isa_instruction\": \"global_load_dword\", \"cache_lines\": {\"needed\": "
+                    << access.needed_ << ", \"used\": " << access.used_ << "}}}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << "}}\n";
+    return out.str();
+}
+
+std::string blockRecord(const std::string& kernel, uint64_t dispatch_id, uint64_t start, uint64_t duration)
+{
+    std::ostringstream out;
+    out << "{\"kernel\": \"" << kernel << "\", \"kernel_file_name\": \"k.hip\", \"block_duration\": " << duration
+        << ", \"block_start_line\": " << start << ", \"block_end_line\": " << start + 1 << ", \"dispatch_id\": "
+        << dispatch_id << ", \"block_count\": 4, \"block_duration_p99\": 7}\n";
+    return out.str();
+}
+
+std::string regionRecord(const std::string& kernel, uint64_t dispatch_id, uint64_t duration)
+{
+    std::ostringstream out;
+    out << "{\"kernel\": \"" << kernel << "\", \"kernel_file_name\": \"k.hip\", \"region\": 0, \"region_kind\": "
+        << "\"kernel\", \"region_start_line\": 1, \"region_end_line\": 90, \"region_duration\": " << duration
+        << ", \"dispatch_id\": " << dispatch_id << ", \"region_count\": 1}\n";
+    return out.str();
+}
+
+// Two processes running gemm, one of them also reduce
+std::vector<std::string> outputs()
+{
+    std::vector<fakeAccess_t> gemm = {
+        {10, 100, 100, 100, false},   // coalesced
+        {11, 100, 100, 400, false},   // 300 excess per dispatch
+        {12, 100, 100, 200, false},   // 100 excess
+        {20, 50, 0, 0, true},         // no conflicts
+        {21, 50, 8, 0, true},
+    };
+    std::vector<fakeAccess_t> reduce = {
+        {40, 10, 10, 410, false},     // 400 excess, once
+        {41, 10, 30, 0, true},
+    };
+    std::string rank0 = "[\n" + memoryAnalysisRecord("gemm", 1, gemm) + ",\n" + memoryAnalysisRecord("gemm", 2, gemm) +
+                        ",\n" + memoryAnalysisRecord("reduce", 3, reduce) + "]\n";
+    std::string rank1 = "[\n" + memoryAnalysisRecord("gemm", 1, gemm) + "]\n" + blockRecord("gemm", 1, 30, 500) +
+                        blockRecord("gemm", 1, 50, 900) + blockRecord("gemm", 2, 30, 600) +
+                        blockRecord("reduce", 3, 60, 200) + regionRecord("gemm", 1, 100000);
+    return {rank0, rank1};
+}
+
+void mergeOutputs(mergeTable& table)
+{
+    std::vector<std::string> texts = outputs();
+    for (size_t i = 0; i < texts.size(); i++)
+        resultMerger::mergeChunk(texts[i].data(), texts[i].data() + texts[i].size(), i, table);
+}
+
+void testKernels()
+{
+    mergeTable table;
+    mergeOutputs(table);
+    resultAnalysis analysis(table);
+    CHECK_EQ(analysis.kernels().size(), 2u);
+    if (analysis.kernels().size() != 2)
+        return;
+    const kernelSummary_t& gemm = analysis.kernels()[0];
+    CHECK_EQ(gemm.name_, std::string("gemm"));
+    CHECK_EQ(gemm.processes_, 2u);
+    CHECK_EQ(gemm.dispatches_, 4u);
+    CHECK_EQ(gemm.global_sites_, 3u);
+    CHECK_EQ(gemm.lds_sites_, 2u);
+    CHECK_EQ(gemm.execution_count_, 3u * 400);
+    CHECK_EQ(gemm.cache_lines_needed_, 3u * 300);
+    CHECK_EQ(gemm.cache_lines_used_, 3u * 700);
+    CHECK_EQ(gemm.bank_conflicts_, 3u * 8);
+    // The region is left out of the block totals
+    CHECK_EQ(gemm.blocks_, 2u);
+    CHECK_EQ(gemm.block_duration_, 2000u);
+    const kernelSummary_t& reduce = analysis.kernels()[1];
+    CHECK_EQ(reduce.name_, std::string("reduce"));
+    CHECK_EQ(reduce.processes_, 2u);
+    CHECK_EQ(reduce.dispatches_, 2u);
+    CHECK_EQ(reduce.bank_conflicts_, 30u);
+}
+
+void testRankings()
+{
+    mergeTable table;
+    mergeOutputs(table);
+    resultAnalysis analysis(table);
+
+    // Summed over dispatches, gemm line 11 (900 excess) outranks reduce line 40 (400), which outranks gemm
+    // line 12 (300); the coalesced access isn't listed
+    const auto& uncoalesced = analysis.uncoalesced();
+    CHECK_EQ(uncoalesced.size(), 3u);
+    if (uncoalesced.size() == 3)
+    {
+        CHECK_EQ(uncoalesced[0]->first.line_, 11u);
+        CHECK_EQ(resultAnalysis::excessCacheLines(uncoalesced[0]->second), 900u);
+        CHECK_EQ(uncoalesced[1]->first.kernel_, std::string("reduce"));
+        CHECK_EQ(uncoalesced[2]->first.line_, 12u);
+    }
+    const auto& conflicts = analysis.bankConflicts();
+    CHECK_EQ(conflicts.size(), 2u);
+    if (conflicts.size() == 2)
+    {
+        CHECK_EQ(conflicts[0]->first.line_, 41u);
+        CHECK_EQ(conflicts[1]->second.bank_conflicts_, 24u);
+    }
+    const auto& blocks = analysis.hottestBlocks();
+    CHECK_EQ(blocks.size(), 3u);
+    if (blocks.size() == 3)
+    {
+        CHECK_EQ(blocks[0]->first.start_line_, 30u);
+        CHECK_EQ(blocks[0]->second.duration_, 1100u);
+        CHECK_EQ(blocks[1]->first.start_line_, 50u);
+        CHECK_EQ(blocks[2]->first.kernel_, std::string("reduce"));
+    }
+
+    analysisOptions_t options;
+    options.top_ = 1;
+    resultAnalysis top(table, options);
+    CHECK_EQ(top.uncoalesced().size(), 1u);
+    CHECK_EQ(top.bankConflicts().size(), 1u);
+    CHECK_EQ(top.hottestBlocks().size(), 1u);
+    CHECK_EQ(top.kernels().size(), 2u);
+}
+
+void testReports()
+{
+    mergeTable table;
+    mergeOutputs(table);
+    resultAnalysis analysis(table);
+
+    std::ostringstream json;
+    analysis.writeJson(json);
+    std::string report = json.str();
+    jsonValue parsed;
+    jsonReader reader(report.data(), report.data() + report.size());
+    CHECK(reader.read(parsed));
+    CHECK_EQ(parsed.uintAt("records"), 9u);
+    const jsonValue *uncoalesced = parsed.find("uncoalesced");
+    CHECK(uncoalesced && uncoalesced->items().size() == 3);
+    if (uncoalesced && !uncoalesced->items().empty())
+    {
+        const jsonValue& first = uncoalesced->items()[0];
+        CHECK_EQ(first.stringAt("kernel"), std::string("gemm"));
+        CHECK_EQ(first.uintAt("excess_cache_lines"), 900u);
+        CHECK_EQ(first.uintAt("dispatches"), 3u);
+        CHECK_EQ(first.stringAt("code_context"), std::string("line 11"));
+    }
+    CHECK(parsed.find("kernels") && parsed.find("kernels")->items().size() == 2);
+    CHECK(parsed.find("bank_conflicts") && parsed.find("bank_conflicts")->items().size() == 2);
+    CHECK(parsed.find("hottest_blocks") && parsed.find("hottest_blocks")->items().size() == 3);
+
+    std::ostringstream text;
+    analysis.writeText(text);
+    CHECK(text.str().find("k.hip:11:1 in gemm") != std::string::npos);
+    CHECK(text.str().find("1200 cache lines used, 300 needed (900 excess, 4.00x)") != std::string::npos);
+
+    // Nothing to rank
+    mergeTable empty;
+    std::ostringstream none;
+    resultAnalysis(empty).writeText(none);
+    CHECK(none.str().find("none") != std::string::npos);
+}
+
+void testSplitWork()
+{
+    // Chunked and merged by several workers, the tables and so the reports are the same as read in one go
+    mergeTable whole;
+    mergeOutputs(whole);
+    std::ostringstream expected;
+    resultAnalysis(whole).writeJson(expected);
+
+    std::vector<std::string> texts = outputs();
+    mergeTable split;
+    for (size_t i = 0; i < texts.size(); i++)
+    {
+        std::vector<size_t> starts = resultMerger::chunkStarts(texts[i].data(), texts[i].size(), 16);
+        CHECK(starts.size() > 2);
+        for (size_t c = 0; c < starts.size(); c++)
+        {
+            mergeTable chunk;
+            size_t end = c + 1 < starts.size() ? starts[c + 1] : texts[i].size();
+            resultMerger::mergeChunk(texts[i].data() + starts[c], texts[i].data() + end, i, chunk);
+            split.add(chunk);
+        }
+    }
+    std::ostringstream actual;
+    resultAnalysis(split).writeJson(actual);
+    CHECK(actual.str() == expected.str());
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testKernels);
+    RUN_TEST(testRankings);
+    RUN_TEST(testReports);
+    RUN_TEST(testSplitWork);
+    return unit_test::finish();
+}
@@ -0,0 +1,258 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/result_merge.h"
+#include "inc/json_reader.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef struct {
+    const char *file_;
+    uint32_t line_;
+    uint32_t column_;
+    const char *context_;
+    uint64_t count_;
+    uint64_t needed_;     // cache lines, or bank conflicts for an LDS access
+    uint64_t used_;
+    bool lds_;
+} fakeAccess_t;
+
+// One MemoryAnalysis record laid out the way memory_analysis_handler_t::report_json() writes it
+std::string memoryAnalysisRecord(const std::string& kernel, uint64_t dispatch_id, const std::vector<fakeAccess_t>& accesses,
+                                 uint64_t dropped = 0)
+{
+    std::ostringstream out;
+    out << "{\n  \"kernel_analysis\": {\n    \"kernel_info\": {\n      \"name\": \"" << kernel << "\",\n";
+    out << "      \"dispatch_id\": " << dispatch_id;
+    if (dropped)
+        out << ",\n      \"messages_dropped\": " << dropped << ",\n      \"loss_rate\": 0.5";
+    out << "\n    },\n";
+    for (bool lds : {false, true})
+    {
+        out << (lds ? "    \"bank_conflicts\": {\n" : "    \"cache_analysis\": {\n") << "      \"accesses\": [\n";
+        bool first = true;
+        for (const auto& access : accesses)
+        {
+            if (access.lds_ != lds)
+                continue;
+            out << (first ? "" : ",\n");
+            first = false;
+            out << "        {\n          \"source_location\": {\n            \"file\": \"" << access.file_ << "\",\n";
+            out << "            \"line\": " << access.line_ << ",\n            \"column\": " << access.column_ << "\n";
+            out << "          },\n          \"code_context\": \"" << access.context_ << "\",\n";
+            out << "          \"access_info\": {\n            \"type\": \"read\",\n";
+            out << "            \"execution_count\": " << access.count_ << ",\n            \"ir_bytes\": 4,\n";
+            if (lds)
+                out << "            \"total_conflicts\": " << access.needed_ << "\n";
+            else
+            {
+                out << "            \"isa_bytes\": 4,\n            \"isa_instruction\": \"global_load_dword\",\n";
+                out << "            \"cache_lines\": {\n              \"needed\": " << access.needed_ << ",\n";
+                out << "              \"used\": " << access.used_ << "\n            }\n";
+            }
+            out << "          }\n        }";
+        }
+        out << "\n      ]\n    }" << (lds ? "\n" : ",\n");
+    }
+    out << "  },\n  \"metadata\": {\n    \"version\": null\n  }\n}";
+    return out.str();
+}
+
+// A basic block JSON line as basic_block_analysis::report() writes it
+std::string blockRecord(const std::string& kernel, uint64_t dispatch_id, uint64_t start, uint64_t duration,
+                        uint64_t count, double branchiness, uint64_t p99)
+{
+    std::ostringstream out;
+    out << "{\"kernel\": \"" << kernel << "\",\"kernel_file_name\": \"k.hip\",\"block_duration\": " << duration
+        << ",\"block_duration_p50\": 1,\"block_duration_p90\": 2,\"block_duration_p99\": " << p99
+        << ",\"block_end_line\": " << start + 3 << ",\"block_start_line\": " << start << ",\"dispatch_id\": "
+        << dispatch_id << ",\"block_branchiness\": " << branchiness << ",\"block_count\": " << count
+        << ",\"block_overhead\": 0.5,\"kernel_branchiness\": 0.1,\"instructions\": {\"s_load\": 4}}\n";
+    return out.str();
+}
+
+std::string writeTemp(const std::string& text)
+{
+    char path[] = "/tmp/result_merge_testXXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0)
+    {
+        if (write(fd, text.data(), text.size()) != static_cast<ssize_t>(text.size()))
+            std::cerr << "short write to " << path << std::endl;
+        close(fd);
+    }
+    return path;
+}
+
+const std::vector<fakeAccess_t> rank_accesses = {
+    {"/src/k.hip", 10, 5, "float x = a[i];", 100, 400, 400, false},
+    {"/src/k.hip", 12, 9, "printf(\"%d, %s\", x, \"y\");", 50, 200, 800, false},
+    {"/src/k.hip", 20, 3, "tile[t] = x;", 10, 7, 0, true},
+};
+
+// Three ranks: a finalized array, an array cut off before its closing bracket (a rank that crashed or
+// wasn't finalized) with a truncated last record, and basic block lines with a compute resources record
+std::vector<std::string> rankOutputs()
+{
+    std::string rank0 = "[\n" + memoryAnalysisRecord("_Z4gemmPf", 1, rank_accesses) + ",\n" +
+                        memoryAnalysisRecord("_Z4gemmPf", 2, rank_accesses) + ",\n" +
+                        memoryAnalysisRecord("_Z6reducePf", 3, {rank_accesses[0]}) + "\n]";
+    std::string truncated = memoryAnalysisRecord("_Z4gemmPf", 9, rank_accesses);
+    std::string rank1 = "[\n" + memoryAnalysisRecord("_Z4gemmPf", 1, rank_accesses, 25) + ",\n" +
+                        truncated.substr(0, truncated.size() / 2);
+    std::string rank2 = "{\"kernel\": \"_Z4gemmPf\", \"dispatch\": 1, \"resources\":[]}\n" +
+                        blockRecord("_Z4gemmPf", 1, 30, 1000, 10, 0.5, 40) +
+                        blockRecord("_Z4gemmPf", 2, 30, 3000, 30, 0.0, 90) +
+                        "Kernel: text the handler printed\n";
+    return {rank0, rank1, rank2};
+}
+
+std::string mergeToString(const std::vector<std::string>& paths, const mergeOptions_t& options)
+{
+    resultMerger merger(options);
+    CHECK(merger.merge(paths));
+    std::ostringstream out;
+    merger.write(out);
+    return out.str();
+}
+
+void testChunkStarts()
+{
+    std::string text = "[\n{\n  \"a\": {\n    \"b\": 1\n  }\n},\n{\n  \"c\": 2\n}\n]";
+    std::vector<size_t> starts = resultMerger::chunkStarts(text.data(), text.size(), 1);
+    CHECK_EQ(starts.size(), 3u);
+    CHECK_EQ(starts[0], 0u);
+    CHECK_EQ(text[starts[1]], '{');
+    CHECK_EQ(text[starts[1] - 1], '\n');
+    CHECK_EQ(text.compare(starts[2], 3, "{\n "), 0);
+    CHECK_EQ(resultMerger::chunkStarts(text.data(), text.size(), 1 << 20).size(), 1u);
+    CHECK(resultMerger::chunkStarts(text.data(), 0, 1).empty());
+}
+
+void testMerge()
+{
+    std::vector<std::string> paths;
+    for (const auto& output : rankOutputs())
+        paths.push_back(writeTemp(output));
+
+    mergeOptions_t options;
+    options.threads_ = 1;
+    resultMerger merger(options);
+    CHECK(merger.merge(paths));
+    const mergeTable& table = merger.table();
+    CHECK_EQ(table.records_, 6u);
+    CHECK_EQ(table.skipped_records_, 1u);
+    CHECK_EQ(table.malformed_records_, 1u);
+    CHECK_EQ(table.kernels_.size(), 2u);
+    const mergedKernel_t& gemm = table.kernels_.at("_Z4gemmPf");
+    // Dispatch 1 of each rank counts separately
+    CHECK_EQ(gemm.dispatches_.size(), 5u);
+    CHECK_EQ(gemm.messages_dropped_, 25u);
+    CHECK_EQ(static_cast<size_t>(std::count(gemm.inputs_.begin(), gemm.inputs_.end(), true)), 3u);
+
+    mergedAccessKey_t key{"_Z4gemmPf", MERGED_CACHE_LINES, "/src/k.hip", 12, 9, "read", 4, 4, "global_load_dword"};
+    auto access = table.accesses_.find(key);
+    CHECK(access != table.accesses_.end());
+    if (access != table.accesses_.end())
+    {
+        CHECK_EQ(access->second.execution_count_, 150u);
+        CHECK_EQ(access->second.cache_lines_needed_, 600u);
+        CHECK_EQ(access->second.cache_lines_used_, 2400u);
+        CHECK_EQ(access->second.dispatches_, 3u);
+        CHECK_EQ(access->second.code_context_, std::string("printf(\"%d, %s\", x, \"y\");"));
+    }
+    mergedAccessKey_t lds{"_Z4gemmPf", MERGED_BANK_CONFLICTS, "/src/k.hip", 20, 3, "read", 4, 0, ""};
+    CHECK(table.accesses_.count(lds) == 1);
+    if (table.accesses_.count(lds))
+        CHECK_EQ(table.accesses_.at(lds).bank_conflicts_, 21u);
+
+    mergedBlockKey_t block_key{"_Z4gemmPf", false, "k.hip", 0, 30, 33, ""};
+    CHECK(table.blocks_.count(block_key) == 1);
+    if (table.blocks_.count(block_key))
+    {
+        const mergedBlock_t& block = table.blocks_.at(block_key);
+        CHECK_EQ(block.duration_, 4000u);
+        CHECK_EQ(block.count_, 40u);
+        // 10 visits at half the lanes and 30 at all of them
+        CHECK_EQ(block.thread_count_, 10u * 32 + 30u * 64);
+        CHECK_EQ(block.duration_p99_max_, 90u);
+        CHECK_EQ(block.dispatches_, 2u);
+    }
+
+    // The report is JSON, and the same however the work is split up
+    std::string report = mergeToString(paths, options);
+    jsonValue parsed;
+    jsonReader reader(report.data(), report.data() + report.size());
+    CHECK(reader.read(parsed));
+    const jsonValue *kernels = parsed.find("kernels");
+    CHECK(kernels && kernels->items().size() == 2);
+    if (kernels && kernels->items().size() == 2)
+    {
+        const jsonValue& first = kernels->items()[0];
+        CHECK_EQ(first.stringAt("name"), std::string("_Z4gemmPf"));
+        CHECK_EQ(first.uintAt("processes"), 3u);
+        CHECK_EQ(first.find("cache_analysis")->find("accesses")->items().size(), 2u);
+        CHECK_EQ(first.find("basic_blocks")->items().size(), 1u);
+        CHECK_EQ(first.find("basic_blocks")->items()[0].doubleAt("branchiness"), 0.125);
+    }
+    options.threads_ = 4;
+    options.chunk_bytes_ = 64;
+    CHECK(mergeToString(paths, options) == report);
+
+    for (const auto& path : paths)
+        unlink(path.c_str());
+    resultMerger missing;
+    CHECK(!missing.merge({"/nonexistent/omniprobe/output.json"}));
+}
+
+void testEmpty()
+{
+    std::string path = writeTemp("");
+    resultMerger merger;
+    CHECK(merger.merge({path}));
+    CHECK_EQ(merger.table().records_, 0u);
+    std::ostringstream out;
+    merger.write(out);
+    jsonValue parsed;
+    std::string report = out.str();
+    jsonReader report_reader(report.data(), report.data() + report.size());
+    CHECK(report_reader.read(parsed));
+    CHECK(parsed.find("kernels") && parsed.find("kernels")->items().empty());
+    unlink(path.c_str());
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testChunkStarts);
+    RUN_TEST(testMerge);
+    RUN_TEST(testEmpty);
+    return unit_test::finish();
+}
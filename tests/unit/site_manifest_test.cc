@@ -0,0 +1,250 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/site_manifest.h"
+#include "unit_test.h"
+
+#include <elf.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+void put(std::vector<uint8_t>& bytes, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// A manifest as InstrumentationSiteManifest::emit writes it
+std::vector<uint8_t> makeManifest(const std::vector<siteRecord_t>& sites, const std::vector<std::string>& files)
+{
+    std::vector<uint8_t> bytes = {'O', 'P', 'S', 'M'};
+    put(bytes, SITE_MANIFEST_VERSION, 2);
+    put(bytes, sizeof(siteRecord_t), 2);
+    put(bytes, sites.size(), 4);
+    put(bytes, files.size(), 4);
+    for (const siteRecord_t& site : sites)
+    {
+        put(bytes, site.file_, 4);
+        put(bytes, site.line_, 4);
+        put(bytes, site.column_, 4);
+        put(bytes, site.addr_space_, 1);
+        put(bytes, site.access_kind_, 1);
+        put(bytes, site.size_, 2);
+    }
+    for (const std::string& file : files)
+    {
+        bytes.insert(bytes.end(), file.begin(), file.end());
+        bytes.push_back(0);
+    }
+    return bytes;
+}
+
+const std::vector<siteRecord_t> SITES = {
+    {0, 12, 5, 1, 0b01, 4},
+    {1, 40, 9, 3, 0b10, 16},
+    {0, 13, 7, 1, 0b10, 8},
+};
+const std::vector<std::string> FILES = {"/src/kernel.hip", "/src/helpers.h"};
+
+void testParse()
+{
+    siteManifest manifest;
+    std::vector<uint8_t> bytes = makeManifest(SITES, FILES);
+    CHECK(manifest.parse(bytes.data(), bytes.size()));
+    CHECK_EQ(manifest.size(), 3u);
+    CHECK_EQ(manifest[1].line_, 40u);
+    CHECK_EQ(manifest[1].column_, 9u);
+    CHECK_EQ(manifest[1].addr_space_, 3);
+    CHECK_EQ(manifest[1].access_kind_, 0b10);
+    CHECK_EQ(manifest[1].size_, 16);
+    CHECK_EQ(manifest.fileName(manifest[1]), "/src/helpers.h");
+    CHECK_EQ(manifest.fileName(manifest[2]), "/src/kernel.hip");
+
+    // Messages refer to a site by id, with the flag in place of the line
+    const siteRecord_t *site = manifest.find(2, SITE_MANIFEST_LINE_FLAG);
+    CHECK(site == &manifest[2]);
+    CHECK(manifest.find(3, SITE_MANIFEST_LINE_FLAG) == nullptr);
+    CHECK(manifest.find(2, 13) == nullptr);
+}
+
+void testMemberSites()
+{
+    // Version 2 on: each member of an access group has a site of its own, following the group's
+    siteManifest manifest;
+    std::vector<uint8_t> bytes = makeManifest(SITES, FILES);
+    CHECK(manifest.parse(bytes.data(), bytes.size()));
+    CHECK_EQ(manifest.version(), SITE_MANIFEST_VERSION);
+    CHECK_EQ(manifest.memberSite(1, 0), 1u);
+    CHECK_EQ(manifest.memberSite(1, 1), 2u);
+
+    // Version 1: the members share the group's site
+    std::vector<uint8_t> v1 = bytes;
+    v1[4] = 1;
+    CHECK(manifest.parse(v1.data(), v1.size()));
+    CHECK_EQ(manifest.version(), 1);
+    CHECK_EQ(manifest.size(), 3u);
+    CHECK_EQ(manifest.memberSite(1, 0), 1u);
+    CHECK_EQ(manifest.memberSite(1, 1), 1u);
+}
+
+void testMalformed()
+{
+    siteManifest manifest;
+    std::vector<uint8_t> bytes = makeManifest(SITES, FILES);
+    CHECK(!manifest.parse(bytes.data(), 12));
+    // truncated file names
+    CHECK(!manifest.parse(bytes.data(), bytes.size() - 4));
+    CHECK_EQ(manifest.size(), 0u);
+
+    std::vector<uint8_t> bad_magic = bytes;
+    bad_magic[0] = 'X';
+    CHECK(!manifest.parse(bad_magic.data(), bad_magic.size()));
+
+    std::vector<uint8_t> bad_version = bytes;
+    bad_version[4] = SITE_MANIFEST_VERSION + 1;
+    CHECK(!manifest.parse(bad_version.data(), bad_version.size()));
+    bad_version[4] = 0;
+    CHECK(!manifest.parse(bad_version.data(), bad_version.size()));
+    CHECK_EQ(manifest.version(), 0);
+
+    // a site that refers to a file that isn't there
+    std::vector<siteRecord_t> sites = SITES;
+    sites[0].file_ = 2;
+    std::vector<uint8_t> bad_file = makeManifest(sites, FILES);
+    CHECK(!manifest.parse(bad_file.data(), bad_file.size()));
+
+    // an empty manifest, for a clone without instrumented accesses, is fine
+    std::vector<uint8_t> empty = makeManifest({}, {});
+    CHECK(manifest.parse(empty.data(), empty.size()));
+    CHECK_EQ(manifest.size(), 0u);
+}
+
+/* A minimal code object: a .rodata section holding the data at a non-zero address, and a symbol table
+ * with one symbol per (name, offset into data, size) */
+struct testSymbol {
+    std::string name;
+    uint64_t offset;
+    uint64_t size;
+    unsigned char type;
+};
+
+std::vector<uint8_t> makeElf(const std::vector<uint8_t>& data, const std::vector<testSymbol>& symbols)
+{
+    const uint64_t rodata_addr = 0x1000;
+    std::string strtab(1, '\0');
+    std::vector<Elf64_Sym> syms(1);
+    for (const testSymbol& s : symbols)
+    {
+        Elf64_Sym sym = {};
+        sym.st_name = strtab.size();
+        sym.st_info = ELF64_ST_INFO(STB_GLOBAL, s.type);
+        sym.st_shndx = 1;
+        sym.st_value = rodata_addr + s.offset;
+        sym.st_size = s.size;
+        syms.push_back(sym);
+        strtab += s.name;
+        strtab.push_back('\0');
+    }
+
+    std::vector<uint8_t> image(sizeof(Elf64_Ehdr));
+    auto append = [&image](const void *p, size_t n) {
+        size_t offset = image.size();
+        image.insert(image.end(), static_cast<const uint8_t *>(p), static_cast<const uint8_t *>(p) + n);
+        return offset;
+    };
+    size_t rodata_offset = append(data.data(), data.size());
+    size_t symtab_offset = append(syms.data(), syms.size() * sizeof(Elf64_Sym));
+    size_t strtab_offset = append(strtab.data(), strtab.size());
+    image.resize((image.size() + 7) & ~size_t(7));
+
+    Elf64_Shdr shdrs[4] = {};
+    shdrs[1].sh_type = SHT_PROGBITS;
+    shdrs[1].sh_addr = rodata_addr;
+    shdrs[1].sh_offset = rodata_offset;
+    shdrs[1].sh_size = data.size();
+    shdrs[2].sh_type = SHT_SYMTAB;
+    shdrs[2].sh_offset = symtab_offset;
+    shdrs[2].sh_size = syms.size() * sizeof(Elf64_Sym);
+    shdrs[2].sh_entsize = sizeof(Elf64_Sym);
+    shdrs[2].sh_link = 3;
+    shdrs[3].sh_type = SHT_STRTAB;
+    shdrs[3].sh_offset = strtab_offset;
+    shdrs[3].sh_size = strtab.size();
+    size_t shoff = append(shdrs, sizeof(shdrs));
+
+    Elf64_Ehdr ehdr = {};
+    memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_shoff = shoff;
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = 4;
+    memcpy(image.data(), &ehdr, sizeof(ehdr));
+    return image;
+}
+
+void testFindInElf()
+{
+    std::vector<uint8_t> first = makeManifest(SITES, FILES);
+    std::vector<uint8_t> second = makeManifest({SITES[1]}, FILES);
+    std::vector<uint8_t> data(8, 0xcd);
+    size_t first_offset = data.size();
+    data.insert(data.end(), first.begin(), first.end());
+    size_t second_offset = data.size();
+    data.insert(data.end(), second.begin(), second.end());
+
+    std::vector<uint8_t> image = makeElf(data, {
+        {"__amd_crk_kernelPv", 0, 8, STT_FUNC},
+        {"__amd_crk_kernelPv" SITE_MANIFEST_SUFFIX, first_offset, first.size(), STT_OBJECT},
+        {"__amd_crk_otherPv" SITE_MANIFEST_SUFFIX, second_offset, second.size(), STT_OBJECT},
+        // not a manifest, only named like one
+        {"bogus" SITE_MANIFEST_SUFFIX, 0, 8, STT_OBJECT},
+    });
+
+    siteManifestMap_t manifests;
+    CHECK_EQ(findSiteManifests(image.data(), image.size(), manifests), 2u);
+    CHECK_EQ(manifests.size(), 2u);
+    CHECK(manifests.count("__amd_crk_kernelPv") == 1);
+    CHECK(manifests.count("__amd_crk_otherPv") == 1);
+    CHECK_EQ(manifests["__amd_crk_kernelPv"]->size(), 3u);
+    CHECK_EQ(manifests["__amd_crk_otherPv"]->size(), 1u);
+    CHECK_EQ((*manifests["__amd_crk_otherPv"])[0].line_, 40u);
+
+    // Not an ELF file, or cut short
+    CHECK_EQ(findSiteManifests(data.data(), data.size(), manifests), 0u);
+    siteManifestMap_t none;
+    CHECK_EQ(findSiteManifests(image.data(), image.size() / 2, none), 0u);
+    CHECK(none.empty());
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testParse);
+    RUN_TEST(testMemberSites);
+    RUN_TEST(testMalformed);
+    RUN_TEST(testFindInElf);
+    return unit_test::finish();
+}
@@ -0,0 +1,129 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/synthetic_messages.h"
+#include "inc/timing_region.h"
+#include "unit_test.h"
+
+#include <set>
+#include <vector>
+
+namespace {
+
+std::vector<syntheticMessage_t> generate(syntheticPattern_t pattern, const syntheticConfig_t& config)
+{
+    std::vector<syntheticMessage_t> messages;
+    generateSyntheticMessages(pattern, config, [&](const syntheticMessage_t& message) { messages.push_back(message); });
+    return messages;
+}
+
+void testPatternNames()
+{
+    for (int i = 0; i < SYNTHETIC_PATTERN_COUNT; i++)
+    {
+        syntheticPattern_t pattern = SYNTHETIC_PATTERN_COUNT;
+        CHECK(parseSyntheticPattern(syntheticPatternName(static_cast<syntheticPattern_t>(i)), pattern));
+        CHECK_EQ(static_cast<int>(pattern), i);
+    }
+    syntheticPattern_t pattern;
+    CHECK(!parseSyntheticPattern("bogus", pattern));
+}
+
+void testAddresses()
+{
+    syntheticConfig_t config;
+    config.waves_ = 8;
+    config.messages_per_wave_ = 4;
+    config.active_lanes_ = 48;
+    auto messages = generate(SYNTHETIC_COALESCED, config);
+    CHECK_EQ(messages.size(), 32u);
+    const syntheticMessage_t& first = messages[0];
+    CHECK_EQ(first.kind_, SYNTHETIC_ADDRESS_MESSAGE);
+    CHECK_EQ(first.exec_, (1ull << 48) - 1);
+    CHECK_EQ(first.items_.size(), 48u);
+    CHECK_EQ(first.item_size_, 8u);
+    CHECK_EQ(first.items_[47] - first.items_[0], 47u * 4);
+    CHECK_EQ((first.user_data_ >> 2) & 0xf, SYNTHETIC_GLOBAL_SPACE);
+    CHECK_EQ((first.user_data_ >> 6) & 0xffff, 4u);
+    // Four waves to a block
+    CHECK_EQ(messages[4 * 4].block_idx_x_, 1u);
+    CHECK_EQ(messages[4 * 4].wave_num_, 0u);
+    CHECK_EQ(messages[4 * 5].wave_num_, 1u);
+
+    auto strided = generate(SYNTHETIC_STRIDED, config);
+    CHECK(strided[0].items_[1] - strided[0].items_[0] >= 128);
+
+    auto lds = generate(SYNTHETIC_LDS_CONFLICT, config);
+    for (const auto& message : lds)
+    {
+        CHECK_EQ((message.user_data_ >> 2) & 0xf, SYNTHETIC_LDS_SPACE);
+        for (uint64_t address : message.items_)
+            CHECK(address < 64 * 1024);
+    }
+
+    // The same seed gives the same gather
+    auto gather = generate(SYNTHETIC_GATHER, config);
+    auto again = generate(SYNTHETIC_GATHER, config);
+    CHECK(gather[3].items_ == again[3].items_);
+    std::set<uint64_t> distinct(gather[0].items_.begin(), gather[0].items_.end());
+    CHECK(distinct.size() > 40);
+}
+
+void testTimes()
+{
+    syntheticConfig_t config;
+    config.waves_ = 4;
+    config.messages_per_wave_ = 6;
+    config.sites_ = 5;
+    auto intervals = generate(SYNTHETIC_TIME_INTERVALS, config);
+    for (const auto& message : intervals)
+    {
+        CHECK_EQ(message.kind_, SYNTHETIC_TIME_INTERVAL_MESSAGE);
+        CHECK_EQ(message.item_size_, 16u);
+        CHECK_EQ(message.items_.size(), 2u);
+        CHECK(message.items_[1] > message.items_[0]);
+        CHECK(!isTimingRegion(message.user_data_));
+    }
+
+    auto regions = generate(SYNTHETIC_TIMING_REGIONS, config);
+    timingRegionTable table;
+    for (const auto& message : regions)
+    {
+        CHECK(isTimingRegion(message.user_data_));
+        table.record(message.user_data_, message.dwarf_fname_hash_, message.dwarf_line_, message.dwarf_column_, 64,
+                     message.items_[1] - message.items_[0]);
+    }
+    CHECK_EQ(table.size(), 5u);
+    CHECK_EQ(table[0].depth_, 0u);
+    CHECK_EQ(table[4].parent_, 2u);
+    CHECK_EQ(table[4].depth_, 3u);
+    CHECK_EQ(table[0].count_, 8u);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testPatternNames);
+    RUN_TEST(testAddresses);
+    RUN_TEST(testTimes);
+    return unit_test::finish();
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/telemetry.h"
+#include "unit_test.h"
+
+#include <atomic>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string testName(const char *suffix)
+{
+    return "/omniprobe_test." + std::to_string(getpid()) + "." + suffix;
+}
+
+void testDisabled()
+{
+    // No active segment: updates go nowhere and timers don't read the clock
+    CHECK(!telemetryEnabled());
+    telemetryCount(TELEMETRY_DISPATCHES);
+    telemetryRecord(TELEMETRY_FIXUP_NS, 100);
+    {
+        telemetryTimer timer(TELEMETRY_FIXUP_NS);
+    }
+    telemetrySegment segment;
+    telemetry_snapshot_t snapshot;
+    CHECK(!segment.snapshot(snapshot));
+    CHECK(!segment.attach(testName("missing")));
+}
+
+void testBuckets()
+{
+    CHECK_EQ(telemetrySegment::bucket(0), 0u);
+    CHECK_EQ(telemetrySegment::bucket(1), 1u);
+    CHECK_EQ(telemetrySegment::bucket(2), 2u);
+    CHECK_EQ(telemetrySegment::bucket(3), 2u);
+    CHECK_EQ(telemetrySegment::bucket(4), 3u);
+    CHECK_EQ(telemetrySegment::bucket(1023), 10u);
+    CHECK_EQ(telemetrySegment::bucket(1024), 11u);
+    CHECK_EQ(telemetrySegment::bucket(UINT64_MAX), static_cast<uint32_t>(TELEMETRY_BUCKETS - 1));
+}
+
+void testAttach()
+{
+    std::string name = testName("attach");
+    telemetrySegment writer;
+    CHECK(writer.create(name));
+    CHECK(!writer.create(name));
+    writer.activate();
+    CHECK(telemetryEnabled());
+    telemetryCount(TELEMETRY_PENDING_SIGNALS, 3);
+    telemetryCount(TELEMETRY_PENDING_SIGNALS, -1);
+    telemetryRecord(TELEMETRY_HANDLER_NS, 0);
+    telemetryRecord(TELEMETRY_HANDLER_NS, 1500);
+    {
+        telemetryTimer timer(TELEMETRY_FIXUP_NS);
+    }
+
+    // What `omniprobe stats` sees: a self describing header and the shards summed up
+    telemetrySegment reader;
+    CHECK(reader.attach(name));
+    telemetry_snapshot_t snapshot;
+    CHECK(reader.snapshot(snapshot));
+    CHECK_EQ(snapshot.counters_[TELEMETRY_PENDING_SIGNALS], 2);
+    CHECK_EQ(snapshot.counters_[TELEMETRY_DISPATCHES], 0);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].count_, 2);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].sum_, 1500);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].buckets_[0], 1);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].buckets_[11], 1);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_FIXUP_NS].count_, 1);
+
+    writer.deactivate();
+    CHECK(!telemetryEnabled());
+    telemetryCount(TELEMETRY_PENDING_SIGNALS);
+    CHECK(reader.snapshot(snapshot));
+    CHECK_EQ(snapshot.counters_[TELEMETRY_PENDING_SIGNALS], 2);
+}
+
+void testHeader()
+{
+    std::string name = testName("header");
+    {
+        telemetrySegment writer;
+        CHECK(writer.create(name));
+        CHECK_EQ(writer.name(), name);
+        telemetrySegment reader;
+        CHECK(reader.attach(name));
+    }
+    // The creator unlinks the segment when it goes away
+    telemetrySegment reader;
+    CHECK(!reader.attach(name));
+    CHECK(telemetrySegment::defaultName() == "/omniprobe." + std::to_string(getpid()));
+}
+
+void testConcurrent()
+{
+    // Every update from every writer lands exactly once, whatever shards the threads end up sharing
+    const int THREADS = 24;
+    const int UPDATES = 100000;
+    std::string name = testName("concurrent");
+    telemetrySegment writer;
+    CHECK(writer.create(name));
+    writer.activate();
+    telemetrySegment reader;
+    CHECK(reader.attach(name));
+    std::vector<std::thread> threads;
+    std::atomic<bool> done(false);
+    // A reader snapshotting while the writers run never sees a counter go backwards
+    int regressions = 0;
+    std::thread watcher([&]() {
+        int64_t last = 0;
+        while (!done.load())
+        {
+            telemetry_snapshot_t snapshot;
+            reader.snapshot(snapshot);
+            if (snapshot.counters_[TELEMETRY_MESSAGES] < last)
+                regressions++;
+            last = snapshot.counters_[TELEMETRY_MESSAGES];
+        }
+    });
+    for (int t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < UPDATES; i++)
+            {
+                telemetryCount(TELEMETRY_MESSAGES);
+                telemetryCount(TELEMETRY_COMMS_IN_USE, i % 2 ? -1 : 1);
+                telemetryRecord(TELEMETRY_HANDLER_NS, t);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    done = true;
+    watcher.join();
+    writer.deactivate();
+
+    telemetry_snapshot_t snapshot;
+    CHECK(reader.snapshot(snapshot));
+    CHECK_EQ(regressions, 0);
+    CHECK_EQ(snapshot.counters_[TELEMETRY_MESSAGES], static_cast<int64_t>(THREADS) * UPDATES);
+    CHECK_EQ(snapshot.counters_[TELEMETRY_COMMS_IN_USE], 0);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].count_, static_cast<int64_t>(THREADS) * UPDATES);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].sum_, static_cast<int64_t>(THREADS) * (THREADS - 1) / 2 * UPDATES);
+    int64_t buckets = 0;
+    for (int b = 0; b < TELEMETRY_BUCKETS; b++)
+        buckets += snapshot.histograms_[TELEMETRY_HANDLER_NS].buckets_[b];
+    CHECK_EQ(buckets, static_cast<int64_t>(THREADS) * UPDATES);
+    CHECK_EQ(snapshot.histograms_[TELEMETRY_HANDLER_NS].buckets_[0], static_cast<int64_t>(UPDATES));
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testDisabled);
+    RUN_TEST(testBuckets);
+    RUN_TEST(testAttach);
+    RUN_TEST(testHeader);
+    RUN_TEST(testConcurrent);
+    return unit_test::finish();
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/access_group.h"
+#include "inc/timing_region.h"
+#include "unit_test.h"
+
+namespace {
+
+uint32_t regionUserData(uint32_t idx, uint32_t parent, uint32_t depth)
+{
+    return TIMING_REGION_FLAG | idx | (parent << TIMING_REGION_PARENT_SHIFT) | (depth << TIMING_REGION_DEPTH_SHIFT);
+}
+
+void testDecode()
+{
+    // basic block intervals carry a plain block index
+    CHECK(!isTimingRegion(17));
+
+    uint32_t user_data = regionUserData(4095, 12, 15);
+    CHECK(isTimingRegion(user_data));
+    CHECK_EQ(timingRegionIndex(user_data), 4095u);
+    CHECK_EQ(timingRegionParent(user_data), 12u);
+    CHECK_EQ(timingRegionDepth(user_data), 15u);
+
+    // the kernel region
+    CHECK_EQ(TIMING_REGION_FLAG, 0x80000000u);
+    CHECK_EQ(timingRegionIndex(TIMING_REGION_FLAG), 0u);
+    CHECK_EQ(timingRegionDepth(TIMING_REGION_FLAG), 0u);
+}
+
+void testRecord()
+{
+    timingRegionTable table;
+    CHECK(table.empty());
+    // regions show up in any order, e.g. an inner loop finishes before the kernel does
+    table.record(regionUserData(2, 1, 2), 0x1234, 11, 12, 64, 100);
+    table.record(regionUserData(2, 1, 2), 0x1234, 11, 12, 32, 300);
+    CHECK_EQ(table.size(), 3u);
+    CHECK_EQ(table[0].count_, 0u);
+    CHECK_EQ(table[1].count_, 0u);
+    const timingRegionInfo_t& inner = table[2];
+    CHECK_EQ(inner.count_, 2u);
+    CHECK_EQ(inner.thread_count_, 96u);
+    CHECK_EQ(inner.duration_, 400u);
+    CHECK_EQ(inner.fname_hash_, 0x1234u);
+    CHECK_EQ(inner.start_line_, 11u);
+    CHECK_EQ(inner.end_line_, 12u);
+    CHECK_EQ(inner.parent_, 1u);
+    CHECK_EQ(inner.depth_, 2u);
+    CHECK_EQ(table.durations(2).count(), 2u);
+
+    table.clear();
+    CHECK(table.empty());
+}
+
+void testSelfDuration()
+{
+    // kernel (0) > outer loop (1) > inner loop (2), plus a sibling loop (3) in the kernel
+    timingRegionTable table;
+    table.record(regionUserData(0, 0, 0), 0, 10, 30, 64, 1000);
+    table.record(regionUserData(1, 0, 1), 0, 12, 20, 64, 600);
+    table.record(regionUserData(2, 1, 2), 0, 14, 16, 64, 250);
+    table.record(regionUserData(2, 1, 2), 0, 14, 16, 64, 250);
+    table.record(regionUserData(3, 0, 1), 0, 22, 28, 64, 300);
+    CHECK_EQ(table.selfDuration(0), 100u);
+    CHECK_EQ(table.selfDuration(1), 100u);
+    CHECK_EQ(table.selfDuration(2), 500u);
+    CHECK_EQ(table.selfDuration(3), 300u);
+    uint64_t total = 0;
+    for (size_t idx = 0; idx < table.size(); idx++)
+        total += table.selfDuration(idx);
+    CHECK_EQ(total, table[0].duration_);
+
+    // children that add up to more than their parent (e.g. a lost message) leave it no self time
+    table.record(regionUserData(1, 0, 1), 0, 12, 20, 64, 1000);
+    CHECK_EQ(table.selfDuration(0), 0u);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testDecode);
+    RUN_TEST(testRecord);
+    RUN_TEST(testSelfDuration);
+    return unit_test::finish();
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+#pragma once
+
+// Minimal helpers for the host-only unit tests. Each test file defines test functions,
+// registers them with RUN_TEST in main() and returns unit_test::finish().
+
+#include <iostream>
+
+namespace unit_test {
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+inline int finish()
+{
+    if (failures())
+        std::cerr << failures() << " check(s) failed" << std::endl;
+    else
+        std::cout << "All tests passed" << std::endl;
+    return failures() ? 1 : 0;
+}
+
+} // namespace unit_test
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" \
+                      << std::endl;                                                 \
+            unit_test::failures()++;                                                \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                              \
+    do {                                                                            \
+        auto va_ = (a);                                                             \
+        auto vb_ = (b);                                                             \
+        if (!(va_ == vb_)) {                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b    \
+                      << ") failed: " << va_ << " != " << vb_ << std::endl;         \
+            unit_test::failures()++;                                                \
+        }                                                                           \
+    } while (0)
+
+#define RUN_TEST(fn)                                                                \
+    do {                                                                            \
+        std::cout << "[ RUN ] " #fn << std::endl;                                   \
+        fn();                                                                       \
+    } while (0)
@@ -0,0 +1,180 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/wave_encoding.h"
+#include "unit_test.h"
+
+#include <vector>
+
+namespace {
+
+template<typename Address> std::vector<uint64_t> laneAddresses(uint64_t exec, Address address)
+{
+    std::vector<uint64_t> addresses;
+    for (uint32_t lane = 0; lane < 64; lane++)
+        if (exec & (1ull << lane))
+            addresses.push_back(address(lane));
+    return addresses;
+}
+
+// Encodes, checks the encoding chosen and the item count, and decodes again
+void roundTrip(uint64_t exec, const std::vector<uint64_t>& addresses, uint32_t encoding, size_t item_count)
+{
+    std::vector<uint64_t> items;
+    uint32_t column = encodeWaveAddresses(17, exec, addresses, items);
+    CHECK_EQ(waveEncoding(column), encoding);
+    CHECK_EQ(waveEncodingColumn(column), 17u);
+    CHECK_EQ(items.size(), item_count);
+    if (encoding == WAVE_ENCODING_RAW)
+    {
+        CHECK(!isWaveEncoded(column));
+        CHECK(items == addresses);
+        return;
+    }
+    uint64_t decoded_exec = 0;
+    std::vector<uint64_t> decoded;
+    CHECK(decodeWaveAddresses(column, items.data(), items.size(), decoded_exec, decoded));
+    CHECK_EQ(decoded_exec, exec);
+    CHECK(decoded == addresses);
+}
+
+void testAffine()
+{
+    // Unit stride, full wave: 24 bytes instead of 512
+    roundTrip(~0ull, laneAddresses(~0ull, [](uint32_t lane) { return 0x7f0000001000ull + 4 * lane; }),
+              WAVE_ENCODING_AFFINE, 3);
+    // Broadcast
+    roundTrip(~0ull, laneAddresses(~0ull, [](uint32_t) { return 0x7f0000002000ull; }), WAVE_ENCODING_AFFINE, 3);
+    // Negative stride, and lanes missing from the exec mask, including the first ones
+    uint64_t exec = 0xf0f0f0f0f0f0f0f0ull;
+    roundTrip(exec, laneAddresses(exec, [](uint32_t lane) { return 0x7f0000004000ull - 16 * lane; }),
+              WAVE_ENCODING_AFFINE, 3);
+    // A gap between the first two active lanes
+    exec = 0xfffffffffffffff1ull;
+    roundTrip(exec, laneAddresses(exec, [](uint32_t lane) { return 0x1000ull + 8 * lane; }),
+              WAVE_ENCODING_AFFINE, 3);
+}
+
+void testDictionary()
+{
+    roundTrip(~0ull, laneAddresses(~0ull, [](uint32_t lane) { return 0x5000ull + 0x100 * (lane / 32); }),
+              WAVE_ENCODING_DICTIONARY, 5);
+    uint64_t exec = 0x00ff00ff00ff00ffull;
+    roundTrip(exec, laneAddresses(exec, [](uint32_t lane) { return 0x9000ull + 0x40 * (lane % 2) + (lane & 16); }),
+              WAVE_ENCODING_DICTIONARY, 7);
+}
+
+void testRaw()
+{
+    // Five distinct addresses that aren't affine
+    roundTrip(~0ull, laneAddresses(~0ull, [](uint32_t lane) { return 0x1000ull * ((lane * 7) % 5); }),
+              WAVE_ENCODING_RAW, 64);
+    // Too few active lanes for an encoding to pay off
+    uint64_t exec = 0x8000000000000101ull;
+    roundTrip(exec, laneAddresses(exec, [](uint32_t lane) { return 0x1000ull + 4 * lane; }), WAVE_ENCODING_RAW, 3);
+    // Columns that don't fit next to the encoding bits
+    std::vector<uint64_t> items;
+    std::vector<uint64_t> addresses(64, 0x1000);
+    CHECK_EQ(encodeWaveAddresses(WAVE_ENCODING_COLUMN_MASK + 1, ~0ull, addresses, items), WAVE_ENCODING_COLUMN_MASK + 1);
+    CHECK_EQ(items.size(), 64u);
+}
+
+void testMalformed()
+{
+    uint64_t exec = 0;
+    std::vector<uint64_t> addresses;
+    uint32_t affine = WAVE_ENCODING_COLUMN_FLAG | (WAVE_ENCODING_AFFINE << WAVE_ENCODING_SHIFT);
+    uint32_t dictionary = WAVE_ENCODING_COLUMN_FLAG | (WAVE_ENCODING_DICTIONARY << WAVE_ENCODING_SHIFT);
+    uint64_t items[] = {0xf, 0x3, 0xc, 0x100, 0x200, 0x300, 0x400, 0x500};
+    CHECK(!decodeWaveAddresses(affine, items, 2, exec, addresses));
+    CHECK(!decodeWaveAddresses(dictionary, items, 3, exec, addresses));
+    CHECK(!decodeWaveAddresses(dictionary, items, 8, exec, addresses));
+    // lanes 2 and 3 have index 2 but there are only two values
+    CHECK(!decodeWaveAddresses(dictionary, items, 5, exec, addresses));
+    CHECK(addresses.empty());
+    CHECK(decodeWaveAddresses(dictionary, items, 6, exec, addresses));
+    CHECK(addresses == std::vector<uint64_t>({0x200, 0x200, 0x300, 0x300}));
+    uint64_t no_lanes[] = {0, 0x100, 4};
+    CHECK(!decodeWaveAddresses(affine, no_lanes, 3, exec, addresses));
+    // Neither access groups nor affine summaries are encoded messages
+    CHECK(!isWaveEncoded(affine | 0x40000000u));
+    CHECK(!isWaveEncoded(affine | 0x80000000u));
+    CHECK_EQ(waveEncodingColumn(0x40000000u | 0x20000005u), 0x60000005u);
+}
+
+// The parts of dh_comms::message_t the view uses
+struct fakeHeader {
+    uint64_t exec;
+    uint32_t dwarf_column;
+    uint32_t active_lane_count;
+};
+
+struct fakeMessage {
+    fakeHeader header_;
+    std::vector<uint64_t> items_;
+    const fakeHeader& wave_header() const { return header_; }
+    size_t no_data_items() const { return items_.size(); }
+    size_t data_item_size() const { return sizeof(uint64_t); }
+    const void *data_item(size_t i) const { return &items_[i]; }
+};
+
+void testView()
+{
+    uint64_t exec = 0xffffffff00000000ull;
+    std::vector<uint64_t> addresses = laneAddresses(exec, [](uint32_t lane) { return 0x2000ull + 8 * lane; });
+    std::vector<uint64_t> items;
+    uint32_t column = encodeWaveAddresses(9, exec, addresses, items);
+    // Sent by the first three lanes
+    fakeMessage encoded = {{0x7, column, 3}, items};
+    waveAddressView<fakeMessage> view(encoded);
+    CHECK(view.encoded());
+    CHECK(view.valid());
+    CHECK_EQ(view.wave_header().exec, exec);
+    CHECK_EQ(view.wave_header().dwarf_column, 9u);
+    CHECK_EQ(view.wave_header().active_lane_count, 32u);
+    CHECK_EQ(view.no_data_items(), 32u);
+    for (size_t i = 0; i != view.no_data_items(); ++i)
+        CHECK_EQ(*static_cast<const uint64_t *>(view.data_item(i)), addresses[i]);
+
+    fakeMessage raw = {{exec, 9, 32}, addresses};
+    waveAddressView<fakeMessage> raw_view(raw);
+    CHECK(!raw_view.encoded());
+    CHECK_EQ(raw_view.wave_header().exec, exec);
+    CHECK_EQ(raw_view.no_data_items(), 32u);
+    CHECK(raw_view.data_item(5) == raw.data_item(5));
+
+    fakeMessage broken = {{0x3, column, 2}, {exec, 0x2000}};
+    waveAddressView<fakeMessage> broken_view(broken);
+    CHECK(!broken_view.valid());
+    CHECK_EQ(broken_view.no_data_items(), 0u);
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testAffine);
+    RUN_TEST(testDictionary);
+    RUN_TEST(testRaw);
+    RUN_TEST(testMalformed);
+    RUN_TEST(testView);
+    return unit_test::finish();
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+Copyright (c) 2026 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*******************************************************************************/
+#include "inc/wave_state_table.h"
+#include "unit_test.h"
+
+#include <map>
+#include <random>
+#include <tuple>
+
+namespace {
+
+struct waveLess
+{
+    bool operator()(const waveIdentifier_t& a, const waveIdentifier_t& b) const
+    {
+        return std::tie(a.block_x_, a.block_y_, a.block_z_, a.wave_id_) <
+               std::tie(b.block_x_, b.block_y_, b.block_z_, b.wave_id_);
+    }
+};
+
+void testInsertFindErase()
+{
+    waveStateTable<uint64_t> table(16);
+    waveIdentifier_t a = {1, 2, 3, 4};
+    waveIdentifier_t b = {1, 2, 3, 5};
+    CHECK(table.find(a) == nullptr);
+    table.insert(a, 10);
+    table.insert(b, 20);
+    CHECK_EQ(table.size(), 2u);
+    CHECK_EQ(*table.find(a), 10u);
+    CHECK_EQ(*table.find(b), 20u);
+    table.insert(a, 11);
+    CHECK_EQ(table.size(), 2u);
+    CHECK_EQ(*table.find(a), 11u);
+    *table.find(b) = 21;
+    CHECK_EQ(*table.find(b), 21u);
+    CHECK(table.erase(a));
+    CHECK(!table.erase(a));
+    CHECK(table.find(a) == nullptr);
+    CHECK_EQ(*table.find(b), 21u);
+    table.clear();
+    CHECK_EQ(table.size(), 0u);
+    CHECK(table.find(b) == nullptr);
+}
+
+// Random inserts/erases/lookups checked against std::map, with a small key space so probe runs
+// collide, wrap around the end of the table and get shifted back on erase
+void testMatchesMap()
+{
+    waveStateTable<uint64_t> table(16);
+    std::map<waveIdentifier_t, uint64_t, waveLess> reference;
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<uint32_t> coord(0, 15);
+    std::uniform_int_distribution<int> op(0, 2);
+    for (uint64_t i = 0; i < 200000; i++)
+    {
+        waveIdentifier_t wave = {coord(generator), coord(generator), 0, coord(generator) % 4};
+        switch (op(generator))
+        {
+            case 0:
+                table.insert(wave, i);
+                reference[wave] = i;
+                break;
+            case 1:
+                CHECK_EQ(table.erase(wave), reference.erase(wave) == 1);
+                break;
+            default:
+            {
+                uint64_t *value = table.find(wave);
+                auto it = reference.find(wave);
+                CHECK_EQ(value != nullptr, it != reference.end());
+                if (value && it != reference.end())
+                    CHECK_EQ(*value, it->second);
+                break;
+            }
+        }
+    }
+    CHECK_EQ(table.size(), reference.size());
+    size_t visited = 0;
+    table.forEach([&](const waveIdentifier_t& wave, uint64_t value) {
+        auto it = reference.find(wave);
+        CHECK(it != reference.end());
+        if (it != reference.end())
+            CHECK_EQ(value, it->second);
+        visited++;
+    });
+    CHECK_EQ(visited, reference.size());
+}
+
+} // namespace
+
+int main()
+{
+    RUN_TEST(testInsertFindErase);
+    RUN_TEST(testMatchesMap);
+    return unit_test::finish();
+}